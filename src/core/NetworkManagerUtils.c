@@ -1898,8 +1898,18 @@ nm_platform_get()
 
 /*****************************************************************************/
 
+void
+nm_linux_platform_setup_full(const char *ignore_routes)
+{
+    gs_free const char **ignore_routes_strv = NULL;
+
+    ignore_routes_strv =
+        nm_utils_strsplit_set_full(ignore_routes, ",", NM_UTILS_STRSPLIT_SET_FLAGS_STRSTRIP);
+    nm_platform_setup(nm_linux_platform_new(FALSE, FALSE, ignore_routes_strv));
+}
+
 void
 nm_linux_platform_setup(void)
 {
-    nm_platform_setup(nm_linux_platform_new(FALSE, FALSE));
+    nm_linux_platform_setup_full(NULL);
 }
@@ -257,6 +257,7 @@ NMPlatform *nm_platform_get(void);
 #define NM_PLATFORM_GET (nm_platform_get())
 
 void nm_linux_platform_setup(void);
+void nm_linux_platform_setup_full(const char *ignore_routes);
 
 /*****************************************************************************/
 
@@ -2040,6 +2040,11 @@ nm_device_ethernet_class_init(NMDeviceEthernetClass *klass)
     device_class->connection_type_supported = NM_SETTING_WIRED_SETTING_NAME;
     device_class->link_types                = NM_DEVICE_DEFINE_LINK_TYPES(NM_LINK_TYPE_ETHERNET);
 
+    device_class->connection_types_compatible =
+        NM_DEVICE_DEFINE_CONNECTION_TYPES(NM_SETTING_WIRED_SETTING_NAME,
+                                          NM_SETTING_PPPOE_SETTING_NAME,
+                                          NM_SETTING_VETH_SETTING_NAME);
+
     device_class->get_generic_capabilities    = get_generic_capabilities;
     device_class->check_connection_compatible = check_connection_compatible;
     device_class->complete_connection         = complete_connection;
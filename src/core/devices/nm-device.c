@@ -49,6 +49,7 @@
 #include "nm-ip6-config.h"
 #include "nm-pacrunner-manager.h"
 #include "dnsmasq/nm-dnsmasq-manager.h"
+#include "dhcp/nm-dhcp-server.h"
 #include "nm-dhcp-config.h"
 #include "nm-rfkill-manager.h"
 #include "nm-firewall-manager.h"
@@ -592,6 +593,10 @@ typedef struct _NMDevicePrivate {
     NMDnsMasqManager *dnsmasq_manager;
     gulong            dnsmasq_state_id;
 
+    /* in-process DHCP server for shared connections, used instead
+     * of dnsmasq with "main.shared-dhcp=internal". */
+    NMDhcpServer *shared_dhcp_server;
+
     /* Firewall */
     FirewallState            fw_state : 4;
     NMFirewallManager *      fw_mgr;
@@ -687,10 +692,13 @@ typedef struct _NMDevicePrivate {
     guint sriov_reset_pending;
 
     struct {
-        guint   timeout_id;
         guint   refresh_rate_ms;
         guint64 tx_bytes;
         guint64 rx_bytes;
+
+        /* whether the device is realized and we (possibly) periodically
+         * refresh the statistics. */
+        bool active : 1;
     } stats;
 
     bool mtu_force_set_done : 1;
@@ -730,6 +738,7 @@ static guint _prop_get_ipv4_dad_timeout(NMDevice *self);
 
 static NMIP6Config *dad6_get_pending_addresses(NMDevice *self);
 
+static void   _stats_schedule_update(NMDevice *self);
 static void   _carrier_wait_check_queued_act_request(NMDevice *self);
 static gint64 _get_carrier_wait_ms(NMDevice *self);
 
@@ -2868,6 +2877,15 @@ nm_device_get_iface(NMDevice *self)
     return NM_DEVICE_GET_PRIVATE(self)->iface;
 }
 
+static void
+_manager_index_update(NMDevice *self)
+{
+    NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
+
+    if (priv->manager)
+        nm_manager_device_index_update(priv->manager, self);
+}
+
 static gboolean
 _set_ifindex(NMDevice *self, int ifindex, gboolean is_ip_ifindex)
 {
@@ -2888,6 +2906,8 @@ _set_ifindex(NMDevice *self, int ifindex, gboolean is_ip_ifindex)
 
     if (!is_ip_ifindex)
         _notify(self, PROP_IFINDEX);
+    else if (priv->stats.active)
+        _stats_schedule_update(self);
 
     if (priv->manager)
         nm_manager_emit_device_ifindex_changed(priv->manager, self);
@@ -3063,6 +3083,7 @@ _set_ip_ifindex(NMDevice *self, int ifindex, const char *ifname)
         g_free(priv->ip_iface_);
         priv->ip_iface_ = g_strdup(ifname);
         _notify(self, PROP_IP_IFACE);
+        _manager_index_update(self);
     }
 
     if (priv->ip_ifindex > 0) {
@@ -3315,22 +3336,6 @@ _stats_update_counters_from_pllink(NMDevice *self, const NMPlatformLink *pllink)
     _stats_update_counters(self, pllink->tx_bytes, pllink->rx_bytes);
 }
 
-static gboolean
-_stats_timeout_cb(gpointer user_data)
-{
-    NMDevice *self = user_data;
-    int       ifindex;
-
-    ifindex = nm_device_get_ip_ifindex(self);
-
-    _LOGT(LOGD_DEVICE, "stats: refresh %d", ifindex);
-
-    if (ifindex > 0)
-        nm_platform_link_refresh(nm_device_get_platform(self), ifindex);
-
-    return G_SOURCE_CONTINUE;
-}
-
 static guint
 _stats_refresh_rate_real(guint refresh_rate_ms)
 {
@@ -3348,6 +3353,21 @@ _stats_refresh_rate_real(guint refresh_rate_ms)
     return refresh_rate_ms;
 }
 
+static void
+_stats_schedule_update(NMDevice *self)
+{
+    NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
+
+    /* The platform schedules the refresh of all devices together, so that
+     * devices that are due at the same time share one netlink request.
+     * The result reaches us via device_link_changed(). */
+    nm_platform_link_stats_refresh_set(
+        nm_device_get_platform(self),
+        self,
+        priv->stats.active ? nm_device_get_ip_ifindex(self) : 0,
+        priv->stats.active ? _stats_refresh_rate_real(priv->stats.refresh_rate_ms) : 0u);
+}
+
 static void
 _stats_set_refresh_rate(NMDevice *self, guint refresh_rate_ms)
 {
@@ -3373,7 +3393,7 @@ _stats_set_refresh_rate(NMDevice *self, guint refresh_rate_ms)
     if (_stats_refresh_rate_real(old_rate) == refresh_rate_ms)
         return;
 
-    nm_clear_g_source(&priv->stats.timeout_id);
+    _stats_schedule_update(self);
 
     if (!refresh_rate_ms)
         return;
@@ -3384,8 +3404,6 @@ _stats_set_refresh_rate(NMDevice *self, guint refresh_rate_ms)
     ifindex = nm_device_get_ip_ifindex(self);
     if (ifindex > 0)
         nm_platform_link_refresh(nm_device_get_platform(self), ifindex);
-
-    priv->stats.timeout_id = g_timeout_add(refresh_rate_ms, _stats_timeout_cb, self);
 }
 
 /*****************************************************************************/
@@ -5365,6 +5383,7 @@ device_link_changed(NMDevice *self)
         _notify(self, PROP_IFACE);
         if (ip_ifname_changed)
             _notify(self, PROP_IP_IFACE);
+        _manager_index_update(self);
 
         /* Re-match available connections against the new interface name */
         nm_device_recheck_available_connections(self);
@@ -5498,6 +5517,7 @@ device_ip_link_changed(NMDevice *self)
         g_free(priv->ip_iface_);
         priv->ip_iface_ = g_strdup(ip_iface);
         _notify(self, PROP_IP_IFACE);
+        _manager_index_update(self);
 
         nm_device_update_dynamic_ip_setup(self);
     }
@@ -5746,8 +5766,11 @@ nm_device_update_from_platform_link(NMDevice *self, const NMPlatformLink *plink)
         _notify(self, PROP_PATH);
     }
 
-    if (plink && !nm_str_is_empty(plink->name) && nm_utils_strdup_reset(&priv->iface_, plink->name))
+    if (plink && !nm_str_is_empty(plink->name)
+        && nm_utils_strdup_reset(&priv->iface_, plink->name)) {
         _notify(self, PROP_IFACE);
+        _manager_index_update(self);
+    }
 
     str = plink ? plink->driver : NULL;
     if (!nm_streq0(str, priv->driver)) {
@@ -5963,7 +5986,6 @@ realize_start_setup(NMDevice *            self,
     NMPlatform *         platform;
     NMDeviceCapabilities capabilities = 0;
     NMConfig *           config;
-    guint                real_rate;
     gboolean             unmanaged;
 
     /* plink is a NMPlatformLink type, however, we require it to come from the platform
@@ -6071,10 +6093,9 @@ realize_start_setup(NMDevice *            self,
 
     nm_device_set_carrier_from_platform(self);
 
-    nm_assert(!priv->stats.timeout_id);
-    real_rate = _stats_refresh_rate_real(priv->stats.refresh_rate_ms);
-    if (real_rate)
-        priv->stats.timeout_id = g_timeout_add(real_rate, _stats_timeout_cb, self);
+    nm_assert(!priv->stats.active);
+    priv->stats.active = TRUE;
+    _stats_schedule_update(self);
 
     klass->realize_start_notify(self, plink);
 
@@ -6232,8 +6253,10 @@ nm_device_unrealize(NMDevice *self, gboolean remove_resources, GError **error)
 
     _set_ifindex(self, 0, FALSE);
     _set_ifindex(self, 0, TRUE);
-    if (nm_clear_g_free(&priv->ip_iface_))
+    if (nm_clear_g_free(&priv->ip_iface_)) {
         _notify(self, PROP_IP_IFACE);
+        _manager_index_update(self);
+    }
 
     priv->master_ifindex = 0;
 
@@ -6260,15 +6283,18 @@ nm_device_unrealize(NMDevice *self, gboolean remove_resources, GError **error)
         _notify(self, PROP_PHYSICAL_PORT_ID);
     }
 
-    nm_clear_g_source(&priv->stats.timeout_id);
+    priv->stats.active = FALSE;
+    _stats_schedule_update(self);
     _stats_update_counters(self, 0, 0);
 
     priv->hw_addr_len_ = 0;
     if (nm_clear_g_free(&priv->hw_addr))
         _notify(self, PROP_HW_ADDRESS);
     priv->hw_addr_type = HW_ADDR_TYPE_UNSET;
-    if (nm_clear_g_free(&priv->hw_addr_perm))
+    if (nm_clear_g_free(&priv->hw_addr_perm)) {
         _notify(self, PROP_PERM_HW_ADDRESS);
+        _manager_index_update(self);
+    }
     nm_clear_g_free(&priv->hw_addr_initial);
 
     priv->capabilities = NM_DEVICE_CAP_NM_SUPPORTED;
@@ -7535,6 +7561,35 @@ nm_device_check_connection_compatible(NMDevice *self, NMConnection *connection,
     return NM_DEVICE_GET_CLASS(self)->check_connection_compatible(self, connection, error);
 }
 
+/**
+ * nm_device_get_compatible_connection_types:
+ * @self: the #NMDevice
+ * @out_len: the number of returned connection types.
+ *
+ * Returns: the connection types that the device can possibly be compatible
+ *   with (see nm_device_check_connection_compatible()), or %NULL if that
+ *   is not known and any type must be considered.
+ */
+const char *const *
+nm_device_get_compatible_connection_types(NMDevice *self, guint *out_len)
+{
+    NMDeviceClass *klass;
+
+    g_return_val_if_fail(NM_IS_DEVICE(self), NULL);
+
+    klass = NM_DEVICE_GET_CLASS(self);
+    if (klass->connection_type_check_compatible) {
+        *out_len = 1;
+        return &klass->connection_type_check_compatible;
+    }
+    if (klass->connection_types_compatible) {
+        *out_len = NM_PTRARRAY_LEN(klass->connection_types_compatible);
+        return klass->connection_types_compatible;
+    }
+    *out_len = 0;
+    return NULL;
+}
+
 gboolean
 nm_device_check_slave_connection_compatible(NMDevice *self, NMConnection *slave)
 {
@@ -7702,6 +7757,14 @@ nm_device_emit_recheck_auto_activate(NMDevice *self)
     g_signal_emit(self, signals[RECHECK_AUTO_ACTIVATE], 0);
 }
 
+static void
+shared_dhcp_server_failed_cb(NMDhcpServer *server, gpointer user_data)
+{
+    NMDevice *self = NM_DEVICE(user_data);
+
+    nm_device_ip_method_failed(self, AF_INET, NM_DEVICE_STATE_REASON_SHARED_START_FAILED);
+}
+
 static void
 dnsmasq_state_changed_cb(NMDnsMasqManager *manager, guint32 status, gpointer user_data)
 {
@@ -9474,6 +9537,18 @@ nm_device_dhcp4_renew(NMDevice *self, gboolean release)
 
 /*****************************************************************************/
 
+static gboolean
+_shared_dhcp_use_internal(void)
+{
+    gs_free char *value = NULL;
+
+    value = nm_config_data_get_value(NM_CONFIG_GET_DATA,
+                                     NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                     NM_CONFIG_KEYFILE_KEY_MAIN_SHARED_DHCP,
+                                     NM_CONFIG_GET_VALUE_STRIP);
+    return nm_streq0(value, "internal");
+}
+
 static NMIP4Config *
 shared4_new_config(NMDevice *self, NMConnection *connection)
 {
@@ -11159,8 +11234,20 @@ act_stage3_ip_config_start(NMDevice *           self,
             if (out_config) {
                 *out_config = shared4_new_config(self, connection);
                 if (*out_config) {
-                    priv->dnsmasq_manager = nm_dnsmasq_manager_new(nm_device_get_ip_iface(self));
-                    ret                   = NM_ACT_STAGE_RETURN_SUCCESS;
+                    if (_shared_dhcp_use_internal()) {
+                        static const NMDhcpServerCallbacks callbacks = {
+                            .failed_callback = shared_dhcp_server_failed_cb,
+                        };
+
+                        priv->shared_dhcp_server =
+                            nm_dhcp_server_new(nm_device_get_ip_ifindex(self),
+                                               nm_device_get_ip_iface(self),
+                                               &callbacks,
+                                               self);
+                    } else
+                        priv->dnsmasq_manager =
+                            nm_dnsmasq_manager_new(nm_device_get_ip_iface(self));
+                    ret = NM_ACT_STAGE_RETURN_SUCCESS;
                 } else {
                     NM_SET_OUT(out_failure_reason, NM_DEVICE_STATE_REASON_IP_CONFIG_UNAVAILABLE);
                     ret = NM_ACT_STAGE_RETURN_FAILURE;
@@ -11638,6 +11725,26 @@ share_init(NMDevice *self, GError **error)
     return TRUE;
 }
 
+static const NMIP4Config *
+shared4_get_upstream_config(NMDevice *self)
+{
+    NMActiveConnection *ac;
+    NMDevice *          device;
+
+    /* The internal DHCP server does not forward DNS queries, so it announces
+     * the name servers of the primary connection. Like the metered flag, they
+     * are not updated when the primary connection changes later. */
+    ac = nm_manager_get_primary_connection(NM_MANAGER_GET);
+    if (!ac)
+        return NULL;
+
+    device = nm_active_connection_get_device(ac);
+    if (!device || device == self)
+        return NULL;
+
+    return nm_device_get_ip4_config(device);
+}
+
 static gboolean
 start_sharing(NMDevice *self, NMIP4Config *config, GError **error)
 {
@@ -11705,6 +11812,24 @@ start_sharing(NMDevice *self, NMIP4Config *config, GError **error)
         break;
     }
 
+    if (priv->shared_dhcp_server) {
+        if (!nm_dhcp_server_start(priv->shared_dhcp_server,
+                                  config,
+                                  shared4_get_upstream_config(self),
+                                  announce_android_metered,
+                                  &local)) {
+            g_set_error(error,
+                        NM_UTILS_ERROR,
+                        NM_UTILS_ERROR_UNKNOWN,
+                        "could not start DHCP server due to %s",
+                        local->message);
+            g_error_free(local);
+            nm_act_request_set_shared(req, NULL);
+            return FALSE;
+        }
+        return TRUE;
+    }
+
     if (!nm_dnsmasq_manager_start(priv->dnsmasq_manager,
                                   config,
                                   announce_android_metered,
@@ -12114,6 +12239,8 @@ dnsmasq_cleanup(NMDevice *self)
 {
     NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
 
+    nm_clear_pointer(&priv->shared_dhcp_server, nm_dhcp_server_free);
+
     if (!priv->dnsmasq_manager)
         return;
 
@@ -17010,6 +17137,7 @@ nm_device_update_permanent_hw_address(NMDevice *self, gboolean force_freeze)
 
 notify_and_out:
     _notify(self, PROP_PERM_HW_ADDRESS);
+    _manager_index_update(self);
 }
 
 gboolean
@@ -18349,7 +18477,8 @@ dispose(GObject *object)
 
     nm_clear_g_source(&priv->check_delete_unrealized_id);
 
-    nm_clear_g_source(&priv->stats.timeout_id);
+    priv->stats.active = FALSE;
+    _stats_schedule_update(self);
 
     carrier_disconnected_action_cancel(self);
 
@@ -223,6 +223,12 @@ typedef struct _NMDeviceClass {
      * is the connection.type setting, as checked by nm_device_check_connection_compatible() */
     const char *connection_type_check_compatible;
 
+    /* for device types that don't set connection_type_check_compatible, but
+     * implement check_connection_compatible() themselves, the NULL terminated
+     * list of connection types that they can be compatible with. This is only
+     * used to narrow down the autoconnect candidates. */
+    const char *const *connection_types_compatible;
+
     const NMLinkType *link_types;
 
     /* if the device MTU is set based on parent's one, this specifies
@@ -570,6 +576,8 @@ gboolean nm_device_complete_connection(NMDevice *           device,
 gboolean
 nm_device_check_connection_compatible(NMDevice *device, NMConnection *connection, GError **error);
 
+const char *const *nm_device_get_compatible_connection_types(NMDevice *self, guint *out_len);
+
 gboolean nm_device_check_slave_connection_compatible(NMDevice *device, NMConnection *connection);
 
 gboolean nm_device_unmanage_on_quit(NMDevice *self);
@@ -11,6 +11,7 @@
 #include <gio/gunixsocketaddress.h>
 
 #include "libnm-glib-aux/nm-jansson.h"
+#include "libnm-glib-aux/nm-json-aux.h"
 #include "libnm-glib-aux/nm-str-buf.h"
 #include "nm-core-utils.h"
 #include "libnm-core-intern/nm-core-internal.h"
@@ -103,6 +104,13 @@ typedef struct {
     OvsdbMethodCallback callback;
     gpointer            user_data;
     OvsdbMethodPayload  payload;
+
+    /* The "transact" params of the call and the rows that it depends on (see
+     * _call_collect_keys()). They are built once, and only rebuilt if our view
+     * of the database changed while the call waited for a conflicting call. */
+    json_t *   params;
+    GPtrArray *keys;
+    guint      params_db_generation;
 } OvsdbMethodCall;
 
 /*****************************************************************************/
@@ -121,10 +129,10 @@ typedef struct {
     GSocketClient *    client;
     GSocketConnection *conn;
     GCancellable *     cancellable;
-    char               buf[4096]; /* Input buffer */
-    size_t             bufp;      /* Last decoded byte in the input buffer. */
-    GString *          input;     /* JSON stream waiting for decoding. */
-    GString *          output;    /* JSON stream to be sent. */
+    char               buf[4096];     /* Input buffer */
+    NMJsonFrameScanner input_scanner; /* Framing state of the JSON stream in @input. */
+    GString *          input;         /* JSON stream waiting for decoding. */
+    GString *          output;        /* JSON stream to be sent. */
     guint64            call_id_counter;
 
     CList calls_lst_head;
@@ -133,6 +141,7 @@ typedef struct {
     GHashTable *ports;      /* port uuid => OpenvswitchPort */
     GHashTable *bridges;    /* bridge uuid => OpenvswitchBridge */
     char *      db_uuid;
+    guint       db_generation; /* Incremented whenever the view of the database changes. */
     guint       num_failures;
     guint       num_pending_deletions;
     bool        ready : 1;
@@ -260,6 +269,9 @@ _call_complete(OvsdbMethodCall *call, json_t *response, GError *error)
 
     c_list_unlink_stale(&call->calls_lst);
 
+    nm_clear_pointer(&call->params, json_decref);
+    nm_clear_pointer(&call->keys, g_ptr_array_unref);
+
     if (call->callback)
         call->callback(call->self, response, error, call->user_data);
 
@@ -514,6 +526,36 @@ _set_ovs_bridges(json_t *params, const char *db_uuid, json_t *new_bridges)
                                     db_uuid));
 }
 
+/**
+ * _add_ovs_bridge:
+ *
+ * Return a command that will add the bridge @named_uuid (inserted in the same
+ * transaction) to the bridges in @db_uuid database. Unlike _set_ovs_bridges(),
+ * this doesn't depend on the current set of bridges, so it commutes with other
+ * calls that add bridges.
+ */
+static void
+_add_ovs_bridge(json_t *params, const char *db_uuid, const char *named_uuid)
+{
+    json_array_append_new(params,
+                          json_pack("{s:s, s:s, s:[[s, s, [s, [[s, s]]]]], s:[[s, s, [s, s]]]}",
+                                    "op",
+                                    "mutate",
+                                    "table",
+                                    "Open_vSwitch",
+                                    "mutations",
+                                    "bridges",
+                                    "insert",
+                                    "set",
+                                    "named-uuid",
+                                    named_uuid,
+                                    "where",
+                                    "_uuid",
+                                    "==",
+                                    "uuid",
+                                    db_uuid));
+}
+
 /**
  * _expect_bridge_ports:
  *
@@ -572,6 +614,33 @@ _set_bridge_ports(json_t *params, const char *ifname, json_t *new_ports)
                                     ifname));
 }
 
+/**
+ * _add_bridge_port:
+ *
+ * Return a command that will add the port @named_uuid (inserted in the same
+ * transaction) to the ports of bridge @ifname.
+ */
+static void
+_add_bridge_port(json_t *params, const char *ifname, const char *named_uuid)
+{
+    json_array_append_new(params,
+                          json_pack("{s:s, s:s, s:[[s, s, [s, [[s, s]]]]], s:[[s, s, s]]}",
+                                    "op",
+                                    "mutate",
+                                    "table",
+                                    "Bridge",
+                                    "mutations",
+                                    "ports",
+                                    "insert",
+                                    "set",
+                                    "named-uuid",
+                                    named_uuid,
+                                    "where",
+                                    "name",
+                                    "==",
+                                    ifname));
+}
+
 static void
 _set_bridge_mac(json_t *params, const char *ifname, const char *mac)
 {
@@ -650,6 +719,33 @@ _set_port_interfaces(json_t *params, const char *ifname, json_t *new_interfaces)
                                     ifname));
 }
 
+/**
+ * _add_port_interface:
+ *
+ * Return a command that will add the interface @named_uuid (inserted in the
+ * same transaction) to the interfaces of port @ifname.
+ */
+static void
+_add_port_interface(json_t *params, const char *ifname, const char *named_uuid)
+{
+    json_array_append_new(params,
+                          json_pack("{s:s, s:s, s:[[s, s, [s, [[s, s]]]]], s:[[s, s, s]]}",
+                                    "op",
+                                    "mutate",
+                                    "table",
+                                    "Port",
+                                    "mutations",
+                                    "interfaces",
+                                    "insert",
+                                    "set",
+                                    "named-uuid",
+                                    named_uuid,
+                                    "where",
+                                    "name",
+                                    "==",
+                                    ifname));
+}
+
 static json_t *
 _j_create_external_ids_array_new(NMConnection *connection)
 {
@@ -972,10 +1068,16 @@ _inc_next_cfg(const char *db_uuid)
  *
  * Adds an interface as specified by @interface connection, optionally creating
  * a parent @port and @bridge if needed.
+ *
+ * The new rows are added to their parents with "mutate" operations, which don't
+ * depend on the other rows of the parent. The rows that get created are added
+ * to @keys, so that calls that would create them as well are serialized
+ * (see _call_collect_keys()).
  */
 static void
 _add_interface(NMOvsdb *     self,
                json_t *      params,
+               GPtrArray *   keys,
                NMConnection *bridge,
                NMConnection *port,
                NMConnection *interface,
@@ -992,13 +1094,10 @@ _add_interface(NMOvsdb *     self,
     OpenvswitchBridge *   ovs_bridge           = NULL;
     OpenvswitchPort *     ovs_port             = NULL;
     OpenvswitchInterface *ovs_interface        = NULL;
-    nm_auto_decref_json json_t *bridges        = NULL;
-    nm_auto_decref_json json_t *new_bridges    = NULL;
-    nm_auto_decref_json json_t *ports          = NULL;
-    nm_auto_decref_json json_t *new_ports      = NULL;
-    nm_auto_decref_json json_t *interfaces     = NULL;
-    nm_auto_decref_json json_t *new_interfaces = NULL;
-    gboolean                    has_interface  = FALSE;
+    nm_auto_decref_json json_t *new_ports     = NULL;
+    nm_auto_decref_json json_t *interfaces    = NULL;
+    guint                       n_ports       = 0;
+    gboolean                    has_interface = FALSE;
     gboolean                    interface_is_local;
     gs_free char *              bridge_cloned_mac    = NULL;
     gs_free char *              interface_cloned_mac = NULL;
@@ -1006,12 +1105,7 @@ _add_interface(NMOvsdb *     self,
     int                         pi;
     int                         ii;
 
-    bridges        = json_array();
-    ports          = json_array();
-    interfaces     = json_array();
-    new_bridges    = json_array();
-    new_ports      = json_array();
-    new_interfaces = json_array();
+    interfaces = json_array();
 
     bridge_name        = nm_connection_get_interface_name(bridge);
     port_name          = nm_connection_get_interface_name(port);
@@ -1070,8 +1164,6 @@ _add_interface(NMOvsdb *     self,
 
     g_hash_table_iter_init(&iter, priv->bridges);
     while (g_hash_table_iter_next(&iter, (gpointer) &ovs_bridge, NULL)) {
-        json_array_append_new(bridges, json_pack("[s, s]", "uuid", ovs_bridge->bridge_uuid));
-
         if (!nm_streq0(ovs_bridge->name, bridge_name)
             || !nm_streq0(ovs_bridge->connection_uuid, nm_connection_get_uuid(bridge)))
             continue;
@@ -1080,7 +1172,7 @@ _add_interface(NMOvsdb *     self,
             port_uuid = g_ptr_array_index(ovs_bridge->ports, pi);
             ovs_port  = g_hash_table_lookup(priv->ports, &port_uuid);
 
-            json_array_append_new(ports, json_pack("[s, s]", "uuid", port_uuid));
+            n_ports++;
 
             if (!ovs_port) {
                 /* This would be a violation of ovsdb's reference integrity (a bug). */
@@ -1114,39 +1206,37 @@ _add_interface(NMOvsdb *     self,
         break;
     }
 
-    json_array_extend(new_bridges, bridges);
-    json_array_extend(new_ports, ports);
-    json_array_extend(new_interfaces, interfaces);
-
     if (json_array_size(interfaces) == 0) {
+        nm_auto_decref_json json_t *new_interfaces = NULL;
+
         /* Need to create a port. */
-        if (json_array_size(ports) == 0) {
+        if (n_ports == 0) {
             /* Need to create a bridge. */
-            _expect_ovs_bridges(params, priv->db_uuid, bridges);
-            json_array_append_new(new_bridges, json_pack("[s, s]", "named-uuid", "rowBridge"));
-            _set_ovs_bridges(params, priv->db_uuid, new_bridges);
+            new_ports = json_pack("[[s, s]]", "named-uuid", "rowPort");
+            _add_ovs_bridge(params, priv->db_uuid, "rowBridge");
             _insert_bridge(params, bridge, bridge_device, new_ports, bridge_cloned_mac);
+            g_ptr_array_add(keys, g_strdup_printf("Bridge:%s", bridge_name));
         } else {
             /* Bridge already exists. */
             g_return_if_fail(ovs_bridge);
-            _expect_bridge_ports(params, ovs_bridge->name, ports);
-            _set_bridge_ports(params, bridge_name, new_ports);
+            _add_bridge_port(params, bridge_name, "rowPort");
             if (bridge_cloned_mac && interface_is_local)
                 _set_bridge_mac(params, bridge_name, bridge_cloned_mac);
         }
 
-        json_array_append_new(new_ports, json_pack("[s, s]", "named-uuid", "rowPort"));
+        new_interfaces = json_pack("[[s, s]]", "named-uuid", "rowInterface");
         _insert_port(params, port, new_interfaces);
+        g_ptr_array_add(keys, g_strdup_printf("Port:%s", port_name));
     } else {
         /* Port already exists */
         g_return_if_fail(ovs_port);
-        _expect_port_interfaces(params, ovs_port->name, interfaces);
-        _set_port_interfaces(params, port_name, new_interfaces);
+        if (!has_interface)
+            _add_port_interface(params, port_name, "rowInterface");
     }
 
     if (!has_interface) {
         _insert_interface(params, interface, interface_device, interface_cloned_mac);
-        json_array_append_new(new_interfaces, json_pack("[s, s]", "named-uuid", "rowInterface"));
+        g_ptr_array_add(keys, g_strdup_printf("Interface:%s", interface_name));
     }
 }
 
@@ -1257,147 +1347,311 @@ _delete_interface(NMOvsdb *self, json_t *params, const char *ifname)
 }
 
 /**
- * ovsdb_next_command:
+ * _call_collect_keys:
+ *
+ * Collects the rows that the transaction in @params depends on, as strings like
+ * "Bridge:br0". Transactions that share a key must not be in flight at the
+ * same time: the later one is built from our view of the database, which does
+ * not yet reflect the earlier one, and its "wait" operations would fail.
+ *
+ * A "mutate" doesn't depend on our view of the row, so mutations of the same
+ * row commute. They get a shared key with a '+' prefix, like "+Bridge:br0",
+ * which only conflicts with the plain key of the row (see _call_keys_conflict()).
+ * That way, adding ports to the same bridge can be pipelined, while removing
+ * a port (which replaces the set of ports) waits for them.
+ *
+ * Bumping "next_cfg" commutes with everything, so it is not a dependency.
+ */
+static void
+_call_collect_keys(GPtrArray *keys, json_t *params)
+{
+    size_t  index;
+    json_t *op;
+
+    json_array_foreach (params, index, op) {
+        const char *op_name;
+        const char *table;
+        const char *column;
+        const char *function;
+        const char *name;
+
+        if (json_unpack(op, "{s:s, s:s}", "op", &op_name, "table", &table) != 0)
+            continue;
+
+        if (nm_streq(table, "Open_vSwitch")) {
+            if (!nm_streq(op_name, "mutate"))
+                g_ptr_array_add(keys, g_strdup(table));
+            else if (json_unpack(op, "{s:[[s]]}", "mutations", &column) == 0
+                     && !nm_streq(column, "next_cfg"))
+                g_ptr_array_add(keys, g_strdup_printf("+%s", table));
+            continue;
+        }
+
+        if (json_unpack(op, "{s:[[s, s, s]]}", "where", &column, &function, &name) == 0
+            && nm_streq(column, "name")) {
+            g_ptr_array_add(keys,
+                            g_strdup_printf("%s%s:%s",
+                                            nm_streq(op_name, "mutate") ? "+" : "",
+                                            table,
+                                            name));
+        }
+    }
+}
+
+static void
+_call_collect_keys_interface(NMOvsdb *self, GPtrArray *keys, const char *ifname)
+{
+    NMOvsdbPrivate *      priv = NM_OVSDB_GET_PRIVATE(self);
+    GHashTableIter        iter;
+    OpenvswitchBridge *   ovs_bridge;
+    OpenvswitchPort *     ovs_port;
+    OpenvswitchInterface *ovs_interface;
+    int                   pi;
+    int                   ii;
+
+    g_ptr_array_add(keys, g_strdup_printf("Interface:%s", ifname));
+
+    /* Also the bridge and the port that currently contain the interface.
+     * Deleting the last interface deletes the port and the bridge too. */
+    g_hash_table_iter_init(&iter, priv->bridges);
+    while (g_hash_table_iter_next(&iter, (gpointer) &ovs_bridge, NULL)) {
+        for (pi = 0; pi < ovs_bridge->ports->len; pi++) {
+            ovs_port = g_hash_table_lookup(priv->ports, &ovs_bridge->ports->pdata[pi]);
+            if (!ovs_port)
+                continue;
+            for (ii = 0; ii < ovs_port->interfaces->len; ii++) {
+                ovs_interface =
+                    g_hash_table_lookup(priv->interfaces, &ovs_port->interfaces->pdata[ii]);
+                if (ovs_interface && nm_streq0(ovs_interface->name, ifname)) {
+                    g_ptr_array_add(keys, g_strdup_printf("Bridge:%s", ovs_bridge->name));
+                    g_ptr_array_add(keys, g_strdup_printf("Port:%s", ovs_port->name));
+                }
+            }
+        }
+    }
+}
+
+static gboolean
+_call_keys_conflict(NMOvsdb *self, GPtrArray *keys)
+{
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OvsdbMethodCall *call;
+    guint            i;
+    guint            j;
+
+    c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst) {
+        if (call->call_id == CALL_ID_UNSPEC)
+            break;
+        if (!call->keys)
+            continue;
+        for (i = 0; i < call->keys->len; i++) {
+            const char *key_a    = call->keys->pdata[i];
+            gboolean    shared_a = (key_a[0] == '+');
+
+            for (j = 0; j < keys->len; j++) {
+                const char *key_b    = keys->pdata[j];
+                gboolean    shared_b = (key_b[0] == '+');
+
+                /* two mutations of the same row commute. */
+                if (shared_a && shared_b)
+                    continue;
+                if (nm_streq(&key_a[shared_a], &key_b[shared_b]))
+                    return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * _call_create_msg:
  *
  * Translates a higher level operation (add/remove bridge/port) to a RFC 7047
- * command serialized into JSON ands sends it over to the database.
+ * command serialized into JSON. Returns %NULL if the command depends on a
+ * call that is still in flight.
+ */
+static json_t *
+_call_create_msg(NMOvsdb *self, OvsdbMethodCall *call, guint64 call_id)
+{
+    NMOvsdbPrivate *             priv   = NM_OVSDB_GET_PRIVATE(self);
+    gs_unref_ptrarray GPtrArray *keys   = NULL;
+    nm_auto_decref_json json_t *params = NULL;
+
+    if (call->command == OVSDB_MONITOR) {
+        return json_pack("{s:I, s:s, s:[s, n, {"
+                         "  s:[{s:[s, s, s]}],"
+                         "  s:[{s:[s, s, s]}],"
+                         "  s:[{s:[s, s, s, s]}],"
+                         "  s:[{s:[]}]"
+                         "}]}",
+                         "id",
+                         (json_int_t) call_id,
+                         "method",
+                         "monitor",
+                         "params",
+                         "Open_vSwitch",
+                         "Bridge",
+                         "columns",
+                         "name",
+                         "ports",
+                         "external_ids",
+                         "Port",
+                         "columns",
+                         "name",
+                         "interfaces",
+                         "external_ids",
+                         "Interface",
+                         "columns",
+                         "name",
+                         "type",
+                         "external_ids",
+                         "error",
+                         "Open_vSwitch",
+                         "columns");
+    }
+
+    if (call->params && call->params_db_generation == priv->db_generation)
+        goto out;
 
- * Only called when no command is waiting for a response, since the serialized
- * command might depend on result of a previous one (add and remove need to
- * include an up to date bridge list in their transactions to rule out races).
+    nm_clear_pointer(&call->params, json_decref);
+    nm_clear_pointer(&call->keys, g_ptr_array_unref);
+
+    keys = g_ptr_array_new_with_free_func(g_free);
+
+    params = json_array();
+    json_array_append_new(params, json_string("Open_vSwitch"));
+    json_array_append_new(params, _inc_next_cfg(priv->db_uuid));
+
+    switch (call->command) {
+    case OVSDB_ADD_INTERFACE:
+        _add_interface(self,
+                       params,
+                       keys,
+                       call->payload.add_interface.bridge,
+                       call->payload.add_interface.port,
+                       call->payload.add_interface.interface,
+                       call->payload.add_interface.bridge_device,
+                       call->payload.add_interface.interface_device);
+        break;
+    case OVSDB_DEL_INTERFACE:
+        _delete_interface(self, params, call->payload.del_interface.ifname);
+        _call_collect_keys_interface(self, keys, call->payload.del_interface.ifname);
+        break;
+    case OVSDB_SET_INTERFACE_MTU:
+        json_array_append_new(params,
+                              json_pack("{s:s, s:s, s:{s: I}, s:[[s, s, s]]}",
+                                        "op",
+                                        "update",
+                                        "table",
+                                        "Interface",
+                                        "row",
+                                        "mtu_request",
+                                        (json_int_t) call->payload.set_interface_mtu.mtu,
+                                        "where",
+                                        "name",
+                                        "==",
+                                        call->payload.set_interface_mtu.ifname));
+        break;
+    case OVSDB_SET_EXTERNAL_IDS:
+        json_array_append_new(
+            params,
+            json_pack("{s:s, s:s, s:o, s:[[s, s, s]]}",
+                      "op",
+                      "mutate",
+                      "table",
+                      _device_type_to_table(call->payload.set_external_ids.device_type),
+                      "mutations",
+                      _j_create_external_ids_array_update(
+                          call->payload.set_external_ids.connection_uuid,
+                          call->payload.set_external_ids.exid_old,
+                          call->payload.set_external_ids.exid_new),
+                      "where",
+                      "name",
+                      "==",
+                      call->payload.set_external_ids.ifname));
+        break;
+    default:
+        nm_assert_not_reached();
+        break;
+    }
+
+    _call_collect_keys(keys, params);
+
+    call->params               = g_steal_pointer(&params);
+    call->keys                 = g_steal_pointer(&keys);
+    call->params_db_generation = priv->db_generation;
+
+out:
+    if (_call_keys_conflict(self, call->keys))
+        return NULL;
+
+    return json_pack("{s:I, s:s, s:O}",
+                     "id",
+                     (json_int_t) call_id,
+                     "method",
+                     "transact",
+                     "params",
+                     call->params);
+}
+
+/**
+ * ovsdb_next_command:
+ *
+ * Sends the queued commands to the database, in order.
+ *
+ * Multiple commands can be in flight. ovsdb-server processes them in the
+ * order in which it receives them, but a command is serialized against our
+ * (possibly outdated) view of the database. Hence, a command that depends on
+ * rows that an in-flight command modifies is only sent once that one
+ * completes (remove needs to include an up to date port and bridge list in
+ * its transaction to rule out races). Adding to the same bridge or port only
+ * mutates the parent row, so such commands are in flight together (see
+ * _call_collect_keys()). The monitor call must complete before anything else
+ * gets sent.
  */
 static void
 ovsdb_next_command(NMOvsdb *self)
 {
-    NMOvsdbPrivate *    priv = NM_OVSDB_GET_PRIVATE(self);
-    OvsdbMethodCall *   call;
-    char *              cmd;
-    nm_auto_decref_json json_t *msg = NULL;
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OvsdbMethodCall *call;
+    gboolean         sent = FALSE;
 
     if (!priv->conn)
         return;
 
-    if (c_list_is_empty(&priv->calls_lst_head))
-        return;
+    c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst) {
+        nm_auto_decref_json json_t *msg = NULL;
+        char *                      cmd;
 
-    call = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
-    if (call->call_id != CALL_ID_UNSPEC)
-        return;
-
-    call->call_id = ++priv->call_id_counter;
+        if (call->call_id != CALL_ID_UNSPEC) {
+            if (call->command == OVSDB_MONITOR)
+                break;
+            continue;
+        }
 
-    switch (call->command) {
-    case OVSDB_MONITOR:
-        msg = json_pack("{s:I, s:s, s:[s, n, {"
-                        "  s:[{s:[s, s, s]}],"
-                        "  s:[{s:[s, s, s]}],"
-                        "  s:[{s:[s, s, s, s]}],"
-                        "  s:[{s:[]}]"
-                        "}]}",
-                        "id",
-                        (json_int_t) call->call_id,
-                        "method",
-                        "monitor",
-                        "params",
-                        "Open_vSwitch",
-                        "Bridge",
-                        "columns",
-                        "name",
-                        "ports",
-                        "external_ids",
-                        "Port",
-                        "columns",
-                        "name",
-                        "interfaces",
-                        "external_ids",
-                        "Interface",
-                        "columns",
-                        "name",
-                        "type",
-                        "external_ids",
-                        "error",
-                        "Open_vSwitch",
-                        "columns");
-        break;
-    default:
-    {
-        json_t *params = NULL;
-
-        params = json_array();
-        json_array_append_new(params, json_string("Open_vSwitch"));
-        json_array_append_new(params, _inc_next_cfg(priv->db_uuid));
-
-        switch (call->command) {
-        case OVSDB_ADD_INTERFACE:
-            _add_interface(self,
-                           params,
-                           call->payload.add_interface.bridge,
-                           call->payload.add_interface.port,
-                           call->payload.add_interface.interface,
-                           call->payload.add_interface.bridge_device,
-                           call->payload.add_interface.interface_device);
-            break;
-        case OVSDB_DEL_INTERFACE:
-            _delete_interface(self, params, call->payload.del_interface.ifname);
-            break;
-        case OVSDB_SET_INTERFACE_MTU:
-            json_array_append_new(params,
-                                  json_pack("{s:s, s:s, s:{s: I}, s:[[s, s, s]]}",
-                                            "op",
-                                            "update",
-                                            "table",
-                                            "Interface",
-                                            "row",
-                                            "mtu_request",
-                                            (json_int_t) call->payload.set_interface_mtu.mtu,
-                                            "where",
-                                            "name",
-                                            "==",
-                                            call->payload.set_interface_mtu.ifname));
-            break;
-        case OVSDB_SET_EXTERNAL_IDS:
-            json_array_append_new(
-                params,
-                json_pack("{s:s, s:s, s:o, s:[[s, s, s]]}",
-                          "op",
-                          "mutate",
-                          "table",
-                          _device_type_to_table(call->payload.set_external_ids.device_type),
-                          "mutations",
-                          _j_create_external_ids_array_update(
-                              call->payload.set_external_ids.connection_uuid,
-                              call->payload.set_external_ids.exid_old,
-                              call->payload.set_external_ids.exid_new),
-                          "where",
-                          "name",
-                          "==",
-                          call->payload.set_external_ids.ifname));
+        if (call->command == OVSDB_MONITOR && &call->calls_lst != priv->calls_lst_head.next)
             break;
 
-        default:
-            nm_assert_not_reached();
+        msg = _call_create_msg(self, call, priv->call_id_counter + 1);
+        if (!msg) {
+            _LOGT_call(call, "waiting for a conflicting call to complete");
             break;
         }
 
-        msg = json_pack("{s:I, s:s, s:o}",
-                        "id",
-                        (json_int_t) call->call_id,
-                        "method",
-                        "transact",
-                        "params",
-                        params);
-        break;
-    }
-    }
+        call->call_id = ++priv->call_id_counter;
 
-    g_return_if_fail(msg);
+        cmd = json_dumps(msg, 0);
+        _LOGT_call(call, "send: call-id=%" G_GUINT64_FORMAT ", %s", call->call_id, cmd);
+        g_string_append(priv->output, cmd);
+        free(cmd);
+        sent = TRUE;
 
-    cmd = json_dumps(msg, 0);
-    _LOGT_call(call, "send: call-id=%" G_GUINT64_FORMAT ", %s", call->call_id, cmd);
-    g_string_append(priv->output, cmd);
-    free(cmd);
+        if (call->command == OVSDB_MONITOR)
+            break;
+    }
 
-    ovsdb_write(self);
+    if (sent)
+        ovsdb_write(self);
 }
 
 /**
@@ -1571,6 +1825,9 @@ ovsdb_got_update(NMOvsdb *self, json_t *msg)
     const char *type;
     json_t *    value;
 
+    /* The pending calls need to rebuild their transactions. */
+    priv->db_generation++;
+
     if (json_unpack_ex(msg,
                        &json_error,
                        0,
@@ -2021,17 +2278,14 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
         gs_free_error GError *local      = NULL;
         gs_free char *        msg_as_str = NULL;
 
-        /* This is a response to a method call. */
-        if (c_list_is_empty(&priv->calls_lst_head)) {
-            _LOGE("there are no queued calls expecting response %" G_GUINT64_FORMAT, (guint64) id);
-            ovsdb_disconnect(self, FALSE, FALSE);
-            return;
+        /* This is a response to a method call. The calls in flight are
+         * at the front of the queue. */
+        c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst) {
+            if (call->call_id == CALL_ID_UNSPEC || call->call_id == (guint64) id)
+                break;
         }
-        call = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
-        if (call->call_id != id) {
-            _LOGE("expected a response to call %" G_GUINT64_FORMAT ", not %" G_GUINT64_FORMAT,
-                  call->call_id,
-                  (guint64) id);
+        if (&call->calls_lst == &priv->calls_lst_head || call->call_id != (guint64) id) {
+            _LOGE("there are no queued calls expecting response %" G_GUINT64_FORMAT, (guint64) id);
             ovsdb_disconnect(self, FALSE, FALSE);
             return;
         }
@@ -2057,7 +2311,7 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
         if (!priv->conn)
             return;
 
-        /* Now we're free to serialize and send the next command, if any. */
+        /* Send the commands that waited for this one, if any. */
         ovsdb_next_command(self);
 
         return;
@@ -2072,24 +2326,6 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
 /* Lower level marshalling and demarshalling of the JSON-RPC traffic on the
  * ovsdb socket. */
 
-static size_t
-_json_callback(void *buffer, size_t buflen, void *user_data)
-{
-    NMOvsdb *       self = NM_OVSDB(user_data);
-    NMOvsdbPrivate *priv = NM_OVSDB_GET_PRIVATE(self);
-
-    if (priv->bufp == priv->input->len) {
-        /* No more bytes buffered for decoding. */
-        return 0;
-    }
-
-    /* Pass one more byte to the JSON decoder. */
-    *(char *) buffer = priv->input->str[priv->bufp];
-    priv->bufp++;
-
-    return (size_t) 1;
-}
-
 /**
  * ovsdb_read_cb:
  *
@@ -2104,10 +2340,8 @@ ovsdb_read_cb(GObject *source_object, GAsyncResult *res, gpointer user_data)
     GInputStream *  stream = G_INPUT_STREAM(source_object);
     GError *        error  = NULL;
     gssize          size;
-    json_t *        msg;
-    json_error_t    json_error = {
-        0,
-    };
+    gsize           offset;
+    gssize          frame_len;
 
     size = g_input_stream_read_finish(stream, res, &error);
     if (size == -1) {
@@ -2120,21 +2354,44 @@ ovsdb_read_cb(GObject *source_object, GAsyncResult *res, gpointer user_data)
     }
 
     g_string_append_len(priv->input, priv->buf, size);
-    do {
-        priv->bufp = 0;
-        /* The callback always eats up only up to a single byte. This makes
-         * it possible for us to identify complete JSON objects in spite of
-         * us not knowing the length in advance. */
-        msg = json_load_callback(_json_callback, self, JSON_DISABLE_EOF_CHECK, &json_error);
-        if (msg) {
-            ovsdb_got_msg(self, msg);
-            g_string_erase(priv->input, 0, priv->bufp);
+
+    /* Find the complete JSON objects in the input and decode each of them
+     * at once. The scanner remembers how far it got, so that a large message
+     * that arrives in many reads is scanned only once. */
+    offset = 0;
+    while ((frame_len = nm_json_frame_scan(&priv->input_scanner,
+                                           &priv->input->str[offset],
+                                           priv->input->len - offset))
+           != 0) {
+        nm_auto_decref_json json_t *msg        = NULL;
+        json_error_t                json_error = {
+            0,
+        };
+
+        if (frame_len < 0) {
+            _LOGW("couldn't find a JSON object in the input from ovsdb");
+            ovsdb_disconnect(self, FALSE, FALSE);
+            return;
         }
-        json_decref(msg);
-    } while (msg);
 
-    if (!priv->conn)
-        return;
+        msg = json_loadb(&priv->input->str[offset], frame_len, 0, &json_error);
+        offset += frame_len;
+
+        if (!msg) {
+            _LOGW("couldn't decode the message: %s", json_error.text);
+            ovsdb_disconnect(self, FALSE, FALSE);
+            return;
+        }
+
+        ovsdb_got_msg(self, msg);
+
+        if (!priv->conn) {
+            /* ovsdb_got_msg() disconnected us, the input is gone. */
+            return;
+        }
+    }
+
+    g_string_erase(priv->input, 0, offset);
 
     if (size)
         ovsdb_read(self);
@@ -2232,9 +2489,10 @@ ovsdb_disconnect(NMOvsdb *self, gboolean retry, gboolean is_disposing)
      * shutting down, and cancel the remaining calls after the timeout. */
 
     if (retry) {
-        if (!c_list_is_empty(&priv->calls_lst_head)) {
-            call          = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
+        c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst) {
             call->call_id = CALL_ID_UNSPEC;
+            nm_clear_pointer(&call->params, json_decref);
+            nm_clear_pointer(&call->keys, g_ptr_array_unref);
         }
     } else {
         gs_free_error GError *error = NULL;
@@ -2247,7 +2505,7 @@ ovsdb_disconnect(NMOvsdb *self, gboolean retry, gboolean is_disposing)
             _call_complete(call, NULL, error);
     }
 
-    priv->bufp = 0;
+    priv->input_scanner = NM_JSON_FRAME_SCANNER_INIT;
     g_string_truncate(priv->input, 0);
     g_string_truncate(priv->output, 0);
     g_clear_object(&priv->client);
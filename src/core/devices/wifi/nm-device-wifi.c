@@ -56,6 +56,10 @@
 #define SCAN_REQUEST_SSIDS_MAX_NUM      32u
 #define SCAN_REQUEST_SSIDS_MAX_AGE_MSEC (3 * 60 * NM_UTILS_MSEC_PER_SEC)
 
+/* BSS changes from the supplicant are applied to the AP list at most
+ * this often. During a scan, the changes arrive in bursts. */
+#define BSS_CHANGES_RATELIMIT_MSEC 250
+
 #define _LOGT_scan(...) _LOGT(LOGD_WIFI_SCAN, "wifi-scan: " __VA_ARGS__)
 
 /*****************************************************************************/
@@ -107,6 +111,13 @@ typedef struct {
 
     guint ap_dump_id;
 
+    struct {
+        GHashTable *idx;
+        GPtrArray * lst;
+        GSource *   source;
+        gint64      last_flush_msec;
+    } bss_pending;
+
     guint periodic_update_id;
 
     guint link_timeout_id;
@@ -134,6 +145,9 @@ typedef struct {
     bool scan_explicit_requested : 1;
     bool ssid_found : 1;
     bool hidden_probe_scan_warn : 1;
+    bool ap_batch_in_progress : 1;
+    bool ap_batch_changed : 1;
+    bool ap_batch_recheck_available_connections : 1;
 
 } NMDeviceWifiPrivate;
 
@@ -190,6 +204,10 @@ static void supplicant_iface_notify_p2p_available(NMSupplicantInterface *iface,
 
 static void periodic_update(NMDeviceWifi *self);
 
+static void _bss_pending_clear(NMDeviceWifi *self);
+
+static void _bss_pending_flush(NMDeviceWifi *self);
+
 static void ap_add_remove(NMDeviceWifi *self,
                           gboolean      is_adding,
                           NMWifiAP *    ap,
@@ -532,6 +550,10 @@ supplicant_iface_notify_scanning_cb(NMSupplicantInterface *iface,
                                     GParamSpec *           pspec,
                                     NMDeviceWifi *         self)
 {
+    /* A scan finished. Make its results visible right away. */
+    if (!nm_supplicant_interface_get_scanning(iface))
+        _bss_pending_flush(self);
+
     _scan_notify_is_scanning(self);
 }
 
@@ -651,6 +673,8 @@ supplicant_interface_release(NMDeviceWifi *self)
 
     nm_clear_g_source(&priv->ap_dump_id);
 
+    _bss_pending_clear(self);
+
     if (priv->sup_iface) {
         /* Clear supplicant interface signal handlers */
         g_signal_handlers_disconnect_by_data(priv->sup_iface, self);
@@ -821,6 +845,15 @@ ap_add_remove(NMDeviceWifi *self,
         nm_dbus_object_clear_and_unexport(&ap);
     }
 
+    if (priv->ap_batch_in_progress) {
+        /* The rechecks walk all connections. Do them only once for the
+         * whole batch, see _bss_pending_flush(). */
+        priv->ap_batch_changed = TRUE;
+        if (recheck_available_connections)
+            priv->ap_batch_recheck_available_connections = TRUE;
+        return;
+    }
+
     nm_device_emit_recheck_auto_activate(NM_DEVICE(self));
     if (recheck_available_connections)
         nm_device_recheck_available_connections(NM_DEVICE(self));
@@ -1940,18 +1973,15 @@ try_fill_ssid_for_hidden_ap(NMDeviceWifi *self, NMWifiAP *ap)
 }
 
 static void
-supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
-                                NMSupplicantBssInfo *  bss_info,
-                                gboolean               is_present,
-                                NMDeviceWifi *         self)
+_bss_changed_apply(NMDeviceWifi *self, NMRefString *bss_path, const NMSupplicantBssInfo *bss_info)
 {
     NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
     NMWifiAP *           found_ap;
     GBytes *             ssid;
 
-    found_ap = g_hash_table_lookup(priv->aps_idx_by_supplicant_path, bss_info->bss_path);
+    found_ap = g_hash_table_lookup(priv->aps_idx_by_supplicant_path, bss_path);
 
-    if (!is_present) {
+    if (!bss_info) {
         if (!found_ap)
             return;
         if (found_ap == priv->current_ap) {
@@ -1962,10 +1992,8 @@ supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
              */
             if (nm_wifi_ap_set_fake(found_ap, TRUE))
                 _ap_dump(self, LOGL_DEBUG, found_ap, "updated", 0);
-        } else {
+        } else
             ap_add_remove(self, FALSE, found_ap, TRUE);
-            schedule_ap_list_dump(self);
-        }
         return;
     }
 
@@ -2012,12 +2040,112 @@ supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
     /* Update the current AP if the supplicant notified a current BSS change
      * before it sent the current BSS's scan result.
      */
-    if (nm_supplicant_interface_get_current_bss(iface) == bss_info->bss_path)
+    if (nm_supplicant_interface_get_current_bss(priv->sup_iface) == bss_path)
         supplicant_iface_notify_current_bss(priv->sup_iface, NULL, self);
+}
+
+static void
+_bss_pending_clear(NMDeviceWifi *self)
+{
+    NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+
+    nm_clear_g_source_inst(&priv->bss_pending.source);
+    nm_clear_pointer(&priv->bss_pending.lst, g_ptr_array_unref);
+    nm_clear_pointer(&priv->bss_pending.idx, g_hash_table_unref);
+}
+
+static void
+_bss_pending_flush(NMDeviceWifi *self)
+{
+    NMDeviceWifiPrivate *priv          = NM_DEVICE_WIFI_GET_PRIVATE(self);
+    gs_unref_hashtable GHashTable *idx = NULL;
+    gs_unref_ptrarray GPtrArray *lst   = NULL;
+    guint                i;
+
+    nm_clear_g_source_inst(&priv->bss_pending.source);
+
+    if (!priv->bss_pending.lst)
+        return;
+
+    /* Steal the pending list. Applying a change may recurse into
+     * supplicant_iface_notify_current_bss(), which flushes again. */
+    idx = g_steal_pointer(&priv->bss_pending.idx);
+    lst = g_steal_pointer(&priv->bss_pending.lst);
+
+    priv->bss_pending.last_flush_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    if (!priv->sup_iface)
+        return;
+
+    _LOGT_scan("applying %u BSS changes", lst->len);
+
+    g_object_freeze_notify(G_OBJECT(self));
+
+    nm_assert(!priv->ap_batch_in_progress);
+    priv->ap_batch_in_progress = TRUE;
+    for (i = 0; i < lst->len; i++) {
+        NMRefString *bss_path = lst->pdata[i];
+
+        _bss_changed_apply(self,
+                           bss_path,
+                           nm_supplicant_interface_get_bss_info(priv->sup_iface, bss_path));
+    }
+    priv->ap_batch_in_progress = FALSE;
+
+    if (priv->ap_batch_changed) {
+        priv->ap_batch_changed = FALSE;
+        nm_device_emit_recheck_auto_activate(NM_DEVICE(self));
+        if (priv->ap_batch_recheck_available_connections) {
+            priv->ap_batch_recheck_available_connections = FALSE;
+            nm_device_recheck_available_connections(NM_DEVICE(self));
+        }
+    }
+
+    g_object_thaw_notify(G_OBJECT(self));
 
     schedule_ap_list_dump(self);
 }
 
+static gboolean
+_bss_pending_flush_cb(gpointer user_data)
+{
+    _bss_pending_flush(user_data);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
+                                NMSupplicantBssInfo *  bss_info,
+                                gboolean               is_present,
+                                NMDeviceWifi *         self)
+{
+    NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+    gint64               delay_msec;
+
+    /* Only remember which BSS changed. The current state is looked up when
+     * the changes get applied, so that a BSS which changes several times
+     * in a row (or appears and vanishes again) is handled only once. */
+    if (!priv->bss_pending.lst) {
+        priv->bss_pending.idx = g_hash_table_new_full(nm_direct_hash,
+                                                      NULL,
+                                                      (GDestroyNotify) nm_ref_string_unref,
+                                                      NULL);
+        priv->bss_pending.lst = g_ptr_array_new();
+    }
+    if (g_hash_table_add(priv->bss_pending.idx, nm_ref_string_ref(bss_info->bss_path)))
+        g_ptr_array_add(priv->bss_pending.lst, bss_info->bss_path);
+
+    if (priv->bss_pending.source)
+        return;
+
+    delay_msec = priv->bss_pending.last_flush_msec + BSS_CHANGES_RATELIMIT_MSEC
+                 - nm_utils_get_monotonic_timestamp_msec();
+    if (delay_msec > 0)
+        priv->bss_pending.source = nm_g_timeout_add_source(delay_msec, _bss_pending_flush_cb, self);
+    else
+        priv->bss_pending.source = nm_g_idle_add_source(_bss_pending_flush_cb, self);
+}
+
 static void
 cleanup_association_attempt(NMDeviceWifi *self, gboolean disconnect)
 {
@@ -2569,8 +2697,13 @@ supplicant_iface_notify_current_bss(NMSupplicantInterface *iface,
     NMActRequest *       req;
 
     current_bss = nm_supplicant_interface_get_current_bss(iface);
-    if (current_bss)
+    if (current_bss) {
+        if (priv->bss_pending.idx && g_hash_table_contains(priv->bss_pending.idx, current_bss)) {
+            /* We have a not yet applied change for the new current BSS. */
+            _bss_pending_flush(self);
+        }
         new_ap = g_hash_table_lookup(priv->aps_idx_by_supplicant_path, current_bss);
+    }
 
     if (new_ap != priv->current_ap) {
         const char *  new_bssid  = NULL;
@@ -0,0 +1,955 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include "nm-dhcp-server.h"
+
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "libnm-platform/nm-platform.h"
+#include "libnm-glib-aux/nm-io-utils.h"
+#include "dnsmasq/nm-dnsmasq-utils.h"
+#include "nm-dhcp-options.h"
+#include "nm-utils.h"
+#include "NetworkManagerUtils.h"
+#include "n-dhcp4/src/n-dhcp4.h"
+
+/*****************************************************************************/
+
+#define CLIENT_ID_MAX_LEN 64
+#define PERSIST_DELAY_SEC 5
+
+typedef enum {
+    LEASE_STATE_FREE,
+    LEASE_STATE_OFFERED,
+    LEASE_STATE_BOUND,
+    LEASE_STATE_DECLINED,
+} LeaseState;
+
+/* A slot in the lease table. The table is a small fixed array that gets
+ * scanned linearly. With NM_DHCP_SERVER_LEASE_MAX entries this is cheaper
+ * than keeping an index in sync, and the whole table fits in a few cache
+ * lines.
+ *
+ * A slot whose expiry passed is free, regardless of its state. */
+typedef struct {
+    in_addr_t address;
+    gint32    expiry_sec;
+    guint8    state;
+    guint8    client_id_len;
+    guint8    client_id[CLIENT_ID_MAX_LEN];
+} Lease;
+
+struct _NMDhcpServer {
+    int             ifindex;
+    char *          iface;
+    char *          lease_file;
+    NDhcp4Server *  server;
+    NDhcp4ServerIp *server_ip;
+    GSource *       event_source;
+    GSource *       persist_source;
+
+    /* options appended to every OFFER/ACK, as a TLV stream */
+    GByteArray *options;
+
+    in_addr_t address;
+    guint32   range_first; /* host byte order */
+    guint32   range_last;  /* host byte order */
+
+    NMDhcpServerCallbacks callbacks;
+    gpointer              user_data;
+
+    bool persist_dirty : 1;
+
+    Lease leases[NM_DHCP_SERVER_LEASE_MAX];
+};
+
+/*****************************************************************************/
+
+#define _NMLOG_DOMAIN      LOGD_SHARING
+#define _NMLOG_PREFIX_NAME "dhcp-server"
+#define _NMLOG(level, ...)                                             \
+    G_STMT_START                                                       \
+    {                                                                  \
+        nm_log((level),                                                \
+               _NMLOG_DOMAIN,                                          \
+               self ? self->iface : NULL,                              \
+               NULL,                                                   \
+               "%s%s%s%s: " _NM_UTILS_MACRO_FIRST(__VA_ARGS__),        \
+               _NMLOG_PREFIX_NAME,                                     \
+               NM_PRINT_FMT_QUOTED(self, "[", self->iface, "]", "")    \
+                   _NM_UTILS_MACRO_REST(__VA_ARGS__));                 \
+    }                                                                  \
+    G_STMT_END
+
+/*****************************************************************************/
+
+static gboolean
+_lease_is_active(const Lease *lease, gint32 now)
+{
+    return lease->state != LEASE_STATE_FREE && lease->expiry_sec > now;
+}
+
+static Lease *
+_lease_find_by_client_id(NMDhcpServer *self, const guint8 *client_id, gsize len, gint32 now)
+{
+    guint i;
+
+    for (i = 0; i < NM_DHCP_SERVER_LEASE_MAX; i++) {
+        Lease *lease = &self->leases[i];
+
+        if (_lease_is_active(lease, now) && lease->client_id_len == len
+            && memcmp(lease->client_id, client_id, len) == 0)
+            return lease;
+    }
+    return NULL;
+}
+
+static Lease *
+_lease_find_by_address(NMDhcpServer *self, in_addr_t address, gint32 now)
+{
+    guint i;
+
+    for (i = 0; i < NM_DHCP_SERVER_LEASE_MAX; i++) {
+        Lease *lease = &self->leases[i];
+
+        if (_lease_is_active(lease, now) && lease->address == address)
+            return lease;
+    }
+    return NULL;
+}
+
+static Lease *
+_lease_find_free_slot(NMDhcpServer *self, gint32 now)
+{
+    Lease *expired = NULL;
+    guint  i;
+
+    for (i = 0; i < NM_DHCP_SERVER_LEASE_MAX; i++) {
+        Lease *lease = &self->leases[i];
+
+        if (lease->state == LEASE_STATE_FREE)
+            return lease;
+        if (!expired && !_lease_is_active(lease, now))
+            expired = lease;
+    }
+    return expired;
+}
+
+static gboolean
+_address_is_available(NMDhcpServer *self, in_addr_t address, gint32 now)
+{
+    guint32 a = ntohl(address);
+
+    return a >= self->range_first && a <= self->range_last && address != self->address
+           && !_lease_find_by_address(self, address, now);
+}
+
+static in_addr_t
+_address_pick(NMDhcpServer *self,
+              const guint8 *client_id,
+              gsize         client_id_len,
+              in_addr_t     requested,
+              gint32        now)
+{
+    guint32 n;
+    guint32 start;
+    guint32 i;
+
+    if (requested && _address_is_available(self, requested, now))
+        return requested;
+
+    /* Start probing at a position derived from the client-id, so that a
+     * returning client tends to get the same address even after its lease
+     * was reclaimed. */
+    n     = self->range_last - self->range_first + 1;
+    start = nm_hash_mem(1871, client_id, client_id_len) % n;
+    for (i = 0; i < n; i++) {
+        in_addr_t address = htonl(self->range_first + ((start + i) % n));
+
+        if (_address_is_available(self, address, now))
+            return address;
+    }
+    return 0;
+}
+
+static gboolean
+_lease_get_client_id(NDhcp4ServerLease *slease, guint8 *buf, gsize *out_len)
+{
+    const guint8 *chaddr;
+    guint8 *      data;
+    size_t        n_data;
+
+    if (n_dhcp4_server_lease_query(slease, NM_DHCP_OPTION_DHCP4_CLIENT_ID, &data, &n_data) == 0
+        && n_data > 0 && n_data <= CLIENT_ID_MAX_LEN) {
+        memcpy(buf, data, n_data);
+        *out_len = n_data;
+        return TRUE;
+    }
+
+    /* Without a client-id, key the lease by the hardware address. Prefix it
+     * with a zero type byte so it cannot collide with the common type 1
+     * (ethernet) client-id of a different client. */
+    n_dhcp4_server_lease_get_chaddr(slease, &chaddr, &n_data);
+    if (n_data == 0 || n_data >= CLIENT_ID_MAX_LEN)
+        return FALSE;
+
+    buf[0] = 0;
+    memcpy(&buf[1], chaddr, n_data);
+    *out_len = n_data + 1;
+    return TRUE;
+}
+
+static void
+_lease_set_client_id(Lease *lease, const guint8 *client_id, gsize len)
+{
+    nm_assert(len <= CLIENT_ID_MAX_LEN);
+
+    memcpy(lease->client_id, client_id, len);
+    lease->client_id_len = len;
+}
+
+/*****************************************************************************/
+
+static void
+_persist_flush(NMDhcpServer *self)
+{
+    gs_free_error GError *        error = NULL;
+    nm_auto_free_gstring GString *str   = NULL;
+    gint32                        now;
+    gint64                        now_real;
+    guint                         i;
+
+    if (!self->persist_dirty)
+        return;
+
+    self->persist_dirty = FALSE;
+
+    str      = g_string_new(NULL);
+    now      = nm_utils_get_monotonic_timestamp_sec();
+    now_real = time(NULL);
+
+    for (i = 0; i < NM_DHCP_SERVER_LEASE_MAX; i++) {
+        const Lease *lease = &self->leases[i];
+        char         addr_buf[INET_ADDRSTRLEN];
+        char         cid_buf[CLIENT_ID_MAX_LEN * 2 + 1];
+
+        if (lease->state != LEASE_STATE_BOUND || !_lease_is_active(lease, now))
+            continue;
+
+        g_string_append_printf(
+            str,
+            "%" G_GINT64_FORMAT " %s %s\n",
+            now_real + (lease->expiry_sec - now),
+            _nm_utils_inet4_ntop(lease->address, addr_buf),
+            nm_utils_bin2hexstr_full(lease->client_id, lease->client_id_len, '\0', FALSE, cid_buf));
+    }
+
+    if (!nm_utils_file_set_contents(self->lease_file, str->str, str->len, 0644, NULL, &error))
+        _LOGW("failed to write lease file %s: %s", self->lease_file, error->message);
+}
+
+static gboolean
+_persist_timeout_cb(gpointer user_data)
+{
+    NMDhcpServer *self = user_data;
+
+    nm_clear_g_source_inst(&self->persist_source);
+    _persist_flush(self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_persist_schedule(NMDhcpServer *self)
+{
+    /* Writing the file on every ACK would turn a burst of clients into a
+     * burst of fsyncs. Coalesce changes and write at most every few seconds. */
+    self->persist_dirty = TRUE;
+    if (!self->persist_source)
+        self->persist_source =
+            nm_g_timeout_add_source_seconds(PERSIST_DELAY_SEC, _persist_timeout_cb, self);
+}
+
+static void
+_persist_load(NMDhcpServer *self)
+{
+    gs_free char *     contents = NULL;
+    gs_strfreev char **lines    = NULL;
+    gint32             now      = nm_utils_get_monotonic_timestamp_sec();
+    gint64             now_real = time(NULL);
+    guint              n_loaded = 0;
+    guint              i;
+
+    if (!g_file_get_contents(self->lease_file, &contents, NULL, NULL))
+        return;
+
+    lines = g_strsplit(contents, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+        gs_strfreev char **tokens = NULL;
+        guint8             client_id[CLIENT_ID_MAX_LEN];
+        gsize              client_id_len;
+        in_addr_t          address;
+        gint64             expiry;
+        Lease *            lease;
+
+        tokens = g_strsplit(lines[i], " ", 3);
+        if (NM_PTRARRAY_LEN(tokens) != 3)
+            continue;
+
+        expiry = _nm_utils_ascii_str_to_int64(tokens[0], 10, 0, G_MAXINT64, 0);
+        if (expiry <= now_real)
+            continue;
+        if (inet_pton(AF_INET, tokens[1], &address) != 1)
+            continue;
+        if (!nm_utils_hexstr2bin_full(tokens[2],
+                                      FALSE,
+                                      FALSE,
+                                      TRUE,
+                                      NULL,
+                                      0,
+                                      client_id,
+                                      sizeof(client_id),
+                                      &client_id_len))
+            continue;
+
+        /* The subnet may have changed since the file was written. */
+        if (!_address_is_available(self, address, now)
+            || _lease_find_by_client_id(self, client_id, client_id_len, now))
+            continue;
+
+        lease = _lease_find_free_slot(self, now);
+        if (!lease)
+            break;
+
+        lease->address    = address;
+        lease->state      = LEASE_STATE_BOUND;
+        lease->expiry_sec = now + MIN(expiry - now_real, (gint64) NM_DHCP_SERVER_LEASE_TIME_SEC);
+        _lease_set_client_id(lease, client_id, client_id_len);
+        n_loaded++;
+    }
+
+    _LOGD("restored %u leases from %s", n_loaded, self->lease_file);
+}
+
+/*****************************************************************************/
+
+static void
+_reply(NMDhcpServer *self, NDhcp4ServerLease *slease, const Lease *lease, gboolean ack)
+{
+    char  addr_buf[INET_ADDRSTRLEN];
+    guint i;
+    int   r;
+
+    n_dhcp4_server_lease_set_yiaddr(slease, (struct in_addr){lease->address});
+    n_dhcp4_server_lease_set_lifetime(slease, NM_DHCP_SERVER_LEASE_TIME_SEC);
+
+    for (i = 0; i < self->options->len; i += 2 + self->options->data[i + 1]) {
+        r = n_dhcp4_server_lease_append(slease,
+                                        self->options->data[i],
+                                        &self->options->data[i + 2],
+                                        self->options->data[i + 1]);
+        if (r)
+            _LOGT("failed to append option %u: %d", self->options->data[i], r);
+    }
+
+    r = ack ? n_dhcp4_server_lease_ack(slease) : n_dhcp4_server_lease_offer(slease);
+    if (r) {
+        _LOGD("failed to send %s for %s: %d",
+              ack ? "ACK" : "OFFER",
+              _nm_utils_inet4_ntop(lease->address, addr_buf),
+              r);
+        return;
+    }
+
+    _LOGT("sent %s for %s", ack ? "ACK" : "OFFER", _nm_utils_inet4_ntop(lease->address, addr_buf));
+}
+
+/* The lease table operations for the requests of a client. They don't
+ * send replies, so that they can be tested without sockets. */
+
+static const Lease *
+_lease_offer(NMDhcpServer *self,
+             const guint8 *client_id,
+             gsize         client_id_len,
+             in_addr_t     requested,
+             gint32        now)
+{
+    in_addr_t address;
+    Lease *   lease;
+
+    lease = _lease_find_by_client_id(self, client_id, client_id_len, now);
+    if (lease)
+        return lease;
+
+    lease = _lease_find_free_slot(self, now);
+    if (!lease) {
+        _LOGD("ignore DISCOVER: lease table is full");
+        return NULL;
+    }
+
+    address = _address_pick(self, client_id, client_id_len, requested, now);
+    if (!address) {
+        _LOGD("ignore DISCOVER: no free address");
+        return NULL;
+    }
+
+    lease->address    = address;
+    lease->state      = LEASE_STATE_OFFERED;
+    lease->expiry_sec = now + NM_DHCP_SERVER_OFFER_TIME_SEC;
+    _lease_set_client_id(lease, client_id, client_id_len);
+    return lease;
+}
+
+static const Lease *
+_lease_bind(NMDhcpServer *self,
+            const guint8 *client_id,
+            gsize         client_id_len,
+            in_addr_t     requested,
+            gint32        now)
+{
+    Lease *lease;
+
+    lease = _lease_find_by_client_id(self, client_id, client_id_len, now);
+    if (lease) {
+        if (lease->address != requested)
+            return NULL;
+    } else {
+        /* A client we have no record of, for example one that got its lease
+         * before we restarted and lost the file. Grant the address if it is
+         * still free, instead of forcing it through a new DISCOVER. */
+        if (!_address_is_available(self, requested, now)
+            || !(lease = _lease_find_free_slot(self, now)))
+            return NULL;
+        lease->address = requested;
+        _lease_set_client_id(lease, client_id, client_id_len);
+    }
+
+    lease->state      = LEASE_STATE_BOUND;
+    lease->expiry_sec = now + NM_DHCP_SERVER_LEASE_TIME_SEC;
+    _persist_schedule(self);
+    return lease;
+}
+
+static gboolean
+_lease_decline(NMDhcpServer *self, in_addr_t address, gint32 now)
+{
+    char   addr_buf[INET_ADDRSTRLEN];
+    Lease *lease;
+
+    lease = _lease_find_by_address(self, address, now);
+    if (!lease)
+        return FALSE;
+
+    /* Somebody else uses the address. Keep it blocked for a lease time. */
+    _LOGD("address %s declined", _nm_utils_inet4_ntop(address, addr_buf));
+    lease->state         = LEASE_STATE_DECLINED;
+    lease->expiry_sec    = now + NM_DHCP_SERVER_LEASE_TIME_SEC;
+    lease->client_id_len = 0;
+    _persist_schedule(self);
+    return TRUE;
+}
+
+static gboolean
+_lease_release(NMDhcpServer *self,
+               const guint8 *client_id,
+               gsize         client_id_len,
+               in_addr_t     address,
+               gint32        now)
+{
+    Lease *lease;
+
+    lease = _lease_find_by_client_id(self, client_id, client_id_len, now);
+    if (!lease)
+        return FALSE;
+    if (address && address != lease->address)
+        return FALSE;
+
+    lease->state = LEASE_STATE_FREE;
+    _persist_schedule(self);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+_handle_discover(NMDhcpServer *self, NDhcp4ServerLease *slease, gint32 now)
+{
+    guint8         client_id[CLIENT_ID_MAX_LEN];
+    gsize          client_id_len;
+    struct in_addr requested = {};
+    const Lease *  lease;
+
+    if (!_lease_get_client_id(slease, client_id, &client_id_len))
+        return;
+
+    if (n_dhcp4_server_lease_get_requested_ip(slease, &requested) != 0)
+        requested.s_addr = 0;
+
+    lease = _lease_offer(self, client_id, client_id_len, requested.s_addr, now);
+    if (lease)
+        _reply(self, slease, lease, FALSE);
+}
+
+static void
+_handle_request(NMDhcpServer *self, NDhcp4ServerLease *slease, gint32 now)
+{
+    guint8         client_id[CLIENT_ID_MAX_LEN];
+    gsize          client_id_len;
+    struct in_addr requested = {};
+    const Lease *  lease;
+
+    if (!_lease_get_client_id(slease, client_id, &client_id_len))
+        return;
+
+    if (n_dhcp4_server_lease_get_requested_ip(slease, &requested) != 0)
+        return;
+
+    lease = _lease_bind(self, client_id, client_id_len, requested.s_addr, now);
+    if (!lease) {
+        (void) n_dhcp4_server_lease_nack(slease);
+        return;
+    }
+
+    _reply(self, slease, lease, TRUE);
+}
+
+static void
+_handle_decline(NMDhcpServer *self, NDhcp4ServerLease *slease, gint32 now)
+{
+    struct in_addr requested = {};
+
+    if (n_dhcp4_server_lease_get_requested_ip(slease, &requested) != 0)
+        return;
+
+    _lease_decline(self, requested.s_addr, now);
+}
+
+static void
+_handle_release(NMDhcpServer *self, NDhcp4ServerLease *slease, gint32 now)
+{
+    guint8         client_id[CLIENT_ID_MAX_LEN];
+    gsize          client_id_len;
+    struct in_addr requested = {};
+
+    if (!_lease_get_client_id(slease, client_id, &client_id_len))
+        return;
+
+    if (n_dhcp4_server_lease_get_requested_ip(slease, &requested) != 0)
+        requested.s_addr = 0;
+
+    _lease_release(self, client_id, client_id_len, requested.s_addr, now);
+}
+
+static gboolean
+_event_cb(int fd, GIOCondition condition, gpointer user_data)
+{
+    NMDhcpServer *     self = user_data;
+    NDhcp4ServerEvent *event;
+    gint32             now;
+    int                r;
+
+    r = n_dhcp4_server_dispatch(self->server);
+    if (r < 0) {
+        _LOGW("failure handling DHCP requests: %s", nm_strerror_native(-r));
+        nm_clear_g_source_inst(&self->event_source);
+        if (self->callbacks.failed_callback)
+            self->callbacks.failed_callback(self, self->user_data);
+        return G_SOURCE_CONTINUE;
+    }
+
+    /* A positive return value means that n-dhcp4 stopped early because more
+     * requests are pending. The socket stays readable and we get called
+     * again, after the events queued so far are handled. */
+
+    now = nm_utils_get_monotonic_timestamp_sec();
+    while (!n_dhcp4_server_pop_event(self->server, &event) && event) {
+        switch (event->event) {
+        case N_DHCP4_SERVER_EVENT_DISCOVER:
+            _handle_discover(self, event->discover.lease, now);
+            break;
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+            _handle_request(self, event->request.lease, now);
+            break;
+        case N_DHCP4_SERVER_EVENT_RENEW:
+            _handle_request(self, event->renew.lease, now);
+            break;
+        case N_DHCP4_SERVER_EVENT_DECLINE:
+            _handle_decline(self, event->decline.lease, now);
+            break;
+        case N_DHCP4_SERVER_EVENT_RELEASE:
+            _handle_release(self, event->release.lease, now);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+static void
+_options_append(GByteArray *options, guint8 code, gconstpointer data, gsize len)
+{
+    guint8 hdr[2] = {code, len};
+
+    if (len == 0 || len > G_MAXUINT8)
+        return;
+
+    g_byte_array_append(options, hdr, sizeof(hdr));
+    g_byte_array_append(options, data, len);
+}
+
+static gboolean
+_options_encode_domain(GByteArray *buf, const char *domain)
+{
+    const char *label;
+
+    /* RFC 1035 encoding, without compression (RFC 3397). */
+    for (label = domain; *label;) {
+        const char *dot = strchr(label, '.');
+        gsize       len = dot ? (gsize) (dot - label) : strlen(label);
+        guint8      len8;
+
+        if (len == 0 || len > 63)
+            return FALSE;
+
+        len8 = len;
+        g_byte_array_append(buf, &len8, 1);
+        g_byte_array_append(buf, (const guint8 *) label, len);
+        label += len;
+        if (*label == '.')
+            label++;
+    }
+    g_byte_array_append(buf, (const guint8 *) "", 1);
+    return TRUE;
+}
+
+static void
+_options_build(NMDhcpServer *              self,
+               const NMIP4Config *         ip4_config,
+               const NMIP4Config *         upstream_config,
+               const NMPlatformIP4Address *listen_address,
+               gboolean                    announce_android_metered)
+{
+    nm_auto_unref_bytearray GByteArray *search = NULL;
+    in_addr_t                           netmask;
+    in_addr_t                           broadcast;
+    in_addr_t                           dns[G_MAXUINT8 / sizeof(in_addr_t)];
+    guint                               i, n;
+
+    g_byte_array_set_size(self->options, 0);
+
+    netmask   = _nm_utils_ip4_prefix_to_netmask(listen_address->plen);
+    broadcast = listen_address->address | ~netmask;
+
+    _options_append(self->options, NM_DHCP_OPTION_DHCP4_SUBNET_MASK, &netmask, sizeof(netmask));
+    _options_append(self->options, NM_DHCP_OPTION_DHCP4_BROADCAST, &broadcast, sizeof(broadcast));
+
+    /* We always route the clients, like dnsmasq does. */
+    _options_append(self->options,
+                    NM_DHCP_OPTION_DHCP4_ROUTER,
+                    &listen_address->address,
+                    sizeof(listen_address->address));
+
+    /* Unlike dnsmasq, we don't run a DNS forwarder that listens on our
+     * address. Instead, clients get the upstream name servers directly.
+     * Loopback addresses (like a local caching resolver) would not be
+     * reachable for them. */
+    n = 0;
+    if (upstream_config) {
+        guint num = nm_ip4_config_get_num_nameservers(upstream_config);
+
+        for (i = 0; i < num && n < G_N_ELEMENTS(dns); i++) {
+            in_addr_t ns = nm_ip4_config_get_nameserver(upstream_config, i);
+
+            if (ns == INADDR_ANY || (ntohl(ns) >> IN_CLASSA_NSHIFT) == IN_LOOPBACKNET)
+                continue;
+            dns[n++] = ns;
+        }
+    }
+    if (n > 0) {
+        _options_append(self->options,
+                        NM_DHCP_OPTION_DHCP4_DOMAIN_NAME_SERVER,
+                        dns,
+                        n * sizeof(in_addr_t));
+    } else
+        _LOGD("no upstream name servers to announce");
+
+    n = nm_ip4_config_get_num_searches(ip4_config);
+    if (n > 0) {
+        search = g_byte_array_new();
+        for (i = 0; i < n; i++) {
+            const char *domain  = nm_ip4_config_get_search(ip4_config, i);
+            guint       old_len = search->len;
+
+            if (!_options_encode_domain(search, domain) || search->len > G_MAXUINT8) {
+                _LOGD("skip search domain '%s' for DHCP", domain);
+                g_byte_array_set_size(search, old_len);
+            }
+        }
+        _options_append(self->options,
+                        NM_DHCP_OPTION_DHCP4_DOMAIN_SEARCH_LIST,
+                        search->data,
+                        search->len);
+    }
+
+    if (announce_android_metered) {
+        /* See https://www.lorier.net/docs/android-metered.html */
+        _options_append(self->options,
+                        NM_DHCP_OPTION_DHCP4_VENDOR_SPECIFIC,
+                        "ANDROID_METERED",
+                        NM_STRLEN("ANDROID_METERED"));
+    }
+}
+
+/*****************************************************************************/
+
+static gboolean
+_range_set(NMDhcpServer *              self,
+           const NMPlatformIP4Address *listen_address,
+           char *                      out_first,
+           char *                      out_last,
+           GError **                   error)
+{
+    gs_free char *error_desc = NULL;
+    in_addr_t     a;
+
+    /* Use the same range as dnsmasq would, so that switching between the two
+     * does not renumber clients. */
+    if (!nm_dnsmasq_utils_get_range(listen_address, out_first, out_last, &error_desc)) {
+        g_set_error_literal(error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_FAILED, error_desc);
+        return FALSE;
+    }
+    if (inet_pton(AF_INET, out_first, &a) != 1)
+        g_return_val_if_reached(FALSE);
+    self->range_first = ntohl(a);
+    if (inet_pton(AF_INET, out_last, &a) != 1)
+        g_return_val_if_reached(FALSE);
+    self->range_last = ntohl(a);
+    self->address    = listen_address->address;
+    return TRUE;
+}
+
+NMDhcpServer *
+nm_dhcp_server_new(int                          ifindex,
+                   const char *                 iface,
+                   const NMDhcpServerCallbacks *callbacks,
+                   gpointer                     user_data)
+{
+    NMDhcpServer *self;
+
+    g_return_val_if_fail(ifindex > 0, NULL);
+    g_return_val_if_fail(iface, NULL);
+
+    self  = g_slice_new0(NMDhcpServer);
+    *self = (NMDhcpServer){
+        .ifindex    = ifindex,
+        .iface      = g_strdup(iface),
+        .lease_file = g_strdup_printf(NMSTATEDIR "/dhcp-server-%s.leases", iface),
+        .options    = g_byte_array_new(),
+        .user_data  = user_data,
+    };
+    if (callbacks)
+        self->callbacks = *callbacks;
+
+    return self;
+}
+
+gboolean
+nm_dhcp_server_start(NMDhcpServer *     self,
+                     const NMIP4Config *ip4_config,
+                     const NMIP4Config *upstream_config,
+                     gboolean           announce_android_metered,
+                     GError **          error)
+{
+    nm_auto(n_dhcp4_server_config_freep) NDhcp4ServerConfig *config     = NULL;
+    const NMPlatformIP4Address *                             listen_address;
+    char                                                     first[INET_ADDRSTRLEN];
+    char                                                     last[INET_ADDRSTRLEN];
+    int                                                      fd;
+    int                                                      r;
+
+    g_return_val_if_fail(self, FALSE);
+    g_return_val_if_fail(!self->server, FALSE);
+
+    listen_address = nm_ip4_config_get_first_address(ip4_config);
+    g_return_val_if_fail(listen_address, FALSE);
+
+    if (!_range_set(self, listen_address, first, last, error))
+        return FALSE;
+
+    _options_build(self, ip4_config, upstream_config, listen_address, announce_android_metered);
+
+    r = n_dhcp4_server_config_new(&config);
+    if (r) {
+        nm_utils_error_set_errno(error, r, "failed to create DHCP server config: %s");
+        return FALSE;
+    }
+    n_dhcp4_server_config_set_ifindex(config, self->ifindex);
+
+    r = n_dhcp4_server_new(&self->server, config);
+    if (r) {
+        g_set_error(error,
+                    NM_UTILS_ERROR,
+                    NM_UTILS_ERROR_UNKNOWN,
+                    "failed to create DHCP server: %d",
+                    r);
+        return FALSE;
+    }
+
+    r = n_dhcp4_server_add_ip(self->server,
+                              &self->server_ip,
+                              (struct in_addr){listen_address->address});
+    if (r) {
+        g_set_error(error,
+                    NM_UTILS_ERROR,
+                    NM_UTILS_ERROR_UNKNOWN,
+                    "failed to set DHCP server address: %d",
+                    r);
+        return FALSE;
+    }
+
+    _persist_load(self);
+
+    n_dhcp4_server_get_fd(self->server, &fd);
+    self->event_source =
+        nm_g_unix_fd_source_new(fd, G_IO_IN, G_PRIORITY_DEFAULT, _event_cb, self, NULL);
+    g_source_attach(self->event_source, NULL);
+
+    _LOGD("started, handing out %s - %s", first, last);
+    return TRUE;
+}
+
+void
+nm_dhcp_server_free(NMDhcpServer *self)
+{
+    if (!self)
+        return;
+
+    nm_clear_g_source_inst(&self->event_source);
+
+    /* flush pending lease changes */
+    nm_clear_g_source_inst(&self->persist_source);
+    _persist_flush(self);
+
+    nm_clear_pointer(&self->server_ip, n_dhcp4_server_ip_free);
+    nm_clear_pointer(&self->server, n_dhcp4_server_unref);
+
+    g_byte_array_unref(self->options);
+    g_free(self->lease_file);
+    g_free(self->iface);
+    nm_g_slice_free(self);
+}
+
+/*****************************************************************************/
+
+NMDhcpServer *
+_nmtst_dhcp_server_new(const char *lease_file, in_addr_t address, guint8 plen)
+{
+    const NMPlatformIP4Address listen_address = {
+        .address = address,
+        .plen    = plen,
+    };
+    NMDhcpServer *self;
+    char          first[INET_ADDRSTRLEN];
+    char          last[INET_ADDRSTRLEN];
+
+    self = nm_dhcp_server_new(1, "nmtst", NULL, NULL);
+    nm_utils_strdup_reset(&self->lease_file, lease_file);
+
+    if (!_range_set(self, &listen_address, first, last, NULL)) {
+        nm_dhcp_server_free(self);
+        g_return_val_if_reached(NULL);
+    }
+    return self;
+}
+
+void
+_nmtst_dhcp_server_persist_load(NMDhcpServer *self)
+{
+    _persist_load(self);
+}
+
+void
+_nmtst_dhcp_server_persist_flush(NMDhcpServer *self)
+{
+    nm_clear_g_source_inst(&self->persist_source);
+    _persist_flush(self);
+}
+
+in_addr_t
+_nmtst_dhcp_server_address_pick(NMDhcpServer *self,
+                                const guint8 *client_id,
+                                gsize         client_id_len,
+                                in_addr_t     requested,
+                                gint32        now)
+{
+    return _address_pick(self, client_id, client_id_len, requested, now);
+}
+
+in_addr_t
+_nmtst_dhcp_server_offer(NMDhcpServer *self,
+                         const guint8 *client_id,
+                         gsize         client_id_len,
+                         in_addr_t     requested,
+                         gint32        now)
+{
+    const Lease *lease;
+
+    lease = _lease_offer(self, client_id, client_id_len, requested, now);
+    return lease ? lease->address : 0;
+}
+
+in_addr_t
+_nmtst_dhcp_server_bind(NMDhcpServer *self,
+                        const guint8 *client_id,
+                        gsize         client_id_len,
+                        in_addr_t     requested,
+                        gint32        now)
+{
+    const Lease *lease;
+
+    lease = _lease_bind(self, client_id, client_id_len, requested, now);
+    return lease ? lease->address : 0;
+}
+
+gboolean
+_nmtst_dhcp_server_decline(NMDhcpServer *self, in_addr_t address, gint32 now)
+{
+    return _lease_decline(self, address, now);
+}
+
+gboolean
+_nmtst_dhcp_server_release(NMDhcpServer *self,
+                           const guint8 *client_id,
+                           gsize         client_id_len,
+                           in_addr_t     address,
+                           gint32        now)
+{
+    return _lease_release(self, client_id, client_id_len, address, now);
+}
+
+GBytes *
+_nmtst_dhcp_server_options_build(NMDhcpServer *     self,
+                                 const NMIP4Config *ip4_config,
+                                 const NMIP4Config *upstream_config,
+                                 gboolean           announce_android_metered)
+{
+    const NMPlatformIP4Address *listen_address;
+
+    listen_address = nm_ip4_config_get_first_address(ip4_config);
+    g_return_val_if_fail(listen_address, NULL);
+
+    _options_build(self, ip4_config, upstream_config, listen_address, announce_android_metered);
+    return g_bytes_new(self->options->data, self->options->len);
+}
+
+gboolean
+_nmtst_dhcp_server_encode_domain(GByteArray *buf, const char *domain)
+{
+    return _options_encode_domain(buf, domain);
+}
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef __NM_DHCP_SERVER_H__
+#define __NM_DHCP_SERVER_H__
+
+#include "nm-ip4-config.h"
+
+/* The limits match what we pass to dnsmasq for shared connections. */
+#define NM_DHCP_SERVER_LEASE_MAX      50
+#define NM_DHCP_SERVER_LEASE_TIME_SEC 3600
+#define NM_DHCP_SERVER_OFFER_TIME_SEC 30
+
+typedef struct _NMDhcpServer NMDhcpServer;
+
+typedef struct {
+    /* Called when the server socket fails and the server stopped
+     * handing out leases. The instance must still be freed by the
+     * caller. */
+    void (*failed_callback)(NMDhcpServer *self, gpointer user_data);
+} NMDhcpServerCallbacks;
+
+NMDhcpServer *nm_dhcp_server_new(int                          ifindex,
+                                 const char *                 iface,
+                                 const NMDhcpServerCallbacks *callbacks,
+                                 gpointer                     user_data);
+
+gboolean nm_dhcp_server_start(NMDhcpServer *     self,
+                              const NMIP4Config *ip4_config,
+                              const NMIP4Config *upstream_config,
+                              gboolean           announce_android_metered,
+                              GError **          error);
+
+void nm_dhcp_server_free(NMDhcpServer *self);
+
+NM_AUTO_DEFINE_FCN0(NMDhcpServer *, _nm_auto_free_dhcp_server, nm_dhcp_server_free);
+#define nm_auto_free_dhcp_server nm_auto(_nm_auto_free_dhcp_server)
+
+/*****************************************************************************/
+
+NMDhcpServer *_nmtst_dhcp_server_new(const char *lease_file, in_addr_t address, guint8 plen);
+
+void _nmtst_dhcp_server_persist_load(NMDhcpServer *self);
+void _nmtst_dhcp_server_persist_flush(NMDhcpServer *self);
+
+in_addr_t _nmtst_dhcp_server_address_pick(NMDhcpServer *self,
+                                          const guint8 *client_id,
+                                          gsize         client_id_len,
+                                          in_addr_t     requested,
+                                          gint32        now);
+
+in_addr_t _nmtst_dhcp_server_offer(NMDhcpServer *self,
+                                   const guint8 *client_id,
+                                   gsize         client_id_len,
+                                   in_addr_t     requested,
+                                   gint32        now);
+
+in_addr_t _nmtst_dhcp_server_bind(NMDhcpServer *self,
+                                  const guint8 *client_id,
+                                  gsize         client_id_len,
+                                  in_addr_t     requested,
+                                  gint32        now);
+
+gboolean _nmtst_dhcp_server_decline(NMDhcpServer *self, in_addr_t address, gint32 now);
+
+gboolean _nmtst_dhcp_server_release(NMDhcpServer *self,
+                                    const guint8 *client_id,
+                                    gsize         client_id_len,
+                                    in_addr_t     address,
+                                    gint32        now);
+
+GBytes *_nmtst_dhcp_server_options_build(NMDhcpServer *     self,
+                                         const NMIP4Config *ip4_config,
+                                         const NMIP4Config *upstream_config,
+                                         gboolean           announce_android_metered);
+
+gboolean _nmtst_dhcp_server_encode_domain(GByteArray *buf, const char *domain);
+
+#endif /* __NM_DHCP_SERVER_H__ */
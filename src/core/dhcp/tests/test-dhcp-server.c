@@ -0,0 +1,559 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include <arpa/inet.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libnm-glib-aux/nm-io-utils.h"
+#include "libnm-platform/nm-platform.h"
+#include "dhcp/nm-dhcp-server.h"
+#include "dhcp/nm-dhcp-options.h"
+#include "dnsmasq/nm-dnsmasq-utils.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    NMDhcpServer *server;
+    char *        tmpdir;
+    char *        lease_file;
+    in_addr_t     address;
+    guint32       range_first; /* host byte order */
+    guint32       range_last;  /* host byte order */
+} ServerData;
+
+static void
+_server_data_init(ServerData *d, const char *address, guint8 plen)
+{
+    gs_free_error GError *error          = NULL;
+    NMPlatformIP4Address  listen_address = {};
+    char                  first[INET_ADDRSTRLEN];
+    char                  last[INET_ADDRSTRLEN];
+    in_addr_t             a;
+
+    *d = (ServerData){
+        .address = nmtst_inet4_from_string(address),
+    };
+
+    d->tmpdir = g_dir_make_tmp("nm-test-dhcp-server-XXXXXX", &error);
+    nmtst_assert_success(d->tmpdir, error);
+    d->lease_file = g_build_filename(d->tmpdir, "dhcp-server-nmtst.leases", NULL);
+
+    listen_address.address = d->address;
+    listen_address.plen    = plen;
+    g_assert(nm_dnsmasq_utils_get_range(&listen_address, first, last, NULL));
+    g_assert_cmpint(inet_pton(AF_INET, first, &a), ==, 1);
+    d->range_first = ntohl(a);
+    g_assert_cmpint(inet_pton(AF_INET, last, &a), ==, 1);
+    d->range_last = ntohl(a);
+
+    d->server = _nmtst_dhcp_server_new(d->lease_file, d->address, plen);
+    g_assert(d->server);
+}
+
+static void
+_server_data_clear(ServerData *d)
+{
+    nm_clear_pointer(&d->server, nm_dhcp_server_free);
+    (void) unlink(d->lease_file);
+    g_assert_cmpint(rmdir(d->tmpdir), ==, 0);
+    nm_clear_g_free(&d->lease_file);
+    nm_clear_g_free(&d->tmpdir);
+}
+
+static in_addr_t
+_range_addr(const ServerData *d, guint32 idx)
+{
+    g_assert_cmpint(d->range_first + idx, <=, d->range_last);
+    return htonl(d->range_first + idx);
+}
+
+/* The picked addresses depend on a randomly seeded hash. Return the first
+ * address of the range that is none of @a, @b and @c. */
+static in_addr_t
+_range_addr_other(const ServerData *d, in_addr_t a, in_addr_t b, in_addr_t c)
+{
+    guint32 idx;
+
+    for (idx = 0;; idx++) {
+        in_addr_t x = _range_addr(d, idx);
+
+        if (!NM_IN_SET(x, a, b, c))
+            return x;
+    }
+}
+
+static gboolean
+_in_range(const ServerData *d, in_addr_t address)
+{
+    guint32 a = ntohl(address);
+
+    return a >= d->range_first && a <= d->range_last && address != d->address;
+}
+
+#define _CID(str) ((const guint8 *) ("" str "")), NM_STRLEN(str)
+
+/*****************************************************************************/
+
+static void
+_assert_encode_domain(const char *domain, const char *expected, gsize expected_len)
+{
+    nm_auto_unref_bytearray GByteArray *buf = g_byte_array_new();
+    gboolean                            success;
+
+    success = _nmtst_dhcp_server_encode_domain(buf, domain);
+    if (!expected) {
+        g_assert(!success);
+        return;
+    }
+
+    g_assert(success);
+    g_assert_cmpmem(buf->data, buf->len, expected, expected_len);
+}
+
+#define _assert_encode_domain_ok(domain, expected) \
+    _assert_encode_domain((domain), "" expected "", sizeof(expected))
+
+static void
+test_encode_domain(void)
+{
+    char label[65];
+    char expected[66];
+
+    _assert_encode_domain_ok("", "");
+    _assert_encode_domain_ok("a", "\001a");
+    _assert_encode_domain_ok("example.com", "\007example\003com");
+    _assert_encode_domain_ok("example.com.", "\007example\003com");
+    _assert_encode_domain_ok("a.b.c", "\001a\001b\001c");
+
+    _assert_encode_domain(".", NULL, 0);
+    _assert_encode_domain(".example.com", NULL, 0);
+    _assert_encode_domain("example..com", NULL, 0);
+
+    /* labels are limited to 63 characters. */
+    memset(label, 'x', sizeof(label) - 1);
+    label[64] = '\0';
+    _assert_encode_domain(label, NULL, 0);
+
+    label[63]   = '\0';
+    expected[0] = 63;
+    memcpy(&expected[1], label, 63);
+    expected[64] = '\0';
+    _assert_encode_domain(label, expected, 65);
+}
+
+/*****************************************************************************/
+
+static const guint8 *
+_options_find(GBytes *options, guint8 code, gsize *out_len)
+{
+    const guint8 *data;
+    gsize         len;
+    gsize         i;
+
+    data = g_bytes_get_data(options, &len);
+    for (i = 0; i + 2 <= len; i += 2 + data[i + 1]) {
+        g_assert_cmpint(i + 2 + data[i + 1], <=, len);
+        if (data[i] == code) {
+            *out_len = data[i + 1];
+            return &data[i + 2];
+        }
+    }
+    return NULL;
+}
+
+static void
+test_options(void)
+{
+    gs_unref_object NMIP4Config *config   = nmtst_ip4_config_new(1);
+    gs_unref_object NMIP4Config *upstream = nmtst_ip4_config_new(2);
+    const NMPlatformIP4Address   address  = {
+        .address     = nmtst_inet4_from_string("10.42.0.1"),
+        .plen        = 24,
+        .addr_source = NM_IP_CONFIG_SOURCE_SHARED,
+    };
+    const in_addr_t expected_dns[] = {
+        nmtst_inet4_from_string("192.0.2.53"),
+        nmtst_inet4_from_string("198.51.100.53"),
+    };
+    ServerData    d;
+    const guint8 *opt;
+    gsize         len;
+
+    _server_data_init(&d, "10.42.0.1", 24);
+    nm_ip4_config_add_address(config, &address);
+
+    /* the router is announced, even without an upstream default route. */
+    {
+        gs_unref_bytes GBytes *options = NULL;
+
+        options = _nmtst_dhcp_server_options_build(d.server, config, NULL, FALSE);
+        opt     = _options_find(options, NM_DHCP_OPTION_DHCP4_ROUTER, &len);
+        g_assert(opt);
+        g_assert_cmpmem(opt, len, &address.address, sizeof(address.address));
+        g_assert(!_options_find(options, NM_DHCP_OPTION_DHCP4_DOMAIN_NAME_SERVER, &len));
+    }
+
+    /* upstream name servers are announced, except loopback addresses. */
+    nm_ip4_config_add_nameserver(upstream, nmtst_inet4_from_string("127.0.0.53"));
+    nm_ip4_config_add_nameserver(upstream, expected_dns[0]);
+    nm_ip4_config_add_nameserver(upstream, expected_dns[1]);
+    {
+        gs_unref_bytes GBytes *options = NULL;
+
+        options = _nmtst_dhcp_server_options_build(d.server, config, upstream, TRUE);
+        opt     = _options_find(options, NM_DHCP_OPTION_DHCP4_ROUTER, &len);
+        g_assert(opt);
+        g_assert_cmpmem(opt, len, &address.address, sizeof(address.address));
+        opt = _options_find(options, NM_DHCP_OPTION_DHCP4_DOMAIN_NAME_SERVER, &len);
+        g_assert(opt);
+        g_assert_cmpmem(opt, len, expected_dns, sizeof(expected_dns));
+        g_assert(_options_find(options, NM_DHCP_OPTION_DHCP4_VENDOR_SPECIFIC, &len));
+    }
+
+    _server_data_clear(&d);
+}
+
+/*****************************************************************************/
+
+static void
+test_address_pick(void)
+{
+    ServerData d;
+    gint32     now = nm_utils_get_monotonic_timestamp_sec();
+    in_addr_t  a1;
+    in_addr_t  a2;
+    guint32    n_range;
+    guint      n_bound;
+
+    _server_data_init(&d, "192.168.42.1", 24);
+
+    /* a free requested address is granted. */
+    a1 = _range_addr(&d, 7);
+    g_assert_cmpint(_nmtst_dhcp_server_address_pick(d.server, _CID("\001a"), a1, now), ==, a1);
+
+    /* the server address and addresses outside the range are not. */
+    a1 = _nmtst_dhcp_server_address_pick(d.server, _CID("\001a"), d.address, now);
+    g_assert(_in_range(&d, a1));
+    a2 = _nmtst_dhcp_server_address_pick(d.server,
+                                         _CID("\001a"),
+                                         nmtst_inet4_from_string("10.0.0.5"),
+                                         now);
+    g_assert(_in_range(&d, a2));
+
+    /* without a request, the pick only depends on the client-id. */
+    g_assert_cmpint(a1, ==, a2);
+    g_assert_cmpint(_nmtst_dhcp_server_address_pick(d.server, _CID("\001a"), 0, now), ==, a1);
+
+    /* an address in use is not picked again. */
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001a"), a1, now), ==, a1);
+    g_assert_cmpint(_nmtst_dhcp_server_address_pick(d.server, _CID("\001b"), a1, now), !=, a1);
+    g_assert_cmpint(_nmtst_dhcp_server_address_pick(d.server, _CID("\001a"), 0, now), !=, a1);
+
+    _server_data_clear(&d);
+
+    /* a small subnet runs out of addresses before the lease table is full. */
+    _server_data_init(&d, "192.168.43.1", 29);
+    n_range = d.range_last - d.range_first + 1;
+    g_assert_cmpint(n_range, <, NM_DHCP_SERVER_LEASE_MAX);
+
+    for (n_bound = 0;; n_bound++) {
+        char      cid[32];
+        gsize     cid_len;
+        in_addr_t a;
+
+        cid_len = strlen(nm_sprintf_buf(cid, "client-%u", n_bound));
+        a       = _nmtst_dhcp_server_address_pick(d.server, (guint8 *) cid, cid_len, 0, now);
+        if (!a)
+            break;
+        g_assert(_in_range(&d, a));
+        g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, (guint8 *) cid, cid_len, a, now), ==, a);
+    }
+    /* the range does not include the server address. */
+    g_assert_cmpint(n_bound, ==, n_range);
+
+    _server_data_clear(&d);
+}
+
+/*****************************************************************************/
+
+static void
+test_lease_table(void)
+{
+    ServerData d;
+    gint32     now = nm_utils_get_monotonic_timestamp_sec();
+    gint32     now2;
+    in_addr_t  a;
+    in_addr_t  b;
+    in_addr_t  x;
+    guint      i;
+
+    _server_data_init(&d, "192.168.42.1", 24);
+
+    /* DISCOVER is idempotent until the offer expires. */
+    a = _nmtst_dhcp_server_offer(d.server, _CID("\001a"), 0, now);
+    g_assert(_in_range(&d, a));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\001a"), 0, now + 1), ==, a);
+
+    /* REQUEST for another address than the lease is rejected. */
+    x = _range_addr_other(&d, a, 0, 0);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001a"), x, now), ==, 0);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001a"), a, now), ==, a);
+
+    /* An expired offer frees the address for other clients. */
+    b = _nmtst_dhcp_server_offer(d.server, _CID("\001b"), 0, now);
+    g_assert(_in_range(&d, b));
+    g_assert_cmpint(b, !=, a);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001c"), b, now), ==, 0);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server,
+                                            _CID("\001c"),
+                                            b,
+                                            now + NM_DHCP_SERVER_OFFER_TIME_SEC + 1),
+                    ==,
+                    b);
+
+    /* A client without lease gets a free requested address, for example
+     * after the lease file was lost. */
+    x = _range_addr_other(&d, a, b, 0);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001d"), x, now), ==, x);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001e"), a, now), ==, 0);
+
+    /* RELEASE must match the lease. */
+    g_assert(!_nmtst_dhcp_server_release(d.server, _CID("\001a"), x, now));
+    g_assert(!_nmtst_dhcp_server_release(d.server, _CID("\001x"), 0, now));
+    g_assert(_nmtst_dhcp_server_release(d.server, _CID("\001a"), a, now));
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001e"), a, now), ==, a);
+
+    /* A declined address stays blocked for a lease time. */
+    g_assert(_nmtst_dhcp_server_decline(d.server, x, now));
+    g_assert(!_nmtst_dhcp_server_decline(d.server, _range_addr_other(&d, a, b, x), now));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\001d"), x, now), !=, x);
+    now2 = now + NM_DHCP_SERVER_LEASE_TIME_SEC + 1;
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001f"), x, now2), ==, x);
+
+    _server_data_clear(&d);
+
+    /* The table holds NM_DHCP_SERVER_LEASE_MAX leases. */
+    _server_data_init(&d, "192.168.42.1", 24);
+    for (i = 0; i < NM_DHCP_SERVER_LEASE_MAX; i++) {
+        char  cid[32];
+        gsize cid_len;
+
+        cid_len = strlen(nm_sprintf_buf(cid, "client-%u", i));
+        a       = _nmtst_dhcp_server_offer(d.server, (guint8 *) cid, cid_len, 0, now);
+        g_assert(_in_range(&d, a));
+        g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, (guint8 *) cid, cid_len, a, now), ==, a);
+    }
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\001full"), 0, now), ==, 0);
+    g_assert(_nmtst_dhcp_server_release(d.server, _CID("client-7"), 0, now));
+    g_assert(_in_range(&d, _nmtst_dhcp_server_offer(d.server, _CID("\001full"), 0, now)));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\001full2"), 0, now), ==, 0);
+
+    /* expired leases are reclaimed lazily. */
+    a = _nmtst_dhcp_server_offer(d.server,
+                                 _CID("\001full2"),
+                                 0,
+                                 now + NM_DHCP_SERVER_LEASE_TIME_SEC + 1);
+    g_assert(_in_range(&d, a));
+
+    _server_data_clear(&d);
+}
+
+/*****************************************************************************/
+
+static void
+test_persist_load(void)
+{
+    gs_free_error GError *        error    = NULL;
+    nm_auto_free_gstring GString *str      = g_string_new(NULL);
+    ServerData                    d;
+    gint32                        now      = nm_utils_get_monotonic_timestamp_sec();
+    gint64                        now_real = time(NULL);
+    char                          addr_buf[INET_ADDRSTRLEN];
+
+#define _append_line(expiry, idx, cid)                                             \
+    g_string_append_printf(str,                                                    \
+                           "%" G_GINT64_FORMAT " %s %s\n",                         \
+                           (gint64) (expiry),                                      \
+                           _nm_utils_inet4_ntop(_range_addr(&d, (idx)), addr_buf), \
+                           (cid))
+
+    _server_data_init(&d, "192.168.42.1", 24);
+
+    _append_line(now_real + 600, 1, "0102aabb");
+    /* expired */
+    _append_line(now_real - 1, 2, "02");
+    /* broken lines */
+    g_string_append(str, "\n");
+    g_string_append(str, "foo\n");
+    g_string_append_printf(str, "%" G_GINT64_FORMAT " not-an-address 03\n", now_real + 600);
+    _append_line(now_real + 600, 3, "zz");
+    _append_line(now_real + 600, 4, "0");
+    g_string_append_printf(str, "%" G_GINT64_FORMAT " 10.0.0.5 04\n", now_real + 600);
+    /* duplicate client-id and duplicate address */
+    _append_line(now_real + 600, 5, "0102aabb");
+    _append_line(now_real + 600, 1, "05");
+    /* the lifetime is capped to the lease time */
+    _append_line(now_real + 10 * NM_DHCP_SERVER_LEASE_TIME_SEC, 6, "06");
+    /* no trailing newline */
+    g_string_append_printf(str,
+                           "%" G_GINT64_FORMAT " %s 07",
+                           now_real + 600,
+                           _nm_utils_inet4_ntop(_range_addr(&d, 7), addr_buf));
+
+    nmtst_assert_success(
+        nm_utils_file_set_contents(d.lease_file, str->str, str->len, 0600, NULL, &error),
+        error);
+
+    _nmtst_dhcp_server_persist_load(d.server);
+
+    /* restored leases are found by client-id. */
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\001\002\252\273"), 0, now),
+                    ==,
+                    _range_addr(&d, 1));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\007"), 0, now),
+                    ==,
+                    _range_addr(&d, 7));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\006"), 0, now),
+                    ==,
+                    _range_addr(&d, 6));
+
+    /* skipped lines leave the address free. */
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\011"), _range_addr(&d, 2), now),
+                    ==,
+                    _range_addr(&d, 2));
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\012"), _range_addr(&d, 5), now),
+                    ==,
+                    _range_addr(&d, 5));
+    g_assert_cmpint(_nmtst_dhcp_server_offer(d.server, _CID("\005"), _range_addr(&d, 1), now),
+                    !=,
+                    _range_addr(&d, 1));
+
+    /* the capped lease expires after a lease time. */
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server,
+                                            _CID("\013"),
+                                            _range_addr(&d, 6),
+                                            now + NM_DHCP_SERVER_LEASE_TIME_SEC + 1),
+                    ==,
+                    _range_addr(&d, 6));
+
+    _server_data_clear(&d);
+
+    /* a missing file is fine. */
+    _server_data_init(&d, "192.168.42.1", 24);
+    _nmtst_dhcp_server_persist_load(d.server);
+    g_assert(_in_range(&d, _nmtst_dhcp_server_offer(d.server, _CID("\001a"), 0, now)));
+    _server_data_clear(&d);
+}
+
+static void
+test_persist_roundtrip(void)
+{
+    ServerData    d;
+    NMDhcpServer *server2;
+    gint32        now = nm_utils_get_monotonic_timestamp_sec();
+    in_addr_t     a;
+    in_addr_t     b;
+    in_addr_t     c;
+
+    _server_data_init(&d, "192.168.42.1", 24);
+
+    a = _nmtst_dhcp_server_offer(d.server, _CID("\001a"), 0, now);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001a"), a, now), ==, a);
+    b = _nmtst_dhcp_server_offer(d.server, _CID("\001b"), 0, now);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, _CID("\001b"), b, now), ==, b);
+    /* only offered, not persisted. */
+    c = _nmtst_dhcp_server_offer(d.server, _CID("\001c"), 0, now);
+    g_assert(_in_range(&d, c));
+    _nmtst_dhcp_server_persist_flush(d.server);
+
+    server2 = _nmtst_dhcp_server_new(d.lease_file, d.address, 24);
+    _nmtst_dhcp_server_persist_load(server2);
+    g_assert_cmpint(_nmtst_dhcp_server_offer(server2, _CID("\001a"), 0, now), ==, a);
+    g_assert_cmpint(_nmtst_dhcp_server_offer(server2, _CID("\001b"), 0, now), ==, b);
+    g_assert_cmpint(_nmtst_dhcp_server_bind(server2, _CID("\001x"), c, now), ==, c);
+    nm_dhcp_server_free(server2);
+
+    /* a renumbered subnet drops the old leases. */
+    server2 = _nmtst_dhcp_server_new(d.lease_file, nmtst_inet4_from_string("10.42.0.1"), 24);
+    _nmtst_dhcp_server_persist_load(server2);
+    g_assert_cmpint(_nmtst_dhcp_server_offer(server2, _CID("\001a"), 0, now), !=, a);
+    nm_dhcp_server_free(server2);
+
+    _server_data_clear(&d);
+}
+
+/*****************************************************************************/
+
+static void
+test_lease_table_throughput(void)
+{
+    ServerData d;
+    gint32     now = nm_utils_get_monotonic_timestamp_sec();
+    gint64     start_nsec;
+    gint64     duration_nsec;
+    guint      n_rounds;
+    guint      i, j;
+
+    if (nmtst_test_quick()) {
+        g_print("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n",
+                g_get_prgname() ?: "test-dhcp-server");
+        g_test_skip("Skip long running test");
+        return;
+    }
+
+    _server_data_init(&d, "192.168.42.1", 24);
+
+    /* Fill the table, then cycle each client through DISCOVER, REQUEST and
+     * RELEASE. This is the work the server does per request, without the
+     * socket I/O. */
+    n_rounds   = 20000;
+    start_nsec = nm_utils_get_monotonic_timestamp_nsec();
+    for (i = 0; i < n_rounds; i++) {
+        for (j = 0; j < NM_DHCP_SERVER_LEASE_MAX; j++) {
+            guint8    cid[5] = {1, j, j >> 8, 0x42, 0x42};
+            in_addr_t a;
+
+            a = _nmtst_dhcp_server_offer(d.server, cid, sizeof(cid), 0, now);
+            g_assert(a);
+            g_assert_cmpint(_nmtst_dhcp_server_bind(d.server, cid, sizeof(cid), a, now), ==, a);
+        }
+        for (j = 0; j < NM_DHCP_SERVER_LEASE_MAX; j++) {
+            guint8 cid[5] = {1, j, j >> 8, 0x42, 0x42};
+
+            g_assert(_nmtst_dhcp_server_release(d.server, cid, sizeof(cid), 0, now));
+        }
+    }
+    duration_nsec = nm_utils_get_monotonic_timestamp_nsec() - start_nsec;
+
+    g_print("%u leases in %" G_GINT64_FORMAT " msec (%" G_GINT64_FORMAT " leases/sec)\n",
+            n_rounds * NM_DHCP_SERVER_LEASE_MAX,
+            duration_nsec / NM_UTILS_NSEC_PER_MSEC,
+            (gint64) n_rounds * NM_DHCP_SERVER_LEASE_MAX * NM_UTILS_NSEC_PER_SEC
+                / MAX(duration_nsec, 1));
+
+    _server_data_clear(&d);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    nmtst_init_assert_logging(&argc, &argv, "WARN", "DEFAULT");
+
+    g_test_add_func("/dhcp-server/encode-domain", test_encode_domain);
+    g_test_add_func("/dhcp-server/options", test_options);
+    g_test_add_func("/dhcp-server/address-pick", test_address_pick);
+    g_test_add_func("/dhcp-server/lease-table", test_lease_table);
+    g_test_add_func("/dhcp-server/persist-load", test_persist_load);
+    g_test_add_func("/dhcp-server/persist-roundtrip", test_persist_roundtrip);
+    g_test_add_func("/dhcp-server/lease-table-throughput", test_lease_table_throughput);
+
+    return g_test_run();
+}
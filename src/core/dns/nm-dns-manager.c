@@ -68,6 +68,16 @@ typedef struct {
     NMTernary   has_trust_ad;
 } NMResolvConfData;
 
+typedef struct {
+    /* NMDnsConfigIPData that use this domain, and how often. */
+    GHashTable *contributors;
+
+    /* The lowest priority of all contributors. */
+    int priority;
+
+    char domain[];
+} DomainTrack;
+
 /*****************************************************************************/
 
 enum {
@@ -87,6 +97,9 @@ typedef struct {
     CList     ip_config_lst_head;
     GVariant *config_variant;
 
+    GHashTable *domain_track;
+    GHashTable *domain_track_affected;
+
     NMDnsConfigIPData *best_ip_config_4;
     NMDnsConfigIPData *best_ip_config_6;
 
@@ -165,6 +178,8 @@ NM_DEFINE_SINGLETON_GETTER(NMDnsManager, nm_dns_manager_get, NM_TYPE_DNS_MANAGER
 static void
 _ip_config_dns_priority_changed(gpointer config, GParamSpec *pspec, NMDnsConfigIPData *ip_data);
 
+static void _domain_track_unregister(NMDnsManager *self, NMDnsConfigIPData *ip_data);
+
 /*****************************************************************************/
 
 static gboolean
@@ -290,8 +305,11 @@ _dns_config_ip_data_free(NMDnsConfigIPData *ip_data)
     c_list_unlink_stale(&ip_data->data_lst);
     c_list_unlink_stale(&ip_data->ip_config_lst);
 
+    _domain_track_unregister(ip_data->data->self, ip_data);
+
     g_free(ip_data->domains.search);
     g_strfreev(ip_data->domains.reverse);
+    g_strfreev(ip_data->track.candidates);
 
     g_signal_handlers_disconnect_by_func(ip_data->ip_config,
                                          _ip_config_dns_priority_changed,
@@ -1330,16 +1348,150 @@ get_ip_rdns_domains(NMIPConfig *ip_config)
     return _nm_utils_strv_cleanup(strv, FALSE, FALSE, TRUE);
 }
 
+/* The domain tracking decides which configuration gets which search and
+ * routing domain. A domain is kept by the configurations with the lowest
+ * (best) priority for it, and dropped for a configuration if a parent
+ * domain (or the wildcard "") has a negative priority that is lower than
+ * the configuration's own.
+ *
+ * The result only depends on the lowest priority of each domain, so we
+ * keep that table across updates. When a configuration changes, only its
+ * contribution is removed and re-added, and only configurations that use
+ * a domain whose lowest priority changed (or a sub-domain of it) are
+ * re-evaluated. */
+
+static void
+_domain_track_mark_affected(NMDnsManager *self, const char *domain)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+
+    g_hash_table_add(priv->domain_track_affected, g_strdup(domain));
+}
+
+static void
+_domain_track_add(NMDnsManager *self, const char *domain, NMDnsConfigIPData *ip_data)
+{
+    NMDnsManagerPrivate *priv     = NM_DNS_MANAGER_GET_PRIVATE(self);
+    int                  priority = ip_data->track.priority;
+    DomainTrack *        track;
+    gpointer             count;
+
+    track = g_hash_table_lookup(priv->domain_track, domain);
+    if (!track) {
+        gsize l = strlen(domain) + 1;
+
+        track               = g_malloc(G_STRUCT_OFFSET(DomainTrack, domain) + l);
+        track->contributors = g_hash_table_new(nm_direct_hash, NULL);
+        track->priority     = priority;
+        memcpy(track->domain, domain, l);
+        g_hash_table_insert(priv->domain_track, track->domain, track);
+        _domain_track_mark_affected(self, domain);
+    } else if (priority < track->priority) {
+        track->priority = priority;
+        _domain_track_mark_affected(self, domain);
+    }
+
+    count = g_hash_table_lookup(track->contributors, ip_data);
+    g_hash_table_insert(track->contributors,
+                        ip_data,
+                        GUINT_TO_POINTER(GPOINTER_TO_UINT(count) + 1));
+}
+
+static void
+_domain_track_remove(NMDnsManager *self, const char *domain, NMDnsConfigIPData *ip_data)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    DomainTrack *        track;
+    guint                count;
+    GHashTableIter       iter;
+    gpointer             ptr;
+    int                  priority;
+
+    track = g_hash_table_lookup(priv->domain_track, domain);
+    nm_assert(track);
+
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(track->contributors, ip_data));
+    nm_assert(count > 0);
+
+    if (count > 1) {
+        g_hash_table_insert(track->contributors, ip_data, GUINT_TO_POINTER(count - 1));
+        return;
+    }
+
+    g_hash_table_remove(track->contributors, ip_data);
+
+    if (g_hash_table_size(track->contributors) == 0) {
+        _domain_track_mark_affected(self, domain);
+        g_hash_table_remove(priv->domain_track, domain);
+        return;
+    }
+
+    if (ip_data->track.priority > track->priority)
+        return;
+
+    priority = G_MAXINT;
+    g_hash_table_iter_init(&iter, track->contributors);
+    while (g_hash_table_iter_next(&iter, &ptr, NULL))
+        priority = NM_MIN(priority, ((NMDnsConfigIPData *) ptr)->track.priority);
+
+    if (priority != track->priority) {
+        track->priority = priority;
+        _domain_track_mark_affected(self, domain);
+    }
+}
+
+static void
+_domain_track_free(DomainTrack *track)
+{
+    g_hash_table_unref(track->contributors);
+    g_free(track);
+}
+
+static void
+_domain_track_register(NMDnsManager *self, NMDnsConfigIPData *ip_data, gboolean add)
+{
+    guint i;
+
+    if (!ip_data->track.has_nameservers)
+        return;
+
+    for (i = 0; ip_data->track.candidates[i]; i++) {
+        const char *domain = nm_utils_parse_dns_domain(ip_data->track.candidates[i], NULL);
+
+        if (add)
+            _domain_track_add(self, domain, ip_data);
+        else
+            _domain_track_remove(self, domain, ip_data);
+    }
+
+    if (ip_data->track.has_default_route_maybe) {
+        if (add)
+            _domain_track_add(self, "", ip_data);
+        else
+            _domain_track_remove(self, "", ip_data);
+    }
+}
+
+static void
+_domain_track_unregister(NMDnsManager *self, NMDnsConfigIPData *ip_data)
+{
+    if (ip_data->track.registered) {
+        ip_data->track.registered = FALSE;
+        _domain_track_register(self, ip_data, FALSE);
+    }
+}
+
 static gboolean
 _domain_track_get_priority(GHashTable *ht, const char *domain, int *out_priority)
 {
-    gpointer ptr;
+    DomainTrack *track;
 
-    if (!ht || !g_hash_table_lookup_extended(ht, domain, NULL, &ptr)) {
+    track = g_hash_table_lookup(ht, domain);
+    if (!track) {
         *out_priority = 0;
         return FALSE;
     }
-    *out_priority = GPOINTER_TO_INT(ptr);
+    *out_priority = track->priority;
     return TRUE;
 }
 
@@ -1354,13 +1506,7 @@ _domain_track_is_shadowed(GHashTable * ht,
     char *parent;
     int   parent_priority;
 
-    if (!ht)
-        return FALSE;
-
-    nm_assert(!g_hash_table_contains(ht, domain));
-
     if (_domain_track_get_priority(ht, "", &parent_priority)) {
-        nm_assert(parent_priority <= priority);
         if (parent_priority < 0 && parent_priority < priority) {
             *out_parent          = "";
             *out_parent_priority = parent_priority;
@@ -1372,7 +1518,6 @@ _domain_track_is_shadowed(GHashTable * ht,
     while (parent && parent[1]) {
         parent++;
         if (_domain_track_get_priority(ht, parent, &parent_priority)) {
-            nm_assert(parent_priority <= priority);
             if (parent_priority < 0 && parent_priority < priority) {
                 *out_parent          = parent;
                 *out_parent_priority = parent_priority;
@@ -1385,37 +1530,113 @@ _domain_track_is_shadowed(GHashTable * ht,
     return FALSE;
 }
 
+/* Whether the domain, or one of its parent domains, is in @affected. */
+static gboolean
+_domain_track_is_affected(GHashTable *affected, const char *domain)
+{
+    const char *parent;
+
+    if (g_hash_table_contains(affected, "") || g_hash_table_contains(affected, domain))
+        return TRUE;
+
+    parent = strchr(domain, '.');
+    while (parent && parent[1]) {
+        parent++;
+        if (g_hash_table_contains(affected, parent))
+            return TRUE;
+        parent = strchr(parent, '.');
+    }
+
+    return FALSE;
+}
+
 static void
-_mgr_configs_data_construct(NMDnsManager *self)
+_dns_config_ip_data_get_fingerprint(const NMDnsConfigIPData *ip_data,
+                                    const char *const *      candidates,
+                                    guint8                   buffer[static HASH_LEN])
 {
-    NMDnsConfigIPData *ip_data;
-    gs_unref_hashtable GHashTable *ht               = NULL;
-    gs_unref_hashtable GHashTable *wildcard_entries = NULL;
-    CList *                        head;
-    int                            prev_priority = G_MININT;
+    nm_auto_free_checksum GChecksum *sum       = NULL;
+    NMIPConfig *                     ip_config = ip_data->ip_config;
+    gsize                            i;
+    int                              val;
 
-    head = _mgr_get_ip_config_lst_head(self);
+    sum = g_checksum_new(G_CHECKSUM_SHA1);
 
-#if NM_MORE_ASSERTS
-    /* we call _mgr_configs_data_clear() at the end of update. We
-     * don't expect any domain settings here. */
-    c_list_for_each_entry (ip_data, head, ip_config_lst) {
-        nm_assert(!ip_data->domains.search);
-        nm_assert(!ip_data->domains.reverse);
-        nm_assert(!ip_data->domains.has_default_route_explicit);
-        nm_assert(!ip_data->domains.has_default_route_exclusive);
-        nm_assert(!ip_data->domains.has_default_route);
+    /* also covers addresses and routes, which the reverse domains are
+     * generated from. */
+    nm_ip_config_hash(ip_config, sum, FALSE);
+
+    /* hash the candidate domains including their terminating NUL, so that
+     * different splits of the same characters don't collide. */
+    for (i = 0; candidates[i]; i++)
+        g_checksum_update(sum, (const guint8 *) candidates[i], strlen(candidates[i]) + 1);
+
+    val = nm_ip_config_get_dns_priority(ip_config);
+    g_checksum_update(sum, (const guint8 *) &val, sizeof(val));
+    val = ip_data->ip_config_type;
+    g_checksum_update(sum, (const guint8 *) &val, sizeof(val));
+    val = nm_ip_config_get_never_default(ip_config);
+    g_checksum_update(sum, (const guint8 *) &val, sizeof(val));
+    val = !!nm_ip_config_best_default_route_get(ip_config);
+    g_checksum_update(sum, (const guint8 *) &val, sizeof(val));
+
+    nm_utils_checksum_get_digest_len(sum, buffer, HASH_LEN);
+}
+
+static const char **
+_dns_config_ip_data_get_candidates(NMIPConfig *ip_config)
+{
+    const char **candidates;
+    guint        n_searches;
+    guint        n_domains;
+    guint        i;
+
+    n_searches = nm_ip_config_get_num_searches(ip_config);
+    n_domains  = nm_ip_config_get_num_domains(ip_config);
+
+    /* searches are preferred over domains */
+    if (n_searches > 0) {
+        candidates = g_new(const char *, n_searches + 1u);
+        for (i = 0; i < n_searches; i++)
+            candidates[i] = nm_ip_config_get_search(ip_config, i);
+    } else {
+        candidates = g_new(const char *, n_domains + 1u);
+        for (i = 0; i < n_domains; i++)
+            candidates[i] = nm_ip_config_get_domain(ip_config, i);
     }
-#endif
+    candidates[i] = NULL;
+    return candidates;
+}
 
-    c_list_for_each_entry (ip_data, head, ip_config_lst) {
-        NMIPConfig *ip_config    = ip_data->ip_config;
-        gboolean    add_wildcard = FALSE;
+/* Refresh the cached contribution of @ip_data, if the configuration changed
+ * since it was last built. Returns whether it changed. */
+static gboolean
+_dns_config_ip_data_refresh(NMDnsManager *self, NMDnsConfigIPData *ip_data)
+{
+    gs_free const char **candidates = NULL;
+    NMIPConfig *         ip_config  = ip_data->ip_config;
+    guint8               fingerprint[HASH_LEN];
 
-        if (!nm_ip_config_get_num_nameservers(ip_config))
-            continue;
+    candidates = _dns_config_ip_data_get_candidates(ip_config);
+    _dns_config_ip_data_get_fingerprint(ip_data, candidates, fingerprint);
+
+    if (ip_data->track.valid && memcmp(fingerprint, ip_data->track.fingerprint, HASH_LEN) == 0)
+        return FALSE;
+
+    _domain_track_unregister(self, ip_data);
+
+    /* "domains.search" points into the old candidates. */
+    nm_clear_g_free(&ip_data->domains.search);
+    nm_clear_pointer(&ip_data->domains.reverse, g_strfreev);
+    g_strfreev(ip_data->track.candidates);
+
+    ip_data->track.candidates      = nm_utils_strv_dup(candidates, -1, TRUE);
+    ip_data->track.priority        = nm_ip_config_get_dns_priority(ip_config);
+    ip_data->track.has_nameservers = (nm_ip_config_get_num_nameservers(ip_config) > 0);
+    ip_data->track.add_wildcard    = FALSE;
+    if (ip_data->track.has_nameservers) {
         if (nm_ip_config_best_default_route_get(ip_config))
-            add_wildcard = TRUE;
+            ip_data->track.add_wildcard = TRUE;
         else {
             /* If a VPN has never-default=no but doesn't get a default
              * route (this can happen for example when the server
@@ -1424,201 +1645,221 @@ _mgr_configs_data_construct(NMDnsManager *self)
              * by the server would be unused. It is preferable in this
              * case to use the VPN DNS server for all queries. */
             if (ip_data->ip_config_type == NM_DNS_IP_CONFIG_TYPE_VPN
-                && !nm_ip_config_get_never_default(ip_data->ip_config)
-                && nm_ip_config_get_num_searches(ip_data->ip_config) == 0
-                && nm_ip_config_get_num_domains(ip_data->ip_config) == 0)
-                add_wildcard = TRUE;
+                && !nm_ip_config_get_never_default(ip_config)
+                && nm_ip_config_get_num_searches(ip_config) == 0
+                && nm_ip_config_get_num_domains(ip_config) == 0)
+                ip_data->track.add_wildcard = TRUE;
+        }
+        ip_data->domains.reverse = get_ip_rdns_domains(ip_config);
+    }
+    memcpy(ip_data->track.fingerprint, fingerprint, HASH_LEN);
+    ip_data->track.valid = TRUE;
+    ip_data->track.dirty = TRUE;
+    return TRUE;
+}
+
+static void
+_dns_config_ip_data_evaluate(NMDnsManager *self, NMDnsConfigIPData *ip_data)
+{
+    NMDnsManagerPrivate *priv                       = NM_DNS_MANAGER_GET_PRIVATE(self);
+    GHashTable *         ht                         = priv->domain_track;
+    int                  priority                   = ip_data->track.priority;
+    gboolean             has_default_route_explicit = FALSE;
+    gboolean             has_default_route_auto     = FALSE;
+    const char **        domains;
+    guint                num_dom1;
+    guint                num_dom2;
+    guint                i;
+
+    nm_clear_g_free(&ip_data->domains.search);
+    ip_data->domains.has_default_route_explicit  = FALSE;
+    ip_data->domains.has_default_route_exclusive = FALSE;
+    ip_data->domains.has_default_route           = FALSE;
+
+    if (!ip_data->track.has_nameservers)
+        return;
+
+    nm_assert(priority != 0);
+
+    num_dom1 = NM_PTRARRAY_LEN(ip_data->track.candidates);
+    domains  = g_new(const char *, num_dom1 + 1u);
+
+    num_dom2 = 0;
+    for (i = 0; TRUE; i++) {
+        const char *domain_full;
+        const char *domain_clean;
+        const char *parent;
+        int         old_priority;
+        int         parent_priority;
+        gboolean    check_default_route;
+
+        if (i < num_dom1) {
+            check_default_route = FALSE;
+            domain_full         = ip_data->track.candidates[i];
+            domain_clean        = nm_utils_parse_dns_domain(domain_full, NULL);
+        } else if (i == num_dom1) {
+            if (!ip_data->track.has_default_route_maybe)
+                continue;
+            if (has_default_route_explicit)
+                continue;
+            check_default_route = TRUE;
+            domain_full         = "~";
+            domain_clean        = "";
+        } else
+            break;
+
+        /* Remove domains with lower priority */
+        if (!_domain_track_get_priority(ht, domain_clean, &old_priority))
+            nm_assert_not_reached();
+        nm_assert(old_priority <= priority);
+        if (old_priority < priority) {
+            _LOGT("plugin: drop domain %s%s%s (i=%d, p=%d) because it already exists "
+                  "with p=%d",
+                  NM_PRINT_FMT_QUOTED(!check_default_route,
+                                      "'",
+                                      domain_full,
+                                      "'",
+                                      "<auto-default>"),
+                  ip_data->data->ifindex,
+                  priority,
+                  old_priority);
+            continue;
+        }
+        if (_domain_track_is_shadowed(ht, domain_clean, priority, &parent, &parent_priority)) {
+            _LOGT("plugin: drop domain %s%s%s (i=%d, p=%d) shadowed by '%s' (p=%d)",
+                  NM_PRINT_FMT_QUOTED(!check_default_route,
+                                      "'",
+                                      domain_full,
+                                      "'",
+                                      "<auto-default>"),
+                  ip_data->data->ifindex,
+                  priority,
+                  parent,
+                  parent_priority);
+            continue;
         }
 
-        if (add_wildcard) {
-            if (!wildcard_entries)
-                wildcard_entries = g_hash_table_new(nm_direct_hash, NULL);
-            g_hash_table_add(wildcard_entries, ip_data);
+        _LOGT("plugin: add domain %s%s%s (i=%d, p=%d)",
+              NM_PRINT_FMT_QUOTED(!check_default_route, "'", domain_full, "'", "<auto-default>"),
+              ip_data->data->ifindex,
+              priority);
+
+        if (check_default_route)
+            has_default_route_auto = TRUE;
+        else {
+            nm_assert(num_dom2 <= num_dom1);
+            domains[num_dom2++] = domain_full;
+            if (domain_clean[0] == '\0')
+                has_default_route_explicit = TRUE;
         }
     }
+    nm_assert(num_dom2 <= num_dom1);
+    domains[num_dom2] = NULL;
 
-    c_list_for_each_entry (ip_data, head, ip_config_lst) {
-        NMIPConfig * ip_config = ip_data->ip_config;
-        int          priority;
-        const char **domains;
-        guint        n_searches;
-        guint        n_domains;
-        guint        num_dom1;
-        guint        num_dom2;
-        guint        n_domains_allocated;
-        guint        i;
-        gboolean     has_default_route_maybe    = FALSE;
-        gboolean     has_default_route_explicit = FALSE;
-        gboolean     has_default_route_auto     = FALSE;
-
-        if (!nm_ip_config_get_num_nameservers(ip_config))
-            continue;
+    ip_data->domains.search                     = domains;
+    ip_data->domains.has_default_route_explicit = has_default_route_explicit;
+    ip_data->domains.has_default_route_exclusive =
+        has_default_route_explicit || (priority < 0 && has_default_route_auto);
+    ip_data->domains.has_default_route =
+        ip_data->domains.has_default_route_exclusive || has_default_route_auto;
 
-        n_searches = nm_ip_config_get_num_searches(ip_config);
-        n_domains  = nm_ip_config_get_num_domains(ip_config);
+    {
+        gs_free char *str1 = NULL;
+        gs_free char *str2 = NULL;
+
+        _LOGT("plugin: settings: ifindex=%d, priority=%d, default-route=%d%s, search=%s, "
+              "reverse=%s",
+              ip_data->data->ifindex,
+              priority,
+              ip_data->domains.has_default_route,
+              ip_data->domains.has_default_route_explicit
+                  ? " (explicit)"
+                  : (ip_data->domains.has_default_route_exclusive ? " (exclusive)" : ""),
+              (str1 = g_strjoinv(",", (char **) ip_data->domains.search)),
+              (ip_data->domains.reverse ? (str2 = g_strjoinv(",", ip_data->domains.reverse))
+                                        : ""));
+    }
+}
 
-        priority = nm_ip_config_get_dns_priority(ip_config);
+static void
+_mgr_configs_data_construct(NMDnsManager *self)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    NMDnsConfigIPData *  ip_data;
+    CList *              head;
+    gboolean             has_wildcard = FALSE;
+    guint                n_changed    = 0;
+    guint                n_evaluated  = 0;
+    guint                n_total      = 0;
 
-        nm_assert(priority != 0);
-        nm_assert(prev_priority <= priority);
-        prev_priority = priority;
+    head = _mgr_get_ip_config_lst_head(self);
+
+    c_list_for_each_entry (ip_data, head, ip_config_lst) {
+        n_total++;
+        if (_dns_config_ip_data_refresh(self, ip_data))
+            n_changed++;
+        if (ip_data->track.add_wildcard)
+            has_wildcard = TRUE;
+    }
+
+    c_list_for_each_entry (ip_data, head, ip_config_lst) {
+        gboolean has_default_route_maybe;
 
         /* Add wildcard lookup domain to connections with the default route.
          * If there is no default route, add the wildcard domain to all non-VPN
          * connections */
-        if (wildcard_entries) {
+        if (has_wildcard) {
             /* FIXME: this heuristic of which device has a default route does
              * not work with policy routing (as used by default with WireGuard).
              * We should have a more stable mechanism where an NMIPConfig indicates
              * whether it is suitable for certain operations (like having an automatically
              * added "~" domain). */
-            if (g_hash_table_contains(wildcard_entries, ip_data))
-                has_default_route_maybe = TRUE;
-        } else {
-            if (ip_data->ip_config_type != NM_DNS_IP_CONFIG_TYPE_VPN)
-                has_default_route_maybe = TRUE;
-        }
+            has_default_route_maybe = ip_data->track.add_wildcard;
+        } else
+            has_default_route_maybe = (ip_data->ip_config_type != NM_DNS_IP_CONFIG_TYPE_VPN);
 
-        n_domains_allocated = (n_searches > 0 ? n_searches : n_domains) + 1u;
-        domains             = g_new(const char *, n_domains_allocated);
+        if (ip_data->track.registered
+            && ip_data->track.has_default_route_maybe == has_default_route_maybe)
+            continue;
 
-        num_dom1 = 0;
+        _domain_track_unregister(self, ip_data);
+        ip_data->track.has_default_route_maybe = has_default_route_maybe;
+        ip_data->track.registered              = TRUE;
+        ip_data->track.dirty                   = TRUE;
+        _domain_track_register(self, ip_data, TRUE);
+    }
 
-        /* searches are preferred over domains */
-        if (n_searches > 0) {
-            for (i = 0; i < n_searches; i++)
-                domains[num_dom1++] = nm_ip_config_get_search(ip_config, i);
-        } else {
-            for (i = 0; i < n_domains; i++)
-                domains[num_dom1++] = nm_ip_config_get_domain(ip_config, i);
-        }
+    if (g_hash_table_size(priv->domain_track_affected) > 0) {
+        GHashTableIter iter;
+        DomainTrack *  track;
 
-        nm_assert(num_dom1 < n_domains_allocated);
-
-        num_dom2 = 0;
-        for (i = 0; TRUE; i++) {
-            const char *domain_full;
-            const char *domain_clean;
-            const char *parent;
-            int         old_priority;
-            int         parent_priority;
-            gboolean    check_default_route;
-
-            if (i < num_dom1) {
-                check_default_route = FALSE;
-                domain_full         = domains[i];
-                domain_clean        = nm_utils_parse_dns_domain(domains[i], NULL);
-            } else if (i == num_dom1) {
-                if (!has_default_route_maybe)
-                    continue;
-                if (has_default_route_explicit)
-                    continue;
-                check_default_route = TRUE;
-                domain_full         = "~";
-                domain_clean        = "";
-            } else
-                break;
+        g_hash_table_iter_init(&iter, priv->domain_track);
+        while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &track)) {
+            GHashTableIter iter2;
+            gpointer       ptr;
 
-            /* Remove domains with lower priority */
-            if (_domain_track_get_priority(ht, domain_clean, &old_priority)) {
-                nm_assert(old_priority <= priority);
-                if (old_priority < priority) {
-                    _LOGT("plugin: drop domain %s%s%s (i=%d, p=%d) because it already exists "
-                          "with p=%d",
-                          NM_PRINT_FMT_QUOTED(!check_default_route,
-                                              "'",
-                                              domain_full,
-                                              "'",
-                                              "<auto-default>"),
-                          ip_data->data->ifindex,
-                          priority,
-                          old_priority);
-                    continue;
-                }
-            } else if (_domain_track_is_shadowed(ht,
-                                                 domain_clean,
-                                                 priority,
-                                                 &parent,
-                                                 &parent_priority)) {
-                _LOGT("plugin: drop domain %s%s%s (i=%d, p=%d) shadowed by '%s' (p=%d)",
-                      NM_PRINT_FMT_QUOTED(!check_default_route,
-                                          "'",
-                                          domain_full,
-                                          "'",
-                                          "<auto-default>"),
-                      ip_data->data->ifindex,
-                      priority,
-                      parent,
-                      parent_priority);
+            if (!_domain_track_is_affected(priv->domain_track_affected, track->domain))
                 continue;
-            }
 
-            _LOGT(
-                "plugin: add domain %s%s%s (i=%d, p=%d)",
-                NM_PRINT_FMT_QUOTED(!check_default_route, "'", domain_full, "'", "<auto-default>"),
-                ip_data->data->ifindex,
-                priority);
-
-            if (!ht)
-                ht = g_hash_table_new(nm_str_hash, g_str_equal);
-            g_hash_table_insert(ht, (gpointer) domain_clean, GINT_TO_POINTER(priority));
-
-            if (check_default_route)
-                has_default_route_auto = TRUE;
-            else {
-                nm_assert(num_dom2 <= num_dom1);
-                nm_assert(num_dom2 < n_domains_allocated);
-                domains[num_dom2++] = domain_full;
-                if (domain_clean[0] == '\0')
-                    has_default_route_explicit = TRUE;
-            }
-        }
-        nm_assert(num_dom2 < n_domains_allocated);
-        domains[num_dom2] = NULL;
-
-        nm_assert(!ip_data->domains.search);
-        nm_assert(!ip_data->domains.reverse);
-        ip_data->domains.search                     = domains;
-        ip_data->domains.reverse                    = get_ip_rdns_domains(ip_config);
-        ip_data->domains.has_default_route_explicit = has_default_route_explicit;
-        ip_data->domains.has_default_route_exclusive =
-            has_default_route_explicit || (priority < 0 && has_default_route_auto);
-        ip_data->domains.has_default_route =
-            ip_data->domains.has_default_route_exclusive || has_default_route_auto;
-
-        {
-            gs_free char *str1 = NULL;
-            gs_free char *str2 = NULL;
-
-            _LOGT("plugin: settings: ifindex=%d, priority=%d, default-route=%d%s, search=%s, "
-                  "reverse=%s",
-                  ip_data->data->ifindex,
-                  priority,
-                  ip_data->domains.has_default_route,
-                  ip_data->domains.has_default_route_explicit
-                      ? " (explicit)"
-                      : (ip_data->domains.has_default_route_exclusive ? " (exclusive)" : ""),
-                  (str1 = g_strjoinv(",", (char **) ip_data->domains.search)),
-                  (ip_data->domains.reverse ? (str2 = g_strjoinv(",", ip_data->domains.reverse))
-                                            : ""));
+            g_hash_table_iter_init(&iter2, track->contributors);
+            while (g_hash_table_iter_next(&iter2, &ptr, NULL))
+                ((NMDnsConfigIPData *) ptr)->track.dirty = TRUE;
         }
+        g_hash_table_remove_all(priv->domain_track_affected);
     }
-}
 
-static void
-_mgr_configs_data_clear(NMDnsManager *self)
-{
-    NMDnsConfigIPData *ip_data;
-    CList *            head;
-
-    head = _mgr_get_ip_config_lst_head(self);
     c_list_for_each_entry (ip_data, head, ip_config_lst) {
-        nm_clear_g_free(&ip_data->domains.search);
-        nm_clear_pointer(&ip_data->domains.reverse, g_strfreev);
-        ip_data->domains.has_default_route_explicit  = FALSE;
-        ip_data->domains.has_default_route_exclusive = FALSE;
-        ip_data->domains.has_default_route           = FALSE;
+        if (!ip_data->track.dirty)
+            continue;
+        ip_data->track.dirty = FALSE;
+        n_evaluated++;
+        _dns_config_ip_data_evaluate(self, ip_data);
     }
+
+    _LOGT("plugin: %u of %u configurations changed, re-evaluated domains of %u",
+          n_changed,
+          n_total,
+          n_evaluated);
 }
 
 /*****************************************************************************/
@@ -1716,11 +1957,6 @@ update_dns(NMDnsManager *self, gboolean no_caching, GError **error)
 plugin_skip:;
     }
 
-    /* Clear the generated search list as it points to
-     * strings owned by IP configurations and we can't
-     * guarantee they stay alive. */
-    _mgr_configs_data_clear(self);
-
     update_resolv_conf_no_stub(self,
                                NM_CAST_STRV_CC(searches),
                                NM_CAST_STRV_CC(nameservers),
@@ -2556,6 +2792,12 @@ nm_dns_manager_init(NMDnsManager *self)
                                                (GDestroyNotify) _dns_config_data_free,
                                                NULL);
 
+    priv->domain_track          = g_hash_table_new_full(nm_str_hash,
+                                                        g_str_equal,
+                                                        NULL,
+                                                        (GDestroyNotify) _domain_track_free);
+    priv->domain_track_affected = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
+
     /* Set the initial hash */
     compute_hash(self, NULL, NM_DNS_MANAGER_GET_PRIVATE(self)->hash);
 
@@ -2590,6 +2832,9 @@ dispose(GObject *object)
     c_list_for_each_entry_safe (ip_data, ip_data_safe, &priv->ip_config_lst_head, ip_config_lst)
         _dns_config_ip_data_free(ip_data);
 
+    nm_clear_pointer(&priv->domain_track, g_hash_table_destroy);
+    nm_clear_pointer(&priv->domain_track_affected, g_hash_table_destroy);
+
     nm_clear_pointer(&priv->configs_dict, g_hash_table_destroy);
     nm_assert(c_list_is_empty(&priv->configs_lst_head));
 
@@ -62,6 +62,23 @@ typedef struct {
          * With systemd-resolved, this is the value for SetLinkDefaultRoute(). */
         bool has_default_route : 1;
     } domains;
+
+    /* Private to NMDnsManager. The contribution of this configuration to
+     * the domain tracking. It is kept across updates and only rebuilt
+     * when the fingerprint of the configuration changes. */
+    struct {
+        /* Our own copy of the searches (or domains, if there are no searches).
+         * "domains.search" points into these strings. */
+        char **candidates;
+        int    priority;
+        guint8 fingerprint[NM_UTILS_CHECKSUM_LENGTH_SHA1];
+        bool   valid : 1;
+        bool   registered : 1;
+        bool   dirty : 1;
+        bool   has_nameservers : 1;
+        bool   add_wildcard : 1;
+        bool   has_default_route_maybe : 1;
+    } track;
 } NMDnsConfigIPData;
 
 typedef struct _NMDnsConfigData {
@@ -52,13 +52,22 @@ typedef struct {
     int                   ifindex;
 } RequestItem;
 
+typedef struct {
+    const char *operation;
+    GVariant *  argument;
+    int         ifindex;
+} SentRequest;
+
 /*****************************************************************************/
 
 typedef struct {
     GDBusConnection *dbus_connection;
     GHashTable *     dirty_interfaces;
+    GHashTable *     sent_requests;
     GCancellable *   cancellable;
     CList            request_queue_lst_head;
+    guint64          n_requests_sent;
+    guint64          n_requests_skipped;
     guint            name_owner_changed_id;
     bool             send_updates_warn_ratelimited : 1;
     bool             try_start_blocked : 1;
@@ -119,6 +128,88 @@ _request_item_append(NMDnsSystemdResolved *self,
 
 /*****************************************************************************/
 
+/* systemd-resolved keeps the per-link settings until they are changed
+ * or the link goes away. We remember the argument of the last call for
+ * each (ifindex, operation) and don't repeat calls that would not change
+ * anything. */
+
+static guint
+_sent_request_hash(gconstpointer ptr)
+{
+    const SentRequest *sent_request = ptr;
+    NMHashState        h;
+
+    nm_hash_init(&h, 1768399651u);
+    nm_hash_update_val(&h, sent_request->ifindex);
+    nm_hash_update_str(&h, sent_request->operation);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_sent_request_equal(gconstpointer a, gconstpointer b)
+{
+    const SentRequest *sent_request_a = a;
+    const SentRequest *sent_request_b = b;
+
+    return sent_request_a->ifindex == sent_request_b->ifindex
+           && nm_streq(sent_request_a->operation, sent_request_b->operation);
+}
+
+static void
+_sent_request_free(SentRequest *sent_request)
+{
+    g_variant_unref(sent_request->argument);
+    nm_g_slice_free(sent_request);
+}
+
+static gboolean
+_sent_request_is_unchanged(NMDnsSystemdResolved *self, const RequestItem *request_item)
+{
+    NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    const SentRequest *          sent_request;
+
+    sent_request = g_hash_table_lookup(priv->sent_requests,
+                                       &((const SentRequest){
+                                           .ifindex   = request_item->ifindex,
+                                           .operation = request_item->operation,
+                                       }));
+    return sent_request && g_variant_equal(sent_request->argument, request_item->argument);
+}
+
+static void
+_sent_request_track(NMDnsSystemdResolved *self, const RequestItem *request_item)
+{
+    NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    SentRequest *                sent_request;
+
+    sent_request  = g_slice_new(SentRequest);
+    *sent_request = (SentRequest){
+        .ifindex   = request_item->ifindex,
+        .operation = request_item->operation,
+        .argument  = g_variant_ref(request_item->argument),
+    };
+    g_hash_table_add(priv->sent_requests, sent_request);
+}
+
+static void
+_sent_request_forget(NMDnsSystemdResolved *self, const RequestItem *request_item)
+{
+    NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    const SentRequest *          sent_request;
+
+    sent_request = g_hash_table_lookup(priv->sent_requests,
+                                       &((const SentRequest){
+                                           .ifindex   = request_item->ifindex,
+                                           .operation = request_item->operation,
+                                       }));
+
+    /* only forget the request if no newer argument was sent in the meantime. */
+    if (sent_request && sent_request->argument == request_item->argument)
+        g_hash_table_remove(priv->sent_requests, sent_request);
+}
+
+/*****************************************************************************/
+
 static void
 _interface_config_free(InterfaceConfig *config)
 {
@@ -163,6 +254,10 @@ call_done(GObject *source, GAsyncResult *r, gpointer user_data)
         return;
     }
 
+    /* we don't know in which state the link is now. Resend the
+     * request with the next update. */
+    _sent_request_forget(self, request_item);
+
     log_level = LOGL_DEBUG;
     if (!priv->send_updates_warn_ratelimited) {
         priv->send_updates_warn_ratelimited = TRUE;
@@ -331,6 +426,8 @@ send_updates(NMDnsSystemdResolved *self)
 {
     NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
     RequestItem *                request_item;
+    guint                        n_sent    = 0;
+    guint                        n_skipped = 0;
 
     if (!priv->request_queue_to_send) {
         /* nothing to do. */
@@ -370,8 +467,6 @@ send_updates(NMDnsSystemdResolved *self)
         return;
     }
 
-    _LOGT("send-updates: start %lu requests", c_list_length(&priv->request_queue_lst_head));
-
     priv->cancellable = g_cancellable_new();
 
     priv->request_queue_to_send = FALSE;
@@ -386,6 +481,14 @@ send_updates(NMDnsSystemdResolved *self)
             continue;
         }
 
+        if (_sent_request_is_unchanged(self, request_item)) {
+            n_skipped++;
+            continue;
+        }
+
+        _sent_request_track(self, request_item);
+        n_sent++;
+
         /* Above we explicitly call "StartServiceByName" trying to avoid D-Bus activating systmd-resolved
          * multiple times. There is still a race, were we might hit this line although actually
          * the service just quit this very moment. In that case, we would try to D-Bus activate the
@@ -407,6 +510,15 @@ send_updates(NMDnsSystemdResolved *self)
                                call_done,
                                request_item);
     }
+
+    priv->n_requests_sent += n_sent;
+    priv->n_requests_skipped += n_skipped;
+    _LOGD("send-updates: sent %u requests, skipped %u unchanged (total %" G_GUINT64_FORMAT
+          " sent, %" G_GUINT64_FORMAT " skipped)",
+          n_sent,
+          n_skipped,
+          priv->n_requests_sent,
+          priv->n_requests_skipped);
 }
 
 static gboolean
@@ -449,6 +561,17 @@ update(NMDnsPlugin *            plugin,
 
     free_pending_updates(self);
 
+    /* Forget what we sent for links that are neither configured now nor
+     * get reset below. Otherwise the table grows with every link that
+     * ever existed. */
+    g_hash_table_iter_init(&iter, priv->sent_requests);
+    while (g_hash_table_iter_next(&iter, &pointer, NULL)) {
+        ifindex = ((SentRequest *) pointer)->ifindex;
+        if (!g_hash_table_contains(interfaces, GINT_TO_POINTER(ifindex))
+            && !g_hash_table_contains(priv->dirty_interfaces, GINT_TO_POINTER(ifindex)))
+            g_hash_table_iter_remove(&iter);
+    }
+
     interfaces_keys =
         nm_utils_hash_keys_to_array(interfaces, nm_cmp_int2ptr_p_with_data, NULL, &interfaces_len);
     for (i = 0; i < interfaces_len; i++) {
@@ -499,6 +622,11 @@ name_owner_changed(NMDnsSystemdResolved *self, const char *owner)
         _LOGT("D-Bus name for systemd-resolved has owner %s", owner);
 
     priv->dbus_has_owner = !!owner;
+
+    /* a new (or no) instance of systemd-resolved does not know what we
+     * configured before. */
+    g_hash_table_remove_all(priv->sent_requests);
+
     if (owner) {
         priv->try_start_blocked     = FALSE;
         priv->request_queue_to_send = TRUE;
@@ -580,6 +708,10 @@ nm_dns_systemd_resolved_init(NMDnsSystemdResolved *self)
 
     c_list_init(&priv->request_queue_lst_head);
     priv->dirty_interfaces = g_hash_table_new(nm_direct_hash, NULL);
+    priv->sent_requests    = g_hash_table_new_full(_sent_request_hash,
+                                                _sent_request_equal,
+                                                (GDestroyNotify) _sent_request_free,
+                                                NULL);
 
     priv->dbus_connection = nm_g_object_ref(NM_MAIN_DBUS_CONNECTION_GET);
     if (!priv->dbus_connection) {
@@ -622,6 +754,7 @@ dispose(GObject *object)
 
     g_clear_object(&priv->dbus_connection);
     nm_clear_pointer(&priv->dirty_interfaces, g_hash_table_unref);
+    nm_clear_pointer(&priv->sent_requests, g_hash_table_unref);
 
     G_OBJECT_CLASS(nm_dns_systemd_resolved_parent_class)->dispose(object);
 }
@@ -475,7 +475,16 @@ main(int argc, char *argv[])
     if (!_dbus_manager_init(config))
         goto done_no_manager;
 
-    nm_linux_platform_setup();
+    {
+        gs_free char *ignore_routes = NULL;
+
+        ignore_routes =
+            nm_config_data_get_value(NM_CONFIG_GET_DATA_ORIG,
+                                     NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                     NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTES,
+                                     NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+        nm_linux_platform_setup_full(ignore_routes);
+    }
 
     NM_UTILS_KEEP_ALIVE(config, nm_netns_get(), "NMConfig-depends-on-NMNetns");
 
@@ -21,6 +21,11 @@
 #define CANCELLATION_ID_PREFIX  "cancellation-id-"
 #define CANCELLATION_TIMEOUT_MS 5000
 
+/* Results of non-interactive CheckAuthorization calls are cached for a
+ * short time. The cache is dropped when polkit signals "Changed". */
+#define AUTH_CACHE_TTL_MSEC 10000
+#define AUTH_CACHE_MAX_SIZE 256u
+
 /*****************************************************************************/
 
 NM_GOBJECT_PROPERTIES_DEFINE_BASE(PROP_POLKIT_ENABLED, );
@@ -38,6 +43,11 @@ typedef struct {
     GCancellable *   main_cancellable;
     char *           name_owner;
     guint64          call_numid_counter;
+    GHashTable *     cache_idx;
+    CList            cache_lst_head;
+    guint64          cache_hits;
+    guint64          cache_misses;
+    guint            cache_generation;
     guint            changed_id;
     guint            name_owner_changed_id;
     bool             disposing : 1;
@@ -136,15 +146,30 @@ typedef enum {
     POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION = (1 << 0),
 } PolkitCheckAuthorizationFlags;
 
+typedef struct {
+    CList       cache_lst;
+    const char *action_id;
+    gint64      timestamp_msec;
+    guint64     start_time;
+    gulong      pid;
+    gulong      uid;
+    bool        is_authorized : 1;
+    bool        is_challenge : 1;
+    char        action_id_buf[];
+} AuthCacheEntry;
+
 struct _NMAuthManagerCallId {
     CList                                   calls_lst;
     NMAuthManager *                         self;
     GCancellable *                          dbus_cancellable;
     NMAuthManagerCheckAuthorizationCallback callback;
     gpointer                                user_data;
+    AuthCacheEntry *                        cache_entry;
     guint64                                 call_numid;
+    guint                                   cache_generation;
     guint                                   idle_id;
     bool                                    idle_is_authorized : 1;
+    bool                                    idle_is_challenge : 1;
 };
 
 #define cancellation_id_to_str_a(call_numid)                     \
@@ -165,10 +190,171 @@ _call_id_free(NMAuthManagerCallId *call_id)
         return;
     }
 
+    g_free(call_id->cache_entry);
     g_object_unref(call_id->self);
     g_slice_free(NMAuthManagerCallId, call_id);
 }
 
+/*****************************************************************************/
+
+static guint
+_auth_cache_entry_hash(gconstpointer ptr)
+{
+    const AuthCacheEntry *entry = ptr;
+    NMHashState           h;
+
+    nm_hash_init(&h, 1429604713u);
+    nm_hash_update_vals(&h, entry->start_time, entry->pid, entry->uid);
+    nm_hash_update_str(&h, entry->action_id);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_auth_cache_entry_equal(gconstpointer a, gconstpointer b)
+{
+    const AuthCacheEntry *entry_a = a;
+    const AuthCacheEntry *entry_b = b;
+
+    return entry_a->pid == entry_b->pid && entry_a->start_time == entry_b->start_time
+           && entry_a->uid == entry_b->uid && nm_streq(entry_a->action_id, entry_b->action_id);
+}
+
+static void
+_auth_cache_entry_free(gpointer ptr)
+{
+    AuthCacheEntry *entry = ptr;
+
+    c_list_unlink_stale(&entry->cache_lst);
+    g_free(entry);
+}
+
+static AuthCacheEntry *
+_auth_cache_entry_new(NMAuthSubject *subject, const char *action_id)
+{
+    AuthCacheEntry *entry;
+    guint64         start_time;
+    gsize           l;
+
+    /* Without start time, we cannot tell whether the PID got reused by
+     * another process. Don't cache. */
+    start_time = nm_auth_subject_get_unix_process_start_time(subject);
+    if (start_time == 0)
+        return NULL;
+
+    l      = strlen(action_id) + 1;
+    entry  = g_malloc(sizeof(AuthCacheEntry) + l);
+    *entry = (AuthCacheEntry){
+        .cache_lst  = C_LIST_INIT(entry->cache_lst),
+        .action_id  = entry->action_id_buf,
+        .start_time = start_time,
+        .pid        = nm_auth_subject_get_unix_process_pid(subject),
+        .uid        = nm_auth_subject_get_unix_process_uid(subject),
+    };
+    memcpy(entry->action_id_buf, action_id, l);
+    return entry;
+}
+
+static void
+_auth_cache_expire(NMAuthManager *self, gint64 now_msec)
+{
+    NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE(self);
+    AuthCacheEntry *      entry;
+
+    /* the entries are sorted by their timestamp. */
+    while ((entry = c_list_first_entry(&priv->cache_lst_head, AuthCacheEntry, cache_lst))
+           && entry->timestamp_msec + AUTH_CACHE_TTL_MSEC <= now_msec)
+        g_hash_table_remove(priv->cache_idx, entry);
+}
+
+static void
+_auth_cache_clear(NMAuthManager *self, const char *reason)
+{
+    NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE(self);
+
+    /* results of calls that are still pending are no longer valid either. */
+    priv->cache_generation++;
+
+    if (!priv->cache_idx || g_hash_table_size(priv->cache_idx) == 0)
+        return;
+
+    _LOGT("cache: drop %u entries (%s; %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT
+          " misses so far)",
+          g_hash_table_size(priv->cache_idx),
+          reason,
+          priv->cache_hits,
+          priv->cache_misses);
+    g_hash_table_remove_all(priv->cache_idx);
+}
+
+static const AuthCacheEntry *
+_auth_cache_lookup(NMAuthManager *self,
+                   NMAuthSubject *subject,
+                   const char *   action_id,
+                   gboolean       allow_user_interaction)
+{
+    NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE(self);
+    const AuthCacheEntry *entry;
+    AuthCacheEntry        needle;
+
+    needle = (AuthCacheEntry){
+        .action_id  = action_id,
+        .start_time = nm_auth_subject_get_unix_process_start_time(subject),
+        .pid        = nm_auth_subject_get_unix_process_pid(subject),
+        .uid        = nm_auth_subject_get_unix_process_uid(subject),
+    };
+    if (needle.start_time == 0)
+        return NULL;
+
+    _auth_cache_expire(self, nm_utils_get_monotonic_timestamp_msec());
+
+    entry = g_hash_table_lookup(priv->cache_idx, &needle);
+
+    /* The cache only contains results of non-interactive calls. If that result
+     * was to authorize, interaction is not necessary. Otherwise, the user may
+     * get challenged and we must ask polkit. */
+    if (entry && allow_user_interaction && !entry->is_authorized)
+        entry = NULL;
+
+    if (!entry) {
+        priv->cache_misses++;
+        return NULL;
+    }
+
+    priv->cache_hits++;
+    return entry;
+}
+
+static void
+_auth_cache_add(NMAuthManager * self,
+                AuthCacheEntry *entry_take,
+                gboolean        is_authorized,
+                gboolean        is_challenge)
+{
+    NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE(self);
+    AuthCacheEntry *      entry_old;
+    gint64                now_msec;
+
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    _auth_cache_expire(self, now_msec);
+
+    entry_take->timestamp_msec = now_msec;
+    entry_take->is_authorized  = is_authorized;
+    entry_take->is_challenge   = is_challenge;
+
+    g_hash_table_remove(priv->cache_idx, entry_take);
+
+    while (g_hash_table_size(priv->cache_idx) >= AUTH_CACHE_MAX_SIZE) {
+        entry_old = c_list_first_entry(&priv->cache_lst_head, AuthCacheEntry, cache_lst);
+        g_hash_table_remove(priv->cache_idx, entry_old);
+    }
+
+    c_list_link_tail(&priv->cache_lst_head, &entry_take->cache_lst);
+    g_hash_table_add(priv->cache_idx, entry_take);
+}
+
+/*****************************************************************************/
+
 static void
 _call_id_invoke_callback(NMAuthManagerCallId *call_id,
                          gboolean             is_authorized,
@@ -260,6 +446,13 @@ _call_check_authorize_cb(GObject *proxy, GAsyncResult *res, gpointer user_data)
     if (!error) {
         g_variant_get(value, "((bb@a{ss}))", &is_authorized, &is_challenge, NULL);
         _LOG2T(call_id, "completed: authorized=%d, challenge=%d", is_authorized, is_challenge);
+        if (call_id->cache_entry && priv->cache_idx
+            && call_id->cache_generation == priv->cache_generation) {
+            _auth_cache_add(self,
+                            g_steal_pointer(&call_id->cache_entry),
+                            is_authorized,
+                            is_challenge);
+        }
     } else
         _LOG2T(call_id, "completed: failed: %s", error->message);
 
@@ -271,9 +464,10 @@ _call_on_idle(gpointer user_data)
 {
     NMAuthManagerCallId *call_id = user_data;
     gboolean             is_authorized;
-    gboolean             is_challenge = FALSE;
+    gboolean             is_challenge;
 
     is_authorized    = call_id->idle_is_authorized;
+    is_challenge     = call_id->idle_is_challenge;
     call_id->idle_id = 0;
 
     _LOG2T(call_id,
@@ -310,6 +504,7 @@ nm_auth_manager_check_authorization(NMAuthManager *                         self
     PolkitCheckAuthorizationFlags flags;
     char                          subject_buf[64];
     NMAuthManagerCallId *         call_id;
+    const AuthCacheEntry *        cache_entry;
 
     g_return_val_if_fail(NM_IS_AUTH_MANAGER(self), NULL);
     g_return_val_if_fail(NM_IN_SET(nm_auth_subject_get_subject_type(subject),
@@ -357,6 +552,18 @@ nm_auth_manager_check_authorization(NMAuthManager *                         self
                priv->auth_polkit_mode == NM_AUTH_POLKIT_MODE_ALLOW_ALL ? "grant" : "deny");
         call_id->idle_is_authorized = (priv->auth_polkit_mode == NM_AUTH_POLKIT_MODE_ALLOW_ALL);
         call_id->idle_id            = g_idle_add(_call_on_idle, call_id);
+    } else if ((cache_entry =
+                    _auth_cache_lookup(self, subject, action_id, allow_user_interaction))) {
+        _LOG2T(call_id,
+               "CheckAuthorization(%s), subject=%s (cached result, %" G_GUINT64_FORMAT
+               " hits, %" G_GUINT64_FORMAT " misses)",
+               action_id,
+               nm_auth_subject_to_string(subject, subject_buf, sizeof(subject_buf)),
+               priv->cache_hits,
+               priv->cache_misses);
+        call_id->idle_is_authorized = cache_entry->is_authorized;
+        call_id->idle_is_challenge  = cache_entry->is_challenge;
+        call_id->idle_id            = g_idle_add(_call_on_idle, call_id);
     } else {
         GVariant *      parameters;
         GVariantBuilder builder;
@@ -384,6 +591,13 @@ nm_auth_manager_check_authorization(NMAuthManager *                         self
 
         call_id->dbus_cancellable = g_cancellable_new();
 
+        /* Only results of non-interactive calls are cached. With interaction, the
+         * user might have authenticated just for this one request. */
+        if (!allow_user_interaction) {
+            call_id->cache_entry      = _auth_cache_entry_new(subject, action_id);
+            call_id->cache_generation = priv->cache_generation;
+        }
+
         nm_assert(priv->main_cancellable);
 
         g_dbus_connection_call(priv->dbus_connection,
@@ -445,8 +659,10 @@ changed_signal_cb(GDBusConnection *connection,
 
     _LOGD("dbus-signal: \"Changed\" notification%s", valid_sender ? "" : " (ignore)");
 
-    if (valid_sender)
+    if (valid_sender) {
+        _auth_cache_clear(self, "polkit changed");
         _emit_changed_signal(self);
+    }
 }
 
 static void
@@ -469,6 +685,7 @@ _name_owner_changed(NMAuthManager *self, const char *name_owner, gboolean is_ini
     if (is_changed) {
         old_name_owner   = g_steal_pointer(&priv->name_owner);
         priv->name_owner = g_strdup(name_owner);
+        _auth_cache_clear(self, "polkit name owner changed");
     } else {
         if (!is_initial)
             return;
@@ -601,6 +818,11 @@ nm_auth_manager_init(NMAuthManager *self)
     NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE(self);
 
     c_list_init(&priv->calls_lst_head);
+    c_list_init(&priv->cache_lst_head);
+    priv->cache_idx        = g_hash_table_new_full(_auth_cache_entry_hash,
+                                                   _auth_cache_entry_equal,
+                                                   _auth_cache_entry_free,
+                                                   NULL);
     priv->auth_polkit_mode = NM_AUTH_POLKIT_MODE_ROOT_ONLY;
 }
 
@@ -712,6 +934,9 @@ dispose(GObject *object)
 
     nm_clear_g_dbus_connection_signal(priv->dbus_connection, &priv->changed_id);
 
+    _auth_cache_clear(self, "dispose");
+    nm_clear_pointer(&priv->cache_idx, g_hash_table_unref);
+
     G_OBJECT_CLASS(nm_auth_manager_parent_class)->dispose(object);
 
     g_clear_object(&priv->dbus_connection);
@@ -750,7 +750,7 @@ nm_ip4_config_commit(const NMIP4Config *    self,
     routes = nm_dedup_multi_objs_to_ptr_array_head(nm_ip4_config_lookup_routes(self), NULL, NULL);
 
     routes_prune =
-        nm_platform_ip_route_get_prune_list(platform, AF_INET, ifindex, route_table_sync);
+        nm_platform_ip_route_get_prune_list_cached(platform, AF_INET, ifindex, route_table_sync);
 
     nm_platform_ip4_address_sync(platform, ifindex, addresses);
 
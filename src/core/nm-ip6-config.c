@@ -495,7 +495,7 @@ nm_ip6_config_commit(const NMIP6Config *    self,
     routes = nm_dedup_multi_objs_to_ptr_array_head(nm_ip6_config_lookup_routes(self), NULL, NULL);
 
     routes_prune =
-        nm_platform_ip_route_get_prune_list(platform, AF_INET6, ifindex, route_table_sync);
+        nm_platform_ip_route_get_prune_list_cached(platform, AF_INET6, ifindex, route_table_sync);
 
     nm_platform_ip6_address_sync(platform, ifindex, addresses, FALSE);
 
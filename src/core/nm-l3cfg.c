@@ -104,7 +104,14 @@ struct _NML3CfgCommitTypeHandle {
 
 typedef struct {
     const NML3ConfigData *l3cd;
-    NML3ConfigMergeFlags  merge_flags;
+
+    /* @l3cd merged alone with the parameters below (route table, metric,
+     * penalty and merge flags). It is cached so that sources which did not
+     * change don't need to be transformed again, and gets dropped whenever
+     * @l3cd or the parameters change. */
+    const NML3ConfigData *l3cd_merged_one;
+
+    NML3ConfigMergeFlags merge_flags;
     union {
         struct {
             guint32 default_route_table_6;
@@ -155,6 +162,15 @@ typedef struct _NML3CfgPrivate {
 
     const NML3ConfigData *combined_l3cd_commited;
 
+    /* For each route (by ID) in the l3cd_merged_one of the sources, how many
+     * of them contribute it. Updated by delta whenever a l3cd_merged_one gets
+     * created or dropped. */
+    GHashTable *merged_routes_contributors;
+
+    /* The route IDs whose contributors changed since combined_l3cd_merged was
+     * built. Only these need to be resolved again on the next merge. */
+    GHashTable *merged_routes_touched;
+
     CList commit_type_lst_head;
 
     GHashTable *routes_temporary_not_available_hash;
@@ -799,14 +815,12 @@ _nm_l3cfg_notify_platform_change(NML3Cfg *                  self,
 
     switch (obj_type) {
     case NMP_OBJECT_TYPE_LINK:
-    {
-        const NMPObject *plobj;
-
-        plobj = (change_type != NM_PLATFORM_SIGNAL_REMOVED) ? obj : NULL;
-        nm_assert(plobj == nm_platform_link_get_obj(self->priv.platform, self->priv.ifindex, TRUE));
-        nmp_object_ref_set(&self->priv.plobj_next, plobj);
+        /* We get notified with a batch of changes, so @obj might already be
+         * outdated. What counts is the link that is currently in the cache. */
+        nmp_object_ref_set(
+            &self->priv.plobj_next,
+            nm_platform_link_get_obj(self->priv.platform, self->priv.ifindex, TRUE));
         break;
-    }
     case NMP_OBJECT_TYPE_IP4_ADDRESS:
         _l3_acd_ipv4_addresses_on_link_update(self,
                                               NMP_OBJECT_CAST_IP4_ADDRESS(obj)->address,
@@ -2612,8 +2626,123 @@ _l3_config_datas_get_sorted_cmp(gconstpointer p_a, gconstpointer p_b, gpointer u
 }
 
 static void
-_l3_config_datas_remove_index_fast(GArray *arr, guint idx)
+_l3_config_data_track_routes(NML3Cfg *self, const NML3ConfigData *l3cd, gboolean add)
+{
+    GHashTable *     contributors;
+    GHashTable *     touched;
+    NMDedupMultiIter iter;
+    const NMPObject *obj;
+    int              IS_IPv4;
+
+    if (!self->priv.p->merged_routes_contributors) {
+        nm_assert(add);
+        self->priv.p->merged_routes_contributors =
+            g_hash_table_new_full((GHashFunc) nmp_object_id_hash,
+                                  (GEqualFunc) nmp_object_id_equal,
+                                  (GDestroyNotify) nmp_object_unref,
+                                  NULL);
+        self->priv.p->merged_routes_touched =
+            g_hash_table_new_full((GHashFunc) nmp_object_id_hash,
+                                  (GEqualFunc) nmp_object_id_equal,
+                                  (GDestroyNotify) nmp_object_unref,
+                                  NULL);
+    }
+    contributors = self->priv.p->merged_routes_contributors;
+    touched      = self->priv.p->merged_routes_touched;
+
+    for (IS_IPv4 = 1; IS_IPv4 >= 0; IS_IPv4--) {
+        nm_l3_config_data_iter_obj_for_each (&iter, l3cd, &obj, NMP_OBJECT_TYPE_IP_ROUTE(IS_IPv4)) {
+            guint count;
+
+            count = GPOINTER_TO_UINT(g_hash_table_lookup(contributors, obj));
+            if (add) {
+                g_hash_table_insert(contributors,
+                                    (gpointer) nmp_object_ref(obj),
+                                    GUINT_TO_POINTER(count + 1u));
+            } else {
+                nm_assert(count > 0);
+                if (count == 1u)
+                    g_hash_table_remove(contributors, obj);
+                else {
+                    g_hash_table_insert(contributors,
+                                        (gpointer) nmp_object_ref(obj),
+                                        GUINT_TO_POINTER(count - 1u));
+                }
+            }
+
+            if (!g_hash_table_contains(touched, obj))
+                g_hash_table_add(touched, (gpointer) nmp_object_ref(obj));
+        }
+    }
+}
+
+static void
+_l3_config_data_clear_merged_one(NML3Cfg *self, L3ConfigData *l3_config_data)
+{
+    if (!l3_config_data->l3cd_merged_one)
+        return;
+
+    _l3_config_data_track_routes(self, l3_config_data->l3cd_merged_one, FALSE);
+    nm_clear_l3cd(&l3_config_data->l3cd_merged_one);
+}
+
+static const NML3ConfigData *
+_l3_config_data_get_merged_one(NML3Cfg *self, L3ConfigData *l3_config_data)
 {
+    NML3ConfigData *l3cd;
+
+    nm_assert(!NM_FLAGS_HAS(l3_config_data->merge_flags, NM_L3_CONFIG_MERGE_FLAGS_ONLY_FOR_ACD));
+
+    if (l3_config_data->l3cd_merged_one)
+        return l3_config_data->l3cd_merged_one;
+
+    /* This applies the route table, metric and penalty and the merge flags.
+     * The result only contains routes that don't need any transformation,
+     * so merging it into the combined config only references the objects. */
+    l3cd = nm_l3_config_data_new(nm_platform_get_multi_idx(self->priv.platform),
+                                 self->priv.ifindex);
+    nm_l3_config_data_merge(l3cd,
+                            l3_config_data->l3cd,
+                            l3_config_data->merge_flags,
+                            l3_config_data->default_route_table_x,
+                            l3_config_data->default_route_metric_x,
+                            l3_config_data->default_route_penalty_x,
+                            NULL,
+                            NULL);
+    l3_config_data->l3cd_merged_one = nm_l3_config_data_seal(l3cd);
+
+    _l3_config_data_track_routes(self, l3_config_data->l3cd_merged_one, TRUE);
+
+    return l3_config_data->l3cd_merged_one;
+}
+
+static const NMPObject *
+_l3_config_datas_lookup_merged_route(const L3ConfigData *const *l3_config_datas_arr,
+                                     guint                      l3_config_datas_len,
+                                     const NMPObject *          needle)
+{
+    guint i;
+
+    /* the sources are sorted, the first one that has the route wins. */
+    for (i = 0; i < l3_config_datas_len; i++) {
+        const L3ConfigData *     l3cd_data = l3_config_datas_arr[i];
+        const NMDedupMultiEntry *entry;
+
+        if (!l3cd_data->l3cd_merged_one)
+            continue;
+
+        entry = nm_l3_config_data_lookup_route_obj(l3cd_data->l3cd_merged_one, needle);
+        if (entry)
+            return entry->obj;
+    }
+
+    return NULL;
+}
+
+static void
+_l3_config_datas_remove_index_fast(NML3Cfg *self, guint idx)
+{
+    GArray *      arr = self->priv.p->l3_config_datas;
     L3ConfigData *l3_config_data;
 
     nm_assert(arr);
@@ -2621,6 +2750,7 @@ _l3_config_datas_remove_index_fast(GArray *arr, guint idx)
 
     l3_config_data = _l3_config_datas_at(arr, idx);
 
+    _l3_config_data_clear_merged_one(self, l3_config_data);
     nm_l3_config_data_unref(l3_config_data->l3cd);
 
     g_array_remove_index_fast(arr, idx);
@@ -2715,7 +2845,7 @@ nm_l3cfg_add_config(NML3Cfg *             self,
                 idx2++;
             } else {
                 changed = TRUE;
-                _l3_config_datas_remove_index_fast(self->priv.p->l3_config_datas, idx2);
+                _l3_config_datas_remove_index_fast(self, idx2);
             }
             idx2 = _l3_config_datas_find_next(self->priv.p->l3_config_datas, idx2, tag, NULL);
             if (idx2 < 0)
@@ -2787,6 +2917,8 @@ nm_l3cfg_add_config(NML3Cfg *             self,
             l3_config_data->acd_timeout_msec_confdata = acd_timeout_msec;
             changed                                   = TRUE;
         }
+        if (changed)
+            _l3_config_data_clear_merged_one(self, l3_config_data);
     }
 
     nm_assert(l3_config_data->acd_defend_type_confdata == acd_defend_type);
@@ -2828,7 +2960,7 @@ _l3cfg_remove_config(NML3Cfg *             self,
         }
 
         _l3_changed_configs_set_dirty(self);
-        _l3_config_datas_remove_index_fast(self->priv.p->l3_config_datas, idx);
+        _l3_config_datas_remove_index_fast(self, idx);
         changed = TRUE;
         if (l3cd) {
             /* only one was requested to be removed. We are done. */
@@ -2862,8 +2994,9 @@ nm_l3cfg_remove_config_all(NML3Cfg *self, gconstpointer tag, gboolean only_dirty
 /*****************************************************************************/
 
 typedef struct {
-    NML3Cfg *     self;
-    gconstpointer tag;
+    NML3Cfg *             self;
+    const NML3ConfigData *l3cd;
+    gconstpointer         tag;
 } L3ConfigMergeHookAddObjData;
 
 static gboolean
@@ -2902,8 +3035,10 @@ _l3_hook_add_addr_cb(const NML3ConfigData *l3cd,
         goto out;
     }
 
-    nm_assert(
-        _acd_track_data_is_not_dirty(_acd_data_find_track(acd_data, l3cd, obj, hook_data->tag)));
+    /* @l3cd is the cached l3cd_merged_one. The ACD tracking is by the
+     * original l3cd, which contains the same (interned) address objects. */
+    nm_assert(_acd_track_data_is_not_dirty(
+        _acd_data_find_track(acd_data, hook_data->l3cd, obj, hook_data->tag)));
     if (!NM_IN_SET(acd_data->info.state,
                    NM_L3_ACD_ADDR_STATE_READY,
                    NM_L3_ACD_ADDR_STATE_DEFENDING))
@@ -2928,6 +3063,8 @@ _l3cfg_update_combined_config(NML3Cfg *              self,
     const L3ConfigData **        l3_config_datas_arr;
     guint                        l3_config_datas_len;
     guint                        i;
+    guint                        n_rebuilt        = 0;
+    guint                        n_touched        = 0;
     gboolean                     merged_changed   = FALSE;
     gboolean                     commited_changed = FALSE;
 
@@ -2976,33 +3113,157 @@ _l3cfg_update_combined_config(NML3Cfg *              self,
         L3ConfigMergeHookAddObjData hook_data = {
             .self = self,
         };
+        const NML3ConfigData *l3cd_prev = self->priv.p->combined_l3cd_merged;
+        GHashTableIter        h_iter;
+        NMDedupMultiIter      iter;
+        const NMPObject *     obj;
+        int                   IS_IPv4;
+
+        /* Creating the missing l3cd_merged_one updates the contributor counts
+         * and marks the route IDs that they touch. */
+        for (i = 0; i < l3_config_datas_len; i++) {
+            L3ConfigData *l3cd_data = (L3ConfigData *) l3_config_datas_arr[i];
+
+            if (NM_FLAGS_HAS(l3cd_data->merge_flags, NM_L3_CONFIG_MERGE_FLAGS_ONLY_FOR_ACD))
+                continue;
+
+            if (!l3cd_data->l3cd_merged_one) {
+                n_rebuilt++;
+                _l3_config_data_get_merged_one(self, l3cd_data);
+            }
+        }
 
         l3cd = nm_l3_config_data_new(nm_platform_get_multi_idx(self->priv.platform),
                                      self->priv.ifindex);
 
+        /* the transformation was already applied to l3cd_merged_one. What
+         * is left is to combine the sources in order, with the first one
+         * winning. Addresses and DNS settings are cheap and need the ACD hook,
+         * merge them from all sources. */
         for (i = 0; i < l3_config_datas_len; i++) {
             const L3ConfigData *l3cd_data = l3_config_datas_arr[i];
 
-            if (NM_FLAGS_HAS(l3cd_data->merge_flags, NM_L3_CONFIG_MERGE_FLAGS_ONLY_FOR_ACD))
+            if (!l3cd_data->l3cd_merged_one)
                 continue;
 
-            hook_data.tag = l3cd_data->tag_confdata;
+            hook_data.l3cd = l3cd_data->l3cd;
+            hook_data.tag  = l3cd_data->tag_confdata;
             nm_l3_config_data_merge(l3cd,
-                                    l3cd_data->l3cd,
-                                    l3cd_data->merge_flags,
-                                    l3cd_data->default_route_table_x,
-                                    l3cd_data->default_route_metric_x,
-                                    l3cd_data->default_route_penalty_x,
+                                    l3cd_data->l3cd_merged_one,
+                                    NM_L3_CONFIG_MERGE_FLAGS_NO_ROUTES,
+                                    NULL,
+                                    NULL,
+                                    NULL,
                                     _l3_hook_add_addr_cb,
                                     &hook_data);
         }
 
+        if (!l3cd_prev) {
+            for (i = 0; i < l3_config_datas_len; i++) {
+                const L3ConfigData *l3cd_data = l3_config_datas_arr[i];
+
+                if (!l3cd_data->l3cd_merged_one)
+                    continue;
+
+                for (IS_IPv4 = 1; IS_IPv4 >= 0; IS_IPv4--) {
+                    nm_l3_config_data_iter_obj_for_each (&iter,
+                                                         l3cd_data->l3cd_merged_one,
+                                                         &obj,
+                                                         NMP_OBJECT_TYPE_IP_ROUTE(IS_IPv4)) {
+                        nm_l3_config_data_add_route_full(l3cd,
+                                                         NMP_OBJECT_GET_ADDR_FAMILY(obj),
+                                                         obj,
+                                                         NULL,
+                                                         NM_L3_CONFIG_ADD_FLAGS_EXCLUSIVE,
+                                                         NULL,
+                                                         NULL);
+                    }
+                }
+            }
+            n_touched = nm_g_hash_table_size(self->priv.p->merged_routes_contributors);
+        } else {
+            /* The winner of a route ID only changes if a source that
+             * contributes it changed. Keep the winners of the previous
+             * combined config, and resolve only the touched IDs again. They
+             * stay at their position, so that an update which results in the
+             * same routes also results in an equal combined config. */
+            for (IS_IPv4 = 1; IS_IPv4 >= 0; IS_IPv4--) {
+                nm_l3_config_data_iter_obj_for_each (&iter,
+                                                     l3cd_prev,
+                                                     &obj,
+                                                     NMP_OBJECT_TYPE_IP_ROUTE(IS_IPv4)) {
+                    const NMPObject *obj_winner = obj;
+
+                    if (nm_g_hash_table_contains(self->priv.p->merged_routes_touched, obj)) {
+                        if (!g_hash_table_contains(self->priv.p->merged_routes_contributors, obj))
+                            continue;
+                        obj_winner = _l3_config_datas_lookup_merged_route(l3_config_datas_arr,
+                                                                          l3_config_datas_len,
+                                                                          obj);
+                        nm_assert(obj_winner);
+                    } else {
+                        nm_assert(nm_g_hash_table_contains(
+                            self->priv.p->merged_routes_contributors,
+                            obj));
+                    }
+
+                    nm_l3_config_data_add_route_full(l3cd,
+                                                     NMP_OBJECT_GET_ADDR_FAMILY(obj_winner),
+                                                     obj_winner,
+                                                     NULL,
+                                                     NM_L3_CONFIG_ADD_FLAGS_EXCLUSIVE,
+                                                     NULL,
+                                                     NULL);
+                }
+            }
+
+            if (self->priv.p->merged_routes_touched) {
+                g_hash_table_iter_init(&h_iter, self->priv.p->merged_routes_touched);
+                while (g_hash_table_iter_next(&h_iter, (gpointer *) &obj, NULL)) {
+                    const NMPObject *obj_winner;
+
+                    n_touched++;
+
+                    if (!g_hash_table_contains(self->priv.p->merged_routes_contributors, obj))
+                        continue;
+
+                    /* already resolved above. */
+                    if (nm_l3_config_data_lookup_route_obj(l3cd_prev, obj))
+                        continue;
+
+                    obj_winner = _l3_config_datas_lookup_merged_route(l3_config_datas_arr,
+                                                                      l3_config_datas_len,
+                                                                      obj);
+                    nm_assert(obj_winner);
+                    nm_l3_config_data_add_route_full(l3cd,
+                                                     NMP_OBJECT_GET_ADDR_FAMILY(obj_winner),
+                                                     obj_winner,
+                                                     NULL,
+                                                     NM_L3_CONFIG_ADD_FLAGS_EXCLUSIVE,
+                                                     NULL,
+                                                     NULL);
+                }
+            }
+        }
+
         nm_assert(l3cd);
         nm_assert(nm_l3_config_data_get_ifindex(l3cd) == self->priv.ifindex);
+        nm_assert(nm_l3_config_data_get_num_routes(l3cd, AF_INET)
+                      + nm_l3_config_data_get_num_routes(l3cd, AF_INET6)
+                  == nm_g_hash_table_size(self->priv.p->merged_routes_contributors));
+
+        _LOGT("merge: %u of %u sources transformed, %u of %u routes resolved again",
+              n_rebuilt,
+              l3_config_datas_len,
+              n_touched,
+              nm_g_hash_table_size(self->priv.p->merged_routes_contributors));
 
         nm_l3_config_data_seal(l3cd);
     }
 
+    if (self->priv.p->merged_routes_touched)
+        g_hash_table_remove_all(self->priv.p->merged_routes_touched);
+
     if (nm_l3_config_data_equal(l3cd, self->priv.p->combined_l3cd_merged))
         goto out;
 
@@ -3318,10 +3579,10 @@ _l3_commit_one(NML3Cfg *             self,
                                                                 addr_family,
                                                                 self->priv.ifindex,
                                                                 TRUE);
-        routes_prune    = nm_platform_ip_route_get_prune_list(self->priv.platform,
-                                                           addr_family,
-                                                           self->priv.ifindex,
-                                                           route_table_sync);
+        routes_prune    = nm_platform_ip_route_get_prune_list_cached(self->priv.platform,
+                                                                  addr_family,
+                                                                  self->priv.ifindex,
+                                                                  route_table_sync);
     } else if (commit_type == NM_L3_CFG_COMMIT_TYPE_UPDATE) {
         addresses_prune = nm_g_ptr_array_ref(self->priv.p->last_addresses_x[IS_IPv4]);
         routes_prune    = nm_g_ptr_array_ref(self->priv.p->last_routes_x[IS_IPv4]);
@@ -3722,6 +3983,10 @@ finalize(GObject *object)
     nm_assert(!self->priv.p->l3_config_datas);
     nm_assert(!self->priv.p->ipv4ll);
 
+    nm_assert(nm_g_hash_table_size(self->priv.p->merged_routes_contributors) == 0);
+    nm_clear_pointer(&self->priv.p->merged_routes_contributors, g_hash_table_unref);
+    nm_clear_pointer(&self->priv.p->merged_routes_touched, g_hash_table_unref);
+
     nm_assert(c_list_is_empty(&self->priv.p->commit_type_lst_head));
 
     nm_clear_g_source_inst(&self->priv.p->commit_on_idle_source);
@@ -152,6 +152,19 @@ typedef struct {
 
     CList devices_lst_head;
 
+    struct {
+        /* NMDevice -> DevicesIdxEntry, the keys under which a device from
+         * @devices_lst_head is currently tracked in the indexes below. */
+        GHashTable *entries;
+
+        /* Lookup indexes for the devices in @devices_lst_head. They map
+         * the key to a GPtrArray with the matching NMDevice instances. */
+        GHashTable *by_ifindex;
+        GHashTable *by_iface;
+        GHashTable *by_ip_iface;
+        GHashTable *by_perm_hw_addr;
+    } devices_idx;
+
     NMState            state;
     NMConfig *         config;
     NMConnectivity *   concheck_mgr;
@@ -1136,6 +1149,72 @@ nm_manager_get_activatable_connections(NMManager *manager,
         NULL);
 }
 
+/**
+ * nm_manager_get_activatable_connections_for_device:
+ * @manager: the #NMManager
+ * @device: the device for which to find the profiles
+ * @for_auto_activation: whether the profiles are used for autoconnect
+ * @out_len: (allow-none): the number of returned profiles
+ *
+ * Like nm_manager_get_activatable_connections() with sorting, but only returns
+ * profiles that are plausible for @device according to the autoconnect index
+ * of #NMSettings (their connection type and interface name). The caller still
+ * must check whether the profiles are compatible and available.
+ *
+ * Returns: (transfer container): the NULL terminated list of profiles.
+ */
+NMSettingsConnection **
+nm_manager_get_activatable_connections_for_device(NMManager *manager,
+                                                  NMDevice * device,
+                                                  gboolean   for_auto_activation,
+                                                  guint *    out_len)
+{
+    NMManagerPrivate *                        priv = NM_MANAGER_GET_PRIVATE(manager);
+    const GetActivatableConnectionsFilterData d    = {
+        .self                = manager,
+        .for_auto_activation = for_auto_activation,
+    };
+    const char *const *    connection_types;
+    guint                  n_connection_types;
+    NMSettingsConnection **candidates;
+    guint                  n_candidates;
+
+    connection_types = nm_device_get_compatible_connection_types(device, &n_connection_types);
+
+    candidates = nm_settings_get_autoconnect_candidates(priv->settings,
+                                                        connection_types,
+                                                        n_connection_types,
+                                                        nm_device_get_iface(device),
+                                                        &n_candidates,
+                                                        _get_activatable_connections_filter,
+                                                        (gpointer) &d);
+
+#if NM_MORE_ASSERTS > 5
+    {
+        gs_free NMSettingsConnection **all = NULL;
+        guint                          n_all;
+        guint                          i;
+
+        /* The index must not miss any profile that is compatible with the device. */
+        all = nm_manager_get_activatable_connections(manager, for_auto_activation, FALSE, &n_all);
+        for (i = 0; i < n_all; i++) {
+            if (!nm_device_check_connection_compatible(
+                    device,
+                    nm_settings_connection_get_connection(all[i]),
+                    NULL))
+                continue;
+            nm_assert(nm_utils_ptrarray_find_first((gconstpointer *) candidates,
+                                                   n_candidates,
+                                                   all[i])
+                      >= 0);
+        }
+    }
+#endif
+
+    NM_SET_OUT(out_len, n_candidates);
+    return candidates;
+}
+
 static NMActiveConnection *
 active_connection_get_by_path(NMManager *self, const char *path)
 {
@@ -1283,39 +1362,208 @@ nm_manager_get_device_by_path(NMManager *self, const char *path)
     return device;
 }
 
+/*****************************************************************************/
+
+typedef struct {
+    int   ifindex;
+    char *iface;
+    char *ip_iface;
+    char *perm_hw_addr;
+} DevicesIdxEntry;
+
+static void
+_devices_idx_entry_free(gpointer data)
+{
+    DevicesIdxEntry *entry = data;
+
+    g_free(entry->iface);
+    g_free(entry->ip_iface);
+    g_free(entry->perm_hw_addr);
+    nm_g_slice_free(entry);
+}
+
+static char *
+_devices_idx_hw_addr_normalize(const char *hwaddr)
+{
+    guint8 hwaddr_bin[_NM_UTILS_HWADDR_LEN_MAX];
+    gsize  hwaddr_len;
+
+    if (!hwaddr || !_nm_utils_hwaddr_aton(hwaddr, hwaddr_bin, sizeof(hwaddr_bin), &hwaddr_len))
+        return NULL;
+    return nm_utils_hwaddr_ntoa(hwaddr_bin, hwaddr_len);
+}
+
+static const GPtrArray *
+_devices_idx_lookup(GHashTable *idx, gconstpointer key)
+{
+    const GPtrArray *devices;
+
+    devices = g_hash_table_lookup(idx, key);
+    nm_assert(!devices || devices->len > 0);
+    return devices;
+}
+
+static void
+_devices_idx_add(GHashTable *idx, gconstpointer key, gboolean key_is_str, NMDevice *device)
+{
+    GPtrArray *devices;
+
+    devices = g_hash_table_lookup(idx, key);
+    if (!devices) {
+        devices = g_ptr_array_new();
+        g_hash_table_insert(idx, key_is_str ? g_strdup(key) : (gpointer) key, devices);
+    }
+    nm_assert(nm_utils_ptrarray_find_first((gconstpointer *) devices->pdata, devices->len, device)
+              < 0);
+    g_ptr_array_add(devices, device);
+}
+
+static void
+_devices_idx_remove(GHashTable *idx, gconstpointer key, NMDevice *device)
+{
+    GPtrArray *devices;
+
+    devices = g_hash_table_lookup(idx, key);
+    if (!devices || !g_ptr_array_remove(devices, device))
+        g_return_if_reached();
+    if (devices->len == 0)
+        g_hash_table_remove(idx, key);
+}
+
+static void
+_devices_idx_update_str(GHashTable *idx, char **p_key, const char *key, NMDevice *device)
+{
+    if (nm_streq0(*p_key, key))
+        return;
+
+    if (*p_key) {
+        _devices_idx_remove(idx, *p_key, device);
+        nm_clear_g_free(p_key);
+    }
+    if (key) {
+        *p_key = g_strdup(key);
+        _devices_idx_add(idx, key, TRUE, device);
+    }
+}
+
+static void
+_devices_idx_update(NMManager *self, NMDevice *device, gboolean is_removed)
+{
+    NMManagerPrivate *priv         = NM_MANAGER_GET_PRIVATE(self);
+    int               ifindex      = 0;
+    const char *      iface        = NULL;
+    const char *      ip_iface     = NULL;
+    gs_free char *    perm_hw_addr = NULL;
+    DevicesIdxEntry * entry;
+
+    entry = g_hash_table_lookup(priv->devices_idx.entries, device);
+    if (!entry) {
+        if (is_removed)
+            return;
+        entry = g_slice_new0(DevicesIdxEntry);
+        g_hash_table_insert(priv->devices_idx.entries, device, entry);
+    }
+
+    if (!is_removed) {
+        ifindex  = nm_device_get_ifindex(device);
+        iface    = nm_device_get_iface(device);
+        ip_iface = nm_device_get_ip_iface(device);
+
+        /* Don't force reading the permanent MAC address here. Devices that don't know it
+         * yet are handled by find_device_by_permanent_hw_addr(). */
+        perm_hw_addr = _devices_idx_hw_addr_normalize(
+            nm_device_get_permanent_hw_address_full(device, FALSE, NULL));
+    }
+
+    if (entry->ifindex != ifindex) {
+        if (entry->ifindex > 0)
+            _devices_idx_remove(priv->devices_idx.by_ifindex,
+                                GINT_TO_POINTER(entry->ifindex),
+                                device);
+        entry->ifindex = ifindex;
+        if (ifindex > 0)
+            _devices_idx_add(priv->devices_idx.by_ifindex, GINT_TO_POINTER(ifindex), FALSE, device);
+    }
+    _devices_idx_update_str(priv->devices_idx.by_iface, &entry->iface, iface, device);
+    _devices_idx_update_str(priv->devices_idx.by_ip_iface, &entry->ip_iface, ip_iface, device);
+    _devices_idx_update_str(priv->devices_idx.by_perm_hw_addr,
+                            &entry->perm_hw_addr,
+                            perm_hw_addr,
+                            device);
+
+    if (is_removed)
+        g_hash_table_remove(priv->devices_idx.entries, device);
+}
+
+/**
+ * nm_manager_device_index_update:
+ * @self: the #NMManager
+ * @device: the #NMDevice
+ *
+ * Must be called by @device whenever its ifindex, interface name,
+ * IP interface name or permanent MAC address changes, so that the
+ * device lookup indexes stay in sync.
+ */
+void
+nm_manager_device_index_update(NMManager *self, NMDevice *device)
+{
+    g_return_if_fail(NM_IS_MANAGER(self));
+    g_return_if_fail(NM_IS_DEVICE(device));
+
+    if (c_list_is_empty(&device->devices_lst))
+        return;
+
+    nm_assert(c_list_contains(&NM_MANAGER_GET_PRIVATE(self)->devices_lst_head,
+                              &device->devices_lst));
+
+    _devices_idx_update(self, device, FALSE);
+}
+
+/*****************************************************************************/
+
 NMDevice *
 nm_manager_get_device_by_ifindex(NMManager *self, int ifindex)
 {
     NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE(self);
-    NMDevice *        device;
+    const GPtrArray * devices;
 
-    if (ifindex > 0) {
-        c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
-            if (nm_device_get_ifindex(device) == ifindex)
-                return device;
-        }
-    }
+    if (ifindex <= 0)
+        return NULL;
 
-    return NULL;
+    devices = _devices_idx_lookup(priv->devices_idx.by_ifindex, GINT_TO_POINTER(ifindex));
+    if (!devices)
+        return NULL;
+
+    nm_assert(nm_device_get_ifindex(devices->pdata[0]) == ifindex);
+    return devices->pdata[0];
 }
 
 static NMDevice *
 find_device_by_permanent_hw_addr(NMManager *self, const char *hwaddr)
 {
-    NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE(self);
+    NMManagerPrivate *priv        = NM_MANAGER_GET_PRIVATE(self);
+    gs_free char *    hwaddr_norm = NULL;
+    const GPtrArray * devices;
     NMDevice *        device;
     const char *      device_addr;
-    guint8            hwaddr_bin[_NM_UTILS_HWADDR_LEN_MAX];
-    gsize             hwaddr_len;
 
     g_return_val_if_fail(hwaddr != NULL, NULL);
 
-    if (!_nm_utils_hwaddr_aton(hwaddr, hwaddr_bin, sizeof(hwaddr_bin), &hwaddr_len))
+    hwaddr_norm = _devices_idx_hw_addr_normalize(hwaddr);
+    if (!hwaddr_norm)
         return NULL;
 
+    devices = _devices_idx_lookup(priv->devices_idx.by_perm_hw_addr, hwaddr_norm);
+    if (devices)
+        return devices->pdata[0];
+
+    /* Devices that did not yet determine their permanent MAC address are not
+     * indexed. Force reading it now, for those devices only. */
     c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
+        if (nm_device_get_permanent_hw_address_full(device, FALSE, NULL))
+            continue;
         device_addr = nm_device_get_permanent_hw_address(device);
-        if (device_addr && nm_utils_hwaddr_matches(hwaddr_bin, hwaddr_len, device_addr, -1))
+        if (device_addr && nm_utils_hwaddr_matches(hwaddr_norm, -1, device_addr, -1))
             return device;
     }
     return NULL;
@@ -1325,12 +1573,19 @@ static NMDevice *
 find_device_by_ip_iface(NMManager *self, const char *iface)
 {
     NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE(self);
-    NMDevice *        device;
+    const GPtrArray * devices;
+    guint             i;
 
     g_return_val_if_fail(iface, NULL);
 
-    c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
-        if (nm_device_is_real(device) && nm_streq0(nm_device_get_ip_iface(device), iface))
+    devices = _devices_idx_lookup(priv->devices_idx.by_ip_iface, iface);
+    if (!devices)
+        return NULL;
+
+    for (i = 0; i < devices->len; i++) {
+        NMDevice *device = devices->pdata[i];
+
+        if (nm_device_is_real(device))
             return device;
     }
     return NULL;
@@ -1359,13 +1614,20 @@ find_device_by_iface(NMManager *   self,
 {
     NMManagerPrivate *priv     = NM_MANAGER_GET_PRIVATE(self);
     NMDevice *        fallback = NULL;
-    NMDevice *        candidate;
+    const GPtrArray * devices;
+    guint             i;
 
     g_return_val_if_fail(iface != NULL, NULL);
 
-    c_list_for_each_entry (candidate, &priv->devices_lst_head, devices_lst) {
-        if (!nm_streq(nm_device_get_iface(candidate), iface))
-            continue;
+    devices = _devices_idx_lookup(priv->devices_idx.by_iface, iface);
+    if (!devices)
+        return NULL;
+
+    for (i = 0; i < devices->len; i++) {
+        NMDevice *candidate = devices->pdata[i];
+
+        nm_assert(nm_streq0(nm_device_get_iface(candidate), iface));
+
         if (connection && !nm_device_check_connection_compatible(candidate, connection, NULL))
             continue;
         if (slave) {
@@ -1494,6 +1756,14 @@ nm_manager_get_metered(NMManager *self)
     return NM_MANAGER_GET_PRIVATE(self)->metered;
 }
 
+NMActiveConnection *
+nm_manager_get_primary_connection(NMManager *self)
+{
+    g_return_val_if_fail(NM_IS_MANAGER(self), NULL);
+
+    return NM_MANAGER_GET_PRIVATE(self)->primary_connection;
+}
+
 static void
 nm_manager_update_state(NMManager *self)
 {
@@ -1731,6 +2001,7 @@ remove_device(NMManager *self, NMDevice *device, gboolean quitting)
     nm_settings_device_removed(priv->settings, device, quitting);
 
     c_list_unlink(&device->devices_lst);
+    _devices_idx_update(self, device, TRUE);
 
     _parent_notify_changed(self, device, TRUE);
 
@@ -1951,14 +2222,20 @@ NMDevice *
 nm_manager_get_device(NMManager *self, const char *ifname, NMDeviceType device_type)
 {
     NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE(self);
-    NMDevice *        device;
+    const GPtrArray * devices;
+    guint             i;
 
     g_return_val_if_fail(ifname, NULL);
     g_return_val_if_fail(device_type != NM_DEVICE_TYPE_UNKNOWN, NULL);
 
-    c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
-        if (nm_device_get_device_type(device) == device_type
-            && nm_streq0(nm_device_get_iface(device), ifname))
+    devices = _devices_idx_lookup(priv->devices_idx.by_iface, ifname);
+    if (!devices)
+        return NULL;
+
+    for (i = 0; i < devices->len; i++) {
+        NMDevice *device = devices->pdata[i];
+
+        if (nm_device_get_device_type(device) == device_type)
             return device;
     }
 
@@ -3227,6 +3504,7 @@ add_device(NMManager *self, NMDevice *device, GError **error)
 
     nm_assert(c_list_is_empty(&device->devices_lst));
     c_list_link_tail(&priv->devices_lst_head, &device->devices_lst);
+    _devices_idx_update(self, device, FALSE);
 
     g_signal_connect(device,
                      NM_DEVICE_STATE_CHANGED,
@@ -7626,6 +7904,7 @@ nm_manager_set_capability(NMManager *self, NMCapability cap)
 void
 nm_manager_emit_device_ifindex_changed(NMManager *self, NMDevice *device)
 {
+    nm_manager_device_index_update(self, device);
     g_signal_emit(self, signals[DEVICE_IFINDEX_CHANGED], 0, device);
 }
 
@@ -7770,6 +8049,17 @@ nm_manager_init(NMManager *self)
     c_list_init(&priv->link_cb_lst);
     c_list_init(&priv->devices_lst_head);
     c_list_init(&priv->active_connections_lst_head);
+
+    priv->devices_idx.entries =
+        g_hash_table_new_full(nm_direct_hash, NULL, NULL, _devices_idx_entry_free);
+    priv->devices_idx.by_ifindex =
+        g_hash_table_new_full(nm_direct_hash, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+    priv->devices_idx.by_iface =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+    priv->devices_idx.by_ip_iface =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+    priv->devices_idx.by_perm_hw_addr =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
     c_list_init(&priv->async_op_lst_head);
     c_list_init(&priv->delete_volatile_connection_lst_head);
 
@@ -8139,6 +8429,13 @@ finalize(GObject *object)
 
     g_array_free(priv->capabilities, TRUE);
 
+    nm_assert(g_hash_table_size(priv->devices_idx.entries) == 0);
+    g_hash_table_destroy(priv->devices_idx.entries);
+    g_hash_table_destroy(priv->devices_idx.by_ifindex);
+    g_hash_table_destroy(priv->devices_idx.by_iface);
+    g_hash_table_destroy(priv->devices_idx.by_ip_iface);
+    g_hash_table_destroy(priv->devices_idx.by_perm_hw_addr);
+
     G_OBJECT_CLASS(nm_manager_parent_class)->finalize(object);
 
     g_object_unref(priv->platform);
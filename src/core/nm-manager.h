@@ -119,6 +119,12 @@ NMSettingsConnection **nm_manager_get_activatable_connections(NMManager *manager
                                                               gboolean   sort,
                                                               guint *    out_len);
 
+NMSettingsConnection **
+nm_manager_get_activatable_connections_for_device(NMManager *manager,
+                                                  NMDevice * device,
+                                                  gboolean   for_auto_activation,
+                                                  guint *    out_len);
+
 void     nm_manager_write_device_state_all(NMManager *manager);
 gboolean nm_manager_write_device_state(NMManager *manager, NMDevice *device, int *out_ifindex);
 
@@ -182,6 +188,7 @@ gboolean nm_manager_deactivate_connection(NMManager *         manager,
 
 void nm_manager_set_capability(NMManager *self, NMCapability cap);
 void nm_manager_emit_device_ifindex_changed(NMManager *self, NMDevice *device);
+void nm_manager_device_index_update(NMManager *self, NMDevice *device);
 
 NMDevice *nm_manager_get_device(NMManager *self, const char *ifname, NMDeviceType device_type);
 gboolean  nm_manager_remove_device(NMManager *self, const char *ifname, NMDeviceType device_type);
@@ -197,6 +204,8 @@ void nm_manager_dbus_set_property_handle(NMDBusObject *                     obj,
 
 NMMetered nm_manager_get_metered(NMManager *self);
 
+NMActiveConnection *nm_manager_get_primary_connection(NMManager *self);
+
 void nm_manager_notify_device_availability_maybe_changed(NMManager *self);
 
 /*****************************************************************************/
@@ -29,7 +29,6 @@ typedef struct {
     GHashTable *     l3cfgs;
     GHashTable *     shared_ips;
     CList            l3cfg_signal_pending_lst_head;
-    guint            signal_pending_idle_id;
 } NMNetnsPrivate;
 
 struct _NMNetns {
@@ -181,23 +180,23 @@ nm_netns_access_l3cfg(NMNetns *self, int ifindex)
 
 /*****************************************************************************/
 
-static gboolean
-_platform_signal_on_idle_cb(gpointer user_data)
+static void
+_platform_changes_batch_cb(NMPlatform *                            platform,
+                           const NMPlatformSignalChangeBatchEntry *entries,
+                           guint                                   n_entries,
+                           NMNetns **                              p_self)
 {
-    gs_unref_object NMNetns *self = g_object_ref(NM_NETNS(user_data));
+    gs_unref_object NMNetns *self = g_object_ref(NM_NETNS(*p_self));
     NMNetnsPrivate *         priv = NM_NETNS_GET_PRIVATE(self);
     L3CfgData *              l3cfg_data;
     CList                    work_list;
 
-    priv->signal_pending_idle_id = 0;
-
-    /* we emit all queued signals together. However, we don't want to hook the
-     * main loop for longer than the currently queued elements.
-     *
-     * If we catch more change events, they will be queued and processed by a future
-     * idle handler.
+    /* The NML3Cfg instances already got the individual changes via
+     * _platform_signal_cb(). The batch comes once for all changes since
+     * the last batch, that is where they re-evaluate.
      *
-     * Hence, move the list to a temporary list. Isn't CList great? */
+     * Move the list to a temporary list. An NML3Cfg might get destroyed
+     * while we notify another one, and unlinks itself. */
 
     c_list_init(&work_list);
     c_list_splice(&work_list, &priv->l3cfg_signal_pending_lst_head);
@@ -209,8 +208,6 @@ _platform_signal_on_idle_cb(gpointer user_data)
             l3cfg_data->l3cfg,
             nm_steal_int(&l3cfg_data->signal_pending_obj_type_flags));
     }
-
-    return G_SOURCE_REMOVE;
 }
 
 static void
@@ -231,13 +228,12 @@ _platform_signal_cb(NMPlatform *  platform,
     if (!l3cfg_data)
         return;
 
+    /* The NML3Cfg must learn about the change right away (for example, that
+     * a route it configured is gone), before it might commit again. Only the
+     * re-evaluation is deferred to the "changes-batch" signal. */
     l3cfg_data->signal_pending_obj_type_flags |= nmp_object_type_to_flags(obj_type);
-
-    if (c_list_is_empty(&l3cfg_data->signal_pending_lst)) {
+    if (c_list_is_empty(&l3cfg_data->signal_pending_lst))
         c_list_link_tail(&priv->l3cfg_signal_pending_lst_head, &l3cfg_data->signal_pending_lst);
-        if (priv->signal_pending_idle_id == 0)
-            priv->signal_pending_idle_id = g_idle_add(_platform_signal_on_idle_cb, self);
-    }
 
     _nm_l3cfg_notify_platform_change(l3cfg_data->l3cfg,
                                      change_type,
@@ -442,6 +438,10 @@ constructed(GObject *object)
                      NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED,
                      G_CALLBACK(_platform_signal_cb),
                      &priv->_self_signal_user_data);
+    g_signal_connect(priv->platform,
+                     NM_PLATFORM_SIGNAL_CHANGES_BATCH,
+                     G_CALLBACK(_platform_changes_batch_cb),
+                     &priv->_self_signal_user_data);
 }
 
 NMNetns *
@@ -460,8 +460,6 @@ dispose(GObject *object)
     nm_assert(c_list_is_empty(&priv->l3cfg_signal_pending_lst_head));
     nm_assert(!priv->shared_ips);
 
-    nm_clear_g_source(&priv->signal_pending_idle_id);
-
     if (priv->platform)
         g_signal_handlers_disconnect_by_data(priv->platform, &priv->_self_signal_user_data);
 
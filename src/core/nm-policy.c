@@ -1337,7 +1337,8 @@ auto_activate_device(NMPolicy *self, NMDevice *device)
     if (!nm_device_autoconnect_allowed(device))
         return;
 
-    connections = nm_manager_get_activatable_connections(priv->manager, TRUE, TRUE, &len);
+    connections =
+        nm_manager_get_activatable_connections_for_device(priv->manager, device, TRUE, &len);
     if (!connections[0])
         return;
 
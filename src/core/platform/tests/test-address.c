@@ -436,6 +436,49 @@ test_ip4_address_peer_zero(void)
     }
 }
 
+static void
+test_ip4_address_sync_batch(void)
+{
+    const int ifindex = DEVICE_IFINDEX;
+    gs_unref_ptrarray GPtrArray *known_addresses = NULL;
+    const guint                  N_ADDRS         = 300;
+    GArray *                     addrs;
+    guint                        i;
+
+    g_assert(ifindex > 0);
+
+    /* more addresses than fit into one netlink batch. All of them are in the
+     * same subnet, the first one becomes primary and the others secondary. */
+    known_addresses = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+    for (i = 0; i < N_ADDRS; i++) {
+        const NMPlatformIP4Address a = {
+            .ifindex      = ifindex,
+            .address      = htonl(0x0A140000u | (i + 1)), /* 10.20.x.y/16 */
+            .peer_address = htonl(0x0A140000u | (i + 1)),
+            .plen         = 16,
+            .lifetime     = NM_PLATFORM_LIFETIME_PERMANENT,
+            .preferred    = NM_PLATFORM_LIFETIME_PERMANENT,
+        };
+
+        g_ptr_array_add(known_addresses, nmp_object_new(NMP_OBJECT_TYPE_IP4_ADDRESS, &a));
+    }
+
+    g_assert(
+        _nm_platform_ip_address_sync(NM_PLATFORM_GET, AF_INET, ifindex, known_addresses, TRUE));
+
+    addrs = nmtstp_platform_ip4_address_get_all(NM_PLATFORM_GET, ifindex);
+    g_assert(addrs);
+    g_assert_cmpint(addrs->len, ==, N_ADDRS);
+    g_array_unref(addrs);
+
+    g_assert(_nm_platform_ip_address_sync(NM_PLATFORM_GET, AF_INET, ifindex, NULL, TRUE));
+
+    addrs = nmtstp_platform_ip4_address_get_all(NM_PLATFORM_GET, ifindex);
+    g_assert(addrs);
+    g_assert_cmpint(addrs->len, ==, 0);
+    g_array_unref(addrs);
+}
+
 /*****************************************************************************/
 
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
@@ -462,4 +505,5 @@ _nmtstp_setup_tests(void)
 
     add_test_func("/address/ipv4/peer", test_ip4_address_peer);
     add_test_func("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+    add_test_func("/address/ipv4/sync-batch", test_ip4_address_sync_batch);
 }
@@ -559,6 +559,189 @@ test_cache_qdisc(void)
 
 /*****************************************************************************/
 
+static void
+test_obj_alloc_stats(void)
+{
+    const guint                  N_OBJS = 5000;
+    gs_unref_ptrarray GPtrArray *objs   = NULL;
+    NMPObjectAllocStats          stats_before;
+    NMPObjectAllocStats          stats;
+    guint                        i;
+
+    nmp_object_alloc_stats_get(NMP_OBJECT_TYPE_IP6_ROUTE, &stats_before);
+    g_assert_cmpint(stats_before.n_live, ==, stats_before.n_allocated - stats_before.n_freed);
+
+    objs = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+    for (i = 0; i < N_OBJS; i++)
+        g_ptr_array_add(objs, nmp_object_new(NMP_OBJECT_TYPE_IP6_ROUTE, NULL));
+
+    nmp_object_alloc_stats_get(NMP_OBJECT_TYPE_IP6_ROUTE, &stats);
+    g_assert_cmpint(stats.n_live, ==, stats_before.n_live + N_OBJS);
+    g_assert_cmpint(stats.n_allocated, ==, stats_before.n_allocated + N_OBJS);
+    g_assert_cmpint(stats.n_freed, ==, stats_before.n_freed);
+
+    /* clones count, references don't. */
+    g_ptr_array_add(objs, nmp_object_clone(objs->pdata[0], FALSE));
+    g_ptr_array_add(objs, (gpointer) nmp_object_ref(objs->pdata[0]));
+    nmp_object_alloc_stats_get(NMP_OBJECT_TYPE_IP6_ROUTE, &stats);
+    g_assert_cmpint(stats.n_live, ==, stats_before.n_live + N_OBJS + 1);
+
+    for (i = 0; i < N_OBJS; i += 2)
+        nm_clear_nmp_object((NMPObject **) &objs->pdata[i]);
+
+    nmp_object_alloc_stats_get(NMP_OBJECT_TYPE_IP6_ROUTE, &stats);
+    g_assert_cmpint(stats.n_live, ==, stats_before.n_live + N_OBJS / 2 + 2);
+    g_assert_cmpint(stats.n_freed, ==, stats_before.n_freed + N_OBJS / 2 - 1);
+
+    nm_clear_pointer(&objs, g_ptr_array_unref);
+    nmp_object_alloc_stats_get(NMP_OBJECT_TYPE_IP6_ROUTE, &stats);
+    g_assert_cmpint(stats.n_live, ==, stats_before.n_live);
+    g_assert_cmpint(stats.n_freed, ==, stats_before.n_freed + N_OBJS + 1);
+}
+
+/*****************************************************************************/
+
+static gint64
+_get_rss_kb(void)
+{
+    gs_free char *contents = NULL;
+    const char *  s;
+
+    if (!g_file_get_contents("/proc/self/status", &contents, NULL, NULL))
+        return -1;
+    s = strstr(contents, "\nVmRSS:");
+    if (!s)
+        return -1;
+    return g_ascii_strtoll(&s[NM_STRLEN("\nVmRSS:")], NULL, 10);
+}
+
+static NMPObject *
+_cache_route_bench_obj(guint idx, gboolean single_table, guint32 r_rtm_flags)
+{
+    NMPObject *obj;
+
+    /* With @single_table, all routes are on one interface in the main table,
+     * like a full BGP feed. Otherwise they are spread over 16 interfaces and
+     * 4 tables. */
+    obj                          = nmp_object_new(NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+    obj->ip4_route.ifindex       = 2 + (single_table ? 0 : (idx % 16));
+    obj->ip4_route.network       = htonl(0x0A000000u + idx);
+    obj->ip4_route.plen          = 32;
+    obj->ip4_route.gateway       = htonl(0xC0A80001u + (single_table ? 0 : (idx % 16)));
+    obj->ip4_route.table_coerced = nm_platform_route_table_coerce(
+        single_table ? RT_TABLE_MAIN : 100 + (idx % 4));
+    obj->ip4_route.metric        = 100;
+    obj->ip4_route.r_rtm_flags   = r_rtm_flags;
+    return obj;
+}
+
+static void
+_cache_route_bench_update(NMPCache *      cache,
+                          guint           n_routes,
+                          gboolean        single_table,
+                          guint32         r_rtm_flags,
+                          gboolean        is_dump,
+                          NMPCacheOpsType expected,
+                          const char *    what)
+{
+    gint64 start_time;
+    gint64 time;
+    guint  i;
+
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    for (i = 0; i < n_routes; i++) {
+        nm_auto_nmpobj NMPObject *obj = _cache_route_bench_obj(i, single_table, r_rtm_flags);
+        NMPCacheOpsType           ops_type;
+
+        ops_type = nmp_cache_update_netlink_route(cache,
+                                                  obj,
+                                                  is_dump,
+                                                  is_dump ? 0 : NLM_F_REPLACE,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL);
+        g_assert_cmpint(ops_type, ==, expected);
+    }
+    time = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    g_test_message(">>> %s %u routes: %" G_GINT64_FORMAT " msec (%" G_GINT64_FORMAT
+                   " nsec/route), RSS %" G_GINT64_FORMAT " kB",
+                   what,
+                   n_routes,
+                   time / NM_UTILS_NSEC_PER_MSEC,
+                   time / n_routes,
+                   _get_rss_kb());
+}
+
+typedef struct {
+    guint    n_routes;
+    gboolean single_table;
+} CacheRouteBenchData;
+
+static void
+test_cache_route_bench(gconstpointer user_data)
+{
+    const CacheRouteBenchData *     data         = user_data;
+    const guint                     n_routes     = data->n_routes;
+    const gboolean                  single_table = data->single_table;
+    NMPCache *                      cache;
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+    NMPLookup                                          lookup;
+    const NMDedupMultiHeadEntry *                      head_entry;
+
+    if (n_routes > 1000 && nmtst_test_quick()) {
+        g_test_skip("Skip long running test (NMTST_DEBUG=slow)");
+        return;
+    }
+
+    multi_idx = nm_dedup_multi_index_new();
+    cache     = nmp_cache_new(multi_idx, FALSE);
+
+    g_test_message(">>> RSS before: %" G_GINT64_FORMAT " kB", _get_rss_kb());
+
+    _cache_route_bench_update(cache, n_routes, single_table, 0, TRUE, NMP_CACHE_OPS_ADDED, "dump");
+
+    head_entry =
+        nmp_cache_lookup(cache, nmp_lookup_init_obj_type(&lookup, NMP_OBJECT_TYPE_IP4_ROUTE));
+    g_assert(head_entry);
+    g_assert_cmpint(head_entry->len, ==, n_routes);
+
+    head_entry = nmp_cache_lookup(cache,
+                                  nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_IP4_ROUTE, 2));
+    g_assert(head_entry);
+    g_assert_cmpint(head_entry->len, ==, single_table ? n_routes : (n_routes + 15) / 16);
+
+    _cache_route_bench_update(cache,
+                              n_routes,
+                              single_table,
+                              0,
+                              TRUE,
+                              NMP_CACHE_OPS_UNCHANGED,
+                              "redump");
+    _cache_route_bench_update(cache,
+                              n_routes,
+                              single_table,
+                              RTNH_F_DEAD,
+                              FALSE,
+                              NMP_CACHE_OPS_UPDATED,
+                              "update");
+    _cache_route_bench_update(cache,
+                              n_routes,
+                              single_table,
+                              RTM_F_CLONED,
+                              FALSE,
+                              NMP_CACHE_OPS_REMOVED,
+                              "remove");
+
+    g_assert(
+        !nmp_cache_lookup(cache, nmp_lookup_init_obj_type(&lookup, NMP_OBJECT_TYPE_IP4_ROUTE)));
+
+    nmp_cache_free(cache);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -601,8 +784,29 @@ main(int argc, char **argv)
     }
 
     g_test_add_func("/nmp-object/obj-base", test_obj_base);
+    g_test_add_func("/nmp-object/obj-alloc-stats", test_obj_alloc_stats);
     g_test_add_func("/nmp-object/cache_link", test_cache_link);
     g_test_add_func("/nmp-object/cache_qdisc", test_cache_qdisc);
+    {
+        static const CacheRouteBenchData bench_data[] = {
+            {.n_routes = 1000},
+            {.n_routes = 100000},
+            {.n_routes = 500000},
+            {.n_routes = 1000000},
+            {.n_routes = 1000, .single_table = TRUE},
+            {.n_routes = 1000000, .single_table = TRUE},
+        };
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS(bench_data); i++) {
+            gs_free char *path = NULL;
+
+            path = g_strdup_printf("/nmp-object/cache_route_bench/%s%u",
+                                   bench_data[i].single_table ? "single-table/" : "",
+                                   bench_data[i].n_routes);
+            g_test_add_data_func(path, &bench_data[i], test_cache_route_bench);
+        }
+    }
 
     result = g_test_run();
 
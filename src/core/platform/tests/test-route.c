@@ -728,6 +728,259 @@ test_ip4_route_options(gconstpointer test_data)
 #undef RTS_MAX
 }
 
+static void
+test_ip4_route_sync_batch(void)
+{
+    const int IFINDEX = nm_platform_link_get_ifindex(NM_PLATFORM_GET, DEVICE_NAME);
+    gs_unref_ptrarray GPtrArray *routes       = NULL;
+    gs_unref_ptrarray GPtrArray *routes_prune = NULL;
+    gs_unref_ptrarray GPtrArray *routes_plat  = NULL;
+    const guint                  N_ROUTES     = 500;
+    guint                        i;
+
+    /* more routes than fit into one netlink batch. The gateway routes come
+     * first in the list, but can only succeed if the device route for the
+     * gateway was already added. */
+    routes = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+    for (i = 0; i < N_ROUTES; i++) {
+        const NMPlatformIP4Route r = {
+            .ifindex   = IFINDEX,
+            .rt_source = NM_IP_CONFIG_SOURCE_USER,
+            .network   = htonl(0xAC140000u | (i << 8)), /* 172.20.x.0/24 */
+            .plen      = 24,
+            .gateway   = nmtst_inet4_from_string("172.30.0.1"),
+            .metric    = 20,
+        };
+
+        g_ptr_array_add(routes, nmp_object_new(NMP_OBJECT_TYPE_IP4_ROUTE, &r));
+    }
+    g_ptr_array_add(routes,
+                    nmp_object_new(NMP_OBJECT_TYPE_IP4_ROUTE,
+                                   &((const NMPlatformIP4Route){
+                                       .ifindex   = IFINDEX,
+                                       .rt_source = NM_IP_CONFIG_SOURCE_USER,
+                                       .network   = nmtst_inet4_from_string("172.30.0.0"),
+                                       .plen      = 16,
+                                       .metric    = 20,
+                                   })));
+
+    g_assert(nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, routes, NULL, NULL));
+
+    routes_plat = nmtstp_ip4_route_get_all(NM_PLATFORM_GET, IFINDEX);
+    g_assert_cmpint(routes_plat->len, ==, N_ROUTES + 1);
+    nm_clear_pointer(&routes_plat, g_ptr_array_unref);
+
+    /* syncing again is a no-op. */
+    g_assert(nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, routes, NULL, NULL));
+
+    routes_prune = nm_platform_ip_route_get_prune_list(NM_PLATFORM_GET,
+                                                       AF_INET,
+                                                       IFINDEX,
+                                                       NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune);
+    g_assert_cmpint(routes_prune->len, ==, N_ROUTES + 1);
+
+    g_assert(
+        nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, NULL, routes_prune, NULL));
+
+    routes_plat = nmtstp_ip4_route_get_all(NM_PLATFORM_GET, IFINDEX);
+    g_assert(!routes_plat || routes_plat->len == 0);
+}
+
+static void
+test_ip4_route_prune_list_cached(void)
+{
+    const int IFINDEX = nm_platform_link_get_ifindex(NM_PLATFORM_GET, DEVICE_NAME);
+    gs_unref_ptrarray GPtrArray *routes        = NULL;
+    gs_unref_ptrarray GPtrArray *routes_prune1 = NULL;
+    gs_unref_ptrarray GPtrArray *routes_prune2 = NULL;
+    gs_unref_ptrarray GPtrArray *routes_prune3 = NULL;
+    gs_unref_ptrarray GPtrArray *routes_plat   = NULL;
+    const guint                  N_ROUTES      = 50;
+    guint                        i;
+
+    routes = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+    for (i = 0; i < N_ROUTES + 1; i++) {
+        const NMPlatformIP4Route r = {
+            .ifindex   = IFINDEX,
+            .rt_source = NM_IP_CONFIG_SOURCE_USER,
+            .network   = htonl(0xAC140000u | (i << 8)), /* 172.20.x.0/24 */
+            .plen      = 24,
+            .metric    = 20,
+        };
+
+        g_ptr_array_add(routes, nmp_object_new(NMP_OBJECT_TYPE_IP4_ROUTE, &r));
+    }
+
+    /* first only configure N_ROUTES, the last one is added later. */
+    g_ptr_array_set_size(routes, N_ROUTES);
+    g_assert(nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, routes, NULL, NULL));
+
+    routes_prune1 = nm_platform_ip_route_get_prune_list_cached(NM_PLATFORM_GET,
+                                                               AF_INET,
+                                                               IFINDEX,
+                                                               NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune1);
+    g_assert_cmpint(routes_prune1->len, ==, N_ROUTES);
+
+    /* nothing changed, we get the same list again. */
+    routes_prune2 = nm_platform_ip_route_get_prune_list_cached(NM_PLATFORM_GET,
+                                                               AF_INET,
+                                                               IFINDEX,
+                                                               NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune2 == routes_prune1);
+    nm_clear_pointer(&routes_prune2, g_ptr_array_unref);
+
+    nmtstp_ip4_route_add(NM_PLATFORM_GET,
+                         IFINDEX,
+                         NM_IP_CONFIG_SOURCE_USER,
+                         htonl(0xAC140000u | (N_ROUTES << 8)),
+                         24,
+                         INADDR_ANY,
+                         0,
+                         20,
+                         0);
+
+    /* the new route is merged with the previous ones. */
+    routes_prune2 = nm_platform_ip_route_get_prune_list_cached(NM_PLATFORM_GET,
+                                                               AF_INET,
+                                                               IFINDEX,
+                                                               NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune2);
+    g_assert(routes_prune2 != routes_prune1);
+    g_assert_cmpint(routes_prune2->len, ==, N_ROUTES + 1);
+
+    routes_prune3 = nm_platform_ip_route_get_prune_list(NM_PLATFORM_GET,
+                                                        AF_INET,
+                                                        IFINDEX,
+                                                        NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune3);
+    g_assert_cmpint(routes_prune3->len, ==, routes_prune2->len);
+    for (i = 0; i < routes_prune3->len; i++)
+        g_assert(nm_utils_ptrarray_find_first((gconstpointer *) routes_prune2->pdata,
+                                              routes_prune2->len,
+                                              routes_prune3->pdata[i])
+                 >= 0);
+
+    g_assert(
+        nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, NULL, routes_prune2, NULL));
+
+    routes_plat = nmtstp_ip4_route_get_all(NM_PLATFORM_GET, IFINDEX);
+    g_assert(!routes_plat || routes_plat->len == 0);
+
+    g_assert(!nm_platform_ip_route_get_prune_list_cached(NM_PLATFORM_GET,
+                                                         AF_INET,
+                                                         IFINDEX,
+                                                         NM_IP_ROUTE_TABLE_SYNC_MODE_ALL));
+}
+
+typedef struct {
+    int   ifindex;
+    guint n_batches;
+    guint n_added;
+    guint n_removed;
+} ChangesBatchData;
+
+static void
+_changes_batch_cb(NMPlatform *                            platform,
+                  const NMPlatformSignalChangeBatchEntry *entries,
+                  guint                                   n_entries,
+                  ChangesBatchData *                      data)
+{
+    guint i;
+
+    g_assert(entries);
+    g_assert_cmpint(n_entries, >, 0);
+
+    data->n_batches++;
+    for (i = 0; i < n_entries; i++) {
+        g_assert(NMP_OBJECT_IS_VALID(entries[i].obj));
+        if (NMP_OBJECT_GET_TYPE(entries[i].obj) != NMP_OBJECT_TYPE_IP4_ROUTE
+            || NMP_OBJECT_CAST_IP4_ROUTE(entries[i].obj)->ifindex != data->ifindex)
+            continue;
+        if (entries[i].change_type == NM_PLATFORM_SIGNAL_ADDED)
+            data->n_added++;
+        else if (entries[i].change_type == NM_PLATFORM_SIGNAL_REMOVED)
+            data->n_removed++;
+    }
+}
+
+static void
+test_ip4_route_changes_batch(void)
+{
+    const int IFINDEX = nm_platform_link_get_ifindex(NM_PLATFORM_GET, DEVICE_NAME);
+    gs_unref_ptrarray GPtrArray *routes       = NULL;
+    gs_unref_ptrarray GPtrArray *routes_prune = NULL;
+    const guint                  N_ROUTES     = 50;
+    ChangesBatchData             data;
+    gulong                       signal_id;
+    guint                        i;
+
+    data = (ChangesBatchData){
+        .ifindex = IFINDEX,
+    };
+    signal_id = g_signal_connect(NM_PLATFORM_GET,
+                                 NM_PLATFORM_SIGNAL_CHANGES_BATCH,
+                                 G_CALLBACK(_changes_batch_cb),
+                                 &data);
+
+    routes = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+    for (i = 0; i < N_ROUTES; i++) {
+        const NMPlatformIP4Route r = {
+            .ifindex   = IFINDEX,
+            .rt_source = NM_IP_CONFIG_SOURCE_USER,
+            .network   = htonl(0xAC150000u | (i << 8)), /* 172.21.x.0/24 */
+            .plen      = 24,
+            .metric    = 20,
+        };
+
+        g_ptr_array_add(routes, nmp_object_new(NMP_OBJECT_TYPE_IP4_ROUTE, &r));
+    }
+
+    /* all changes of one sync are reported together, once the main loop gets
+     * idle. */
+    g_assert(nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, routes, NULL, NULL));
+    g_assert_cmpint(data.n_batches, ==, 0);
+    nmtst_main_context_iterate_until_assert(NULL, 1000, data.n_batches > 0);
+    g_assert_cmpint(data.n_batches, ==, 1);
+    g_assert_cmpint(data.n_added, ==, N_ROUTES);
+
+    routes_prune = nm_platform_ip_route_get_prune_list(NM_PLATFORM_GET,
+                                                       AF_INET,
+                                                       IFINDEX,
+                                                       NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune);
+
+    data.n_batches = 0;
+    g_assert(
+        nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, NULL, routes_prune, NULL));
+    nmtst_main_context_iterate_until_assert(NULL, 1000, data.n_batches > 0);
+    g_assert_cmpint(data.n_batches, ==, 1);
+    g_assert_cmpint(data.n_removed, >=, N_ROUTES);
+
+    /* changes of the same route within one batch are coalesced. A route that
+     * gets added and removed again is only reported as removed. */
+    data.n_batches = 0;
+    data.n_added   = 0;
+    data.n_removed = 0;
+    g_assert(nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, routes, NULL, NULL));
+    nm_clear_pointer(&routes_prune, g_ptr_array_unref);
+    routes_prune = nm_platform_ip_route_get_prune_list(NM_PLATFORM_GET,
+                                                       AF_INET,
+                                                       IFINDEX,
+                                                       NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+    g_assert(routes_prune);
+    g_assert(
+        nm_platform_ip_route_sync(NM_PLATFORM_GET, AF_INET, IFINDEX, NULL, routes_prune, NULL));
+    g_assert_cmpint(data.n_batches, ==, 0);
+    nmtst_main_context_iterate_until_assert(NULL, 1000, data.n_batches > 0);
+    g_assert_cmpint(data.n_batches, ==, 1);
+    g_assert_cmpint(data.n_added, ==, 0);
+    g_assert_cmpint(data.n_removed, >=, N_ROUTES);
+
+    nm_clear_g_signal_handler(NM_PLATFORM_GET, &signal_id);
+}
+
 static void
 test_ip6_route_get(void)
 {
@@ -1909,6 +2162,9 @@ _nmtstp_setup_tests(void)
     add_test_func_data("/route/ip6_options/1", test_ip6_route_options, GINT_TO_POINTER(1));
     add_test_func_data("/route/ip6_options/2", test_ip6_route_options, GINT_TO_POINTER(2));
     add_test_func_data("/route/ip6_options/3", test_ip6_route_options, GINT_TO_POINTER(3));
+    add_test_func("/route/ip4_sync_batch", test_ip4_route_sync_batch);
+    add_test_func("/route/ip4_prune_list_cached", test_ip4_route_prune_list_cached);
+    add_test_func("/route/ip4_changes_batch", test_ip4_route_changes_batch);
 
     if (nmtstp_is_root_test()) {
         add_test_func_data("/route/ip/1", test_ip, GINT_TO_POINTER(1));
@@ -2601,6 +2601,7 @@ nm_settings_connection_init(NMSettingsConnection *self)
     self->_priv = priv;
 
     c_list_init(&self->_connections_lst);
+    nm_sett_util_autoconnect_idx_entry_init(&self->_autoconnect_idx_entry);
 
     c_list_init(&priv->call_ids_lst_head);
     c_list_init(&priv->auth_lst_head);
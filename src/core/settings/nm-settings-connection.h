@@ -10,7 +10,7 @@
 #include "nm-dbus-object.h"
 #include "nm-connection.h"
 
-#include "nm-settings-storage.h"
+#include "nm-settings-utils.h"
 
 /*****************************************************************************/
 
@@ -205,8 +205,13 @@ typedef struct _NMSettingsConnectionClass NMSettingsConnectionClass;
 struct _NMSettingsConnectionPrivate;
 
 struct _NMSettingsConnection {
-    NMDBusObject                         parent;
-    CList                                _connections_lst;
+    NMDBusObject parent;
+    CList        _connections_lst;
+
+    /* Owned by NMSettings. The entry in the autoconnect index (by connection
+     * type and interface name). */
+    NMSettUtilAutoconnectIdxEntry _autoconnect_idx_entry;
+
     struct _NMSettingsConnectionPrivate *_priv;
 };
 
@@ -159,3 +159,195 @@ nm_sett_util_storages_steal(NMSettUtilStorages *storages,
 
     return storage;
 }
+
+/*****************************************************************************/
+
+/* The index is not sorted, because the autoconnect order also depends on the
+ * timestamp of the last activation, which changes independently. */
+
+typedef struct {
+    GHashTable *buckets;
+    char        iface[];
+} AutoconnectIdxIface;
+
+typedef struct _NMSettUtilAutoconnectIdxBucket {
+    AutoconnectIdxIface *idx_iface;
+    CList                entries_lst_head;
+    char                 type[];
+} AutoconnectIdxBucket;
+
+static void
+_autoconnect_idx_iface_free(gpointer ptr)
+{
+    AutoconnectIdxIface *idx_iface = ptr;
+
+    nm_assert(g_hash_table_size(idx_iface->buckets) == 0);
+
+    g_hash_table_unref(idx_iface->buckets);
+    g_free(idx_iface);
+}
+
+static void
+_autoconnect_idx_bucket_free(gpointer ptr)
+{
+    AutoconnectIdxBucket *bucket = ptr;
+
+    nm_assert(c_list_is_empty(&bucket->entries_lst_head));
+
+    g_free(bucket);
+}
+
+void
+nm_sett_util_autoconnect_idx_init(NMSettUtilAutoconnectIdx *idx)
+{
+    idx->idx_by_iface =
+        g_hash_table_new_full(nm_str_hash, g_str_equal, NULL, _autoconnect_idx_iface_free);
+}
+
+void
+nm_sett_util_autoconnect_idx_clear(NMSettUtilAutoconnectIdx *idx)
+{
+    nm_assert(nm_g_hash_table_size(idx->idx_by_iface) == 0);
+    nm_clear_pointer(&idx->idx_by_iface, g_hash_table_destroy);
+}
+
+void
+nm_sett_util_autoconnect_idx_remove(NMSettUtilAutoconnectIdx *     idx,
+                                    NMSettUtilAutoconnectIdxEntry *entry)
+{
+    AutoconnectIdxBucket *bucket = entry->_bucket;
+    AutoconnectIdxIface * idx_iface;
+
+    if (!bucket)
+        return;
+
+    c_list_unlink(&entry->_bucket_lst);
+    entry->_bucket = NULL;
+
+    if (!c_list_is_empty(&bucket->entries_lst_head))
+        return;
+
+    idx_iface = bucket->idx_iface;
+    g_hash_table_remove(idx_iface->buckets, bucket->type);
+    if (g_hash_table_size(idx_iface->buckets) == 0)
+        g_hash_table_remove(idx->idx_by_iface, idx_iface->iface);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_update:
+ * @idx: the autoconnect index
+ * @entry: the entry of the profile
+ * @type: (allow-none): the "connection.type" of the profile
+ * @iface: (allow-none): the "connection.interface-name" of the profile
+ *
+ * Adds @entry to @idx, or moves it if @type or @iface changed.
+ */
+void
+nm_sett_util_autoconnect_idx_update(NMSettUtilAutoconnectIdx *     idx,
+                                    NMSettUtilAutoconnectIdxEntry *entry,
+                                    const char *                   type,
+                                    const char *                   iface)
+{
+    AutoconnectIdxBucket *bucket;
+    AutoconnectIdxIface * idx_iface;
+    gsize                 l;
+
+    /* profiles without interface name are stored with "". */
+    type  = type ?: "";
+    iface = iface ?: "";
+
+    bucket = entry->_bucket;
+    if (bucket && nm_streq(bucket->type, type) && nm_streq(bucket->idx_iface->iface, iface)) {
+        /* unchanged. */
+        return;
+    }
+
+    nm_sett_util_autoconnect_idx_remove(idx, entry);
+
+    idx_iface = g_hash_table_lookup(idx->idx_by_iface, iface);
+    if (!idx_iface) {
+        l         = strlen(iface) + 1;
+        idx_iface = g_malloc(sizeof(AutoconnectIdxIface) + l);
+        memcpy(idx_iface->iface, iface, l);
+        idx_iface->buckets =
+            g_hash_table_new_full(nm_str_hash, g_str_equal, NULL, _autoconnect_idx_bucket_free);
+        g_hash_table_insert(idx->idx_by_iface, idx_iface->iface, idx_iface);
+    }
+
+    bucket = g_hash_table_lookup(idx_iface->buckets, type);
+    if (!bucket) {
+        l                 = strlen(type) + 1;
+        bucket            = g_malloc(sizeof(AutoconnectIdxBucket) + l);
+        bucket->idx_iface = idx_iface;
+        c_list_init(&bucket->entries_lst_head);
+        memcpy(bucket->type, type, l);
+        g_hash_table_insert(idx_iface->buckets, bucket->type, bucket);
+    }
+
+    c_list_link_tail(&bucket->entries_lst_head, &entry->_bucket_lst);
+    entry->_bucket = bucket;
+}
+
+static void
+_autoconnect_idx_bucket_collect(AutoconnectIdxBucket *bucket, GPtrArray *out_entries)
+{
+    NMSettUtilAutoconnectIdxEntry *entry;
+
+    c_list_for_each_entry (entry, &bucket->entries_lst_head, _bucket_lst)
+        g_ptr_array_add(out_entries, entry);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_lookup:
+ * @idx: the autoconnect index
+ * @types: (allow-none): the connection types to look up, or %NULL for
+ *   all types.
+ * @n_types: the number of @types.
+ * @iface: (allow-none): the interface name of the device.
+ * @out_entries: the #NMSettUtilAutoconnectIdxEntry entries are appended
+ *   to this array.
+ *
+ * Looks up the entries of a type in @types, whose interface name is either
+ * unset or equal to @iface.
+ */
+void
+nm_sett_util_autoconnect_idx_lookup(NMSettUtilAutoconnectIdx *idx,
+                                    const char *const *       types,
+                                    guint                     n_types,
+                                    const char *              iface,
+                                    GPtrArray *               out_entries)
+{
+    AutoconnectIdxIface * idx_iface;
+    AutoconnectIdxBucket *bucket;
+    GHashTableIter        h_iter;
+    const char *          ifaces[2];
+    guint                 i, j;
+
+    nm_assert(types || n_types == 0);
+    nm_assert(out_entries);
+
+    ifaces[0] = "";
+    ifaces[1] = nm_str_not_empty(iface);
+
+    for (i = 0; i < G_N_ELEMENTS(ifaces); i++) {
+        if (!ifaces[i])
+            continue;
+
+        idx_iface = g_hash_table_lookup(idx->idx_by_iface, ifaces[i]);
+        if (!idx_iface)
+            continue;
+
+        if (!types) {
+            g_hash_table_iter_init(&h_iter, idx_iface->buckets);
+            while (g_hash_table_iter_next(&h_iter, NULL, (gpointer *) &bucket))
+                _autoconnect_idx_bucket_collect(bucket, out_entries);
+            continue;
+        }
+
+        for (j = 0; j < n_types; j++) {
+            bucket = g_hash_table_lookup(idx_iface->buckets, types[j]);
+            if (bucket)
+                _autoconnect_idx_bucket_collect(bucket, out_entries);
+        }
+    }
+}
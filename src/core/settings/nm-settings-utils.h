@@ -88,4 +88,45 @@ typedef struct {
 
 gboolean nm_sett_util_allow_filename_cb(const char *filename, gpointer user_data);
 
+/*****************************************************************************/
+
+/* The autoconnect index groups profiles by "connection.interface-name" and
+ * by "connection.type". The entries are embedded in the indexed objects. */
+
+struct _NMSettUtilAutoconnectIdxBucket;
+
+typedef struct {
+    CList                                   _bucket_lst;
+    struct _NMSettUtilAutoconnectIdxBucket *_bucket;
+} NMSettUtilAutoconnectIdxEntry;
+
+typedef struct {
+    GHashTable *idx_by_iface;
+} NMSettUtilAutoconnectIdx;
+
+void nm_sett_util_autoconnect_idx_init(NMSettUtilAutoconnectIdx *idx);
+
+void nm_sett_util_autoconnect_idx_clear(NMSettUtilAutoconnectIdx *idx);
+
+static inline void
+nm_sett_util_autoconnect_idx_entry_init(NMSettUtilAutoconnectIdxEntry *entry)
+{
+    c_list_init(&entry->_bucket_lst);
+    entry->_bucket = NULL;
+}
+
+void nm_sett_util_autoconnect_idx_update(NMSettUtilAutoconnectIdx *     idx,
+                                         NMSettUtilAutoconnectIdxEntry *entry,
+                                         const char *                   type,
+                                         const char *                   iface);
+
+void nm_sett_util_autoconnect_idx_remove(NMSettUtilAutoconnectIdx *     idx,
+                                         NMSettUtilAutoconnectIdxEntry *entry);
+
+void nm_sett_util_autoconnect_idx_lookup(NMSettUtilAutoconnectIdx *idx,
+                                         const char *const *       types,
+                                         guint                     n_types,
+                                         const char *              iface,
+                                         GPtrArray *               out_entries);
+
 #endif /* __NM_SETTINGS_UTILS_H__ */
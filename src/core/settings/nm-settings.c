@@ -51,6 +51,7 @@
 #include "nm-dbus-object.h"
 #include "devices/nm-device-ethernet.h"
 #include "nm-settings-connection.h"
+#include "nm-settings-utils.h"
 #include "nm-settings-plugin.h"
 #include "nm-dbus-manager.h"
 #include "nm-auth-utils.h"
@@ -365,6 +366,11 @@ typedef struct {
 
     GHashTable *sce_idx;
 
+    /* The profiles by "connection.interface-name" and "connection.type". For a
+     * device, only the profiles with a matching (or no) interface name and a
+     * compatible type are plausible candidates for autoconnect. */
+    NMSettUtilAutoconnectIdx autoconnect_idx;
+
     CList sce_dirty_lst_head;
 
     CList connections_lst_head;
@@ -1057,6 +1063,11 @@ _connection_changed_update(NMSettings *                     self,
 
     _nm_settings_connection_set_connection(sett_conn, connection, &connection_old, update_reason);
 
+    nm_sett_util_autoconnect_idx_update(&priv->autoconnect_idx,
+                                        &sett_conn->_autoconnect_idx_entry,
+                                        nm_connection_get_connection_type(connection),
+                                        nm_connection_get_interface_name(connection));
+
     if (is_new) {
         _nm_settings_connection_register_kf_dbs(sett_conn,
                                                 priv->kf_db_timestamps,
@@ -1180,6 +1191,8 @@ _connection_changed_delete(NMSettings *          self,
     priv->connections_len--;
     priv->connections_generation++;
 
+    nm_sett_util_autoconnect_idx_remove(&priv->autoconnect_idx, &sett_conn->_autoconnect_idx_entry);
+
     /* Tell agents to remove secrets for this connection */
     connection_for_agents =
         nm_simple_connection_new_clone(nm_settings_connection_get_connection(sett_conn));
@@ -3081,6 +3094,75 @@ nm_settings_get_connections_clone(NMSettings *                   self,
     return list;
 }
 
+/**
+ * nm_settings_get_autoconnect_candidates:
+ * @self: the #NMSettings
+ * @connection_types: (allow-none): the connection types that are
+ *   compatible with the device, or %NULL if any type may be.
+ * @n_connection_types: the number of @connection_types.
+ * @iface: (allow-none): the interface name of the device.
+ * @out_len: (allow-none): optional output argument
+ * @func: (allow-none): caller-supplied function for filtering connections
+ * @func_data: caller-supplied data passed to @func
+ *
+ * Looks up the profiles in the autoconnect index that could be used
+ * on a device with interface name @iface that supports @connection_types.
+ * Those are profiles of a matching type, whose "connection.interface-name"
+ * is either unset or equal to @iface. The caller still needs to check
+ * whether the profiles are really compatible.
+ *
+ * Returns: (transfer container) (element-type NMSettingsConnection):
+ *   a NULL terminated array of #NMSettingsConnection objects, sorted
+ *   by nm_settings_connection_cmp_autoconnect_priority().
+ *   Caller is responsible for freeing the returned array with free(),
+ *   the contained values do not need to be unrefed.
+ */
+NMSettingsConnection **
+nm_settings_get_autoconnect_candidates(NMSettings *                   self,
+                                       const char *const *            connection_types,
+                                       guint                          n_connection_types,
+                                       const char *                   iface,
+                                       guint *                        out_len,
+                                       NMSettingsConnectionFilterFunc func,
+                                       gpointer                       func_data)
+{
+    NMSettingsPrivate *priv;
+    GPtrArray *        arr;
+    guint              i, j;
+
+    g_return_val_if_fail(NM_IS_SETTINGS(self), NULL);
+    nm_assert(connection_types || n_connection_types == 0);
+
+    priv = NM_SETTINGS_GET_PRIVATE(self);
+
+    arr = g_ptr_array_new();
+
+    nm_sett_util_autoconnect_idx_lookup(&priv->autoconnect_idx,
+                                        connection_types,
+                                        n_connection_types,
+                                        iface,
+                                        arr);
+
+    for (i = 0, j = 0; i < arr->len; i++) {
+        NMSettingsConnection *sett_conn =
+            c_list_entry(arr->pdata[i], NMSettingsConnection, _autoconnect_idx_entry);
+
+        if (!func || func(self, sett_conn, func_data))
+            arr->pdata[j++] = sett_conn;
+    }
+    g_ptr_array_set_size(arr, j);
+
+    if (arr->len > 1) {
+        g_ptr_array_sort_with_data(arr,
+                                   nm_settings_connection_cmp_autoconnect_priority_p_with_data,
+                                   NULL);
+    }
+
+    NM_SET_OUT(out_len, arr->len);
+    g_ptr_array_add(arr, NULL);
+    return (NMSettingsConnection **) g_ptr_array_free(arr, FALSE);
+}
+
 NMSettingsConnection *
 nm_settings_get_connection_by_path(NMSettings *self, const char *path)
 {
@@ -3847,6 +3929,8 @@ nm_settings_init(NMSettings *self)
                                           NULL,
                                           (GDestroyNotify) _sett_conn_entry_free);
 
+    nm_sett_util_autoconnect_idx_init(&priv->autoconnect_idx);
+
     priv->config = g_object_ref(nm_config_get());
 
     priv->agent_mgr = g_object_ref(nm_agent_manager_get());
@@ -3918,6 +4002,8 @@ finalize(GObject *object)
 
     nm_clear_pointer(&priv->sce_idx, g_hash_table_destroy);
 
+    nm_sett_util_autoconnect_idx_clear(&priv->autoconnect_idx);
+
     g_slist_free_full(priv->unmanaged_specs, g_free);
     g_slist_free_full(priv->unrecognized_specs, g_free);
 
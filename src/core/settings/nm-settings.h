@@ -86,6 +86,15 @@ NMSettingsConnection **nm_settings_get_connections_clone(NMSettings *
                                                          GCompareDataFunc sort_compare_func,
                                                          gpointer         sort_data);
 
+NMSettingsConnection **
+nm_settings_get_autoconnect_candidates(NMSettings *                   self,
+                                       const char *const *            connection_types,
+                                       guint                          n_connection_types,
+                                       const char *                   iface,
+                                       guint *                        out_len,
+                                       NMSettingsConnectionFilterFunc func,
+                                       gpointer                       func_data);
+
 gboolean nm_settings_add_connection(NMSettings *                    settings,
                                     NMConnection *                  connection,
                                     NMSettingsConnectionPersistMode persist_mode,
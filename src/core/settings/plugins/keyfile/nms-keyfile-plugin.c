@@ -34,6 +34,7 @@
 #include "nms-keyfile-storage.h"
 #include "nms-keyfile-writer.h"
 #include "nms-keyfile-reader.h"
+#include "nms-keyfile-snapshot.h"
 #include "nms-keyfile-utils.h"
 
 /*****************************************************************************/
@@ -58,6 +59,10 @@ typedef struct {
     char *dirname_etc;
     char *dirname_run;
 
+    /* the file for caching the parsed profiles, or %NULL to not use a
+     * snapshot. */
+    char *snapshot_filename;
+
     NMSettUtilStorages storages;
 
 } NMSKeyfilePluginPrivate;
@@ -238,6 +243,81 @@ _read_from_file(const char * full_filename,
     return connection;
 }
 
+/* The result of reading one keyfile. When loading a directory, the files
+ * are read first (possibly in parallel, see _load_dir()) and the storages
+ * get created afterwards on the main thread. */
+typedef struct {
+    char *        full_filename;
+    NMConnection *connection;
+    GError *      error;
+    char *        shadowed_storage;
+    struct stat   st;
+    NMTernary     is_nm_generated_opt;
+    NMTernary     is_volatile_opt;
+    NMTernary     is_external_opt;
+    NMTernary     shadowed_owned_opt;
+    bool          from_snapshot : 1;
+} ReadFileData;
+
+static void
+_read_file_data_clear(ReadFileData *read_data)
+{
+    nm_clear_g_free(&read_data->full_filename);
+    g_clear_object(&read_data->connection);
+    g_clear_error(&read_data->error);
+    nm_clear_g_free(&read_data->shadowed_storage);
+}
+
+static void
+_read_file_data_lookup_snapshot(ReadFileData *read_data, NMSKeyfileSnapshot *snapshot)
+{
+    nm_assert(!read_data->connection);
+
+    if (!snapshot)
+        return;
+
+    if (!nms_keyfile_utils_check_file_permissions(NMS_KEYFILE_FILETYPE_KEYFILE,
+                                                  read_data->full_filename,
+                                                  &read_data->st,
+                                                  NULL))
+        return;
+
+    read_data->connection = nms_keyfile_snapshot_lookup(snapshot,
+                                                        read_data->full_filename,
+                                                        &read_data->st,
+                                                        &read_data->is_nm_generated_opt,
+                                                        &read_data->is_volatile_opt,
+                                                        &read_data->is_external_opt,
+                                                        &read_data->shadowed_storage,
+                                                        &read_data->shadowed_owned_opt);
+    read_data->from_snapshot = !!read_data->connection;
+}
+
+/* This may be called on a worker thread. It must not touch any state
+ * besides @read_data. */
+static void
+_read_file_data_parse(ReadFileData *read_data, const char *plugin_dir)
+{
+    nm_assert(!read_data->connection);
+    nm_assert(!read_data->error);
+
+    read_data->connection = _read_from_file(read_data->full_filename,
+                                            plugin_dir,
+                                            &read_data->st,
+                                            &read_data->is_nm_generated_opt,
+                                            &read_data->is_volatile_opt,
+                                            &read_data->is_external_opt,
+                                            &read_data->shadowed_storage,
+                                            &read_data->shadowed_owned_opt,
+                                            &read_data->error);
+}
+
+static void
+_read_file_data_parse_thread_fcn(gpointer data, gpointer user_data)
+{
+    _read_file_data_parse(data, user_data);
+}
+
 /*****************************************************************************/
 
 static void
@@ -297,18 +377,12 @@ _load_file(NMSKeyfilePlugin *    self,
            const char *          dirname,
            const char *          filename,
            NMSKeyfileStorageType storage_type,
+           NMSKeyfileSnapshot *  snapshot,
+           ReadFileData *        read_data,
            GError **             error)
 {
-    NMSKeyfilePluginPrivate *priv;
-    gs_unref_object NMConnection *connection = NULL;
-    NMTernary                     is_nm_generated_opt;
-    NMTernary                     is_volatile_opt;
-    NMTernary                     is_external_opt;
-    NMTernary                     shadowed_owned_opt;
-    gs_free char *                shadowed_storage = NULL;
-    gs_free_error GError *local                    = NULL;
-    gs_free char *        full_filename            = NULL;
-    struct stat           st;
+    nm_auto(_read_file_data_clear) ReadFileData read_data_local = {};
+    gs_free char *                              full_filename   = NULL;
 
     if (_ignore_filename(storage_type, filename)) {
         gs_free char *nmmeta                    = NULL;
@@ -368,37 +442,48 @@ _load_file(NMSKeyfilePlugin *    self,
                                                  shadowed_storage_filename);
     }
 
-    full_filename = g_build_filename(dirname, filename, NULL);
-
-    priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
+    if (!read_data) {
+        read_data                = &read_data_local;
+        read_data->full_filename = g_build_filename(dirname, filename, NULL);
+        _read_file_data_lookup_snapshot(read_data, snapshot);
+        if (!read_data->connection)
+            _read_file_data_parse(read_data,
+                                  _get_plugin_dir(NMS_KEYFILE_PLUGIN_GET_PRIVATE(self)));
+    }
 
-    connection = _read_from_file(full_filename,
-                                 _get_plugin_dir(priv),
-                                 &st,
-                                 &is_nm_generated_opt,
-                                 &is_volatile_opt,
-                                 &is_external_opt,
-                                 &shadowed_storage,
-                                 &shadowed_owned_opt,
-                                 &local);
-    if (!connection) {
+    if (!read_data->connection) {
+        nm_assert(read_data->error);
         if (error)
-            g_propagate_error(error, g_steal_pointer(&local));
+            g_propagate_error(error, g_steal_pointer(&read_data->error));
         else
-            _LOGW("load: \"%s\": failed to load connection: %s", full_filename, local->message);
+            _LOGW("load: \"%s\": failed to load connection: %s",
+                  read_data->full_filename,
+                  read_data->error->message);
         return NULL;
     }
 
+    if (snapshot && !read_data->from_snapshot) {
+        nms_keyfile_snapshot_add(snapshot,
+                                 read_data->full_filename,
+                                 &read_data->st,
+                                 read_data->connection,
+                                 read_data->is_nm_generated_opt,
+                                 read_data->is_volatile_opt,
+                                 read_data->is_external_opt,
+                                 read_data->shadowed_storage,
+                                 read_data->shadowed_owned_opt);
+    }
+
     return nms_keyfile_storage_new_connection(self,
-                                              g_steal_pointer(&connection),
-                                              full_filename,
+                                              g_steal_pointer(&read_data->connection),
+                                              read_data->full_filename,
                                               storage_type,
-                                              is_nm_generated_opt,
-                                              is_volatile_opt,
-                                              is_external_opt,
-                                              shadowed_storage,
-                                              shadowed_owned_opt,
-                                              &st.st_mtim);
+                                              read_data->is_nm_generated_opt,
+                                              read_data->is_volatile_opt,
+                                              read_data->is_external_opt,
+                                              read_data->shadowed_storage,
+                                              read_data->shadowed_owned_opt,
+                                              &read_data->st.st_mtim);
 }
 
 static NMSKeyfileStorage *
@@ -416,41 +501,123 @@ _load_file_from_path(NMSKeyfilePlugin *    self,
     f_filename = strrchr(full_filename, '/');
     f_dirname  = nm_strndup_a(300, full_filename, f_filename - full_filename, &f_dirname_free);
     f_filename++;
-    return _load_file(self, f_dirname, f_filename, storage_type, error);
+    return _load_file(self, f_dirname, f_filename, storage_type, NULL, NULL, error);
+}
+
+/* Parsing keyfiles is independent for each file. If there are many files to
+ * parse, do that on a pool of worker threads. The storages are still created
+ * on the main thread, in the same order as when loading serially. */
+#define LOAD_DIR_PARALLEL_MIN_FILES   32u
+#define LOAD_DIR_PARALLEL_MAX_THREADS 8u
+
+static void
+_load_dir_parse(ReadFileData *read_datas, guint n_read_datas, guint n_parse, const char *plugin_dir)
+{
+    gs_free_error GError *error = NULL;
+    GThreadPool *         pool  = NULL;
+    guint                 n_threads;
+    guint                 i;
+
+    /* Reading the files also waits for I/O, so use at least two threads. */
+    n_threads = NM_CLAMP((guint) g_get_num_processors(), 2u, LOAD_DIR_PARALLEL_MAX_THREADS);
+
+    if (n_parse >= LOAD_DIR_PARALLEL_MIN_FILES) {
+        pool = g_thread_pool_new(_read_file_data_parse_thread_fcn,
+                                 (gpointer) plugin_dir,
+                                 n_threads,
+                                 TRUE,
+                                 &error);
+        if (!pool)
+            _LOGD("load: failure to create thread pool: %s", error->message);
+        else
+            _LOGT("load: parse %u files on %u threads", n_parse, n_threads);
+    }
+
+    for (i = 0; i < n_read_datas; i++) {
+        ReadFileData *read_data = &read_datas[i];
+
+        if (!read_data->full_filename || read_data->connection)
+            continue;
+
+        if (pool)
+            g_thread_pool_push(pool, read_data, NULL);
+        else
+            _read_file_data_parse(read_data, plugin_dir);
+    }
+
+    /* wait for all files to be parsed. */
+    if (pool)
+        g_thread_pool_free(pool, FALSE, TRUE);
 }
 
 static void
 _load_dir(NMSKeyfilePlugin *    self,
           NMSKeyfileStorageType storage_type,
           const char *          dirname,
+          NMSKeyfileSnapshot *  snapshot,
           NMSettUtilStorages *  storages)
 {
     const char *       filename;
     GDir *             dir;
     gs_unref_hashtable GHashTable *dupl_filenames = NULL;
+    gs_unref_ptrarray GPtrArray *filenames        = NULL;
+    gs_free ReadFileData *read_datas              = NULL;
+    guint                 n_parse                 = 0;
+    guint                 i;
 
     dir = g_dir_open(dirname, 0, NULL);
     if (!dir)
         return;
 
     dupl_filenames = g_hash_table_new_full(nm_str_hash, g_str_equal, NULL, g_free);
+    filenames      = g_ptr_array_new();
 
     while ((filename = g_dir_read_name(dir))) {
-        gs_unref_object NMSKeyfileStorage *storage = NULL;
-
         filename = g_strdup(filename);
         if (!g_hash_table_add(dupl_filenames, (char *) filename))
             continue;
+        g_ptr_array_add(filenames, (char *) filename);
+    }
+
+    g_dir_close(dir);
+
+    /* first read the keyfiles. nmmeta files are only handled by _load_file(). */
+    read_datas = g_new0(ReadFileData, filenames->len);
+    for (i = 0; i < filenames->len; i++) {
+        ReadFileData *read_data = &read_datas[i];
+
+        filename = filenames->pdata[i];
+        if (_ignore_filename(storage_type, filename))
+            continue;
+
+        read_data->full_filename = g_build_filename(dirname, filename, NULL);
+        _read_file_data_lookup_snapshot(read_data, snapshot);
+        if (!read_data->connection)
+            n_parse++;
+    }
+
+    if (n_parse > 0)
+        _load_dir_parse(read_datas,
+                        filenames->len,
+                        n_parse,
+                        _get_plugin_dir(NMS_KEYFILE_PLUGIN_GET_PRIVATE(self)));
 
-        storage = _load_file(self, dirname, filename, storage_type, NULL);
+    for (i = 0; i < filenames->len; i++) {
+        gs_unref_object NMSKeyfileStorage *storage = NULL;
+        ReadFileData *                     read_data;
+
+        read_data = read_datas[i].full_filename ? &read_datas[i] : NULL;
+
+        storage =
+            _load_file(self, dirname, filenames->pdata[i], storage_type, snapshot, read_data, NULL);
+        if (read_data)
+            _read_file_data_clear(read_data);
         if (!storage)
             continue;
 
         nm_sett_util_storages_add_take(storages, g_steal_pointer(&storage));
     }
 
-    g_dir_close(dir);
-
 #if NM_MORE_ASSERTS
     {
         NMSKeyfileStorage *storage;
@@ -583,13 +750,27 @@ reload_connections(NMSettingsPlugin *                     plugin,
     NMSKeyfilePluginPrivate *                           priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
     nm_auto_clear_sett_util_storages NMSettUtilStorages storages_new =
         NM_SETT_UTIL_STORAGES_INIT(storages_new, nms_keyfile_storage_destroy);
-    int i;
+    nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot = NULL;
+    int                                               i;
+
+    /* Profiles in /run are not cached. They are lost on reboot anyway and
+     * are not supposed to end up on disk. */
+    if (priv->snapshot_filename)
+        snapshot = nms_keyfile_snapshot_new(priv->snapshot_filename, _get_plugin_dir(priv));
 
-    _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_RUN, priv->dirname_run, &storages_new);
+    _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_RUN, priv->dirname_run, NULL, &storages_new);
     if (priv->dirname_etc)
-        _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_ETC, priv->dirname_etc, &storages_new);
-    for (i = 0; priv->dirname_libs[i]; i++)
-        _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_LIB(i), priv->dirname_libs[i], &storages_new);
+        _load_dir(self, NMS_KEYFILE_STORAGE_TYPE_ETC, priv->dirname_etc, snapshot, &storages_new);
+    for (i = 0; priv->dirname_libs[i]; i++) {
+        _load_dir(self,
+                  NMS_KEYFILE_STORAGE_TYPE_LIB(i),
+                  priv->dirname_libs[i],
+                  snapshot,
+                  &storages_new);
+    }
+
+    if (snapshot)
+        nms_keyfile_snapshot_commit(snapshot);
 
     _storages_consolidate(self, &storages_new, TRUE, NULL, callback, user_data);
 }
@@ -675,7 +856,7 @@ load_connections(NMSettingsPlugin *                     plugin,
         if (!g_hash_table_insert(dupl_filenames, g_steal_pointer(&full_filename_keep), entry))
             nm_assert_not_reached();
 
-        storage = _load_file(self, f_dirname, f_filename, storage_type, &local);
+        storage = _load_file(self, f_dirname, f_filename, storage_type, NULL, NULL, &local);
         if (!storage) {
             if (nm_utils_file_stat(full_filename, NULL) == -ENOENT) {
                 NMSKeyfileStorage *storage2;
@@ -1224,6 +1405,9 @@ get_unmanaged_specs(NMSettingsPlugin *config)
     NMSKeyfilePluginPrivate *priv  = NMS_KEYFILE_PLUGIN_GET_PRIVATE(config);
     gs_free char *           value = NULL;
 
+    if (!priv->config)
+        return NULL;
+
     value = nm_config_data_get_value(nm_config_get_data(priv->config),
                                      NM_CONFIG_KEYFILE_GROUP_KEYFILE,
                                      NM_CONFIG_KEYFILE_KEY_KEYFILE_UNMANAGED_DEVICES,
@@ -1238,10 +1422,20 @@ nms_keyfile_plugin_init(NMSKeyfilePlugin *plugin)
 {
     NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(plugin);
 
-    priv->config = g_object_ref(nm_config_get());
-
     priv->storages = (NMSettUtilStorages) NM_SETT_UTIL_STORAGES_INIT(priv->storages,
                                                                      nms_keyfile_storage_destroy);
+}
+
+NMSKeyfilePlugin *
+nms_keyfile_plugin_new(void)
+{
+    NMSKeyfilePlugin *       self;
+    NMSKeyfilePluginPrivate *priv;
+
+    self = g_object_new(NMS_TYPE_KEYFILE_PLUGIN, NULL);
+    priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
+
+    priv->config = g_object_ref(nm_config_get());
 
     /* dirname_libs are a set of read-only directories with lower priority than /etc or /run.
      * There is nothing complicated about having multiple of such directories, so dirname_libs
@@ -1275,15 +1469,11 @@ nms_keyfile_plugin_init(NMSKeyfilePlugin *plugin)
     nm_assert(!priv->dirname_libs[0] || priv->dirname_libs[0][0] == '/');
     nm_assert(!priv->dirname_etc || priv->dirname_etc[0] == '/');
     nm_assert(priv->dirname_run && priv->dirname_run[0] == '/');
-}
 
-static void
-constructed(GObject *object)
-{
-    NMSKeyfilePlugin *       self = NMS_KEYFILE_PLUGIN(object);
-    NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
-
-    G_OBJECT_CLASS(nms_keyfile_plugin_parent_class)->constructed(object);
+    /* unit tests must not touch the snapshot in NMSTATEDIR. They can
+     * use _nmtst_keyfile_plugin_new() instead. */
+    if (!nm_utils_get_testing())
+        priv->snapshot_filename = g_strdup(NMS_KEYFILE_SNAPSHOT_FILENAME);
 
     if (nm_config_data_has_value(nm_config_get_data_orig(priv->config),
                                  NM_CONFIG_KEYFILE_GROUP_KEYFILE,
@@ -1301,12 +1491,31 @@ constructed(GObject *object)
                      NM_CONFIG_SIGNAL_CONFIG_CHANGED,
                      G_CALLBACK(config_changed_cb),
                      self);
+
+    return self;
 }
 
+/* Create a plugin that does not depend on NMConfig and only loads
+ * profiles from the given directories. */
 NMSKeyfilePlugin *
-nms_keyfile_plugin_new(void)
+_nmtst_keyfile_plugin_new(const char *dirname_etc,
+                          const char *dirname_run,
+                          const char *snapshot_filename)
 {
-    return g_object_new(NMS_TYPE_KEYFILE_PLUGIN, NULL);
+    NMSKeyfilePlugin *       self;
+    NMSKeyfilePluginPrivate *priv;
+
+    g_return_val_if_fail(!dirname_etc || dirname_etc[0] == '/', NULL);
+    g_return_val_if_fail(dirname_run && dirname_run[0] == '/', NULL);
+    g_return_val_if_fail(!nm_streq0(dirname_etc, dirname_run), NULL);
+
+    self = g_object_new(NMS_TYPE_KEYFILE_PLUGIN, NULL);
+    priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE(self);
+
+    priv->dirname_etc       = g_strdup(dirname_etc);
+    priv->dirname_run       = g_strdup(dirname_run);
+    priv->snapshot_filename = g_strdup(snapshot_filename);
+    return self;
 }
 
 static void
@@ -1323,6 +1532,7 @@ dispose(GObject *object)
     nm_clear_g_free(&priv->dirname_libs[0]);
     nm_clear_g_free(&priv->dirname_etc);
     nm_clear_g_free(&priv->dirname_run);
+    nm_clear_g_free(&priv->snapshot_filename);
 
     g_clear_object(&priv->config);
 
@@ -1335,8 +1545,7 @@ nms_keyfile_plugin_class_init(NMSKeyfilePluginClass *klass)
     GObjectClass *         object_class = G_OBJECT_CLASS(klass);
     NMSettingsPluginClass *plugin_class = NM_SETTINGS_PLUGIN_CLASS(klass);
 
-    object_class->constructed = constructed;
-    object_class->dispose     = dispose;
+    object_class->dispose = dispose;
 
     plugin_class->plugin_name         = "keyfile";
     plugin_class->get_unmanaged_specs = get_unmanaged_specs;
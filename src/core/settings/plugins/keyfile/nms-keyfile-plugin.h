@@ -30,6 +30,10 @@ GType nms_keyfile_plugin_get_type(void);
 
 NMSKeyfilePlugin *nms_keyfile_plugin_new(void);
 
+NMSKeyfilePlugin *_nmtst_keyfile_plugin_new(const char *dirname_etc,
+                                            const char *dirname_run,
+                                            const char *snapshot_filename);
+
 gboolean nms_keyfile_plugin_add_connection(NMSKeyfilePlugin *  self,
                                            NMConnection *      connection,
                                            gboolean            in_memory,
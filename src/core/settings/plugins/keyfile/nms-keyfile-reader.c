@@ -14,6 +14,11 @@
 #include "NetworkManagerUtils.h"
 #include "nms-keyfile-utils.h"
 
+/* The plugin may read keyfiles on worker threads (see _load_dir()). Logging
+ * must then take the lock of nm-logging. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
 /*****************************************************************************/
 
 static const char *
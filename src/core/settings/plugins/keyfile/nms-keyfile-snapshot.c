@@ -0,0 +1,401 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include "nms-keyfile-snapshot.h"
+
+#include <sys/stat.h>
+
+#include "libnm-core-intern/nm-core-internal.h"
+
+#include "nms-keyfile-utils.h"
+
+/*****************************************************************************/
+
+/* The snapshot caches the result of parsing and normalizing keyfiles, so that
+ * on the next start unchanged files don't need to be parsed again.
+ *
+ * It is a single serialized GVariant that gets mmapped. Every entry contains
+ * the result of nms_keyfile_reader_from_file() together with the stat
+ * information of the file at the time it was read. An entry is only used if
+ * the file still has the same device, inode, size, mode, owner and
+ * modification/change times. Otherwise, the file is parsed again.
+ *
+ * Profiles with an 802-1x setting are not cached. They may reference
+ * certificates and keys by path, and how such a path gets interpreted
+ * depends on whether the file exists (see
+ * nm_keyfile_detect_unqualified_path_scheme()). That can change without
+ * touching the keyfile itself.
+ *
+ * The snapshot contains secrets, hence it has the same permission
+ * requirements as a keyfile.
+ *
+ * Bump the version whenever the format or the reader changes in a way that
+ * would produce a different result for the same file. */
+#define SNAPSHOT_VERSION "nms-keyfile-snapshot-2 " VERSION
+
+#define SNAPSHOT_ENTRY_TYPE "(stttxxxxuuiiimsia{sa{sv}})"
+#define SNAPSHOT_TYPE       "(ssa" SNAPSHOT_ENTRY_TYPE ")"
+
+/* Files modified this recently are not cached. Another modification within
+ * the granularity of the timestamps might otherwise go unnoticed. */
+#define SNAPSHOT_RACY_SEC 2
+
+struct _NMSKeyfileSnapshot {
+    char *filename;
+    char *profile_dir;
+
+    /* the loaded snapshot. */
+    GVariant *old;
+
+    /* the entries of the loaded snapshot that were not yet used, by filename. */
+    GHashTable *old_idx;
+
+    /* the entries for the snapshot to write. */
+    GPtrArray *entries;
+
+    bool dirty : 1;
+};
+
+/*****************************************************************************/
+
+#define _NMLOG_PREFIX_NAME "keyfile"
+#define _NMLOG_DOMAIN      LOGD_SETTINGS
+#define _NMLOG(level, ...)                          \
+    nm_log((level),                                 \
+           _NMLOG_DOMAIN,                           \
+           NULL,                                    \
+           NULL,                                    \
+           "%s" _NM_UTILS_MACRO_FIRST(__VA_ARGS__), \
+           _NMLOG_PREFIX_NAME ": " _NM_UTILS_MACRO_REST(__VA_ARGS__))
+
+/*****************************************************************************/
+
+static NMTernary
+_ternary_from_int(gint32 v)
+{
+    if (v > 0)
+        return NM_TERNARY_TRUE;
+    if (v == 0)
+        return NM_TERNARY_FALSE;
+    return NM_TERNARY_DEFAULT;
+}
+
+static void
+_load(NMSKeyfileSnapshot *self)
+{
+    gs_free_error GError *error        = NULL;
+    gs_unref_bytes GBytes *bytes       = NULL;
+    gs_unref_variant GVariant *entries = NULL;
+    GMappedFile *              mapped;
+    const char *               version;
+    const char *               profile_dir;
+    gsize                      n;
+    gsize                      i;
+
+    if (!nms_keyfile_utils_check_file_permissions(NMS_KEYFILE_FILETYPE_KEYFILE,
+                                                  self->filename,
+                                                  NULL,
+                                                  &error)) {
+        _LOGT("snapshot: not using \"%s\": %s", self->filename, error->message);
+        return;
+    }
+
+    mapped = g_mapped_file_new(self->filename, FALSE, &error);
+    if (!mapped) {
+        _LOGD("snapshot: failure to map \"%s\": %s", self->filename, error->message);
+        return;
+    }
+    bytes = g_mapped_file_get_bytes(mapped);
+    g_mapped_file_unref(mapped);
+
+    /* The data is not trusted. GVariant handles malformed data gracefully,
+     * by returning default values. */
+    self->old =
+        g_variant_ref_sink(g_variant_new_from_bytes(G_VARIANT_TYPE(SNAPSHOT_TYPE), bytes, FALSE));
+
+    g_variant_get(self->old, "(&s&s@a" SNAPSHOT_ENTRY_TYPE ")", &version, &profile_dir, &entries);
+
+    if (!nm_streq(version, SNAPSHOT_VERSION) || !nm_streq(profile_dir, self->profile_dir)) {
+        _LOGD("snapshot: ignore \"%s\" with different version", self->filename);
+        nm_clear_pointer(&self->old, g_variant_unref);
+        self->dirty = TRUE;
+        return;
+    }
+
+    n = g_variant_n_children(entries);
+    for (i = 0; i < n; i++) {
+        GVariant *  entry;
+        const char *full_filename;
+
+        entry = g_variant_get_child_value(entries, i);
+        g_variant_get_child(entry, 0, "&s", &full_filename);
+        if (full_filename[0] != '/') {
+            g_variant_unref(entry);
+            continue;
+        }
+        g_hash_table_insert(self->old_idx, (char *) full_filename, entry);
+    }
+
+    _LOGD("snapshot: loaded %u entries from \"%s\"",
+          g_hash_table_size(self->old_idx),
+          self->filename);
+}
+
+NMSKeyfileSnapshot *
+nms_keyfile_snapshot_new(const char *filename, const char *profile_dir)
+{
+    NMSKeyfileSnapshot *self;
+
+    g_return_val_if_fail(filename && filename[0] == '/', NULL);
+
+    self  = g_slice_new(NMSKeyfileSnapshot);
+    *self = (NMSKeyfileSnapshot){
+        .filename    = g_strdup(filename),
+        .profile_dir = g_strdup(profile_dir ?: ""),
+        .old_idx     = g_hash_table_new_full(nm_str_hash,
+                                         g_str_equal,
+                                         NULL,
+                                         (GDestroyNotify) g_variant_unref),
+        .entries     = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref),
+    };
+
+    _load(self);
+
+    return self;
+}
+
+void
+nms_keyfile_snapshot_free(NMSKeyfileSnapshot *self)
+{
+    if (!self)
+        return;
+
+    g_hash_table_unref(self->old_idx);
+    g_ptr_array_unref(self->entries);
+    nm_g_variant_unref(self->old);
+    g_free(self->filename);
+    g_free(self->profile_dir);
+    g_slice_free(NMSKeyfileSnapshot, self);
+}
+
+/*****************************************************************************/
+
+/**
+ * nms_keyfile_snapshot_lookup:
+ * @self: the #NMSKeyfileSnapshot
+ * @full_filename: the keyfile to look up.
+ * @st: the current stat information of @full_filename.
+ * @out_is_nm_generated: (out): see nms_keyfile_reader_from_file().
+ * @out_is_volatile: (out): see nms_keyfile_reader_from_file().
+ * @out_is_external: (out): see nms_keyfile_reader_from_file().
+ * @out_shadowed_storage: (out) (transfer full): see nms_keyfile_reader_from_file().
+ * @out_shadowed_owned: (out): see nms_keyfile_reader_from_file().
+ *
+ * If the snapshot contains an entry for @full_filename that matches @st, the
+ * cached connection is returned and the entry is kept for the next snapshot.
+ *
+ * Returns: (transfer full): the cached connection or %NULL, in which case
+ *   the caller should parse the file and call nms_keyfile_snapshot_add().
+ */
+NMConnection *
+nms_keyfile_snapshot_lookup(NMSKeyfileSnapshot *self,
+                            const char *        full_filename,
+                            const struct stat * st,
+                            NMTernary *         out_is_nm_generated,
+                            NMTernary *         out_is_volatile,
+                            NMTernary *         out_is_external,
+                            char **             out_shadowed_storage,
+                            NMTernary *         out_shadowed_owned)
+{
+    gs_unref_variant GVariant *entry = NULL;
+    gs_unref_variant GVariant *dict  = NULL;
+    gs_free_error GError *error      = NULL;
+    NMConnection *        connection;
+    guint64               v_dev;
+    guint64               v_ino;
+    guint64               v_size;
+    gint64                v_mtime_sec;
+    gint64                v_mtime_nsec;
+    gint64                v_ctime_sec;
+    gint64                v_ctime_nsec;
+    guint32               v_mode;
+    guint32               v_uid;
+    gint32                v_is_nm_generated;
+    gint32                v_is_volatile;
+    gint32                v_is_external;
+    const char *          v_shadowed_storage;
+    gint32                v_shadowed_owned;
+
+    g_return_val_if_fail(self, NULL);
+    g_return_val_if_fail(full_filename && full_filename[0] == '/', NULL);
+    g_return_val_if_fail(st, NULL);
+
+    if (!g_hash_table_steal_extended(self->old_idx, full_filename, NULL, (gpointer *) &entry))
+        return NULL;
+
+    g_variant_get(entry,
+                  "(&stttxxxxuuiiim&si@a{sa{sv}})",
+                  NULL,
+                  &v_dev,
+                  &v_ino,
+                  &v_size,
+                  &v_mtime_sec,
+                  &v_mtime_nsec,
+                  &v_ctime_sec,
+                  &v_ctime_nsec,
+                  &v_mode,
+                  &v_uid,
+                  &v_is_nm_generated,
+                  &v_is_volatile,
+                  &v_is_external,
+                  &v_shadowed_storage,
+                  &v_shadowed_owned,
+                  &dict);
+
+    if (v_dev != (guint64) st->st_dev || v_ino != (guint64) st->st_ino
+        || v_size != (guint64) st->st_size || v_mtime_sec != (gint64) st->st_mtim.tv_sec
+        || v_mtime_nsec != (gint64) st->st_mtim.tv_nsec
+        || v_ctime_sec != (gint64) st->st_ctim.tv_sec
+        || v_ctime_nsec != (gint64) st->st_ctim.tv_nsec || v_mode != (guint32) st->st_mode
+        || v_uid != (guint32) st->st_uid) {
+        _LOGT("snapshot: \"%s\" changed", full_filename);
+        self->dirty = TRUE;
+        return NULL;
+    }
+
+    connection = _nm_simple_connection_new_from_dbus(dict, NM_SETTING_PARSE_FLAGS_NORMALIZE, &error);
+    if (!connection) {
+        _LOGD("snapshot: invalid entry for \"%s\": %s", full_filename, error->message);
+        self->dirty = TRUE;
+        return NULL;
+    }
+
+    g_ptr_array_add(self->entries, g_steal_pointer(&entry));
+
+    NM_SET_OUT(out_is_nm_generated, _ternary_from_int(v_is_nm_generated));
+    NM_SET_OUT(out_is_volatile, _ternary_from_int(v_is_volatile));
+    NM_SET_OUT(out_is_external, _ternary_from_int(v_is_external));
+    NM_SET_OUT(out_shadowed_storage, g_strdup(v_shadowed_storage));
+    NM_SET_OUT(out_shadowed_owned, _ternary_from_int(v_shadowed_owned));
+    return connection;
+}
+
+/**
+ * nms_keyfile_snapshot_add:
+ * @self: the #NMSKeyfileSnapshot
+ * @full_filename: the keyfile that was parsed.
+ * @st: the stat information of @full_filename, as returned by
+ *   nms_keyfile_reader_from_file().
+ * @connection: the connection that was read.
+ * @is_nm_generated: as returned by nms_keyfile_reader_from_file().
+ * @is_volatile: as returned by nms_keyfile_reader_from_file().
+ * @is_external: as returned by nms_keyfile_reader_from_file().
+ * @shadowed_storage: as returned by nms_keyfile_reader_from_file().
+ * @shadowed_owned: as returned by nms_keyfile_reader_from_file().
+ *
+ * Remember the parsed @connection for the next snapshot.
+ */
+void
+nms_keyfile_snapshot_add(NMSKeyfileSnapshot *self,
+                         const char *        full_filename,
+                         const struct stat * st,
+                         NMConnection *      connection,
+                         NMTernary           is_nm_generated,
+                         NMTernary           is_volatile,
+                         NMTernary           is_external,
+                         const char *        shadowed_storage,
+                         NMTernary           shadowed_owned)
+{
+    gint64 now;
+
+    g_return_if_fail(self);
+    g_return_if_fail(full_filename && full_filename[0] == '/');
+    g_return_if_fail(st);
+    g_return_if_fail(NM_IS_CONNECTION(connection));
+
+    if (g_hash_table_remove(self->old_idx, full_filename))
+        self->dirty = TRUE;
+
+    if (nm_connection_get_setting_802_1x(connection)) {
+        _LOGT("snapshot: don't cache \"%s\" with 802-1x setting", full_filename);
+        return;
+    }
+
+    /* Only the mtime matters here, as any write to the file updates it.
+     * Changes that only touch the ctime (chmod, chown, setting the mtime
+     * back) are still detected by nms_keyfile_snapshot_lookup(). */
+    now = time(NULL);
+    if (st->st_mtim.tv_sec > now - SNAPSHOT_RACY_SEC) {
+        _LOGT("snapshot: don't cache recently modified file \"%s\"", full_filename);
+        return;
+    }
+
+    g_ptr_array_add(
+        self->entries,
+        g_variant_ref_sink(
+            g_variant_new("(stttxxxxuuiiimsi@a{sa{sv}})",
+                          full_filename,
+                          (guint64) st->st_dev,
+                          (guint64) st->st_ino,
+                          (guint64) st->st_size,
+                          (gint64) st->st_mtim.tv_sec,
+                          (gint64) st->st_mtim.tv_nsec,
+                          (gint64) st->st_ctim.tv_sec,
+                          (gint64) st->st_ctim.tv_nsec,
+                          (guint32) st->st_mode,
+                          (guint32) st->st_uid,
+                          (gint32) is_nm_generated,
+                          (gint32) is_volatile,
+                          (gint32) is_external,
+                          shadowed_storage,
+                          (gint32) shadowed_owned,
+                          nm_connection_to_dbus(connection, NM_CONNECTION_SERIALIZE_ALL))));
+    self->dirty = TRUE;
+}
+
+/**
+ * nms_keyfile_snapshot_commit:
+ * @self: the #NMSKeyfileSnapshot
+ *
+ * Writes the snapshot with the entries that were looked up or added,
+ * unless it would be identical to the loaded one.
+ *
+ * Returns: %TRUE if the snapshot was written.
+ */
+gboolean
+nms_keyfile_snapshot_commit(NMSKeyfileSnapshot *self)
+{
+    gs_unref_variant GVariant *snapshot = NULL;
+    gs_free_error GError *error         = NULL;
+
+    g_return_val_if_fail(self, FALSE);
+
+    /* entries that were not looked up belong to files that are gone. */
+    if (!self->dirty && g_hash_table_size(self->old_idx) == 0)
+        return FALSE;
+
+    snapshot = g_variant_ref_sink(
+        g_variant_new("(ss@a" SNAPSHOT_ENTRY_TYPE ")",
+                      SNAPSHOT_VERSION,
+                      self->profile_dir,
+                      g_variant_new_array(G_VARIANT_TYPE(SNAPSHOT_ENTRY_TYPE),
+                                          (GVariant *const *) self->entries->pdata,
+                                          self->entries->len)));
+
+    if (!nm_utils_file_set_contents(self->filename,
+                                    g_variant_get_data(snapshot),
+                                    g_variant_get_size(snapshot),
+                                    0600,
+                                    NULL,
+                                    &error)) {
+        _LOGD("snapshot: failure to write \"%s\": %s", self->filename, error->message);
+        return FALSE;
+    }
+
+    _LOGD("snapshot: wrote %u entries to \"%s\"", self->entries->len, self->filename);
+
+    self->dirty = FALSE;
+    g_hash_table_remove_all(self->old_idx);
+    return TRUE;
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef __NMS_KEYFILE_SNAPSHOT_H__
+#define __NMS_KEYFILE_SNAPSHOT_H__
+
+#include "nm-connection.h"
+
+#define NMS_KEYFILE_SNAPSHOT_FILENAME NMSTATEDIR "/keyfile-snapshot"
+
+typedef struct _NMSKeyfileSnapshot NMSKeyfileSnapshot;
+
+NMSKeyfileSnapshot *nms_keyfile_snapshot_new(const char *filename, const char *profile_dir);
+
+void nms_keyfile_snapshot_free(NMSKeyfileSnapshot *self);
+
+NM_AUTO_DEFINE_FCN0(NMSKeyfileSnapshot *, _nm_auto_free_keyfile_snapshot, nms_keyfile_snapshot_free);
+#define nm_auto_free_keyfile_snapshot nm_auto(_nm_auto_free_keyfile_snapshot)
+
+struct stat;
+
+NMConnection *nms_keyfile_snapshot_lookup(NMSKeyfileSnapshot *self,
+                                          const char *        full_filename,
+                                          const struct stat * st,
+                                          NMTernary *         out_is_nm_generated,
+                                          NMTernary *         out_is_volatile,
+                                          NMTernary *         out_is_external,
+                                          char **             out_shadowed_storage,
+                                          NMTernary *         out_shadowed_owned);
+
+void nms_keyfile_snapshot_add(NMSKeyfileSnapshot *self,
+                              const char *        full_filename,
+                              const struct stat * st,
+                              NMConnection *      connection,
+                              NMTernary           is_nm_generated,
+                              NMTernary           is_volatile,
+                              NMTernary           is_external,
+                              const char *        shadowed_storage,
+                              NMTernary           shadowed_owned);
+
+gboolean nms_keyfile_snapshot_commit(NMSKeyfileSnapshot *self);
+
+#endif /* __NMS_KEYFILE_SNAPSHOT_H__ */
@@ -8,6 +8,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -15,9 +17,12 @@
 #include <linux/if_ether.h>
 #include <linux/if_infiniband.h>
 
+#include "libnm-glib-aux/nm-io-utils.h"
 #include "libnm-core-intern/nm-core-internal.h"
 
+#include "settings/plugins/keyfile/nms-keyfile-plugin.h"
 #include "settings/plugins/keyfile/nms-keyfile-reader.h"
+#include "settings/plugins/keyfile/nms-keyfile-snapshot.h"
 #include "settings/plugins/keyfile/nms-keyfile-writer.h"
 #include "settings/plugins/keyfile/nms-keyfile-utils.h"
 
@@ -2817,6 +2822,536 @@ test_nmmeta(void)
 
 /*****************************************************************************/
 
+#define SNAPSHOT_BENCH_N_ROUNDS 20
+
+#define TEST_SNAPSHOT_DIR     TEST_SCRATCH_DIR "/snapshot"
+#define TEST_SNAPSHOT_DIR_RUN TEST_SCRATCH_DIR "/snapshot-run"
+#define TEST_SNAPSHOT_FILE    TEST_SCRATCH_DIR "/keyfile-snapshot"
+
+/* Copy the fixture @filename to @dirname. The snapshot does not cache files
+ * that were modified in the last seconds, so pretend the copy is old. */
+static char *
+_snapshot_copy_fixture(const char *filename, const char *dirname)
+{
+    gs_free_error GError *error        = NULL;
+    gs_free char *        src_filename = NULL;
+    gs_free char *        contents     = NULL;
+    char *                dst_filename;
+    gsize                 len;
+    struct timespec       times[2];
+
+    src_filename = g_build_filename(TEST_KEYFILES_DIR, filename, NULL);
+    dst_filename = g_build_filename(dirname, filename, NULL);
+
+    nmtst_assert_success(g_file_get_contents(src_filename, &contents, &len, &error), error);
+    nmtst_assert_success(
+        nm_utils_file_set_contents(dst_filename, contents, len, 0600, NULL, &error),
+        error);
+
+    times[0] = (struct timespec){
+        .tv_sec = time(NULL) - 3600,
+    };
+    times[1] = times[0];
+    g_assert_cmpint(utimensat(AT_FDCWD, dst_filename, times, 0), ==, 0);
+
+    return dst_filename;
+}
+
+static void
+_snapshot_remove_files(char **full_filenames, const char *dirname)
+{
+    guint i;
+
+    for (i = 0; full_filenames[i]; i++)
+        (void) unlink(full_filenames[i]);
+    (void) rmdir(dirname);
+    (void) unlink(TEST_SNAPSHOT_FILE);
+}
+
+static NMConnection *
+_snapshot_load_file(NMSKeyfileSnapshot *snapshot, const char *full_filename, gboolean expect_hit)
+{
+    gs_free_error GError *error            = NULL;
+    gs_free char *        shadowed_storage = NULL;
+    NMConnection *        connection       = NULL;
+    NMTernary             is_nm_generated;
+    NMTernary             is_volatile;
+    NMTernary             is_external;
+    NMTernary             shadowed_owned;
+    struct stat           st;
+
+    if (nms_keyfile_utils_check_file_permissions(NMS_KEYFILE_FILETYPE_KEYFILE,
+                                                 full_filename,
+                                                 &st,
+                                                 NULL)) {
+        connection = nms_keyfile_snapshot_lookup(snapshot,
+                                                 full_filename,
+                                                 &st,
+                                                 &is_nm_generated,
+                                                 &is_volatile,
+                                                 &is_external,
+                                                 &shadowed_storage,
+                                                 &shadowed_owned);
+    }
+
+    if (expect_hit)
+        g_assert(connection);
+
+    if (!connection) {
+        connection = nms_keyfile_reader_from_file(full_filename,
+                                                  NULL,
+                                                  &st,
+                                                  &is_nm_generated,
+                                                  &is_volatile,
+                                                  &is_external,
+                                                  &shadowed_storage,
+                                                  &shadowed_owned,
+                                                  &error);
+        nmtst_assert_success(connection, error);
+        nms_keyfile_snapshot_add(snapshot,
+                                 full_filename,
+                                 &st,
+                                 connection,
+                                 is_nm_generated,
+                                 is_volatile,
+                                 is_external,
+                                 shadowed_storage,
+                                 shadowed_owned);
+    }
+
+    nmtst_assert_connection_verifies_without_normalization(connection);
+    return connection;
+}
+
+static void
+test_snapshot(void)
+{
+    static const char *const fixtures[] = {
+        "Test_Wired_Connection_IP6",
+        "Test_MAC_Old_Format",
+        "Test_Wireless_Connection",
+        "Test_String_SSID",
+        "Test_Intlist_SSID",
+        "ATT_Data_Connect_BT",
+        "ATT_Data_Connect_Plain",
+        "Test_dcb_connection",
+        "Test_InfiniBand_Connection",
+        "Test_Bridge_Main",
+        "Test_Bridge_Component",
+        "Test_minimal_1",
+        "Test_Enum_Property",
+        "Test_TC_Config",
+    };
+    const char *const snapshot_filename = TEST_SNAPSHOT_FILE;
+    char *            filenames[G_N_ELEMENTS(fixtures) + 1];
+    NMConnection *    connections[G_N_ELEMENTS(fixtures)];
+    gint64            start_time;
+    gint64            time_parse;
+    gint64            time_snapshot;
+    guint             r;
+    guint             i;
+
+    (void) unlink(snapshot_filename);
+
+    g_assert_cmpint(g_mkdir_with_parents(TEST_SNAPSHOT_DIR, 0755), ==, 0);
+    for (i = 0; i < G_N_ELEMENTS(fixtures); i++)
+        filenames[i] = _snapshot_copy_fixture(fixtures[i], TEST_SNAPSHOT_DIR);
+    filenames[i] = NULL;
+
+    /* the first load parses all files and writes the snapshot. */
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+
+        for (i = 0; i < G_N_ELEMENTS(fixtures); i++)
+            connections[i] = _snapshot_load_file(snapshot, filenames[i], FALSE);
+        g_assert(nms_keyfile_snapshot_commit(snapshot));
+    }
+
+    /* the next load gets the same connections from the snapshot, which
+     * is then unchanged. */
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+
+        for (i = 0; i < G_N_ELEMENTS(fixtures); i++) {
+            gs_unref_object NMConnection *connection = NULL;
+
+            connection = _snapshot_load_file(snapshot, filenames[i], TRUE);
+            nmtst_assert_connection_equals(connections[i], FALSE, connection, FALSE);
+        }
+        g_assert(!nms_keyfile_snapshot_commit(snapshot));
+    }
+
+    /* a modified file is not taken from the snapshot. */
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+        struct stat st;
+
+        g_assert(stat(filenames[0], &st) == 0);
+        st.st_size++;
+        g_assert(!nms_keyfile_snapshot_lookup(snapshot,
+                                              filenames[0],
+                                              &st,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL));
+        g_assert(nms_keyfile_snapshot_commit(snapshot));
+    }
+
+    /* a snapshot for a different profile directory is ignored. */
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, "/etc/NetworkManager/other");
+        struct stat st;
+
+        g_assert(stat(filenames[1], &st) == 0);
+        g_assert(!nms_keyfile_snapshot_lookup(snapshot,
+                                              filenames[1],
+                                              &st,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL));
+    }
+
+    /* a file that was just written is not cached. */
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+        gs_unref_object NMConnection *connection = NULL;
+
+        g_assert_cmpint(utimensat(AT_FDCWD, filenames[2], NULL, 0), ==, 0);
+        connection = _snapshot_load_file(snapshot, filenames[2], FALSE);
+        g_assert(nms_keyfile_snapshot_commit(snapshot));
+    }
+    {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+        struct stat st;
+
+        g_assert(stat(filenames[2], &st) == 0);
+        g_assert(!nms_keyfile_snapshot_lookup(snapshot,
+                                              filenames[2],
+                                              &st,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              NULL));
+    }
+
+    /* profiles with 802-1x are never cached, because they may refer to
+     * certificate files. */
+    {
+        gs_unref_object NMConnection *connection1 = NULL;
+        gs_unref_object NMConnection *connection2 = NULL;
+        gs_free_error GError *error               = NULL;
+        gs_free char *        filename            = NULL;
+        struct timespec       times[2];
+
+        filename = g_build_filename(TEST_SNAPSHOT_DIR, "Test_Snapshot_8021x", NULL);
+        nmtst_assert_success(
+            nm_utils_file_set_contents(filename,
+                                       "[connection]\n"
+                                       "id=snapshot-8021x\n"
+                                       "uuid=6f8d6fbb-9a4f-4c3b-9c55-23a5c05d3a0e\n"
+                                       "type=ethernet\n"
+                                       "\n"
+                                       "[802-1x]\n"
+                                       "eap=tls;\n"
+                                       "identity=Bill Smith\n"
+                                       "ca-cert=" TEST_KEYFILES_DIR "/test-ca-cert.pem\n"
+                                       "client-cert=" TEST_KEYFILES_DIR "/test-key-and-cert.pem\n"
+                                       "private-key=" TEST_KEYFILES_DIR "/test-key-and-cert.pem\n"
+                                       "private-key-password=12345testing\n",
+                                       -1,
+                                       0600,
+                                       NULL,
+                                       &error),
+            error);
+        times[0] = (struct timespec){
+            .tv_sec = time(NULL) - 3600,
+        };
+        times[1] = times[0];
+        g_assert_cmpint(utimensat(AT_FDCWD, filename, times, 0), ==, 0);
+
+        {
+            nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+                nms_keyfile_snapshot_new(snapshot_filename, NULL);
+
+            connection1 = _snapshot_load_file(snapshot, filename, FALSE);
+            g_assert(nm_connection_get_setting_802_1x(connection1));
+            nms_keyfile_snapshot_commit(snapshot);
+        }
+        {
+            nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+                nms_keyfile_snapshot_new(snapshot_filename, NULL);
+            struct stat st;
+
+            g_assert(stat(filename, &st) == 0);
+            g_assert(!nms_keyfile_snapshot_lookup(snapshot,
+                                                  filename,
+                                                  &st,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL));
+            connection2 = _snapshot_load_file(snapshot, filename, FALSE);
+            nmtst_assert_connection_equals(connection1, FALSE, connection2, FALSE);
+        }
+
+        (void) unlink(filename);
+    }
+
+    if (nmtst_test_quick()) {
+        /* comparing the load times takes a while. */
+        goto out;
+    }
+
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    for (r = 0; r < SNAPSHOT_BENCH_N_ROUNDS; r++) {
+        for (i = 0; i < G_N_ELEMENTS(fixtures); i++) {
+            gs_unref_object NMConnection *connection = NULL;
+
+            connection = nms_keyfile_reader_from_file(filenames[i],
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL);
+            g_assert(connection);
+        }
+    }
+    time_parse = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    /* filenames[2] was just touched and would not be cached. Copy it again. */
+    g_free(filenames[2]);
+    filenames[2] = _snapshot_copy_fixture(fixtures[2], TEST_SNAPSHOT_DIR);
+
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    for (r = 0; r < SNAPSHOT_BENCH_N_ROUNDS; r++) {
+        nm_auto_free_keyfile_snapshot NMSKeyfileSnapshot *snapshot =
+            nms_keyfile_snapshot_new(snapshot_filename, NULL);
+
+        for (i = 0; i < G_N_ELEMENTS(fixtures); i++) {
+            gs_unref_object NMConnection *connection = NULL;
+
+            connection = _snapshot_load_file(snapshot, filenames[i], r > 0);
+        }
+        nms_keyfile_snapshot_commit(snapshot);
+    }
+    time_snapshot = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    g_test_message(">>> loading %u keyfiles %u times: %" G_GINT64_FORMAT
+                   " usec parsing, %" G_GINT64_FORMAT " usec with snapshot",
+                   (guint) G_N_ELEMENTS(fixtures),
+                   (guint) SNAPSHOT_BENCH_N_ROUNDS,
+                   time_parse / 1000,
+                   time_snapshot / 1000);
+
+out:
+    for (i = 0; i < G_N_ELEMENTS(fixtures); i++)
+        g_object_unref(connections[i]);
+
+    _snapshot_remove_files(filenames, TEST_SNAPSHOT_DIR);
+    for (i = 0; filenames[i]; i++)
+        g_free(filenames[i]);
+}
+
+static void
+_plugin_reload_connections_cb(NMSettingsPlugin * plugin,
+                              NMSettingsStorage *storage,
+                              NMConnection *     connection,
+                              gpointer           user_data)
+{
+    GHashTable *connections = user_data;
+
+    g_assert(NMS_IS_KEYFILE_PLUGIN(plugin));
+    g_assert(connection);
+    g_assert(!g_hash_table_contains(connections, nm_connection_get_uuid(connection)));
+
+    g_hash_table_insert(connections,
+                        g_strdup(nm_connection_get_uuid(connection)),
+                        g_object_ref(connection));
+}
+
+static GHashTable *
+_plugin_reload_connections(NMSKeyfilePlugin *plugin)
+{
+    GHashTable *connections;
+
+    connections = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, g_object_unref);
+    nm_settings_plugin_reload_connections(NM_SETTINGS_PLUGIN(plugin),
+                                          _plugin_reload_connections_cb,
+                                          connections);
+    return connections;
+}
+
+static void
+test_snapshot_plugin(void)
+{
+    /* fixtures with distinct UUIDs. */
+    static const char *const fixtures[] = {
+        "Test_Wired_Connection_IP6",
+        "Test_MAC_Old_Format",
+        "Test_Wireless_Connection",
+        "ATT_Data_Connect_BT",
+        "ATT_Data_Connect_Plain",
+        "Test_dcb_connection",
+        "Test_Bridge_Main",
+        "Test_Bridge_Component",
+        "Test_TC_Config",
+    };
+    gs_unref_object NMSKeyfilePlugin *plugin    = NULL;
+    gs_unref_hashtable GHashTable *connections1 = NULL;
+    gs_unref_hashtable GHashTable *connections2 = NULL;
+    char *                         filenames[G_N_ELEMENTS(fixtures) + 1];
+    GHashTableIter                 h_iter;
+    NMConnection *                 connection;
+    struct stat                    st1;
+    struct stat                    st2;
+    guint                          i;
+
+    (void) unlink(TEST_SNAPSHOT_FILE);
+
+    g_assert_cmpint(g_mkdir_with_parents(TEST_SNAPSHOT_DIR, 0755), ==, 0);
+    for (i = 0; i < G_N_ELEMENTS(fixtures); i++)
+        filenames[i] = _snapshot_copy_fixture(fixtures[i], TEST_SNAPSHOT_DIR);
+    filenames[i] = NULL;
+
+    /* the run directory does not exist, there is nothing to load from it. */
+    plugin =
+        _nmtst_keyfile_plugin_new(TEST_SNAPSHOT_DIR, TEST_SNAPSHOT_DIR_RUN, TEST_SNAPSHOT_FILE);
+
+    connections1 = _plugin_reload_connections(plugin);
+    g_assert_cmpint(g_hash_table_size(connections1), ==, G_N_ELEMENTS(fixtures));
+    g_assert_cmpint(stat(TEST_SNAPSHOT_FILE, &st1), ==, 0);
+
+    /* a fresh plugin instance gets the profiles from the snapshot. As
+     * nothing changed, the snapshot is not written again. */
+    g_clear_object(&plugin);
+    plugin =
+        _nmtst_keyfile_plugin_new(TEST_SNAPSHOT_DIR, TEST_SNAPSHOT_DIR_RUN, TEST_SNAPSHOT_FILE);
+
+    connections2 = _plugin_reload_connections(plugin);
+    g_assert_cmpint(g_hash_table_size(connections2), ==, G_N_ELEMENTS(fixtures));
+    g_assert_cmpint(stat(TEST_SNAPSHOT_FILE, &st2), ==, 0);
+    g_assert_cmpint(st1.st_ino, ==, st2.st_ino);
+    g_assert_cmpint(st1.st_mtim.tv_sec, ==, st2.st_mtim.tv_sec);
+    g_assert_cmpint(st1.st_mtim.tv_nsec, ==, st2.st_mtim.tv_nsec);
+
+    g_hash_table_iter_init(&h_iter, connections1);
+    while (g_hash_table_iter_next(&h_iter, NULL, (gpointer *) &connection)) {
+        nmtst_assert_connection_equals(
+            connection,
+            FALSE,
+            g_hash_table_lookup(connections2, nm_connection_get_uuid(connection)),
+            FALSE);
+    }
+
+    g_clear_object(&plugin);
+    _snapshot_remove_files(filenames, TEST_SNAPSHOT_DIR);
+    for (i = 0; filenames[i]; i++)
+        g_free(filenames[i]);
+}
+
+#define TEST_LOAD_DIR     TEST_SCRATCH_DIR "/load-dir"
+#define TEST_LOAD_DIR_RUN TEST_SCRATCH_DIR "/load-dir-run"
+
+static void
+test_load_dir_parallel(void)
+{
+    /* enough files for the plugin to parse them on a thread pool. Every
+     * other profile has a password protected private key, for which the
+     * crypto library gets initialized on a worker thread. */
+    const guint N_FILES                        = 40;
+    gs_unref_object NMSKeyfilePlugin *plugin   = NULL;
+    gs_unref_hashtable GHashTable *connections = NULL;
+    gs_unref_ptrarray GPtrArray *filenames     = NULL;
+    guint                        i;
+
+    g_assert_cmpint(g_mkdir_with_parents(TEST_LOAD_DIR, 0755), ==, 0);
+
+    filenames = g_ptr_array_new_with_free_func(g_free);
+    for (i = 0; i < N_FILES; i++) {
+        gs_free_error GError *error    = NULL;
+        gs_free char *        uuid     = nm_utils_uuid_generate();
+        gs_free char *        contents = NULL;
+        char *                filename;
+
+        contents = g_strdup_printf("[connection]\n"
+                                   "id=parallel-%u\n"
+                                   "uuid=%s\n"
+                                   "type=ethernet\n"
+                                   "%s"
+                                   "\n"
+                                   "[ipv4]\n"
+                                   "method=auto\n",
+                                   i,
+                                   uuid,
+                                   (i % 2) ? "\n"
+                                             "[802-1x]\n"
+                                             "eap=tls;\n"
+                                             "identity=Bill Smith\n"
+                                             "ca-cert=" TEST_KEYFILES_DIR "/test-ca-cert.pem\n"
+                                             "client-cert=" TEST_KEYFILES_DIR
+                                             "/test-key-and-cert.pem\n"
+                                             "private-key=" TEST_KEYFILES_DIR
+                                             "/test-key-and-cert.pem\n"
+                                             "private-key-password=12345testing\n"
+                                           : "");
+
+        filename = g_strdup_printf("%s/parallel-%u", TEST_LOAD_DIR, i);
+        nmtst_assert_success(
+            nm_utils_file_set_contents(filename, contents, -1, 0600, NULL, &error),
+            error);
+        g_ptr_array_add(filenames, filename);
+    }
+
+    plugin      = _nmtst_keyfile_plugin_new(TEST_LOAD_DIR, TEST_LOAD_DIR_RUN, NULL);
+    connections = _plugin_reload_connections(plugin);
+    g_assert_cmpint(g_hash_table_size(connections), ==, N_FILES);
+
+    /* the result is the same as reading the files one by one. */
+    for (i = 0; i < N_FILES; i++) {
+        gs_unref_object NMConnection *connection = NULL;
+        gs_free_error GError *error              = NULL;
+
+        connection = nms_keyfile_reader_from_file(filenames->pdata[i],
+                                                  TEST_LOAD_DIR,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  NULL,
+                                                  &error);
+        nmtst_assert_success(connection, error);
+        g_assert_cmpint(!!nm_connection_get_setting_802_1x(connection), ==, i % 2);
+        nmtst_assert_connection_equals(
+            connection,
+            FALSE,
+            g_hash_table_lookup(connections, nm_connection_get_uuid(connection)),
+            FALSE);
+    }
+
+    g_clear_object(&plugin);
+    for (i = 0; i < N_FILES; i++)
+        (void) unlink(filenames->pdata[i]);
+    (void) rmdir(TEST_LOAD_DIR);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -2919,5 +3454,9 @@ main(int argc, char **argv)
 
     g_test_add_func("/keyfile/test_nmmeta", test_nmmeta);
 
+    g_test_add_func("/keyfile/test_snapshot", test_snapshot);
+    g_test_add_func("/keyfile/test_snapshot_plugin", test_snapshot_plugin);
+    g_test_add_func("/keyfile/test_load_dir_parallel", test_load_dir_parallel);
+
     return g_test_run();
 }
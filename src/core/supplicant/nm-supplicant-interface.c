@@ -732,36 +732,42 @@ _bss_info_properties_changed(NMSupplicantInterface *self,
     _bss_info_changed_emit(self, bss_info, TRUE);
 }
 
+static void
+_bss_info_init_complete(NMSupplicantInterface *self,
+                        NMSupplicantBssInfo *  bss_info,
+                        GVariant *             properties)
+{
+    NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
+
+    nm_clear_g_cancellable(&bss_info->_init_cancellable);
+    nm_c_list_move_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
+
+    _bss_info_properties_changed(self, bss_info, properties, TRUE);
+
+    _starting_check_ready(self);
+
+    _notify_maybe_scanning(self);
+}
+
 static void
 _bss_info_get_all_cb(GVariant *result, GError *error, gpointer user_data)
 {
-    NMSupplicantBssInfo *         bss_info;
-    NMSupplicantInterface *       self;
-    NMSupplicantInterfacePrivate *priv;
+    NMSupplicantBssInfo *bss_info;
     gs_unref_variant GVariant *properties = NULL;
 
     if (nm_utils_error_is_cancelled(error))
         return;
 
     bss_info = user_data;
-    self     = bss_info->_self;
-    priv     = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
-
-    g_clear_object(&bss_info->_init_cancellable);
-    nm_c_list_move_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
 
     if (result)
         g_variant_get(result, "(@a{sv})", &properties);
 
-    _bss_info_properties_changed(self, bss_info, properties, TRUE);
-
-    _starting_check_ready(self);
-
-    _notify_maybe_scanning(self);
+    _bss_info_init_complete(bss_info->_self, bss_info, properties);
 }
 
 static void
-_bss_info_add(NMSupplicantInterface *self, const char *object_path)
+_bss_info_add(NMSupplicantInterface *self, const char *object_path, GVariant *properties)
 {
     NMSupplicantInterfacePrivate *priv       = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
     nm_auto_ref_string NMRefString *bss_path = NULL;
@@ -774,6 +780,11 @@ _bss_info_add(NMSupplicantInterface *self, const char *object_path)
     bss_info = g_hash_table_lookup(priv->bss_idx, &bss_path);
     if (bss_info) {
         bss_info->_bss_dirty = FALSE;
+        if (properties && bss_info->_init_cancellable) {
+            /* The BSSAdded signal raced with a GetAll() we issued for the
+             * "BSSs" property. We already have everything we need. */
+            _bss_info_init_complete(self, bss_info, properties);
+        }
         return;
     }
 
@@ -781,11 +792,22 @@ _bss_info_add(NMSupplicantInterface *self, const char *object_path)
     *bss_info = (NMSupplicantBssInfo){
         ._self             = self,
         .bss_path          = g_steal_pointer(&bss_path),
-        ._init_cancellable = g_cancellable_new(),
+        ._init_cancellable = properties ? NULL : g_cancellable_new(),
     };
     c_list_link_tail(&priv->bss_initializing_lst_head, &bss_info->_bss_lst);
     g_hash_table_add(priv->bss_idx, bss_info);
 
+    if (properties) {
+        /* wpa_supplicant sends the full set of BSS properties along with the
+         * BSSAdded signal. During a scan there are many such signals, and
+         * a GetAll() round trip for each of them only doubles the D-Bus
+         * traffic. */
+        _bss_info_init_complete(self, bss_info, properties);
+        return;
+    }
+
+    /* The GetAll() requests for all BSSs are sent at once without waiting
+     * for the replies, so the D-Bus round trips overlap. */
     nm_dbus_connection_call_get_all(priv->dbus_connection,
                                     priv->name_owner->str,
                                     bss_info->bss_path->str,
@@ -1145,6 +1167,28 @@ nm_supplicant_interface_get_current_bss(NMSupplicantInterface *self)
     return NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self)->current_bss;
 }
 
+/**
+ * nm_supplicant_interface_get_bss_info:
+ * @self: the #NMSupplicantInterface
+ * @bss_path: the D-Bus object path of the BSS
+ *
+ * Returns: (transfer none): the #NMSupplicantBssInfo for @bss_path or %NULL
+ *   if the BSS is unknown or its properties were not yet fetched.
+ */
+const NMSupplicantBssInfo *
+nm_supplicant_interface_get_bss_info(NMSupplicantInterface *self, NMRefString *bss_path)
+{
+    const NMSupplicantBssInfo *bss_info;
+
+    g_return_val_if_fail(NM_IS_SUPPLICANT_INTERFACE(self), NULL);
+    g_return_val_if_fail(bss_path, NULL);
+
+    bss_info = g_hash_table_lookup(NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self)->bss_idx, &bss_path);
+    if (!bss_info || bss_info->_init_cancellable)
+        return NULL;
+    return bss_info;
+}
+
 gboolean
 nm_supplicant_interface_get_scanning(NMSupplicantInterface *self)
 {
@@ -1930,7 +1974,7 @@ _properties_changed_main(NMSupplicantInterface *self, GVariant *properties)
             bss_info->_bss_dirty = TRUE;
 
         for (iter = v_strv; *iter; iter++)
-            _bss_info_add(self, *iter);
+            _bss_info_add(self, *iter, NULL);
 
         g_free(v_strv);
 
@@ -2908,11 +2952,15 @@ _signal_handle(NMSupplicantInterface *self,
             return;
 
         if (nm_streq(signal_name, "BSSAdded")) {
+            gs_unref_variant GVariant *properties = NULL;
+
             if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(oa{sv})")))
                 return;
 
-            g_variant_get(parameters, "(&oa{sv})", &path, NULL);
-            _bss_info_add(self, path);
+            g_variant_get(parameters, "(&o@a{sv})", &path, &properties);
+            if (g_variant_n_children(properties) == 0)
+                nm_clear_pointer(&properties, g_variant_unref);
+            _bss_info_add(self, path, properties);
             return;
         }
 
@@ -150,6 +150,9 @@ gboolean nm_supplicant_interface_get_scanning(NMSupplicantInterface *self);
 
 NMRefString *nm_supplicant_interface_get_current_bss(NMSupplicantInterface *self);
 
+const NMSupplicantBssInfo *nm_supplicant_interface_get_bss_info(NMSupplicantInterface *self,
+                                                                NMRefString *          bss_path);
+
 gint64 nm_supplicant_interface_get_last_scan(NMSupplicantInterface *self);
 
 const char *nm_supplicant_interface_get_ifname(NMSupplicantInterface *self);
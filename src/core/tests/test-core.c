@@ -18,6 +18,7 @@
 
 #include "dns/nm-dns-manager.h"
 #include "nm-connectivity.h"
+#include "settings/nm-settings-utils.h"
 
 #include "nm-test-utils-core.h"
 
@@ -1216,6 +1217,168 @@ test_connection_sort_autoconnect_priority(void)
 
 /*****************************************************************************/
 
+typedef struct {
+    NMSettUtilAutoconnectIdxEntry entry;
+    const char *                  type;
+    const char *                  iface;
+    bool                          in_idx : 1;
+    bool                          seen : 1;
+} AutoconnectIdxProfile;
+
+static void
+_test_autoconnect_idx_check(NMSettUtilAutoconnectIdx *idx,
+                            AutoconnectIdxProfile *   profiles,
+                            guint                     n_profiles,
+                            const char *const *       types,
+                            guint                     n_types,
+                            const char *              iface)
+{
+    gs_unref_ptrarray GPtrArray *arr = g_ptr_array_new();
+    guint                        n_expected;
+    guint                        i, j;
+
+    nm_sett_util_autoconnect_idx_lookup(idx, types, n_types, iface, arr);
+
+    for (i = 0; i < n_profiles; i++)
+        profiles[i].seen = FALSE;
+
+    for (i = 0; i < arr->len; i++) {
+        AutoconnectIdxProfile *p = c_list_entry(arr->pdata[i], AutoconnectIdxProfile, entry);
+
+        g_assert(p >= profiles && p < &profiles[n_profiles]);
+        g_assert(p->in_idx);
+        g_assert(!p->seen);
+        p->seen = TRUE;
+    }
+
+    /* compare with a brute force filter over all profiles. */
+    n_expected = 0;
+    for (i = 0; i < n_profiles; i++) {
+        const AutoconnectIdxProfile *p = &profiles[i];
+        gboolean                     matches;
+
+        if (!p->in_idx) {
+            g_assert(!p->seen);
+            continue;
+        }
+
+        matches = !types;
+        for (j = 0; !matches && j < n_types; j++)
+            matches = nm_streq0(p->type, types[j]);
+        if (matches && p->iface)
+            matches = nm_streq0(p->iface, nm_str_not_empty(iface));
+
+        g_assert_cmpint(matches, ==, p->seen);
+        if (matches)
+            n_expected++;
+    }
+    g_assert_cmpint(n_expected, ==, arr->len);
+}
+
+static void
+test_autoconnect_idx(void)
+{
+    static const char *const ALL_TYPES[] = {
+        NULL,
+        NM_SETTING_WIRED_SETTING_NAME,
+        NM_SETTING_WIRELESS_SETTING_NAME,
+        NM_SETTING_BRIDGE_SETTING_NAME,
+        NM_SETTING_VLAN_SETTING_NAME,
+    };
+    static const char *const ALL_IFACES[] = {
+        NULL,
+        "eth0",
+        "eth1",
+        "wlan0",
+    };
+    static const char *const LOOKUP_TYPES_1[] = {
+        NM_SETTING_WIRED_SETTING_NAME,
+    };
+    static const char *const LOOKUP_TYPES_2[] = {
+        NM_SETTING_WIRELESS_SETTING_NAME,
+        NM_SETTING_VLAN_SETTING_NAME,
+        "dummy",
+    };
+    static const char *const LOOKUP_IFACES[] = {
+        NULL,
+        "",
+        "eth0",
+        "eth1",
+        "eth2",
+    };
+    NMSettUtilAutoconnectIdx idx;
+    AutoconnectIdxProfile    profiles[30] = {};
+    guint                    i_step;
+    guint                    i;
+
+    nm_sett_util_autoconnect_idx_init(&idx);
+
+    for (i = 0; i < G_N_ELEMENTS(profiles); i++)
+        nm_sett_util_autoconnect_idx_entry_init(&profiles[i].entry);
+
+    for (i_step = 0; i_step < 1000; i_step++) {
+        AutoconnectIdxProfile *p = &profiles[nmtst_get_rand_uint32() % G_N_ELEMENTS(profiles)];
+
+        if (!p->in_idx) {
+            /* add. */
+            p->type   = ALL_TYPES[nmtst_get_rand_uint32() % G_N_ELEMENTS(ALL_TYPES)];
+            p->iface  = ALL_IFACES[nmtst_get_rand_uint32() % G_N_ELEMENTS(ALL_IFACES)];
+            p->in_idx = TRUE;
+        } else {
+            switch (nmtst_get_rand_uint32() % 4) {
+            case 0:
+                p->type = ALL_TYPES[nmtst_get_rand_uint32() % G_N_ELEMENTS(ALL_TYPES)];
+                break;
+            case 1:
+                p->iface = ALL_IFACES[nmtst_get_rand_uint32() % G_N_ELEMENTS(ALL_IFACES)];
+                break;
+            case 2:
+                /* update without change. */
+                break;
+            default:
+                p->in_idx = FALSE;
+                break;
+            }
+        }
+
+        if (p->in_idx)
+            nm_sett_util_autoconnect_idx_update(&idx, &p->entry, p->type, p->iface);
+        else
+            nm_sett_util_autoconnect_idx_remove(&idx, &p->entry);
+
+        for (i = 0; i < G_N_ELEMENTS(LOOKUP_IFACES); i++) {
+            _test_autoconnect_idx_check(&idx,
+                                        profiles,
+                                        G_N_ELEMENTS(profiles),
+                                        NULL,
+                                        0,
+                                        LOOKUP_IFACES[i]);
+            _test_autoconnect_idx_check(&idx,
+                                        profiles,
+                                        G_N_ELEMENTS(profiles),
+                                        LOOKUP_TYPES_1,
+                                        G_N_ELEMENTS(LOOKUP_TYPES_1),
+                                        LOOKUP_IFACES[i]);
+            _test_autoconnect_idx_check(&idx,
+                                        profiles,
+                                        G_N_ELEMENTS(profiles),
+                                        LOOKUP_TYPES_2,
+                                        G_N_ELEMENTS(LOOKUP_TYPES_2),
+                                        LOOKUP_IFACES[i]);
+        }
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(profiles); i++) {
+        nm_sett_util_autoconnect_idx_remove(&idx, &profiles[i].entry);
+        profiles[i].in_idx = FALSE;
+    }
+    _test_autoconnect_idx_check(&idx, profiles, G_N_ELEMENTS(profiles), NULL, 0, "eth0");
+
+    nm_sett_util_autoconnect_idx_clear(&idx);
+}
+
+/*****************************************************************************/
+
 #define MATCH_S390   "S390:"
 #define MATCH_DRIVER "DRIVER:"
 
@@ -2607,6 +2770,7 @@ main(int argc, char **argv)
 
     g_test_add_func("/general/connection-sort/autoconnect-priority",
                     test_connection_sort_autoconnect_priority);
+    g_test_add_func("/general/autoconnect-idx", test_autoconnect_idx);
 
     g_test_add_func("/general/match-spec/device", test_match_spec_device);
     g_test_add_func("/general/match-spec/config", test_match_spec_config);
@@ -494,6 +494,234 @@ test_l3cfg(gconstpointer test_data)
 
 /*****************************************************************************/
 
+static void
+_merge_shadowed_add_config(const TestFixture1 *f,
+                           NML3Cfg *           l3cfg,
+                           char                tag,
+                           int                 priority,
+                           guint32             mtu,
+                           gboolean            with_y)
+{
+    nm_auto_unref_l3cd_init NML3ConfigData *l3cd = NULL;
+    NMPlatformIP4Route                      rt   = {
+        .network   = nmtst_inet4_from_string("10.1.0.0"),
+        .plen      = 16,
+        .metric    = 50,
+        .mtu       = mtu,
+        .rt_source = NM_IP_CONFIG_SOURCE_USER,
+    };
+
+    l3cd = nm_l3_config_data_new(f->multiidx, f->ifindex0);
+    nm_l3_config_data_add_route_4(l3cd, &rt);
+    if (with_y) {
+        rt.network = nmtst_inet4_from_string("10.2.0.0");
+        nm_l3_config_data_add_route_4(l3cd, &rt);
+    }
+
+    nm_l3cfg_add_config(l3cfg,
+                        GINT_TO_POINTER(tag),
+                        TRUE,
+                        l3cd,
+                        priority,
+                        0,
+                        0,
+                        NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP4,
+                        NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP6,
+                        0,
+                        0,
+                        NM_L3_ACD_DEFEND_TYPE_NEVER,
+                        0,
+                        NM_L3_CONFIG_MERGE_FLAGS_NONE);
+}
+
+static guint32
+_merge_shadowed_get_mtu(NML3Cfg *l3cfg, const char *network)
+{
+    const NML3ConfigData *   l3cd;
+    const NMDedupMultiEntry *entry;
+    const NMPlatformIP4Route needle = {
+        .network = nmtst_inet4_from_string(network),
+        .plen    = 16,
+        .metric  = 50,
+    };
+
+    l3cd = nm_l3cfg_get_combined_l3cd(l3cfg, FALSE);
+    g_assert(l3cd);
+
+    entry = nm_l3_config_data_lookup_route(l3cd, AF_INET, NM_PLATFORM_IP_ROUTE_CAST(&needle));
+    g_assert(entry);
+    return NMP_OBJECT_CAST_IP4_ROUTE(entry->obj)->mtu;
+}
+
+static void
+test_l3cfg_merge_shadowed(void)
+{
+    nm_auto(_test_fixture_1_teardown) TestFixture1 test_fixture = {};
+    const TestFixture1 *                           f;
+    gs_unref_object NML3Cfg *l3cfg0                   = NULL;
+
+    f = _test_fixture_1_setup(&test_fixture, 6);
+
+    l3cfg0 = _netns_access_l3cfg(f->netns, f->ifindex0);
+
+    /* 'b' alone. */
+    _merge_shadowed_add_config(f, l3cfg0, 'b', 2, 1500, TRUE);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.1.0.0"), ==, 1500);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.2.0.0"), ==, 1500);
+
+    /* 'a' has a better priority and shadows the route of 'b'. */
+    _merge_shadowed_add_config(f, l3cfg0, 'a', 1, 1400, FALSE);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.1.0.0"), ==, 1400);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.2.0.0"), ==, 1500);
+    g_assert_cmpint(nm_l3_config_data_get_num_routes(nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE),
+                                                     AF_INET),
+                    ==,
+                    2);
+
+    /* with a worse priority, 'a' no longer wins. */
+    _merge_shadowed_add_config(f, l3cfg0, 'a', 3, 1400, FALSE);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.1.0.0"), ==, 1500);
+
+    /* 'b' changes only the route that is not shadowed. */
+    _merge_shadowed_add_config(f, l3cfg0, 'b', 2, 1500, FALSE);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.1.0.0"), ==, 1500);
+    g_assert_cmpint(nm_l3_config_data_get_num_routes(nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE),
+                                                     AF_INET),
+                    ==,
+                    1);
+
+    /* without 'b', the route of 'a' takes over. */
+    nm_l3cfg_remove_config_all(l3cfg0, GINT_TO_POINTER('b'), FALSE);
+    g_assert_cmpint(_merge_shadowed_get_mtu(l3cfg0, "10.1.0.0"), ==, 1400);
+
+    nm_l3cfg_remove_config_all(l3cfg0, GINT_TO_POINTER('a'), FALSE);
+    g_assert(!nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE));
+}
+
+/*****************************************************************************/
+
+#define MERGE_BENCH_N_ROUTES  10000u
+#define MERGE_BENCH_N_UPDATES 200u
+
+static void
+test_l3cfg_merge_bench(void)
+{
+    nm_auto(_test_fixture_1_teardown) TestFixture1 test_fixture = {};
+    const TestFixture1 *                           f;
+    gs_unref_object NML3Cfg *l3cfg0                   = NULL;
+    nm_auto_unref_l3cd_init NML3ConfigData *l3cd_big  = NULL;
+    const NML3ConfigData *                  l3cd_combined;
+    gint64                                  start_time;
+    gint64                                  time;
+    guint                                   i;
+
+    if (nmtst_test_quick()) {
+        g_test_skip("Skip long running test (NMTST_DEBUG=slow)");
+        return;
+    }
+
+    f = _test_fixture_1_setup(&test_fixture, 5);
+
+    l3cfg0 = _netns_access_l3cfg(f->netns, f->ifindex0);
+
+    /* a large, static config. Like a routed VPN or routes learned via BGP. */
+    l3cd_big = nm_l3_config_data_new(f->multiidx, f->ifindex0);
+    for (i = 0; i < MERGE_BENCH_N_ROUTES; i++) {
+        const NMPlatformIP4Route rt = {
+            .network    = htonl(0x0A000000u | (i << 8)),
+            .plen       = 24,
+            .rt_source  = NM_IP_CONFIG_SOURCE_USER,
+            .table_any  = TRUE,
+            .metric_any = TRUE,
+        };
+
+        nm_l3_config_data_add_route_4(l3cd_big, &rt);
+    }
+    nm_l3_config_data_seal(l3cd_big);
+
+    nm_l3cfg_add_config(l3cfg0,
+                        GINT_TO_POINTER('b'),
+                        TRUE,
+                        l3cd_big,
+                        'b',
+                        0,
+                        0,
+                        NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP4,
+                        NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP6,
+                        0,
+                        0,
+                        NM_L3_ACD_DEFEND_TYPE_NEVER,
+                        0,
+                        NM_L3_CONFIG_MERGE_FLAGS_NONE);
+
+    l3cd_combined = nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE);
+    g_assert_cmpint(nm_l3_config_data_get_num_routes(l3cd_combined, AF_INET),
+                    ==,
+                    MERGE_BENCH_N_ROUTES);
+
+    /* frequent, small updates of another source. Like DHCP renewals. */
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    for (i = 0; i < MERGE_BENCH_N_UPDATES; i++) {
+        nm_auto_unref_l3cd_init NML3ConfigData *l3cd = NULL;
+        const NMPlatformIP4Route                rt   = {
+            .network    = nmtst_inet4_from_string("192.168.134.0"),
+            .plen       = 24,
+            .gateway    = nmtst_inet4_from_string("192.168.133.1"),
+            .rt_source  = NM_IP_CONFIG_SOURCE_DHCP,
+            .table_any  = TRUE,
+            .metric_any = TRUE,
+        };
+
+        l3cd = nm_l3_config_data_new(f->multiidx, f->ifindex0);
+        nm_l3_config_data_add_address_4(
+            l3cd,
+            NM_PLATFORM_IP4_ADDRESS_INIT(.address      = nmtst_inet4_from_string("192.168.133.45"),
+                                         .peer_address = nmtst_inet4_from_string("192.168.133.45"),
+                                         .plen         = 24,
+                                         .addr_source  = NM_IP_CONFIG_SOURCE_DHCP,
+                                         .lifetime     = 3600u + i,
+                                         .preferred    = 3600u + i, ));
+        nm_l3_config_data_add_route_4(l3cd, &rt);
+
+        nm_l3cfg_add_config(l3cfg0,
+                            GINT_TO_POINTER('d'),
+                            TRUE,
+                            l3cd,
+                            'd',
+                            0,
+                            0,
+                            NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP4,
+                            NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP6,
+                            0,
+                            0,
+                            NM_L3_ACD_DEFEND_TYPE_NEVER,
+                            0,
+                            NM_L3_CONFIG_MERGE_FLAGS_NONE);
+
+        l3cd_combined = nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE);
+        g_assert_cmpint(nm_l3_config_data_get_num_routes(l3cd_combined, AF_INET),
+                        ==,
+                        MERGE_BENCH_N_ROUTES + 1u);
+        g_assert_cmpint(nm_l3_config_data_get_num_addresses(l3cd_combined, AF_INET), ==, 1);
+    }
+    time = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    g_test_message(">>> %u updates on top of %u routes: %" G_GINT64_FORMAT
+                   " msec (%" G_GINT64_FORMAT " usec/update)",
+                   MERGE_BENCH_N_UPDATES,
+                   MERGE_BENCH_N_ROUTES,
+                   time / NM_UTILS_NSEC_PER_MSEC,
+                   time / 1000 / MERGE_BENCH_N_UPDATES);
+
+    nm_l3cfg_remove_config_all(l3cfg0, GINT_TO_POINTER('d'), FALSE);
+    nm_l3cfg_remove_config_all(l3cfg0, GINT_TO_POINTER('b'), FALSE);
+
+    l3cd_combined = nm_l3cfg_get_combined_l3cd(l3cfg0, FALSE);
+    g_assert(!l3cd_combined);
+}
+
+/*****************************************************************************/
+
 #define L3IPV4LL_ACD_TIMEOUT_MSEC 1500u
 
 typedef struct {
@@ -790,6 +1018,8 @@ _nmtstp_setup_tests(void)
     g_test_add_data_func("/l3cfg/2", GINT_TO_POINTER(2), test_l3cfg);
     g_test_add_data_func("/l3cfg/3", GINT_TO_POINTER(3), test_l3cfg);
     g_test_add_data_func("/l3cfg/4", GINT_TO_POINTER(4), test_l3cfg);
+    g_test_add_func("/l3cfg/merge-shadowed", test_l3cfg_merge_shadowed);
+    g_test_add_func("/l3cfg/merge-bench", test_l3cfg_merge_bench);
     g_test_add_data_func("/l3-ipv4ll/1", GINT_TO_POINTER(1), test_l3_ipv4ll);
     g_test_add_data_func("/l3-ipv4ll/2", GINT_TO_POINTER(2), test_l3_ipv4ll);
 }
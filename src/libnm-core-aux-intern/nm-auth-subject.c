@@ -143,6 +143,14 @@ nm_auth_subject_get_unix_process_pid(NMAuthSubject *subject)
     return priv->unix_process.pid;
 }
 
+guint64
+nm_auth_subject_get_unix_process_start_time(NMAuthSubject *subject)
+{
+    CHECK_SUBJECT_TYPED(subject, NM_AUTH_SUBJECT_TYPE_UNIX_PROCESS, 0);
+
+    return priv->unix_process.start_time;
+}
+
 gulong
 nm_auth_subject_get_unix_process_uid(NMAuthSubject *subject)
 {
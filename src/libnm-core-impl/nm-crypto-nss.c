@@ -55,9 +55,15 @@ _get_cipher_info(NMCryptoCipherType cipher,
 gboolean
 _nm_crypto_init(GError **error)
 {
+    static GMutex   lock;
     static gboolean initialized = FALSE;
     SECStatus       ret;
 
+    /* This may be called from several threads at once, for example while
+     * the keyfile plugin parses profiles on a thread pool. On failure we
+     * stay uninitialized, so that the next call tries again. */
+    NM_G_MUTEX_LOCKED(&lock);
+
     if (initialized)
         return TRUE;
 
@@ -829,7 +829,8 @@ nm_dedup_multi_index_obj_intern(NMDedupMultiIndex *                         self
     if (!g_hash_table_add(self->idx_objs, (gpointer) obj_new))
         nm_assert_not_reached();
 
-    ((NMDedupMultiObj *) obj_new)->_multi_idx = self;
+    ((NMDedupMultiObj *) obj_new)->_multi_idx      = self;
+    ((NMDedupMultiObj *) obj_new)->_obj_hash_cache = 0;
     return obj_new;
 }
 
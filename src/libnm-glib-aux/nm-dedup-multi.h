@@ -44,6 +44,12 @@ struct _NMDedupMultiObj {
     };
     NMDedupMultiIndex *_multi_idx;
     guint              _ref_count;
+
+    /* Free for the implementation to cache a hash of the object. It is
+     * reset when the object gets interned and only meaningful while the
+     * object is interned (and thus immutable). On 64 bit, this field fills
+     * what would otherwise be padding. */
+    guint _obj_hash_cache;
 };
 
 struct _NMDedupMultiObjClass {
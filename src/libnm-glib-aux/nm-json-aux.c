@@ -153,6 +153,78 @@ nm_json_gstr_append_obj_name(GString *gstr, const char *key, char start_containe
 
 /*****************************************************************************/
 
+/**
+ * nm_json_frame_scan:
+ * @scanner: the scanner state. Initialize with %NM_JSON_FRAME_SCANNER_INIT.
+ * @buf: the buffered input.
+ * @len: the length of @buf.
+ *
+ * Scans @buf for the end of the first JSON object or array. If @buf
+ * does not yet contain the complete text, the scanner remembers how far it
+ * got. Call it again once more data is appended to @buf, so that each byte
+ * is only scanned once.
+ *
+ * Returns: the length of the first complete JSON text in @buf (including leading
+ *   whitespace), after which @scanner is reset for the next one. 0 if the text is
+ *   not yet complete, and -1 if @buf does not start with a JSON object or array.
+ */
+gssize
+nm_json_frame_scan(NMJsonFrameScanner *scanner, const char *buf, gsize len)
+{
+    gsize i;
+
+    g_return_val_if_fail(scanner, -1);
+    g_return_val_if_fail(buf || len == 0, -1);
+    g_return_val_if_fail(scanner->scanned <= len, -1);
+
+    for (i = scanner->scanned; i < len; i++) {
+        const char ch = buf[i];
+
+        if (scanner->in_string) {
+            if (scanner->escaped)
+                scanner->escaped = FALSE;
+            else if (ch == '\\')
+                scanner->escaped = TRUE;
+            else if (ch == '"')
+                scanner->in_string = FALSE;
+            continue;
+        }
+
+        switch (ch) {
+        case '{':
+        case '[':
+            scanner->depth++;
+            break;
+        case '}':
+        case ']':
+            if (scanner->depth == 0)
+                return -1;
+            if (--scanner->depth == 0) {
+                *scanner = NM_JSON_FRAME_SCANNER_INIT;
+                return i + 1;
+            }
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            break;
+        case '"':
+            scanner->in_string = TRUE;
+            /* fall-through */
+        default:
+            if (scanner->depth == 0)
+                return -1;
+            break;
+        }
+    }
+
+    scanner->scanned = len;
+    return 0;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     NMJsonVt vt;
     void *   dl_handle;
@@ -35,6 +35,20 @@ nm_json_gstr_append_int64(GString *gstr, gint64 v)
 
 void nm_json_gstr_append_obj_name(GString *gstr, const char *key, char start_container);
 
+/* Finds the boundaries of JSON objects and arrays in a stream of
+ * concatenated JSON texts, like JSON-RPC over a socket. The scanner only
+ * tracks the nesting and strings, it does not validate the JSON. */
+typedef struct {
+    gsize scanned;
+    guint depth;
+    bool  in_string : 1;
+    bool  escaped : 1;
+} NMJsonFrameScanner;
+
+#define NM_JSON_FRAME_SCANNER_INIT ((NMJsonFrameScanner){})
+
+gssize nm_json_frame_scan(NMJsonFrameScanner *scanner, const char *buf, gsize len);
+
 /*****************************************************************************/
 
 #define NM_JSON_REJECT_DUPLICATES 0x1
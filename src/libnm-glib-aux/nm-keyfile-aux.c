@@ -10,23 +10,55 @@
 #include <syslog.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include "nm-io-utils.h"
 
 /*****************************************************************************/
 
+/* Instead of rewriting the whole keyfile on every flush, changes are appended
+ * to a journal file next to it ("$FILENAME.journal"). It starts with a header
+ * line, followed by one line per changed key:
+ *
+ *   +$KEY=$RAW_VALUE
+ *   -$KEY
+ *
+ * where $RAW_VALUE is the escaped value as it would be written to the keyfile.
+ * On start, the journal gets replayed on top of the keyfile. Once the journal
+ * grows larger than the keyfile, it gets compacted by writing the keyfile anew
+ * and deleting the journal. The keyfile stays the canonical format, which is
+ * also written when flushing with "force". */
+#define JOURNAL_HEADER "# NMKeyFileDB journal v1"
+
+/* the journal is compacted when it is larger than the keyfile, but not before
+ * it reaches this size. */
+#define JOURNAL_COMPACT_MIN_SIZE ((gsize) (64 * 1024))
+
 struct _NMKeyFileDB {
     NMKeyFileDBLogFcn      log_fcn;
     NMKeyFileDBGotDirtyFcn got_dirty_fcn;
     gpointer               user_data;
     const char *           group_name;
+    const char *           journal_filename;
     GKeyFile *             kf;
     guint                  ref_count;
 
+    /* the keys that changed since the last flush. */
+    GHashTable *journal_keys;
+
+    /* the size of the keyfile when it was last loaded or written, and the
+     * size of the journal. */
+    gsize kf_size;
+    gsize journal_size;
+
     bool is_started : 1;
     bool dirty : 1;
     bool destroyed : 1;
 
+    /* the journal cannot be appended to (for example, because it ends with an
+     * incomplete line). The next flush compacts it. */
+    bool journal_broken : 1;
+
     char filename[];
 };
 
@@ -74,6 +106,7 @@ nm_key_file_db_new(const char *           filename,
     NMKeyFileDB *self;
     gsize        l_filename;
     gsize        l_group;
+    char *       s;
 
     g_return_val_if_fail(filename && filename[0], NULL);
     g_return_val_if_fail(group_name && group_name[0], NULL);
@@ -81,7 +114,8 @@ nm_key_file_db_new(const char *           filename,
     l_filename = strlen(filename);
     l_group    = strlen(group_name);
 
-    self                = g_malloc0(sizeof(NMKeyFileDB) + l_filename + 1 + l_group + 1);
+    self = g_malloc0(sizeof(NMKeyFileDB) + l_filename + 1 + l_group + 1 + l_filename
+                     + NM_STRLEN(".journal") + 1);
     self->ref_count     = 1;
     self->log_fcn       = log_fcn;
     self->got_dirty_fcn = got_dirty_fcn;
@@ -91,6 +125,10 @@ nm_key_file_db_new(const char *           filename,
     memcpy(self->filename, filename, l_filename + 1);
     self->group_name = &self->filename[l_filename + 1];
     memcpy((char *) self->group_name, group_name, l_group + 1);
+    s                      = (char *) &self->group_name[l_group + 1];
+    self->journal_filename = s;
+    memcpy(s, filename, l_filename);
+    memcpy(&s[l_filename], ".journal", NM_STRLEN(".journal") + 1);
 
     return self;
 }
@@ -120,6 +158,7 @@ nm_key_file_db_unref(NMKeyFileDB *self)
         return;
 
     g_key_file_unref(self->kf);
+    nm_g_hash_table_unref(self->journal_keys);
 
     g_free(self);
 }
@@ -155,6 +194,80 @@ nm_key_file_db_destroy(NMKeyFileDB *self)
 
 /*****************************************************************************/
 
+static void
+_journal_replay(NMKeyFileDB *self)
+{
+    gs_free char *contents = NULL;
+    gsize         contents_len;
+    gs_free_error GError *error = NULL;
+    int                   errsv;
+    const char *          line;
+    const char *          line_end;
+    const char *          end;
+    guint                 n_entries = 0;
+
+    if (!nm_utils_file_get_contents(-1,
+                                    self->journal_filename,
+                                    20 * 1024 * 1024,
+                                    NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
+                                    &contents,
+                                    &contents_len,
+                                    &errsv,
+                                    &error)) {
+        if (errsv != ENOENT) {
+            _LOGD("failed to read journal \"%s\": %s", self->journal_filename, error->message);
+            self->journal_broken = TRUE;
+        }
+        return;
+    }
+
+    self->journal_size = contents_len;
+
+    if (contents_len < NM_STRLEN(JOURNAL_HEADER "\n")
+        || memcmp(contents, JOURNAL_HEADER "\n", NM_STRLEN(JOURNAL_HEADER "\n")) != 0) {
+        _LOGD("ignore journal \"%s\" with unknown format", self->journal_filename);
+        self->journal_broken = TRUE;
+        return;
+    }
+
+    end = &contents[contents_len];
+    for (line = &contents[NM_STRLEN(JOURNAL_HEADER "\n")]; line < end; line = &line_end[1]) {
+        gs_free char *key = NULL;
+        const char *  eq;
+
+        line_end = memchr(line, '\n', end - line);
+        if (!line_end) {
+            /* the last line is incomplete, probably because we crashed while
+             * writing it. Ignore it. */
+            self->journal_broken = TRUE;
+            break;
+        }
+
+        if (line[0] == '+') {
+            eq = memchr(line, '=', line_end - line);
+            if (!eq || eq == &line[1])
+                goto bad_line;
+            key                  = g_strndup(&line[1], eq - &line[1]);
+            *((char *) line_end) = '\0';
+            g_key_file_set_value(self->kf, self->group_name, key, &eq[1]);
+        } else if (line[0] == '-') {
+            if (line_end == &line[1])
+                goto bad_line;
+            key = g_strndup(&line[1], line_end - &line[1]);
+            g_key_file_remove_key(self->kf, self->group_name, key, NULL);
+        } else
+            goto bad_line;
+
+        n_entries++;
+        continue;
+
+bad_line:
+        _LOGD("ignore invalid line in journal \"%s\"", self->journal_filename);
+    }
+
+    _LOGD("replayed %u entries from journal \"%s\"", n_entries, self->journal_filename);
+}
+
 /* nm_key_file_db_start() is supposed to be called right away, after creating the
  * instance.
  *
@@ -182,19 +295,20 @@ nm_key_file_db_start(NMKeyFileDB *self)
                                     NULL,
                                     &error)) {
         _LOGD("failed to read \"%s\": %s", self->filename, error->message);
-        return;
-    }
-
-    if (!g_key_file_load_from_data(self->kf,
-                                   contents,
-                                   contents_len,
-                                   G_KEY_FILE_KEEP_COMMENTS,
-                                   &error)) {
+        g_clear_error(&error);
+    } else if (!g_key_file_load_from_data(self->kf,
+                                          contents,
+                                          contents_len,
+                                          G_KEY_FILE_KEEP_COMMENTS,
+                                          &error)) {
         _LOGD("failed to load keyfile \"%s\": %s", self->filename, error->message);
-        return;
+        g_clear_error(&error);
+    } else {
+        self->kf_size = contents_len;
+        _LOGD("loaded keyfile-db for \"%s\"", self->filename);
     }
 
-    _LOGD("loaded keyfile-db for \"%s\"", self->filename);
+    _journal_replay(self);
 }
 
 /*****************************************************************************/
@@ -235,6 +349,15 @@ nm_key_file_db_get_string_list(NMKeyFileDB *self, const char *key, gsize *out_le
 
 /*****************************************************************************/
 
+static void
+_journal_record(NMKeyFileDB *self, const char *key)
+{
+    if (!self->journal_keys)
+        self->journal_keys = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
+    if (!g_hash_table_contains(self->journal_keys, key))
+        g_hash_table_add(self->journal_keys, g_strdup(key));
+}
+
 static void
 _got_dirty(NMKeyFileDB *self, const char *key)
 {
@@ -260,14 +383,14 @@ nm_key_file_db_remove_key(NMKeyFileDB *self, const char *key)
     if (!key)
         return;
 
-    if (!self->dirty) {
-        gs_free_error GError *error = NULL;
+    if (!g_key_file_has_key(self->kf, self->group_name, key, NULL))
+        return;
 
-        g_key_file_has_key(self->kf, self->group_name, key, &error);
-        got_dirty = (error != NULL);
-    }
     g_key_file_remove_key(self->kf, self->group_name, key, NULL);
 
+    got_dirty = !self->dirty;
+    _journal_record(self, key);
+
     if (got_dirty)
         _got_dirty(self, key);
 }
@@ -305,6 +428,9 @@ nm_key_file_db_set_value(NMKeyFileDB *self, const char *key, const char *value)
             got_dirty = TRUE;
     }
 
+    if (got_dirty || self->dirty)
+        _journal_record(self, key);
+
     if (got_dirty)
         _got_dirty(self, key);
 }
@@ -348,17 +474,145 @@ nm_key_file_db_set_string_list(NMKeyFileDB *      self,
             got_dirty = TRUE;
     }
 
+    if (got_dirty || self->dirty)
+        _journal_record(self, key);
+
     if (got_dirty)
         _got_dirty(self, key);
 }
 
 /*****************************************************************************/
 
-void
-nm_key_file_db_to_file(NMKeyFileDB *self, gboolean force)
+static gboolean
+_journal_append(NMKeyFileDB *self)
+{
+    nm_auto_free_gstring GString *str = NULL;
+    nm_auto_close int             fd  = -1;
+    GHashTableIter                h_iter;
+    const char *                  key;
+    const char *                  data;
+    gsize                         len;
+    guint                         n_entries;
+
+    nm_assert(!self->journal_broken);
+
+    n_entries = nm_g_hash_table_size(self->journal_keys);
+    if (n_entries == 0)
+        return TRUE;
+
+    str = g_string_new(NULL);
+    if (self->journal_size == 0)
+        g_string_append(str, JOURNAL_HEADER "\n");
+
+    g_hash_table_iter_init(&h_iter, self->journal_keys);
+    while (g_hash_table_iter_next(&h_iter, (gpointer *) &key, NULL)) {
+        gs_free char *value = NULL;
+
+        if (NM_STRCHAR_ANY(key, ch, NM_IN_SET(ch, '\n', '\r', '=')))
+            return FALSE;
+
+        value = g_key_file_get_value(self->kf, self->group_name, key, NULL);
+        if (!value)
+            g_string_append_printf(str, "-%s\n", key);
+        else {
+            if (strchr(value, '\n'))
+                return FALSE;
+            g_string_append_printf(str, "+%s=%s\n", key, value);
+        }
+    }
+
+    fd = open(self->journal_filename, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        _LOGD("failure to open journal \"%s\": %s",
+              self->journal_filename,
+              nm_strerror_native(errno));
+        return FALSE;
+    }
+
+    data = str->str;
+    len  = str->len;
+    while (len > 0) {
+        gssize n;
+
+        n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            _LOGD("failure to write journal \"%s\": %s",
+                  self->journal_filename,
+                  nm_strerror_native(errno));
+            /* we may have written part of a line. */
+            self->journal_broken = TRUE;
+            return FALSE;
+        }
+        data += n;
+        len -= n;
+        self->journal_size += n;
+    }
+
+    g_hash_table_remove_all(self->journal_keys);
+    _LOGD("append %u entries to journal \"%s\"", n_entries, self->journal_filename);
+    return TRUE;
+}
+
+static void
+_compact(NMKeyFileDB *self)
 {
     gs_free_error GError *error = NULL;
+    gs_free char *        data  = NULL;
+    gsize                 len;
+
+    /* If we crash after writing the keyfile but before deleting the journal,
+     * the journal gets replayed on top of the new keyfile. That is only
+     * correct if the journal contains all changes, so append them first.
+     * If that fails, delete the journal right away, which in the worst case
+     * loses changes that were not in the keyfile. */
+    if (self->journal_size > 0 && (self->journal_broken || !_journal_append(self))) {
+        if (unlink(self->journal_filename) != 0 && errno != ENOENT) {
+            _LOGD("failure to delete journal \"%s\": %s",
+                  self->journal_filename,
+                  nm_strerror_native(errno));
+        }
+        self->journal_size = 0;
+    }
+
+    data = g_key_file_to_data(self->kf, &len, NULL);
+    if (!g_file_set_contents(self->filename, data, len, &error)) {
+        _LOGD("failure to write keyfile \"%s\": %s", self->filename, error->message);
+        return;
+    }
 
+    _LOGD("write keyfile: \"%s\"", self->filename);
+
+    self->kf_size = len;
+    if (self->journal_keys)
+        g_hash_table_remove_all(self->journal_keys);
+
+    if (self->journal_size > 0 || self->journal_broken) {
+        if (unlink(self->journal_filename) != 0 && errno != ENOENT) {
+            _LOGD("failure to delete journal \"%s\": %s",
+                  self->journal_filename,
+                  nm_strerror_native(errno));
+            self->journal_broken = TRUE;
+            return;
+        }
+        self->journal_size   = 0;
+        self->journal_broken = FALSE;
+    }
+}
+
+/**
+ * nm_key_file_db_to_file:
+ * @self: the #NMKeyFileDB
+ * @force: if %TRUE, write the keyfile even if there are no changes.
+ *
+ * Persist the changes. Usually, the changes are only appended to the
+ * journal. With @force, or when the journal grew too large, the keyfile
+ * is written and the journal deleted.
+ */
+void
+nm_key_file_db_to_file(NMKeyFileDB *self, gboolean force)
+{
     g_return_if_fail(_IS_KEY_FILE_DB(self, TRUE, FALSE));
 
     if (!force && !self->dirty)
@@ -366,8 +620,10 @@ nm_key_file_db_to_file(NMKeyFileDB *self, gboolean force)
 
     self->dirty = FALSE;
 
-    if (!g_key_file_save_to_file(self->kf, self->filename, &error)) {
-        _LOGD("failure to write keyfile \"%s\": %s", self->filename, error->message);
-    } else
-        _LOGD("write keyfile: \"%s\"", self->filename);
+    if (!force && !self->journal_broken
+        && self->journal_size < NM_MAX(self->kf_size, JOURNAL_COMPACT_MIN_SIZE)
+        && _journal_append(self))
+        return;
+
+    _compact(self);
 }
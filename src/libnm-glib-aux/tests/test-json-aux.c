@@ -5,6 +5,7 @@
 #include <jansson.h>
 
 #include "libnm-glib-aux/nm-json-aux.h"
+#include "libnm-glib-aux/nm-time-utils.h"
 
 #include "libnm-glib-aux/nm-test-utils.h"
 
@@ -152,6 +153,222 @@ test_jansson(void)
 
 /*****************************************************************************/
 
+static void
+_assert_frames(const char *input, gsize chunk_size, const char *const *expected)
+{
+    NMJsonFrameScanner scanner = NM_JSON_FRAME_SCANNER_INIT;
+    const gsize        len     = strlen(input);
+    gsize              offset  = 0;
+    gsize              avail   = 0;
+    guint              n       = 0;
+
+    /* feed the input in chunks of @chunk_size bytes. */
+    while (avail < len) {
+        gssize frame_len;
+
+        avail = NM_MIN(avail + chunk_size, len);
+
+        while ((frame_len = nm_json_frame_scan(&scanner, &input[offset], avail - offset))
+               > 0) {
+            gs_free char *frame = g_strndup(&input[offset], frame_len);
+
+            g_assert(expected[n]);
+            g_assert_cmpstr(g_strstrip(frame), ==, expected[n]);
+            n++;
+            offset += frame_len;
+        }
+        g_assert_cmpint(frame_len, ==, 0);
+    }
+
+    g_assert(!expected[n]);
+}
+
+static void
+test_json_frame_scan(void)
+{
+    const char *const input     = "{\"a\": [1, 2, {}]}\n"
+                                  " [\"}\\\"]\", \"\\\\\"]"
+                                  "{\"id\":1,\"result\":{\"x\":\"{[\"}}\r\n";
+    const char *const expected[] = {
+        "{\"a\": [1, 2, {}]}",
+        "[\"}\\\"]\", \"\\\\\"]",
+        "{\"id\":1,\"result\":{\"x\":\"{[\"}}",
+        NULL,
+    };
+    NMJsonFrameScanner scanner;
+    gsize              chunk_size;
+
+    for (chunk_size = 1; chunk_size <= strlen(input) + 1; chunk_size++)
+        _assert_frames(input, chunk_size, expected);
+
+    scanner = NM_JSON_FRAME_SCANNER_INIT;
+    g_assert_cmpint(nm_json_frame_scan(&scanner, " 1", 2), ==, -1);
+    scanner = NM_JSON_FRAME_SCANNER_INIT;
+    g_assert_cmpint(nm_json_frame_scan(&scanner, "\"a\"", 3), ==, -1);
+    scanner = NM_JSON_FRAME_SCANNER_INIT;
+    g_assert_cmpint(nm_json_frame_scan(&scanner, "}", 1), ==, -1);
+    scanner = NM_JSON_FRAME_SCANNER_INIT;
+    g_assert_cmpint(nm_json_frame_scan(&scanner, "  ", 2), ==, 0);
+}
+
+/*****************************************************************************/
+
+/* Generates an ovsdb "update" notification as ovsdb-server sends it for the
+ * monitor of NMOvsdb, with one bridge with @n_ports ports, each with
+ * one interface. */
+static char *
+_ovsdb_monitor_update_new(guint n_ports)
+{
+    GString *str = g_string_sized_new(n_ports * 400u);
+    guint    i;
+
+    g_string_append(str, "{\"id\":null,\"method\":\"update\",\"params\":[null,{\"Port\":{");
+    for (i = 0; i < n_ports; i++) {
+        g_string_append_printf(
+            str,
+            "%s\"00000000-0000-0000-0001-%012u\":{\"new\":{\"name\":\"port%u\","
+            "\"interfaces\":[\"uuid\",\"00000000-0000-0000-0002-%012u\"],"
+            "\"external_ids\":[\"map\",[[\"NM.connection.uuid\","
+            "\"11111111-0000-0000-0001-%012u\"]]]}}",
+            i == 0 ? "" : ",",
+            i,
+            i,
+            i,
+            i);
+    }
+    g_string_append(str, "},\"Interface\":{");
+    for (i = 0; i < n_ports; i++) {
+        g_string_append_printf(
+            str,
+            "%s\"00000000-0000-0000-0002-%012u\":{\"new\":{\"name\":\"iface%u\","
+            "\"type\":\"internal\",\"error\":[\"set\",[]],"
+            "\"external_ids\":[\"map\",[[\"NM.connection.uuid\","
+            "\"11111111-0000-0000-0002-%012u\"]]]}}",
+            i == 0 ? "" : ",",
+            i,
+            i,
+            i);
+    }
+    g_string_append(str, "},\"Bridge\":{\"00000000-0000-0000-0000-000000000001\":{\"new\":{");
+    g_string_append(str, "\"name\":\"br0\",\"ports\":[\"set\",[");
+    for (i = 0; i < n_ports; i++) {
+        g_string_append_printf(str,
+                               "%s[\"uuid\",\"00000000-0000-0000-0001-%012u\"]",
+                               i == 0 ? "" : ",",
+                               i);
+    }
+    g_string_append(str, "]],\"external_ids\":[\"map\",[]]}}}}]}\n");
+    return g_string_free(str, FALSE);
+}
+
+typedef struct {
+    const char *input;
+    gsize       avail;
+    gsize       bufp;
+} BenchLoadData;
+
+static size_t
+_bench_load_callback(void *buffer, size_t buflen, void *user_data)
+{
+    BenchLoadData *data = user_data;
+
+    if (data->bufp == data->avail)
+        return 0;
+
+    *(char *) buffer = data->input[data->bufp++];
+    return 1;
+}
+
+static void
+test_json_frame_scan_bench(void)
+{
+    const guint   N_PORTS    = 10000;
+    const gsize   CHUNK_SIZE = 4096;
+    gs_free char *input      = _ovsdb_monitor_update_new(N_PORTS);
+    const gsize   len        = strlen(input);
+    gint64        start_time;
+    gint64        time_frame;
+    gint64        time_callback;
+    gsize         avail;
+    json_t *      msg;
+    json_error_t  json_error;
+
+    if (nmtst_test_quick()) {
+        g_print("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n",
+                g_get_prgname() ?: "test-json-aux");
+        g_test_skip("Skip long running test");
+        return;
+    }
+
+    /* Decode the update as it arrives from the socket, in chunks of 4 KiB. */
+
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    {
+        NMJsonFrameScanner scanner = NM_JSON_FRAME_SCANNER_INIT;
+        gssize             frame_len;
+
+        msg = NULL;
+        for (avail = 0; avail < len;) {
+            avail     = NM_MIN(avail + CHUNK_SIZE, len);
+            frame_len = nm_json_frame_scan(&scanner, input, avail);
+            if (frame_len == 0)
+                continue;
+            g_assert_cmpint(frame_len, ==, len - 1);
+            msg = json_loadb(input, frame_len, 0, &json_error);
+        }
+        g_assert(msg);
+        g_assert_cmpint(json_object_size(json_object_get(json_array_get(json_object_get(msg,
+                                                                                        "params"),
+                                                                        1),
+                                                         "Port")),
+                        ==,
+                        N_PORTS);
+        json_decref(msg);
+    }
+    time_frame = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    /* For comparison, the previous approach: after each chunk, let jansson
+     * parse the buffer from the start, one byte per callback. */
+
+    start_time = nm_utils_get_monotonic_timestamp_nsec();
+    {
+        BenchLoadData data = {
+            .input = input,
+        };
+
+        msg = NULL;
+        for (avail = 0; avail < len;) {
+            avail      = NM_MIN(avail + CHUNK_SIZE, len);
+            data.avail = avail;
+            data.bufp  = 0;
+            msg        = json_load_callback(_bench_load_callback,
+                                     &data,
+                                     JSON_DISABLE_EOF_CHECK,
+                                     &json_error);
+            if (msg)
+                break;
+            if (nm_utils_get_monotonic_timestamp_nsec() - start_time
+                > 5000 * NM_UTILS_NSEC_PER_MSEC) {
+                /* this is quadratic. Don't wait for it. */
+                break;
+            }
+        }
+        nm_clear_pointer(&msg, json_decref);
+    }
+    time_callback = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+
+    g_test_message(">>> monitor update with %u ports (%" G_GSIZE_FORMAT
+                   " bytes): frame scan %" G_GINT64_FORMAT
+                   " msec, byte callback %" G_GINT64_FORMAT " msec%s",
+                   N_PORTS,
+                   len,
+                   time_frame / NM_UTILS_NSEC_PER_MSEC,
+                   time_callback / NM_UTILS_NSEC_PER_MSEC,
+                   avail < len ? " (aborted)" : "");
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -160,6 +377,8 @@ main(int argc, char **argv)
     nmtst_init(&argc, &argv, TRUE);
 
     g_test_add_func("/general/test_jansson", test_jansson);
+    g_test_add_func("/general/test_json_frame_scan", test_json_frame_scan);
+    g_test_add_func("/general/test_json_frame_scan_bench", test_json_frame_scan_bench);
 
     return g_test_run();
 }
@@ -5,11 +5,16 @@
 
 #include "libnm-glib-aux/nm-default-glib-i18n-prog.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "libnm-std-aux/unaligned.h"
 #include "libnm-glib-aux/nm-random-utils.h"
 #include "libnm-glib-aux/nm-str-buf.h"
 #include "libnm-glib-aux/nm-time-utils.h"
 #include "libnm-glib-aux/nm-ref-string.h"
+#include "libnm-glib-aux/nm-keyfile-aux.h"
+#include "libnm-glib-aux/nm-io-utils.h"
 
 #include "libnm-glib-aux/nm-test-utils.h"
 
@@ -1259,6 +1264,259 @@ again:
 
 /*****************************************************************************/
 
+#define KEY_FILE_DB_GROUP "timestamps"
+
+/* see JOURNAL_COMPACT_MIN_SIZE in nm-keyfile-aux.c. */
+#define KEY_FILE_DB_COMPACT_MIN_SIZE (64 * 1024)
+
+typedef struct {
+    char *dirname;
+    char *filename;
+    char *journal_filename;
+} KeyFileDBFixture;
+
+static void
+_key_file_db_fixture_init(KeyFileDBFixture *f, const char *kf_contents, const char *journal)
+{
+    gs_free_error GError *error = NULL;
+
+    f->dirname = g_dir_make_tmp("nm-test-keyfile-db-XXXXXX", &error);
+    g_assert_no_error(error);
+    f->filename         = g_build_filename(f->dirname, "db", NULL);
+    f->journal_filename = g_strdup_printf("%s.journal", f->filename);
+
+    if (kf_contents) {
+        nmtst_assert_success(
+            nm_utils_file_set_contents(f->filename, kf_contents, -1, 0644, NULL, &error),
+            error);
+    }
+    if (journal) {
+        nmtst_assert_success(
+            nm_utils_file_set_contents(f->journal_filename, journal, -1, 0644, NULL, &error),
+            error);
+    }
+}
+
+static void
+_key_file_db_fixture_clear(KeyFileDBFixture *f)
+{
+    (void) unlink(f->journal_filename);
+    (void) unlink(f->filename);
+    g_assert_cmpint(rmdir(f->dirname), ==, 0);
+    nm_clear_g_free(&f->journal_filename);
+    nm_clear_g_free(&f->filename);
+    nm_clear_g_free(&f->dirname);
+}
+
+static NMKeyFileDB *
+_key_file_db_new(KeyFileDBFixture *f)
+{
+    NMKeyFileDB *db;
+
+    db = nm_key_file_db_new(f->filename, KEY_FILE_DB_GROUP, NULL, NULL, NULL);
+    nm_key_file_db_start(db);
+    g_assert(!nm_key_file_db_is_dirty(db));
+    return db;
+}
+
+#define _assert_key_file_db_value(db, key, expected)                  \
+    G_STMT_START                                                      \
+    {                                                                 \
+        gs_free char *_value = nm_key_file_db_get_value((db), (key)); \
+                                                                      \
+        g_assert_cmpstr(_value, ==, (expected));                      \
+    }                                                                 \
+    G_STMT_END
+
+/* the value of @key in the keyfile on disk, ignoring the journal. */
+static char *
+_key_file_db_read_value(KeyFileDBFixture *f, const char *key)
+{
+    nm_auto_unref_keyfile GKeyFile *kf = g_key_file_new();
+
+    if (!g_key_file_load_from_file(kf, f->filename, G_KEY_FILE_NONE, NULL))
+        return NULL;
+    return g_key_file_get_value(kf, KEY_FILE_DB_GROUP, key, NULL);
+}
+
+static gsize
+_key_file_db_get_size(const char *filename)
+{
+    struct stat st;
+
+    if (stat(filename, &st) != 0) {
+        g_assert_cmpint(errno, ==, ENOENT);
+        return 0;
+    }
+    return st.st_size;
+}
+
+static void
+test_key_file_db_journal(void)
+{
+    KeyFileDBFixture f = {};
+    NMKeyFileDB *    db;
+    gs_free char *   kf_value = NULL;
+
+    _key_file_db_fixture_init(&f, "[" KEY_FILE_DB_GROUP "]\na=1\nb=2\n", NULL);
+
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "a", "1");
+    _assert_key_file_db_value(db, "b", "2");
+
+    nm_key_file_db_set_value(db, "a", "10");
+    g_assert(nm_key_file_db_is_dirty(db));
+    nm_key_file_db_set_value(db, "c", "3");
+    nm_key_file_db_remove_key(db, "b");
+    nm_key_file_db_to_file(db, FALSE);
+    g_assert(!nm_key_file_db_is_dirty(db));
+    nm_key_file_db_destroy(db);
+
+    /* the changes were only appended to the journal. */
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), >, 0);
+    kf_value = _key_file_db_read_value(&f, "a");
+    g_assert_cmpstr(kf_value, ==, "1");
+    nm_clear_g_free(&kf_value);
+    kf_value = _key_file_db_read_value(&f, "b");
+    g_assert_cmpstr(kf_value, ==, "2");
+    nm_clear_g_free(&kf_value);
+
+    /* ... and get replayed on top of the keyfile. The removed key stays
+     * removed. */
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "a", "10");
+    _assert_key_file_db_value(db, "b", NULL);
+    _assert_key_file_db_value(db, "c", "3");
+
+    /* a later change of the same key wins. */
+    nm_key_file_db_set_value(db, "b", "20");
+    nm_key_file_db_to_file(db, FALSE);
+    nm_key_file_db_remove_key(db, "b");
+    nm_key_file_db_to_file(db, FALSE);
+    nm_key_file_db_destroy(db);
+
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "a", "10");
+    _assert_key_file_db_value(db, "b", NULL);
+    _assert_key_file_db_value(db, "c", "3");
+    nm_key_file_db_destroy(db);
+
+    _key_file_db_fixture_clear(&f);
+}
+
+static void
+test_key_file_db_journal_broken(gconstpointer test_data)
+{
+    const int        TEST_IDX = GPOINTER_TO_INT(test_data);
+    KeyFileDBFixture f        = {};
+    NMKeyFileDB *    db;
+    gs_free char *   kf_value = NULL;
+
+    if (TEST_IDX == 1) {
+        /* the last line is incomplete, as after a crash while appending. */
+        _key_file_db_fixture_init(&f,
+                                  "[" KEY_FILE_DB_GROUP "]\na=1\n",
+                                  "# NMKeyFileDB journal v1\n+a=2\n+b=3");
+    } else {
+        /* a journal in a format we don't know. */
+        _key_file_db_fixture_init(&f,
+                                  "[" KEY_FILE_DB_GROUP "]\na=1\n",
+                                  "# NMKeyFileDB journal v2\n+a=2\n");
+    }
+
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "a", TEST_IDX == 1 ? "2" : "1");
+    _assert_key_file_db_value(db, "b", NULL);
+
+    /* the journal cannot be appended to. The next flush compacts it. */
+    nm_key_file_db_set_value(db, "c", "4");
+    nm_key_file_db_to_file(db, FALSE);
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), ==, 0);
+    kf_value = _key_file_db_read_value(&f, "a");
+    g_assert_cmpstr(kf_value, ==, TEST_IDX == 1 ? "2" : "1");
+    nm_clear_g_free(&kf_value);
+    kf_value = _key_file_db_read_value(&f, "c");
+    g_assert_cmpstr(kf_value, ==, "4");
+    nm_clear_g_free(&kf_value);
+
+    /* afterwards, a new journal gets started. */
+    nm_key_file_db_set_value(db, "c", "5");
+    nm_key_file_db_to_file(db, FALSE);
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), >, 0);
+    nm_key_file_db_destroy(db);
+
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "c", "5");
+    nm_key_file_db_destroy(db);
+
+    _key_file_db_fixture_clear(&f);
+}
+
+static void
+test_key_file_db_compact(void)
+{
+    KeyFileDBFixture f = {};
+    NMKeyFileDB *    db;
+    gs_free char *   kf_value = NULL;
+    gsize            journal_size;
+    guint            i;
+
+    _key_file_db_fixture_init(&f, NULL, NULL);
+
+    db = _key_file_db_new(&f);
+
+    /* flushing with force writes the keyfile, even without changes. */
+    nm_key_file_db_to_file(db, TRUE);
+    g_assert(g_file_test(f.filename, G_FILE_TEST_EXISTS));
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), ==, 0);
+
+    /* the journal grows until it reaches the minimum size, then it gets
+     * compacted into the keyfile. */
+    journal_size = 0;
+    for (i = 0;; i++) {
+        char key[100];
+        char value[100];
+
+        g_assert_cmpint(i, <, 10000);
+
+        nm_sprintf_buf(key, "key-%u", i % 50);
+        nm_sprintf_buf(value, "%u-%064u", i, i);
+        nm_key_file_db_set_value(db, key, value);
+        nm_key_file_db_to_file(db, FALSE);
+
+        if (_key_file_db_get_size(f.journal_filename) == 0)
+            break;
+        journal_size = _key_file_db_get_size(f.journal_filename);
+    }
+    g_assert_cmpint(journal_size, >=, KEY_FILE_DB_COMPACT_MIN_SIZE);
+    kf_value = _key_file_db_read_value(&f, "key-0");
+    g_assert(kf_value);
+    nm_clear_g_free(&kf_value);
+
+    /* pending changes go to the keyfile with force. */
+    nm_key_file_db_set_value(db, "key-0", "forced");
+    nm_key_file_db_to_file(db, FALSE);
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), >, 0);
+    nm_key_file_db_remove_key(db, "key-1");
+    nm_key_file_db_to_file(db, TRUE);
+    g_assert_cmpint(_key_file_db_get_size(f.journal_filename), ==, 0);
+    kf_value = _key_file_db_read_value(&f, "key-0");
+    g_assert_cmpstr(kf_value, ==, "forced");
+    nm_clear_g_free(&kf_value);
+    kf_value = _key_file_db_read_value(&f, "key-1");
+    g_assert_cmpstr(kf_value, ==, NULL);
+    nm_key_file_db_destroy(db);
+
+    db = _key_file_db_new(&f);
+    _assert_key_file_db_value(db, "key-0", "forced");
+    _assert_key_file_db_value(db, "key-1", NULL);
+    nm_key_file_db_destroy(db);
+
+    _key_file_db_fixture_clear(&f);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -1287,6 +1545,14 @@ main(int argc, char **argv)
     g_test_add_func("/general/test_is_specific_hostname", test_is_specific_hostname);
     g_test_add_func("/general/test_strv_dup_packed", test_strv_dup_packed);
     g_test_add_func("/general/test_utils_hashtable_cmp", test_utils_hashtable_cmp);
+    g_test_add_func("/general/test_key_file_db_journal", test_key_file_db_journal);
+    g_test_add_data_func("/general/test_key_file_db_journal_broken/1",
+                         GINT_TO_POINTER(1),
+                         test_key_file_db_journal_broken);
+    g_test_add_data_func("/general/test_key_file_db_journal_broken/2",
+                         GINT_TO_POINTER(2),
+                         test_key_file_db_journal_broken);
+    g_test_add_func("/general/test_key_file_db_compact", test_key_file_db_compact);
 
     return g_test_run();
 }
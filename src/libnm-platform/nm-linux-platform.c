@@ -14,6 +14,7 @@
 #include <libudev.h>
 #include <net/ethernet.h>
 #include <linux/fib_rules.h>
+#include <linux/filter.h>
 #include <linux/ip.h>
 #include <linux/if.h>
 #include <linux/if_bridge.h>
@@ -408,10 +409,21 @@ typedef struct {
         NMPObject **out_route_get;
         gpointer    out_data;
     } response;
+
+    /* whether the request adds or deletes a route. */
+    bool is_route_change : 1;
 } DelayedActionWaitForNlResponseData;
 
 /*****************************************************************************/
 
+/* The filters are also compiled to a socket filter, whose jump offsets
+ * are limited to 8 bit. Keep the number of filters well below that. */
+#define ROUTE_FILTERS_MAX 64
+
+/*****************************************************************************/
+
+NM_GOBJECT_PROPERTIES_DEFINE_BASE(PROP_IGNORE_ROUTES, );
+
 typedef struct {
     struct nl_sock *genl;
 
@@ -419,12 +431,23 @@ typedef struct {
 
     GSource *event_source;
 
+    /* route notifications are received on their own socket, so that a storm of
+     * route events does not delay (or overflow the buffer for) link and address
+     * events on @nlh. Requests, dumps and their responses still go via @nlh. */
+    struct nl_sock *nlh_route;
+
+    GSource *route_event_source;
+
     guint32 nlh_seq_next;
 #if NM_MORE_LOGGING
     guint32 nlh_seq_last_handled;
 #endif
     guint32 nlh_seq_last_seen;
 
+    /* the sequence number of the last successful route request. Its notification
+     * is still to be read from @nlh_route. */
+    guint32 nlh_route_seq_wait;
+
     guint32 pruning[_REFRESH_ALL_TYPE_NUM];
 
     GHashTable *sysctl_get_prev_values;
@@ -449,6 +472,19 @@ typedef struct {
         int is_handling;
     } delayed_action;
 
+    struct {
+        /* After losing netlink events (ENOBUFS), the object types in @pending
+         * still need to be re-dumped. We request only one type per main loop
+         * iteration from @idle_source, so that resyncing a huge cache does
+         * not block the daemon (and does not cause another ENOBUFS right away). */
+        DelayedActionType pending;
+        GSource *         idle_source;
+    } resync;
+
+    /* Routes matching any of these filters are dropped when parsing netlink
+     * messages and never enter the cache. See NM_LINUX_PLATFORM_IGNORE_ROUTES. */
+    GArray *route_filters;
+
 } NMLinuxPlatformPrivate;
 
 struct _NMLinuxPlatform {
@@ -557,7 +593,10 @@ static void cache_on_change(NMPlatform *     platform,
                             const NMPObject *obj_old,
                             const NMPObject *obj_new);
 static void cache_prune_all(NMPlatform *platform);
+static void resync_schedule(NMPlatform *platform, DelayedActionType types);
 static gboolean        event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks);
+static gboolean        event_handler_read_netlink_routes(NMPlatform *platform, guint max_reads);
+static void            event_handler_read_netlink_routes_sync(NMPlatform *platform);
 static struct nl_sock *_genl_sock(NMLinuxPlatform *platform);
 
 /*****************************************************************************/
@@ -5899,6 +5938,8 @@ delayed_action_wait_for_nl_response_complete(NMPlatform *            platform,
 
     if (priv->delayed_action.list_wait_for_nl_response->len <= 1)
         priv->delayed_action.flags &= ~DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE;
+    if (data->is_route_change && seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+        priv->nlh_route_seq_wait = data->seq_number;
     if (data->out_seq_result)
         *data->out_seq_result = seq_result;
     switch (data->response_type) {
@@ -6175,20 +6216,21 @@ delayed_action_schedule(NMPlatform *platform, DelayedActionType action_type, gpo
 
 static void
 delayed_action_schedule_WAIT_FOR_NL_RESPONSE(NMPlatform *                       platform,
-                                             guint32                            seq_number,
+                                             const struct nlmsghdr *            nlhdr,
                                              WaitForNlResponseResult *          out_seq_result,
                                              char **                            out_errmsg,
                                              DelayedActionWaitForNlResponseType response_type,
                                              gpointer                           response_out_data)
 {
     DelayedActionWaitForNlResponseData data = {
-        .seq_number = seq_number,
+        .seq_number = nlhdr->nlmsg_seq,
         .timeout_abs_ns =
             nm_utils_get_monotonic_timestamp_nsec() + (200 * (NM_UTILS_NSEC_PER_SEC / 1000)),
         .out_seq_result    = out_seq_result,
         .out_errmsg        = out_errmsg,
         .response_type     = response_type,
         .response.out_data = response_out_data,
+        .is_route_change   = NM_IN_SET(nlhdr->nlmsg_type, RTM_NEWROUTE, RTM_DELROUTE),
     };
 
     delayed_action_schedule(platform, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE, &data);
@@ -6196,6 +6238,104 @@ delayed_action_schedule_WAIT_FOR_NL_RESPONSE(NMPlatform *
 
 /*****************************************************************************/
 
+static DelayedActionType
+resync_next_chunk(DelayedActionType pending)
+{
+    DelayedActionType iflags;
+
+    /* Routing rules for both address families are requested together,
+     * because do_request_all_no_delayed_actions() can mark them dirty
+     * more efficiently that way. */
+    FOR_EACH_DELAYED_ACTION(iflags, pending)
+    {
+        if (NM_FLAGS_ANY(iflags, DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL))
+            return pending & DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL;
+        return iflags;
+    }
+    return DELAYED_ACTION_TYPE_NONE;
+}
+
+static void
+_log_alloc_stats(NMPlatform *platform)
+{
+    NMPObjectType obj_type;
+
+    if (!_LOGD_ENABLED())
+        return;
+
+    for (obj_type = NMP_OBJECT_TYPE_UNKNOWN + 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+        NMPObjectAllocStats stats;
+
+        nmp_object_alloc_stats_get(obj_type, &stats);
+        if (stats.n_allocated == 0)
+            continue;
+
+        _LOGD("nmp-object: %s: %u alive, %" G_GUINT64_FORMAT " freed",
+              nmp_class_from_type(obj_type)->obj_type_name,
+              stats.n_live,
+              stats.n_freed);
+    }
+}
+
+static gboolean
+resync_idle_cb(gpointer user_data)
+{
+    NMPlatform *            platform = user_data;
+    NMLinuxPlatformPrivate *priv     = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    DelayedActionType       action_type;
+
+    action_type = resync_next_chunk(priv->resync.pending);
+    if (action_type != DELAYED_ACTION_TYPE_NONE) {
+        /* delayed_action_schedule() logs the requested types. */
+        delayed_action_schedule(platform, action_type, NULL);
+        delayed_action_handle_all(platform, FALSE);
+    }
+
+    if (priv->resync.pending != DELAYED_ACTION_TYPE_NONE)
+        return G_SOURCE_CONTINUE;
+
+    _LOGD("netlink: resync: platform cache resynchronized");
+    _log_alloc_stats(platform);
+    nm_clear_g_source_inst(&priv->resync.idle_source);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+resync_schedule(NMPlatform *platform, DelayedActionType types)
+{
+    NMLinuxPlatformPrivate *priv            = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    DelayedActionType       action_type_now = DELAYED_ACTION_TYPE_NONE;
+    RefreshAllType          refresh_all_type;
+
+    nm_assert(types != DELAYED_ACTION_TYPE_NONE);
+    nm_assert(!NM_FLAGS_ANY(types, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
+
+    /* A dump that was in progress when we lost events is still going to
+     * prune the cache. It must be repeated right away, otherwise we would
+     * prune based on an incomplete dump. */
+    for (refresh_all_type = _REFRESH_ALL_TYPE_FIRST; refresh_all_type < _REFRESH_ALL_TYPE_NUM;
+         refresh_all_type++) {
+        if (priv->pruning[refresh_all_type] > 0)
+            action_type_now |= delayed_action_type_from_refresh_all_type(refresh_all_type);
+    }
+    action_type_now &= types;
+    if (action_type_now != DELAYED_ACTION_TYPE_NONE)
+        delayed_action_schedule(platform, action_type_now, NULL);
+
+    /* Everything else is re-dumped incrementally, one object type per
+     * main loop iteration. Types that are already scheduled for a
+     * refresh get handled by the delayed action. */
+    priv->resync.pending |= types & ~(action_type_now | priv->delayed_action.flags);
+
+    if (priv->resync.pending != DELAYED_ACTION_TYPE_NONE && !priv->resync.idle_source) {
+        priv->resync.idle_source =
+            nm_g_idle_source_new(G_PRIORITY_DEFAULT, resync_idle_cb, platform, NULL);
+        g_source_attach(priv->resync.idle_source, NULL);
+    }
+}
+
+/*****************************************************************************/
+
 static void
 cache_prune_one_type(NMPlatform *platform, const NMPLookup *lookup)
 {
@@ -6570,7 +6710,7 @@ again:
     }
 
     delayed_action_schedule_WAIT_FOR_NL_RESPONSE(platform,
-                                                 seq,
+                                                 nlhdr,
                                                  out_seq_result,
                                                  out_errmsg,
                                                  response_type,
@@ -6612,7 +6752,7 @@ _nl_send_nlmsg(NMPlatform *                       platform,
     }
 
     delayed_action_schedule_WAIT_FOR_NL_RESPONSE(platform,
-                                                 seq,
+                                                 nlhdr,
                                                  out_seq_result,
                                                  out_errmsg,
                                                  response_type,
@@ -6620,6 +6760,95 @@ _nl_send_nlmsg(NMPlatform *                       platform,
     return 0;
 }
 
+/* Upper bounds for how many requests get packed into one sendmsg() before
+ * waiting for the ACKs. This keeps the request well below the socket's send
+ * buffer and the (error) responses below the receive buffer, which we must
+ * not overflow as that would require a full resync. */
+#define OBJECT_BATCH_MAX_MSGS 128
+#define OBJECT_BATCH_MAX_LEN  (32 * 1024)
+
+/**
+ * _nl_send_nlmsg_batch:
+ * @platform:
+ * @nlmsgs: the netlink messages to send.
+ * @n_nlmsgs: the number of messages in @nlmsgs.
+ * @out_seq_results: array of @n_nlmsgs results, one for each message.
+ * @out_errmsgs: array of @n_nlmsgs error messages, one for each message.
+ *
+ * Like _nl_send_nlmsg(), but sends all messages with a single sendmsg() call.
+ * Kernel processes them in order and acknowledges each request separately,
+ * so the caller only needs to wait once for all responses.
+ *
+ * Returns: 0 on success or a negative errno.
+ */
+static int
+_nl_send_nlmsg_batch(NMPlatform *             platform,
+                     struct nl_msg *const *   nlmsgs,
+                     guint                    n_nlmsgs,
+                     WaitForNlResponseResult *out_seq_results,
+                     char **                  out_errmsgs)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    struct sockaddr_nl      nladdr = {
+        .nl_family = AF_NETLINK,
+    };
+    struct iovec  iov[OBJECT_BATCH_MAX_MSGS];
+    struct msghdr msg = {
+        .msg_name    = &nladdr,
+        .msg_namelen = sizeof(nladdr),
+        .msg_iov     = iov,
+        .msg_iovlen  = n_nlmsgs,
+    };
+    guint i;
+    int   try_count;
+    int   errsv;
+
+    nm_assert(n_nlmsgs > 0);
+    nm_assert(n_nlmsgs <= G_N_ELEMENTS(iov));
+
+    for (i = 0; i < n_nlmsgs; i++) {
+        struct nlmsghdr *nlhdr = nlmsg_hdr(nlmsgs[i]);
+
+        /* kernel walks the buffer in steps of NLMSG_ALIGN(). Our messages
+         * are always padded, so they can be concatenated as-is. */
+        nm_assert(NLMSG_ALIGN(nlhdr->nlmsg_len) == nlhdr->nlmsg_len);
+
+        nlhdr->nlmsg_seq = _nlh_seq_next_get(priv);
+        if (!nlhdr->nlmsg_pid)
+            nlhdr->nlmsg_pid = nl_socket_get_local_port(priv->nlh);
+        nlhdr->nlmsg_flags |= (NLM_F_REQUEST | NLM_F_ACK);
+
+        iov[i] = (struct iovec){
+            .iov_base = nlhdr,
+            .iov_len  = nlhdr->nlmsg_len,
+        };
+    }
+
+    try_count = 0;
+again:
+    errsv = sendmsg(nl_socket_get_fd(priv->nlh), &msg, 0);
+    if (errsv < 0) {
+        errsv = errno;
+        if (errsv == EINTR && try_count++ < 100)
+            goto again;
+        _LOGD("netlink: nl-send-nlmsg-batch: failed sending %u messages: %s (%d)",
+              n_nlmsgs,
+              nm_strerror_native(errsv),
+              errsv);
+        return -nm_errno_from_native(errsv);
+    }
+
+    for (i = 0; i < n_nlmsgs; i++) {
+        delayed_action_schedule_WAIT_FOR_NL_RESPONSE(platform,
+                                                     nlmsg_hdr(nlmsgs[i]),
+                                                     &out_seq_results[i],
+                                                     &out_errmsgs[i],
+                                                     DELAYED_ACTION_RESPONSE_TYPE_VOID,
+                                                     NULL);
+    }
+    return 0;
+}
+
 static void
 do_request_link_no_delayed_actions(NMPlatform *platform, int ifindex, const char *name)
 {
@@ -6728,6 +6957,19 @@ do_request_all_no_delayed_actions(NMPlatform *platform, DelayedActionType action
     nm_assert(!NM_FLAGS_ANY(action_type, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
     action_type &= DELAYED_ACTION_TYPE_REFRESH_ALL;
 
+    if (NM_FLAGS_ANY(action_type,
+                     DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
+                         | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES)) {
+        /* Route notifications arrive on their own socket. Process those that are
+         * already queued before marking the cache dirty, otherwise an older
+         * RTM_NEWROUTE would be handled after the dump got pruned and bring
+         * back a route that no longer exists. */
+        event_handler_read_netlink_routes(platform, 0);
+    }
+
+    /* a pending resync of these types is fulfilled by this request. */
+    priv->resync.pending &= ~action_type;
+
     action_type_prune = action_type;
 
     /* calling nmp_cache_dirty_set_all_main() with a non-main lookup-index requires an extra
@@ -6814,6 +7056,24 @@ do_request_one_type_by_needle_object(NMPlatform *platform, const NMPObject *obj_
     delayed_action_handle_all(platform, FALSE);
 }
 
+static void
+refresh_all(NMPlatform *platform, NMPObjectType obj_type)
+{
+    DelayedActionType action_type = DELAYED_ACTION_TYPE_NONE;
+    RefreshAllType    refresh_all_type;
+
+    for (refresh_all_type = _REFRESH_ALL_TYPE_FIRST; refresh_all_type < _REFRESH_ALL_TYPE_NUM;
+         refresh_all_type++) {
+        if (refresh_all_type_get_info(refresh_all_type)->obj_type == obj_type)
+            action_type |= delayed_action_type_from_refresh_all_type(refresh_all_type);
+    }
+
+    g_return_if_fail(action_type != DELAYED_ACTION_TYPE_NONE);
+
+    do_request_all_no_delayed_actions(platform, action_type);
+    delayed_action_handle_all(platform, FALSE);
+}
+
 static void
 event_seq_check_refresh_all(NMPlatform *platform, guint32 seq_number)
 {
@@ -6889,6 +7149,221 @@ event_seq_check(NMPlatform *            platform,
 #endif
 }
 
+/*****************************************************************************/
+
+static void
+_route_filters_set(NMPlatform *platform, const char *const *specs)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    NMPUtilsRouteFilter     filter;
+
+    nm_assert(!priv->route_filters);
+
+    for (; specs && *specs; specs++) {
+        if (!nmp_utils_route_filter_parse(*specs, &filter)) {
+            _LOGW("ignore-routes: invalid filter \"%s\"", *specs);
+            continue;
+        }
+        if (priv->route_filters && priv->route_filters->len >= ROUTE_FILTERS_MAX) {
+            _LOGW("ignore-routes: too many filters, ignore \"%s\"", *specs);
+            continue;
+        }
+        if (!priv->route_filters)
+            priv->route_filters = g_array_new(FALSE, FALSE, sizeof(NMPUtilsRouteFilter));
+        g_array_append_val(priv->route_filters, filter);
+        _LOGD("ignore-routes: ignore routes with %s", *specs);
+    }
+}
+
+static gboolean
+_route_filters_match(NMPlatform *platform, struct nlmsghdr *nlh)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    nm_assert(priv->route_filters);
+
+    return nmp_utils_route_filters_match((const NMPUtilsRouteFilter *) priv->route_filters->data,
+                                         priv->route_filters->len,
+                                         nlh);
+}
+
+static void
+_route_filters_bpf_add(struct sock_filter *prog,
+                       guint *             p_n,
+                       guint16             code,
+                       guint32             k,
+                       guint               jt_idx,
+                       guint               jf_idx)
+{
+    const guint n = (*p_n)++;
+
+    /* @jt_idx and @jf_idx are absolute indexes of the jump targets, or
+     * zero to continue with the next instruction. */
+    nm_assert(!jt_idx || (jt_idx > n && jt_idx - n - 1 <= G_MAXUINT8));
+    nm_assert(!jf_idx || (jf_idx > n && jf_idx - n - 1 <= G_MAXUINT8));
+
+    prog[n] = (struct sock_filter){
+        .code = code,
+        .jt   = jt_idx ? jt_idx - n - 1 : 0,
+        .jf   = jf_idx ? jf_idx - n - 1 : 0,
+        .k    = k,
+    };
+}
+
+static void
+_route_filters_attach_bpf(NMPlatform *platform)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    struct sock_filter      prog[11 + ROUTE_FILTERS_MAX];
+    struct sock_fprog       fprog;
+    guint                   n_tables    = 0;
+    guint                   n_protocols = 0;
+    guint                   idx_accept;
+    guint                   idx_drop;
+    guint                   n;
+    guint                   i;
+
+    /* Let the kernel drop route notifications for ignored tables and protocols,
+     * so that they don't even wake us up. The filter is attached to the route
+     * socket, which only receives notifications. It only sees the first message
+     * of each datagram, so it leaves multi-part messages and notifications caused
+     * by our own requests alone. The filter also cannot look at attributes,
+     * so prefix filters and tables larger than 255 are only handled in
+     * user space, by _route_filters_match(). */
+
+    if (!priv->route_filters)
+        return;
+
+    for (i = 0; i < priv->route_filters->len; i++) {
+        const NMPUtilsRouteFilter *f = &g_array_index(priv->route_filters, NMPUtilsRouteFilter, i);
+
+        if (f->type == NMP_UTILS_ROUTE_FILTER_TYPE_TABLE && f->table < RT_TABLE_COMPAT)
+            n_tables++;
+        else if (f->type == NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL)
+            n_protocols++;
+    }
+
+    if (n_tables == 0 && n_protocols == 0)
+        return;
+
+    idx_accept = 9 + n_tables + n_protocols;
+    idx_drop   = idx_accept + 1;
+
+    /* netlink headers are in host endianness, but BPF loads are big endian. */
+    n = 0;
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_LD | BPF_H | BPF_ABS,
+                           offsetof(struct nlmsghdr, nlmsg_type),
+                           0,
+                           0);
+    _route_filters_bpf_add(prog, &n, BPF_JMP | BPF_JEQ | BPF_K, htobe16(RTM_NEWROUTE), 3, 0);
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_JMP | BPF_JEQ | BPF_K,
+                           htobe16(RTM_DELROUTE),
+                           0,
+                           idx_accept);
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_LD | BPF_H | BPF_ABS,
+                           offsetof(struct nlmsghdr, nlmsg_flags),
+                           0,
+                           0);
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_JMP | BPF_JSET | BPF_K,
+                           htobe16(NLM_F_MULTI),
+                           idx_accept,
+                           0);
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_LD | BPF_W | BPF_ABS,
+                           offsetof(struct nlmsghdr, nlmsg_pid),
+                           0,
+                           0);
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_JMP | BPF_JEQ | BPF_K,
+                           htobe32(nl_socket_get_local_port(priv->nlh)),
+                           idx_accept,
+                           0);
+
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_LD | BPF_B | BPF_ABS,
+                           NLMSG_HDRLEN + offsetof(struct rtmsg, rtm_table),
+                           0,
+                           0);
+    for (i = 0; i < priv->route_filters->len; i++) {
+        const NMPUtilsRouteFilter *f = &g_array_index(priv->route_filters, NMPUtilsRouteFilter, i);
+
+        if (f->type == NMP_UTILS_ROUTE_FILTER_TYPE_TABLE && f->table < RT_TABLE_COMPAT)
+            _route_filters_bpf_add(prog, &n, BPF_JMP | BPF_JEQ | BPF_K, f->table, idx_drop, 0);
+    }
+
+    _route_filters_bpf_add(prog,
+                           &n,
+                           BPF_LD | BPF_B | BPF_ABS,
+                           NLMSG_HDRLEN + offsetof(struct rtmsg, rtm_protocol),
+                           0,
+                           0);
+    for (i = 0; i < priv->route_filters->len; i++) {
+        const NMPUtilsRouteFilter *f = &g_array_index(priv->route_filters, NMPUtilsRouteFilter, i);
+
+        if (f->type == NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL)
+            _route_filters_bpf_add(prog, &n, BPF_JMP | BPF_JEQ | BPF_K, f->protocol, idx_drop, 0);
+    }
+
+    nm_assert(n == idx_accept);
+    _route_filters_bpf_add(prog, &n, BPF_RET | BPF_K, 0xFFFFFFFFu, 0, 0);
+    _route_filters_bpf_add(prog, &n, BPF_RET | BPF_K, 0, 0, 0);
+    nm_assert(n == idx_drop + 1);
+    nm_assert(n <= G_N_ELEMENTS(prog));
+
+    fprog = (struct sock_fprog){
+        .len    = n,
+        .filter = prog,
+    };
+    if (setsockopt(nl_socket_get_fd(priv->nlh_route),
+                   SOL_SOCKET,
+                   SO_ATTACH_FILTER,
+                   &fprog,
+                   sizeof(fprog))
+        < 0) {
+        _LOGW("ignore-routes: failure to attach socket filter: %s", nm_strerror_native(errno));
+        return;
+    }
+
+    _LOGD("ignore-routes: attached socket filter for %u tables and %u protocols",
+          n_tables,
+          n_protocols);
+}
+
+static gboolean
+_route_get_is_pending(NMPlatform *platform, guint32 seq_number)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    guint                   i;
+
+    if (!NM_FLAGS_HAS(priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE))
+        return FALSE;
+
+    for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+        const DelayedActionWaitForNlResponseData *data =
+            &g_array_index(priv->delayed_action.list_wait_for_nl_response,
+                           DelayedActionWaitForNlResponseData,
+                           i);
+
+        if (data->response_type == DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET
+            && data->seq_number == seq_number)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*****************************************************************************/
+
 static void
 event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
 {
@@ -6927,6 +7402,15 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
     if (!handle_events)
         return;
 
+    if (NM_IN_SET(msghdr->nlmsg_type, RTM_NEWROUTE, RTM_DELROUTE)
+        && NM_LINUX_PLATFORM_GET_PRIVATE(platform)->route_filters
+        && _route_filters_match(platform, msghdr)
+        && !_route_get_is_pending(platform, msghdr->nlmsg_seq)) {
+        _LOGt("event-notification: %s: ignore route",
+              nl_nlmsghdr_to_str(msghdr, buf_nlmsghdr, sizeof(buf_nlmsghdr)));
+        return;
+    }
+
     if (NM_IN_SET(msghdr->nlmsg_type,
                   RTM_DELLINK,
                   RTM_DELADDR,
@@ -6939,6 +7423,14 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
         is_del = TRUE;
     }
 
+    if (msghdr->nlmsg_type == RTM_DELLINK) {
+        /* Kernel removes the routes of the link without notifications, and the
+         * cache drops them together with the link. Route notifications arrive on
+         * their own socket. Process those that are already queued first, so that
+         * none of them brings back a route of the deleted link. */
+        event_handler_read_netlink_routes(platform, 0);
+    }
+
     obj = nmp_object_new_from_nl(platform, cache, msg, is_del);
     if (!obj) {
         _LOGT("event-notification: %s: ignore",
@@ -7147,40 +7639,13 @@ do_add_link_with_lookup(NMPlatform *           platform,
 }
 
 static int
-do_add_addrroute(NMPlatform *     platform,
-                 const NMPObject *obj_id,
-                 struct nl_msg *  nlmsg,
-                 gboolean         suppress_netlink_failure)
+_do_add_addrroute_complete(NMPlatform *            platform,
+                           const NMPObject *       obj_id,
+                           WaitForNlResponseResult seq_result,
+                           const char *            errmsg,
+                           gboolean                suppress_netlink_failure)
 {
-    WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
-    gs_free char *          errmsg     = NULL;
-    int                     nle;
-    char                    s_buf[256];
-
-    nm_assert(NM_IN_SET(NMP_OBJECT_GET_TYPE(obj_id),
-                        NMP_OBJECT_TYPE_IP4_ADDRESS,
-                        NMP_OBJECT_TYPE_IP6_ADDRESS,
-                        NMP_OBJECT_TYPE_IP4_ROUTE,
-                        NMP_OBJECT_TYPE_IP6_ROUTE));
-
-    event_handler_read_netlink(platform, FALSE);
-
-    nle = _nl_send_nlmsg(platform,
-                         nlmsg,
-                         &seq_result,
-                         &errmsg,
-                         DELAYED_ACTION_RESPONSE_TYPE_VOID,
-                         NULL);
-    if (nle < 0) {
-        _LOGE("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
-              NMP_OBJECT_GET_CLASS(obj_id)->obj_type_name,
-              nmp_object_to_string(obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-              nm_strerror(nle),
-              -nle);
-        return -NME_PL_NETLINK;
-    }
-
-    delayed_action_handle_all(platform, FALSE);
+    char s_buf[256];
 
     nm_assert(seq_result);
 
@@ -7208,15 +7673,21 @@ do_add_addrroute(NMPlatform *     platform,
     return wait_for_nl_response_to_nmerr(seq_result);
 }
 
-static gboolean
-do_delete_object(NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+static int
+do_add_addrroute(NMPlatform *     platform,
+                 const NMPObject *obj_id,
+                 struct nl_msg *  nlmsg,
+                 gboolean         suppress_netlink_failure)
 {
     WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
     gs_free char *          errmsg     = NULL;
     int                     nle;
-    char                    s_buf[256];
-    gboolean                success;
-    const char *            log_detail = "";
+
+    nm_assert(NM_IN_SET(NMP_OBJECT_GET_TYPE(obj_id),
+                        NMP_OBJECT_TYPE_IP4_ADDRESS,
+                        NMP_OBJECT_TYPE_IP6_ADDRESS,
+                        NMP_OBJECT_TYPE_IP4_ROUTE,
+                        NMP_OBJECT_TYPE_IP6_ROUTE));
 
     event_handler_read_netlink(platform, FALSE);
 
@@ -7227,16 +7698,33 @@ do_delete_object(NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *n
                          DELAYED_ACTION_RESPONSE_TYPE_VOID,
                          NULL);
     if (nle < 0) {
-        _LOGE("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+        _LOGE("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
               NMP_OBJECT_GET_CLASS(obj_id)->obj_type_name,
               nmp_object_to_string(obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
               nm_strerror(nle),
               -nle);
-        return FALSE;
+        return -NME_PL_NETLINK;
     }
 
     delayed_action_handle_all(platform, FALSE);
 
+    return _do_add_addrroute_complete(platform,
+                                      obj_id,
+                                      seq_result,
+                                      errmsg,
+                                      suppress_netlink_failure);
+}
+
+static gboolean
+_do_delete_object_complete(NMPlatform *            platform,
+                           const NMPObject *       obj_id,
+                           WaitForNlResponseResult seq_result,
+                           const char *            errmsg)
+{
+    char        s_buf[256];
+    gboolean    success;
+    const char *log_detail = "";
+
     nm_assert(seq_result);
 
     success = TRUE;
@@ -7281,6 +7769,35 @@ do_delete_object(NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *n
     return success;
 }
 
+static gboolean
+do_delete_object(NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+{
+    WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+    gs_free char *          errmsg     = NULL;
+    int                     nle;
+
+    event_handler_read_netlink(platform, FALSE);
+
+    nle = _nl_send_nlmsg(platform,
+                         nlmsg,
+                         &seq_result,
+                         &errmsg,
+                         DELAYED_ACTION_RESPONSE_TYPE_VOID,
+                         NULL);
+    if (nle < 0) {
+        _LOGE("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+              NMP_OBJECT_GET_CLASS(obj_id)->obj_type_name,
+              nmp_object_to_string(obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+              nm_strerror(nle),
+              -nle);
+        return FALSE;
+    }
+
+    delayed_action_handle_all(platform, FALSE);
+
+    return _do_delete_object_complete(platform, obj_id, seq_result, errmsg);
+}
+
 static int
 do_change_link(NMPlatform *          platform,
                ChangeLinkType        change_link_type,
@@ -7438,6 +7955,11 @@ link_delete(NMPlatform *platform, int ifindex)
 
     nlmsg = _nl_msg_new_link(RTM_DELLINK, 0, ifindex, NULL);
 
+    /* Kernel does not notify about routes that go away together with the link,
+     * the cache drops them when the link is removed. Process the queued route
+     * notifications first, so that none of them re-adds such a route afterwards. */
+    event_handler_read_netlink_routes(platform, 0);
+
     nmp_object_stackinit_id_link(&obj_id, ifindex);
     return do_delete_object(platform, &obj_id, nlmsg);
 }
@@ -8724,6 +9246,173 @@ object_delete(NMPlatform *platform, const NMPObject *obj)
     return do_delete_object(platform, obj, nlmsg);
 }
 
+static struct nl_msg *
+_object_batch_nlmsg_new(const NMPlatformObjBatchOp *op, NMPObject *obj_stack)
+{
+    switch (NMP_OBJECT_GET_TYPE(op->obj)) {
+    case NMP_OBJECT_TYPE_IP4_ROUTE:
+    case NMP_OBJECT_TYPE_IP6_ROUTE:
+        if (op->is_delete)
+            return _nl_msg_new_route(RTM_DELROUTE, 0, op->obj);
+        nmp_object_stackinit(obj_stack, NMP_OBJECT_GET_TYPE(op->obj), &op->obj->object);
+        nm_platform_ip_route_normalize(NMP_OBJECT_GET_CLASS(op->obj)->addr_family,
+                                       NMP_OBJECT_CAST_IP_ROUTE(obj_stack));
+        return _nl_msg_new_route(RTM_NEWROUTE, op->nlmflags & NMP_NLM_FLAG_FMASK, obj_stack);
+    case NMP_OBJECT_TYPE_IP4_ADDRESS:
+    {
+        const NMPlatformIP4Address *a = NMP_OBJECT_CAST_IP4_ADDRESS(op->obj);
+
+        if (op->is_delete) {
+            return _nl_msg_new_address(RTM_DELADDR,
+                                       0,
+                                       AF_INET,
+                                       a->ifindex,
+                                       &a->address,
+                                       a->plen,
+                                       &a->peer_address,
+                                       0,
+                                       RT_SCOPE_NOWHERE,
+                                       NM_PLATFORM_LIFETIME_PERMANENT,
+                                       NM_PLATFORM_LIFETIME_PERMANENT,
+                                       0,
+                                       NULL);
+        }
+        return _nl_msg_new_address(RTM_NEWADDR,
+                                   NLM_F_CREATE | NLM_F_REPLACE,
+                                   AF_INET,
+                                   a->ifindex,
+                                   &a->address,
+                                   a->plen,
+                                   &a->peer_address,
+                                   a->n_ifa_flags,
+                                   nm_utils_ip4_address_is_link_local(a->address)
+                                       ? RT_SCOPE_LINK
+                                       : RT_SCOPE_UNIVERSE,
+                                   a->lifetime,
+                                   a->preferred,
+                                   nm_platform_ip4_broadcast_address_from_addr(a),
+                                   a->label);
+    }
+    case NMP_OBJECT_TYPE_IP6_ADDRESS:
+    {
+        const NMPlatformIP6Address *a = NMP_OBJECT_CAST_IP6_ADDRESS(op->obj);
+
+        if (op->is_delete) {
+            return _nl_msg_new_address(RTM_DELADDR,
+                                       0,
+                                       AF_INET6,
+                                       a->ifindex,
+                                       &a->address,
+                                       a->plen,
+                                       NULL,
+                                       0,
+                                       RT_SCOPE_NOWHERE,
+                                       NM_PLATFORM_LIFETIME_PERMANENT,
+                                       NM_PLATFORM_LIFETIME_PERMANENT,
+                                       0,
+                                       NULL);
+        }
+        return _nl_msg_new_address(RTM_NEWADDR,
+                                   NLM_F_CREATE | NLM_F_REPLACE,
+                                   AF_INET6,
+                                   a->ifindex,
+                                   &a->address,
+                                   a->plen,
+                                   IN6_IS_ADDR_UNSPECIFIED(&a->peer_address) ? NULL
+                                                                            : &a->peer_address,
+                                   a->n_ifa_flags,
+                                   RT_SCOPE_UNIVERSE,
+                                   a->lifetime,
+                                   a->preferred,
+                                   0,
+                                   NULL);
+    }
+    default:
+        return NULL;
+    }
+}
+
+static void
+object_batch(NMPlatform *platform, NMPlatformObjBatchOp *ops, guint n_ops)
+{
+    guint i_op = 0;
+
+    event_handler_read_netlink(platform, FALSE);
+
+    while (i_op < n_ops) {
+        struct nl_msg *         nlmsgs[OBJECT_BATCH_MAX_MSGS];
+        guint                   nlmsgs_op[OBJECT_BATCH_MAX_MSGS];
+        WaitForNlResponseResult seq_results[OBJECT_BATCH_MAX_MSGS];
+        char *                  errmsgs[OBJECT_BATCH_MAX_MSGS];
+        NMPObject               obj_stack;
+        gsize                   len = 0;
+        guint                   n   = 0;
+        guint                   i;
+        int                     r;
+
+        for (; i_op < n_ops && n < OBJECT_BATCH_MAX_MSGS && len < OBJECT_BATCH_MAX_LEN; i_op++) {
+            struct nl_msg *nlmsg;
+
+            nlmsg = _object_batch_nlmsg_new(&ops[i_op], &obj_stack);
+            if (!nlmsg) {
+                nm_assert_not_reached();
+                ops[i_op].result = -NME_BUG;
+                continue;
+            }
+
+            nlmsgs[n]      = nlmsg;
+            nlmsgs_op[n]   = i_op;
+            seq_results[n] = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+            errmsgs[n]     = NULL;
+            len += nlmsg_hdr(nlmsg)->nlmsg_len;
+            n++;
+        }
+
+        if (n == 0)
+            continue;
+
+        r = _nl_send_nlmsg_batch(platform, nlmsgs, n, seq_results, errmsgs);
+        if (r < 0) {
+            _LOGE("do-batch: failure sending %u netlink requests \"%s\" (%d)",
+                  n,
+                  nm_strerror(r),
+                  -r);
+        } else
+            delayed_action_handle_all(platform, FALSE);
+
+        for (i = 0; i < n; i++) {
+            NMPlatformObjBatchOp *op = &ops[nlmsgs_op[i]];
+
+            if (r < 0)
+                op->result = -NME_PL_NETLINK;
+            else if (op->is_delete) {
+                gboolean deleted;
+
+                deleted =
+                    _do_delete_object_complete(platform, op->obj, seq_results[i], errmsgs[i]);
+
+                /* Like for additions, report the response to this very request.
+                 * Only the errors that mean the object is already gone count as
+                 * success. */
+                op->result = wait_for_nl_response_to_nmerr(seq_results[i]);
+                if (deleted)
+                    op->result = 0;
+                else if (op->result >= 0)
+                    op->result = -NME_PL_NETLINK;
+            } else {
+                op->result = _do_add_addrroute_complete(
+                    platform,
+                    op->obj,
+                    seq_results[i],
+                    errmsgs[i],
+                    NM_FLAGS_HAS(op->nlmflags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE));
+            }
+            nlmsg_free(nlmsgs[i]);
+            g_free(errmsgs[i]);
+        }
+    }
+}
+
 /*****************************************************************************/
 
 static int
@@ -8945,14 +9634,33 @@ event_handler(int fd, GIOCondition io_condition, gpointer user_data)
     return TRUE;
 }
 
+/* How many datagrams to read from the route socket per main loop iteration. */
+#define ROUTE_EVENTS_MAX_READS 100
+
+static gboolean
+event_handler_routes(int fd, GIOCondition io_condition, gpointer user_data)
+{
+    NMPlatform *            platform = NM_PLATFORM(user_data);
+    NMLinuxPlatformPrivate *priv     = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    /* The source has a lower priority than the one for @nlh and only reads
+     * a limited number of messages at a time. During a route storm, link and
+     * address events still get processed in between. */
+    event_handler_read_netlink_routes(platform, ROUTE_EVENTS_MAX_READS);
+
+    if (priv->delayed_action.flags != DELAYED_ACTION_TYPE_NONE)
+        delayed_action_handle_all(platform, FALSE);
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 /* copied from libnl3's recvmsgs() */
 static int
-event_handler_recvmsgs(NMPlatform *platform, gboolean handle_events)
+event_handler_recvmsgs(NMPlatform *platform, struct nl_sock *sk, gboolean handle_events)
 {
-    NMLinuxPlatformPrivate *    priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
-    struct nl_sock *            sk   = priv->nlh;
+    NMLinuxPlatformPrivate *    priv        = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    const gboolean              is_route_sk = (sk == priv->nlh_route);
     int                         n;
     int                         err         = 0;
     gboolean                    multipart   = 0;
@@ -9103,6 +9811,19 @@ continue_reading:
 
         seq_number = nlmsg_hdr(msg)->nlmsg_seq;
 
+        if (is_route_sk) {
+            /* we don't send requests on the route socket. The sequence numbers
+             * of its notifications are unrelated to our pending requests, except
+             * for notifications about our own changes. They carry the port and
+             * sequence number of the request that we sent on @nlh. */
+            if (process_valid_msg)
+                event_valid_msg(platform, msg, handle_events);
+            if (priv->nlh_route_seq_wait != 0 && seq_number == priv->nlh_route_seq_wait
+                && nlmsg_hdr(msg)->nlmsg_pid == nl_socket_get_local_port(priv->nlh))
+                priv->nlh_route_seq_wait = 0;
+            goto next;
+        }
+
         /* check whether the seq number is different from before, and
          * whether the previous number (@nlh_seq_last_seen) is a pending
          * refresh-all request. In that case, the pending request is thereby
@@ -9124,6 +9845,7 @@ continue_reading:
 
         event_seq_check(platform, seq_number, seq_result, extack_msg);
 
+next:
         if (abort_parsing)
             goto stop;
 
@@ -9175,7 +9897,7 @@ event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks)
         for (;;) {
             int nle;
 
-            nle = event_handler_recvmsgs(platform, TRUE);
+            nle = event_handler_recvmsgs(platform, priv->nlh, TRUE);
 
             if (nle < 0) {
                 switch (nle) {
@@ -9200,21 +9922,12 @@ event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks)
                               }
                               _reason;
                           }));
-                    event_handler_recvmsgs(platform, FALSE);
+                    event_handler_recvmsgs(platform, priv->nlh, FALSE);
                     delayed_action_wait_for_nl_response_complete_all(
                         platform,
                         WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
 
-                    delayed_action_schedule(platform,
-                                            DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
-                                            NULL);
+                    resync_schedule(platform, DELAYED_ACTION_TYPE_REFRESH_ALL);
                     break;
                 default:
                     _LOGE("netlink: read: failed to retrieve incoming events: %s (%d)",
@@ -9228,6 +9941,9 @@ event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks)
 
 after_read:
 
+        /* the ACKs we just read may be for route changes. */
+        event_handler_read_netlink_routes_sync(platform);
+
         if (!NM_FLAGS_HAS(priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE))
             return any;
 
@@ -9274,6 +9990,67 @@ after_read:
     }
 }
 
+/* Read route notifications from the route socket. With @max_reads zero,
+ * drain the socket. Returns %TRUE if there might be more to read. */
+static gboolean
+event_handler_read_netlink_routes(NMPlatform *platform, guint max_reads)
+{
+    nm_auto_pop_netns NMPNetns *netns = NULL;
+    NMLinuxPlatformPrivate *    priv  = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    guint                       n_reads;
+    int                         nle;
+
+    if (!nm_platform_netns_push(platform, &netns))
+        return FALSE;
+
+    for (n_reads = 0; max_reads == 0 || n_reads < max_reads; n_reads++) {
+        nle = event_handler_recvmsgs(platform, priv->nlh_route, TRUE);
+        if (nle >= 0)
+            continue;
+
+        switch (nle) {
+        case -EAGAIN:
+            return FALSE;
+        case -NME_NL_MSG_TRUNC:
+        case -ENOBUFS:
+            _LOGI("netlink: read routes: %s. Need to resynchronize routes",
+                  nle == -ENOBUFS ? "too many netlink events" : "message truncated");
+            event_handler_recvmsgs(platform, priv->nlh_route, FALSE);
+            resync_schedule(platform,
+                            DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
+                                | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES);
+            return FALSE;
+        default:
+            _LOGE("netlink: read routes: failed to retrieve incoming events: %s (%d)",
+                  nm_strerror(nle),
+                  nle);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* Kernel queues the notifications about a route change before it acknowledges
+ * the request. After we got the ACKs, read the route socket until we saw the
+ * notification for the last successful route request, so that the cache (and
+ * its signals) reflect our requests when they return. Notifications queued
+ * after it are left for event_handler_routes().
+ *
+ * If there is no such notification (because the request did not change
+ * anything), this stops once the socket is empty. */
+static void
+event_handler_read_netlink_routes_sync(NMPlatform *platform)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    while (priv->nlh_route_seq_wait != 0) {
+        if (!event_handler_read_netlink_routes(platform, 1))
+            break;
+    }
+    priv->nlh_route_seq_wait = 0;
+}
+
 /*****************************************************************************/
 
 static void
@@ -9482,11 +10259,9 @@ constructed(GObject *_object)
 
     nle = nl_socket_add_memberships(priv->nlh,
                                     RTNLGRP_IPV4_IFADDR,
-                                    RTNLGRP_IPV4_ROUTE,
                                     RTNLGRP_IPV4_RULE,
                                     RTNLGRP_IPV6_RULE,
                                     RTNLGRP_IPV6_IFADDR,
-                                    RTNLGRP_IPV6_ROUTE,
                                     RTNLGRP_LINK,
                                     RTNLGRP_TC,
                                     0);
@@ -9498,6 +10273,34 @@ constructed(GObject *_object)
           nl_socket_get_local_port(priv->nlh),
           fd);
 
+    priv->nlh_route = nl_socket_alloc();
+    g_assert(priv->nlh_route);
+
+    nle = nl_connect(priv->nlh_route, NETLINK_ROUTE);
+    g_assert(!nle);
+    nle = nl_socket_set_passcred(priv->nlh_route, 1);
+    g_assert(!nle);
+    nle = nl_socket_set_nonblocking(priv->nlh_route);
+    g_assert(!nle);
+
+    /* Hosts with large routing tables see bursts of route events. Give them
+     * a larger buffer than the main socket (32 MB). */
+    nle = nl_socket_set_buffer_size(priv->nlh_route, 32 * 1024 * 1024, 0);
+    g_assert(!nle);
+
+    nl_socket_disable_msg_peek(priv->nlh_route);
+    nle = nl_socket_set_msg_buf_size(priv->nlh_route, 32 * 1024);
+    g_assert(!nle);
+
+    nle = nl_socket_add_memberships(priv->nlh_route, RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE, 0);
+    g_assert(!nle);
+
+    _route_filters_attach_bpf(platform);
+
+    _LOGD("Netlink socket for route events established: port=%u, fd=%d",
+          nl_socket_get_local_port(priv->nlh_route),
+          nl_socket_get_fd(priv->nlh_route));
+
     priv->event_source =
         nm_g_unix_fd_source_new(fd,
                                 G_IO_IN | G_IO_NVAL | G_IO_PRI | G_IO_ERR | G_IO_HUP,
@@ -9507,6 +10310,15 @@ constructed(GObject *_object)
                                 NULL);
     g_source_attach(priv->event_source, NULL);
 
+    priv->route_event_source =
+        nm_g_unix_fd_source_new(nl_socket_get_fd(priv->nlh_route),
+                                G_IO_IN | G_IO_NVAL | G_IO_PRI | G_IO_ERR | G_IO_HUP,
+                                G_PRIORITY_DEFAULT + 1,
+                                event_handler_routes,
+                                platform,
+                                NULL);
+    g_source_attach(priv->route_event_source, NULL);
+
     /* complete construction of the GObject instance before populating the cache. */
     G_OBJECT_CLASS(nm_linux_platform_parent_class)->constructed(_object);
 
@@ -9523,6 +10335,8 @@ constructed(GObject *_object)
 
     delayed_action_handle_all(platform, FALSE);
 
+    _log_alloc_stats(platform);
+
     /* Set up udev monitoring */
     if (priv->udev_client) {
         struct udev_enumerate * enumerator;
@@ -9575,7 +10389,9 @@ path_is_read_only_fs(const char *path)
 }
 
 NMPlatform *
-nm_linux_platform_new(gboolean log_with_ptr, gboolean netns_support)
+nm_linux_platform_new(gboolean           log_with_ptr,
+                      gboolean           netns_support,
+                      const char *const *ignore_routes)
 {
     gboolean use_udev = FALSE;
 
@@ -9589,9 +10405,25 @@ nm_linux_platform_new(gboolean log_with_ptr, gboolean netns_support)
                         use_udev,
                         NM_PLATFORM_NETNS_SUPPORT,
                         netns_support,
+                        NM_LINUX_PLATFORM_IGNORE_ROUTES,
+                        ignore_routes,
                         NULL);
 }
 
+static void
+set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec)
+{
+    switch (prop_id) {
+    case PROP_IGNORE_ROUTES:
+        /* construct-only */
+        _route_filters_set(NM_PLATFORM(object), g_value_get_boxed(value));
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
 static void
 dispose(GObject *object)
 {
@@ -9607,6 +10439,9 @@ dispose(GObject *object)
     g_ptr_array_set_size(priv->delayed_action.list_master_connected, 0);
     g_ptr_array_set_size(priv->delayed_action.list_refresh_link, 0);
 
+    priv->resync.pending = DELAYED_ACTION_TYPE_NONE;
+    nm_clear_g_source_inst(&priv->resync.idle_source);
+
     G_OBJECT_CLASS(nm_linux_platform_parent_class)->dispose(object);
 }
 
@@ -9619,11 +10454,15 @@ finalize(GObject *object)
     g_ptr_array_unref(priv->delayed_action.list_refresh_link);
     g_array_unref(priv->delayed_action.list_wait_for_nl_response);
 
+    nm_clear_pointer(&priv->route_filters, g_array_unref);
+
     nl_socket_free(priv->genl);
 
     nm_clear_g_source_inst(&priv->event_source);
+    nm_clear_g_source_inst(&priv->route_event_source);
 
     nl_socket_free(priv->nlh);
+    nl_socket_free(priv->nlh_route);
 
     {
         NM_G_MUTEX_LOCKED(&sysctl_clear_cache_lock);
@@ -9648,9 +10487,19 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     GObjectClass *   object_class   = G_OBJECT_CLASS(klass);
     NMPlatformClass *platform_class = NM_PLATFORM_CLASS(klass);
 
-    object_class->constructed = constructed;
-    object_class->dispose     = dispose;
-    object_class->finalize    = finalize;
+    object_class->constructed  = constructed;
+    object_class->set_property = set_property;
+    object_class->dispose      = dispose;
+    object_class->finalize     = finalize;
+
+    obj_properties[PROP_IGNORE_ROUTES] =
+        g_param_spec_boxed(NM_LINUX_PLATFORM_IGNORE_ROUTES,
+                           "",
+                           "",
+                           G_TYPE_STRV,
+                           G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
     platform_class->sysctl_set       = sysctl_set;
     platform_class->sysctl_set_async = sysctl_set_async;
@@ -9723,6 +10572,7 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     platform_class->link_tun_add = link_tun_add;
 
     platform_class->object_delete      = object_delete;
+    platform_class->object_batch       = object_batch;
     platform_class->ip4_address_add    = ip4_address_add;
     platform_class->ip6_address_add    = ip6_address_add;
     platform_class->ip4_address_delete = ip4_address_delete;
@@ -9736,5 +10586,6 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     platform_class->qdisc_add   = qdisc_add;
     platform_class->tfilter_add = tfilter_add;
 
+    platform_class->refresh_all    = refresh_all;
     platform_class->process_events = process_events;
 }
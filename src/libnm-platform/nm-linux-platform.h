@@ -18,11 +18,15 @@
 #define NM_LINUX_PLATFORM_GET_CLASS(obj) \
     (G_TYPE_INSTANCE_GET_CLASS((obj), NM_TYPE_LINUX_PLATFORM, NMLinuxPlatformClass))
 
+#define NM_LINUX_PLATFORM_IGNORE_ROUTES "ignore-routes"
+
 typedef struct _NMLinuxPlatform      NMLinuxPlatform;
 typedef struct _NMLinuxPlatformClass NMLinuxPlatformClass;
 
 GType nm_linux_platform_get_type(void);
 
-NMPlatform *nm_linux_platform_new(gboolean log_with_ptr, gboolean netns_support);
+NMPlatform *nm_linux_platform_new(gboolean           log_with_ptr,
+                                  gboolean           netns_support,
+                                  const char *const *ignore_routes);
 
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
@@ -21,6 +21,7 @@
 #include "libnm-base/nm-ethtool-base.h"
 #include "libnm-log-core/nm-logging.h"
 #include "libnm-glib-aux/nm-time-utils.h"
+#include "libnm-platform/nm-netlink.h"
 
 /*****************************************************************************/
 
@@ -2033,3 +2034,187 @@ nmp_utils_modprobe(GError **error, gboolean suppress_error_logging, const char *
 
     return exit_status;
 }
+
+/*****************************************************************************/
+
+static const struct {
+    const char *name;
+    guint8      protocol;
+} _route_filter_protocols[] = {
+    /* names as in iproute2's rt_protos. */
+    {"redirect", 1},
+    {"kernel", 2},
+    {"boot", 3},
+    {"static", 4},
+    {"gated", 8},
+    {"ra", 9},
+    {"mrt", 10},
+    {"zebra", 11},
+    {"bird", 12},
+    {"dnrouted", 13},
+    {"xorp", 14},
+    {"ntk", 15},
+    {"dhcp", 16},
+    {"mrouted", 17},
+    {"keepalived", 18},
+    {"babel", 42},
+    {"openr", 99},
+    {"bgp", 186},
+    {"isis", 187},
+    {"ospf", 188},
+    {"rip", 189},
+    {"eigrp", 192},
+};
+
+/**
+ * nmp_utils_route_filter_parse:
+ * @spec: the filter, one of "table:TABLE", "protocol:PROTO" or "prefix:ADDR/PLEN".
+ * @out_filter: (out): the parsed filter.
+ *
+ * The reserved tables 0 (unspec), 253 (default), 254 (main) and 255 (local)
+ * are rejected. NetworkManager manages routes in those tables, and ignoring
+ * them would break that. Likewise, the protocols 0 (unspec), 1 (redirect),
+ * 2 (kernel), 3 (boot), 4 (static), 9 (ra) and 16 (dhcp) are rejected. They
+ * are used by the routes that NetworkManager configures (see
+ * nmp_utils_ip_config_source_coerce_to_rtprot()) and by the routes the kernel
+ * adds for addresses.
+ *
+ * Returns: %TRUE if @spec is a valid filter.
+ */
+gboolean
+nmp_utils_route_filter_parse(const char *spec, NMPUtilsRouteFilter *out_filter)
+{
+    const char *s;
+    gint64      v;
+    guint       i;
+
+    *out_filter = (NMPUtilsRouteFilter){};
+
+    if (NM_STR_HAS_PREFIX(spec, "table:")) {
+        s = &spec[NM_STRLEN("table:")];
+        v = _nm_utils_ascii_str_to_int64(s, 10, 1, G_MAXUINT32, -1);
+        if (v < 0 || NM_IN_SET(v, RT_TABLE_DEFAULT, RT_TABLE_MAIN, RT_TABLE_LOCAL))
+            return FALSE;
+        out_filter->type  = NMP_UTILS_ROUTE_FILTER_TYPE_TABLE;
+        out_filter->table = v;
+        return TRUE;
+    }
+
+    if (NM_STR_HAS_PREFIX(spec, "protocol:")) {
+        s = &spec[NM_STRLEN("protocol:")];
+        v = _nm_utils_ascii_str_to_int64(s, 10, 0, G_MAXUINT8, -1);
+        for (i = 0; v < 0 && i < G_N_ELEMENTS(_route_filter_protocols); i++) {
+            if (nm_streq(s, _route_filter_protocols[i].name))
+                v = _route_filter_protocols[i].protocol;
+        }
+        if (v < 0
+            || NM_IN_SET(v,
+                         RTPROT_UNSPEC,
+                         RTPROT_REDIRECT,
+                         RTPROT_KERNEL,
+                         RTPROT_BOOT,
+                         RTPROT_STATIC,
+                         RTPROT_RA,
+                         RTPROT_DHCP))
+            return FALSE;
+        out_filter->type     = NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL;
+        out_filter->protocol = v;
+        return TRUE;
+    }
+
+    if (NM_STR_HAS_PREFIX(spec, "prefix:")) {
+        NMIPAddr addr;
+        int      addr_family;
+        int      plen;
+
+        s = &spec[NM_STRLEN("prefix:")];
+        if (!nm_utils_parse_inaddr_prefix_bin(AF_UNSPEC, s, &addr_family, &addr, &plen))
+            return FALSE;
+        if (plen == -1)
+            plen = nm_utils_addr_family_to_size(addr_family) * 8;
+        out_filter->type               = NMP_UTILS_ROUTE_FILTER_TYPE_PREFIX;
+        out_filter->prefix.addr_family = addr_family;
+        out_filter->prefix.plen        = plen;
+        nm_utils_ipx_address_clear_host_address(addr_family,
+                                                &out_filter->prefix.addr,
+                                                &addr,
+                                                plen);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * nmp_utils_route_filters_match:
+ * @filters: the filters, parsed by nmp_utils_route_filter_parse().
+ * @n_filters: the number of @filters.
+ * @nlh: a RTM_NEWROUTE or RTM_DELROUTE message.
+ *
+ * Only looks at the header of @nlh and the RTA_TABLE and RTA_DST attributes,
+ * the route is not parsed.
+ *
+ * Returns: %TRUE if any of the filters matches the route in @nlh.
+ */
+gboolean
+nmp_utils_route_filters_match(const NMPUtilsRouteFilter *filters,
+                              guint                      n_filters,
+                              struct nlmsghdr *          nlh)
+{
+    const struct rtmsg *rtm;
+    struct nlattr *     nla;
+    guint32             table;
+    NMIPAddr            dst       = NM_IP_ADDR_INIT;
+    gboolean            dst_valid = FALSE;
+    guint               i;
+
+    nm_assert(filters || n_filters == 0);
+    nm_assert(NM_IN_SET(nlh->nlmsg_type, RTM_NEWROUTE, RTM_DELROUTE));
+
+    if (!nlmsg_valid_hdr(nlh, sizeof(*rtm)))
+        return FALSE;
+
+    rtm = nlmsg_data(nlh);
+
+    if (!NM_IN_SET(rtm->rtm_family, AF_INET, AF_INET6))
+        return FALSE;
+
+    table = rtm->rtm_table;
+    nla   = nlmsg_find_attr(nlh, sizeof(*rtm), RTA_TABLE);
+    if (nla && nla_len(nla) >= (int) sizeof(guint32))
+        table = nla_get_u32(nla);
+
+    for (i = 0; i < n_filters; i++) {
+        const NMPUtilsRouteFilter *f = &filters[i];
+
+        switch (f->type) {
+        case NMP_UTILS_ROUTE_FILTER_TYPE_TABLE:
+            if (f->table == table)
+                return TRUE;
+            break;
+        case NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL:
+            if (f->protocol == rtm->rtm_protocol)
+                return TRUE;
+            break;
+        case NMP_UTILS_ROUTE_FILTER_TYPE_PREFIX:
+            if (f->prefix.addr_family != rtm->rtm_family || rtm->rtm_dst_len < f->prefix.plen)
+                break;
+            if (!dst_valid) {
+                gsize addr_len = nm_utils_addr_family_to_size(rtm->rtm_family);
+
+                nla = nlmsg_find_attr(nlh, sizeof(*rtm), RTA_DST);
+                if (nla && nla_len(nla) >= (int) addr_len)
+                    memcpy(&dst, nla_data(nla), addr_len);
+                dst_valid = TRUE;
+            }
+            if (nm_utils_ip_address_same_prefix(rtm->rtm_family,
+                                                &dst,
+                                                &f->prefix.addr,
+                                                f->prefix.plen))
+                return TRUE;
+            break;
+        }
+    }
+
+    return FALSE;
+}
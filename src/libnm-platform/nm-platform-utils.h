@@ -85,4 +85,33 @@ guint32 nmp_utils_lifetime_get(guint32  timestamp,
 int nmp_utils_modprobe(GError **error, gboolean suppress_error_logging, const char *arg1, ...)
     G_GNUC_NULL_TERMINATED;
 
+/*****************************************************************************/
+
+typedef enum {
+    NMP_UTILS_ROUTE_FILTER_TYPE_TABLE,
+    NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL,
+    NMP_UTILS_ROUTE_FILTER_TYPE_PREFIX,
+} NMPUtilsRouteFilterType;
+
+typedef struct {
+    NMPUtilsRouteFilterType type;
+    union {
+        guint32 table;
+        guint8  protocol;
+        struct {
+            NMIPAddr addr;
+            int      addr_family;
+            guint8   plen;
+        } prefix;
+    };
+} NMPUtilsRouteFilter;
+
+gboolean nmp_utils_route_filter_parse(const char *spec, NMPUtilsRouteFilter *out_filter);
+
+struct nlmsghdr;
+
+gboolean nmp_utils_route_filters_match(const NMPUtilsRouteFilter *filters,
+                                       guint                      n_filters,
+                                       struct nlmsghdr *          nlh);
+
 #endif /* __NM_PLATFORM_UTILS_H__ */
@@ -187,6 +187,27 @@ typedef struct _NMPlatformPrivate {
     GHashTable *       ip4_dev_route_blacklist_hash;
     NMDedupMultiIndex *multi_idx;
     NMPCache *         cache;
+
+    /* IPRoutePruneListData for nm_platform_ip_route_get_prune_list_cached() */
+    GHashTable *ip_route_prune_lists;
+
+    struct {
+        /* tag -> LinkStatsRefreshData */
+        GHashTable *hash;
+        GSource *   timeout_source;
+        gint64      timeout_at_msec;
+    } link_stats_refresh;
+
+    struct {
+        /* NMPlatformSignalChangeBatchEntry, pending for NM_PLATFORM_SIGNAL_CHANGES_BATCH */
+        GArray *entries;
+
+        /* NMPObject (by ID) -> the index in @entries. Used to coalesce
+         * changes of the same object. The keys are owned by @entries. */
+        GHashTable *entries_idx;
+
+        GSource *idle_source;
+    } change_batch;
 } NMPlatformPrivate;
 
 G_DEFINE_TYPE(NMPlatform, nm_platform, G_TYPE_OBJECT)
@@ -196,6 +217,7 @@ G_DEFINE_TYPE(NMPlatform, nm_platform, G_TYPE_OBJECT)
 /*****************************************************************************/
 
 static void _ip4_dev_route_blacklist_schedule(NMPlatform *self);
+static void _link_stats_refresh_schedule(NMPlatform *self);
 
 /*****************************************************************************/
 
@@ -1529,6 +1551,205 @@ nm_platform_link_refresh(NMPlatform *self, int ifindex)
     return TRUE;
 }
 
+/**
+ * nm_platform_refresh_all:
+ * @self: the #NMPlatform
+ * @obj_type: the object type to refresh
+ *
+ * Synchronously re-read all objects of @obj_type from kernel.
+ */
+void
+nm_platform_refresh_all(NMPlatform *self, NMPObjectType obj_type)
+{
+    _CHECK_SELF_VOID(self, klass);
+
+    if (klass->refresh_all)
+        klass->refresh_all(self, obj_type);
+}
+
+/*****************************************************************************/
+
+/* The links are refreshed in one dump request (instead of one request
+ * per link), if at least this fraction of all links is due at once. */
+#define LINK_STATS_REFRESH_DUMP_RATIO 4
+
+/* refreshes that are due within this time are handled together. */
+#define LINK_STATS_REFRESH_SLACK_MSEC 50
+
+typedef struct {
+    int    ifindex;
+    guint  refresh_rate_msec;
+    gint64 next_msec;
+} LinkStatsRefreshData;
+
+static gint64
+_link_stats_refresh_next_msec(gint64 now_msec, guint refresh_rate_msec)
+{
+    /* align the timestamps to multiples of the refresh rate. That way, all
+     * links with the same rate become due at the same time and can be
+     * refreshed together. */
+    return ((now_msec / refresh_rate_msec) + 1) * refresh_rate_msec;
+}
+
+static gboolean
+_link_stats_refresh_timeout_cb(gpointer user_data)
+{
+    NMPlatform *                 self = user_data;
+    NMPlatformPrivate *          priv = NM_PLATFORM_GET_PRIVATE(self);
+    gs_unref_array GArray *      due  = NULL;
+    const NMDedupMultiHeadEntry *head_entry;
+    LinkStatsRefreshData *       data;
+    GHashTableIter               iter;
+    NMPLookup                    lookup;
+    gint64                       now_msec;
+    guint                        n_links;
+    guint                        i;
+
+    nm_clear_g_source_inst(&priv->link_stats_refresh.timeout_source);
+
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    due = g_array_new(FALSE, FALSE, sizeof(int));
+    g_hash_table_iter_init(&iter, priv->link_stats_refresh.hash);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &data)) {
+        if (data->next_msec > now_msec + LINK_STATS_REFRESH_SLACK_MSEC)
+            continue;
+        data->next_msec = _link_stats_refresh_next_msec(now_msec, data->refresh_rate_msec);
+        for (i = 0; i < due->len; i++) {
+            if (g_array_index(due, int, i) == data->ifindex)
+                break;
+        }
+        if (i == due->len)
+            g_array_append_val(due, data->ifindex);
+    }
+
+    /* Refreshing the links below emits signals, and the handlers might change
+     * the registrations. We collected the ifindexes first, and we don't touch
+     * the hash anymore. */
+    if (due->len > 0) {
+        nmp_lookup_init_obj_type(&lookup, NMP_OBJECT_TYPE_LINK);
+        head_entry = nm_platform_lookup(self, &lookup);
+        n_links    = head_entry ? head_entry->len : 0u;
+
+        if (due->len > 1 && due->len * LINK_STATS_REFRESH_DUMP_RATIO >= n_links) {
+            _LOGT("link-stats: refresh %u links by dumping all %u links", due->len, n_links);
+            nm_platform_refresh_all(self, NMP_OBJECT_TYPE_LINK);
+        } else {
+            for (i = 0; i < due->len; i++) {
+                _LOGT("link-stats: refresh link %d", g_array_index(due, int, i));
+                nm_platform_link_refresh(self, g_array_index(due, int, i));
+            }
+        }
+    }
+
+    _link_stats_refresh_schedule(self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_link_stats_refresh_schedule(NMPlatform *self)
+{
+    NMPlatformPrivate *   priv            = NM_PLATFORM_GET_PRIVATE(self);
+    gint64                timeout_at_msec = 0;
+    LinkStatsRefreshData *data;
+    GHashTableIter        iter;
+    gint64                now_msec;
+
+    if (priv->link_stats_refresh.hash) {
+        g_hash_table_iter_init(&iter, priv->link_stats_refresh.hash);
+        while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &data)) {
+            if (timeout_at_msec == 0 || data->next_msec < timeout_at_msec)
+                timeout_at_msec = data->next_msec;
+        }
+    }
+
+    if (timeout_at_msec == 0) {
+        nm_clear_g_source_inst(&priv->link_stats_refresh.timeout_source);
+        return;
+    }
+
+    if (priv->link_stats_refresh.timeout_source
+        && priv->link_stats_refresh.timeout_at_msec == timeout_at_msec)
+        return;
+
+    nm_clear_g_source_inst(&priv->link_stats_refresh.timeout_source);
+
+    now_msec                                 = nm_utils_get_monotonic_timestamp_msec();
+    priv->link_stats_refresh.timeout_at_msec = timeout_at_msec;
+    priv->link_stats_refresh.timeout_source =
+        nm_g_timeout_source_new(NM_MAX(timeout_at_msec - now_msec, (gint64) 0),
+                                G_PRIORITY_DEFAULT,
+                                _link_stats_refresh_timeout_cb,
+                                self,
+                                NULL);
+    g_source_attach(priv->link_stats_refresh.timeout_source, NULL);
+}
+
+/**
+ * nm_platform_link_stats_refresh_set:
+ * @self: the #NMPlatform
+ * @tag: an opaque pointer that identifies the registration
+ * @ifindex: the link whose statistics should be refreshed
+ * @refresh_rate_msec: the refresh rate, or 0 to unregister
+ *
+ * Periodically refresh the link (and thereby its statistics) with the
+ * given rate. In contrast to calling nm_platform_link_refresh() from a
+ * timer for every link, the refreshes of all registered links are scheduled
+ * together. When many links are due at the same time, they get refreshed
+ * with one dump request instead of one request per link.
+ *
+ * The result is signaled as usual, as link change via the platform cache.
+ */
+void
+nm_platform_link_stats_refresh_set(NMPlatform *  self,
+                                   gconstpointer tag,
+                                   int           ifindex,
+                                   guint         refresh_rate_msec)
+{
+    NMPlatformPrivate *   priv;
+    LinkStatsRefreshData *data;
+
+    _CHECK_SELF_VOID(self, klass);
+
+    g_return_if_fail(tag);
+
+    priv = NM_PLATFORM_GET_PRIVATE(self);
+
+    if (ifindex <= 0 || refresh_rate_msec == 0) {
+        if (priv->link_stats_refresh.hash
+            && g_hash_table_remove(priv->link_stats_refresh.hash, tag))
+            _link_stats_refresh_schedule(self);
+        return;
+    }
+
+    if (!priv->link_stats_refresh.hash) {
+        priv->link_stats_refresh.hash = g_hash_table_new_full(nm_direct_hash,
+                                                              NULL,
+                                                              NULL,
+                                                              nm_g_slice_free_fcn(LinkStatsRefreshData));
+    }
+
+    data = g_hash_table_lookup(priv->link_stats_refresh.hash, tag);
+    if (data && data->ifindex == ifindex && data->refresh_rate_msec == refresh_rate_msec)
+        return;
+
+    if (!data) {
+        data = g_slice_new(LinkStatsRefreshData);
+        g_hash_table_insert(priv->link_stats_refresh.hash, (gpointer) tag, data);
+    }
+
+    *data = (LinkStatsRefreshData){
+        .ifindex           = ifindex,
+        .refresh_rate_msec = refresh_rate_msec,
+        .next_msec         = _link_stats_refresh_next_msec(nm_utils_get_monotonic_timestamp_msec(),
+                                                   refresh_rate_msec),
+    };
+
+    _link_stats_refresh_schedule(self);
+}
+
+/*****************************************************************************/
+
 int
 nm_platform_link_get_ifi_flags(NMPlatform *self, int ifindex, guint requested_flags)
 {
@@ -3921,6 +4142,9 @@ nm_platform_ip_address_sync(NMPlatform *self,
     const gint32       now                             = nm_utils_get_monotonic_timestamp_sec();
     const int          IS_IPv4                         = NM_IS_IPv4(addr_family);
     gs_unref_hashtable GHashTable *known_addresses_idx = NULL;
+    gs_unref_array GArray *ops                         = NULL;
+    gs_unref_ptrarray GPtrArray *objs_deleted          = NULL;
+    gs_free NMPObject *objs_add                        = NULL;
     GPtrArray *                    plat_addresses;
     GHashTable *                   known_subnets = NULL;
     guint32                        ifa_flags;
@@ -3942,6 +4166,15 @@ nm_platform_ip_address_sync(NMPlatform *self,
                                        GINT_TO_POINTER(TRUE));
     }
 
+    /* All deletions and additions are collected in @ops and sent to kernel at
+     * once at the end. Kernel handles them in order, so the order below is
+     * still the order in which the addresses get deleted and added. */
+    ops = g_array_new(FALSE, FALSE, sizeof(NMPlatformObjBatchOp));
+
+    /* objects that we remove from @addresses_prune must stay alive until
+     * the requests are sent. */
+    objs_deleted = g_ptr_array_new_with_free_func((GDestroyNotify) nmp_object_unref);
+
     if (!_addr_array_clean_expired(addr_family,
                                    ifindex,
                                    known_addresses,
@@ -3994,11 +4227,10 @@ nm_platform_ip_address_sync(NMPlatform *self,
                     }
                 }
 
-                nm_platform_ip4_address_delete(self,
-                                               ifindex,
-                                               plat_address->address,
-                                               plat_address->plen,
-                                               plat_address->peer_address);
+                *nm_g_array_append_new(ops, NMPlatformObjBatchOp) = (NMPlatformObjBatchOp){
+                    .obj       = plat_obj,
+                    .is_delete = TRUE,
+                };
 
                 if (!ip4_addr_subnets_is_secondary(plat_obj,
                                                    plat_subnets,
@@ -4018,15 +4250,12 @@ nm_platform_ip_address_sync(NMPlatform *self,
                         nm_assert(o);
 
                         if (*o) {
-                            const NMPlatformIP4Address *a;
-
-                            a = NMP_OBJECT_CAST_IP4_ADDRESS(*o);
-                            nm_platform_ip4_address_delete(self,
-                                                           ifindex,
-                                                           a->address,
-                                                           a->plen,
-                                                           a->peer_address);
-                            nmp_object_unref(*o);
+                            *nm_g_array_append_new(ops, NMPlatformObjBatchOp) =
+                                (NMPlatformObjBatchOp){
+                                    .obj       = *o,
+                                    .is_delete = TRUE,
+                                };
+                            g_ptr_array_add(objs_deleted, (gpointer) *o);
                             *o = NULL;
                         }
                     }
@@ -4078,8 +4307,11 @@ nm_platform_ip_address_sync(NMPlatform *self,
                     }
                 }
 
-                nm_platform_ip6_address_delete(self, ifindex, plat_addr->address, plat_addr->plen);
-                nmp_object_unref(g_steal_pointer(&plat_addresses->pdata[i_plat]));
+                *nm_g_array_append_new(ops, NMPlatformObjBatchOp) = (NMPlatformObjBatchOp){
+                    .obj       = plat_obj,
+                    .is_delete = TRUE,
+                };
+                g_ptr_array_add(objs_deleted, g_steal_pointer(&plat_addresses->pdata[i_plat]));
             }
 
             /* Next, we must preserve the priority of the routes. That is, source address
@@ -4138,14 +4370,19 @@ nm_platform_ip_address_sync(NMPlatform *self,
                     }
                 }
 
-                nm_platform_ip6_address_delete(self, ifindex, plat_addr->address, plat_addr->plen);
+                *nm_g_array_append_new(ops, NMPlatformObjBatchOp) = (NMPlatformObjBatchOp){
+                    .obj       = plat_addresses->pdata[i_plat],
+                    .is_delete = TRUE,
+                };
 next_plat:;
             }
         }
     }
 
-    if (!known_addresses)
+    if (!known_addresses) {
+        nm_platform_object_batch(self, (NMPlatformObjBatchOp *) ops->data, ops->len);
         return TRUE;
+    }
 
     if (IS_IPv4)
         ip4_addr_subnets_destroy_index(known_subnets, known_addresses);
@@ -4157,11 +4394,12 @@ next_plat:;
     /* Add missing addresses. New addresses are added by kernel with top
      * priority.
      */
+    objs_add = g_new(NMPObject, known_addresses->len);
     for (i_know = 0; i_know < known_addresses->len; i_know++) {
-        const NMPlatformIPXAddress *known_address;
-        const NMPObject *           o;
-        guint32                     lifetime;
-        guint32                     preferred;
+        const NMPObject *o;
+        NMPObject *      obj_add;
+        guint32          lifetime;
+        guint32          preferred;
 
         o = known_addresses->pdata[i_know];
         if (!o)
@@ -4169,40 +4407,42 @@ next_plat:;
 
         nm_assert(NMP_OBJECT_GET_TYPE(o) == NMP_OBJECT_TYPE_IP_ADDRESS(IS_IPv4));
 
-        known_address = NMP_OBJECT_CAST_IPX_ADDRESS(o);
-
-        lifetime = nmp_utils_lifetime_get(known_address->ax.timestamp,
-                                          known_address->ax.lifetime,
-                                          known_address->ax.preferred,
+        lifetime = nmp_utils_lifetime_get(NMP_OBJECT_CAST_IP_ADDRESS(o)->timestamp,
+                                          NMP_OBJECT_CAST_IP_ADDRESS(o)->lifetime,
+                                          NMP_OBJECT_CAST_IP_ADDRESS(o)->preferred,
                                           now,
                                           &preferred);
         nm_assert(lifetime > 0);
 
+        obj_add = &objs_add[i_know];
+        nmp_object_stackinit(obj_add, NMP_OBJECT_GET_TYPE(o), &o->object);
+        obj_add->ip_address.timestamp = 0;
+        obj_add->ip_address.lifetime  = lifetime;
+        obj_add->ip_address.preferred = preferred;
         if (IS_IPv4) {
-            if (!nm_platform_ip4_address_add(
-                    self,
-                    ifindex,
-                    known_address->a4.address,
-                    known_address->a4.plen,
-                    known_address->a4.peer_address,
-                    nm_platform_ip4_broadcast_address_from_addr(&known_address->a4),
-                    lifetime,
-                    preferred,
-                    ifa_flags,
-                    known_address->a4.label)) {
-                /* ignore error, for unclear reasons. */
-            }
-        } else {
-            if (!nm_platform_ip6_address_add(self,
-                                             ifindex,
-                                             known_address->a6.address,
-                                             known_address->a6.plen,
-                                             known_address->a6.peer_address,
-                                             lifetime,
-                                             preferred,
-                                             ifa_flags | known_address->a6.n_ifa_flags))
-                return FALSE;
-        }
+            obj_add->ip4_address.broadcast_address =
+                nm_platform_ip4_broadcast_address_from_addr(NMP_OBJECT_CAST_IP4_ADDRESS(o));
+            obj_add->ip4_address.use_ip4_broadcast_address = TRUE;
+            obj_add->ip4_address.n_ifa_flags               = ifa_flags;
+        } else
+            obj_add->ip6_address.n_ifa_flags |= ifa_flags;
+
+        *nm_g_array_append_new(ops, NMPlatformObjBatchOp) = (NMPlatformObjBatchOp){
+            .obj = obj_add,
+        };
+    }
+
+    nm_platform_object_batch(self, (NMPlatformObjBatchOp *) ops->data, ops->len);
+
+    for (i = 0; i < ops->len; i++) {
+        const NMPlatformObjBatchOp *op = &g_array_index(ops, NMPlatformObjBatchOp, i);
+
+        if (op->is_delete || op->result >= 0)
+            continue;
+
+        /* ignore errors for IPv4, for unclear reasons. */
+        if (!IS_IPv4)
+            return FALSE;
     }
 
     return TRUE;
@@ -4302,6 +4542,125 @@ nm_platform_ip_address_get_prune_list(NMPlatform *self,
     return result;
 }
 
+static gboolean
+_ip_route_prune_list_filter(int                       addr_family,
+                            NMIPRouteTableSyncMode    route_table_sync,
+                            guint32                   local_table,
+                            const NMPlatformIPXRoute *rt,
+                            NMPlatformIP4Route *      rt_local4,
+                            NMPlatformIP6Route *      rt_local6)
+{
+    switch (route_table_sync) {
+    case NM_IP_ROUTE_TABLE_SYNC_MODE_MAIN:
+        if (!nm_platform_route_table_is_main(nm_platform_ip_route_get_effective_table(&rt->rx)))
+            return FALSE;
+        break;
+    case NM_IP_ROUTE_TABLE_SYNC_MODE_FULL:
+        if (nm_platform_ip_route_get_effective_table(&rt->rx) == RT_TABLE_LOCAL)
+            return FALSE;
+        break;
+    case NM_IP_ROUTE_TABLE_SYNC_MODE_ALL:
+
+        /* FIXME: we should better handle routes that are automatically added by kernel.
+         *
+         * For now, make a good guess which are those routes and exclude them from
+         * pruning them. */
+
+        if (NM_IS_IPv4(addr_family)) {
+            /* for each IPv4 address kernel adds a route like
+             *
+             *  local $ADDR dev $IFACE table local proto kernel scope host src $PRIMARY_ADDR
+             *
+             * Check whether route could be of that kind. */
+            if (nm_platform_ip_route_get_effective_table(&rt->rx) == local_table
+                && rt->rx.plen == 32 && rt->rx.rt_source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL
+                && rt->rx.metric == 0
+                && rt->r4.scope_inv == nm_platform_route_scope_inv(RT_SCOPE_HOST)
+                && rt->r4.gateway == INADDR_ANY) {
+                if (rt_local4->plen == 0) {
+                    *rt_local4 = (NMPlatformIP4Route){
+                        .ifindex       = rt->rx.ifindex,
+                        .type_coerced  = nm_platform_route_type_coerce(RTN_LOCAL),
+                        .plen          = 32,
+                        .rt_source     = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+                        .metric        = 0,
+                        .table_coerced = nm_platform_route_table_coerce(local_table),
+                        .scope_inv     = nm_platform_route_scope_inv(RT_SCOPE_HOST),
+                        .gateway       = INADDR_ANY,
+                    };
+                }
+
+                /* the possible "network" depends on the addresses we have. We don't check that
+                 * carefully. If the other parameters match, we assume that this route is the one
+                 * generated by kernel. */
+                rt_local4->network  = rt->r4.network;
+                rt_local4->pref_src = rt->r4.pref_src;
+
+                /* to be more confident about comparing the value, use our nm_platform_ip4_route_cmp()
+                 * implementation. That will also consider parameters that we leave unspecified here. */
+                if (nm_platform_ip4_route_cmp(&rt->r4,
+                                              rt_local4,
+                                              NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
+                    == 0)
+                    return FALSE;
+            }
+        } else {
+            /* for each IPv6 address (that is no longer tentative) kernel adds a route like
+             *
+             *  local $ADDR dev $IFACE table local proto kernel metric 0 pref medium
+             *
+             * Same as for the IPv4 case. */
+            if (nm_platform_ip_route_get_effective_table(&rt->rx) == local_table
+                && rt->rx.plen == 128 && rt->rx.rt_source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL
+                && rt->rx.metric == 0 && rt->r6.rt_pref == NM_ICMPV6_ROUTER_PREF_MEDIUM
+                && IN6_IS_ADDR_UNSPECIFIED(&rt->r6.gateway)) {
+                if (rt_local6->plen == 0) {
+                    *rt_local6 = (NMPlatformIP6Route){
+                        .ifindex       = rt->rx.ifindex,
+                        .type_coerced  = nm_platform_route_type_coerce(RTN_LOCAL),
+                        .plen          = 128,
+                        .rt_source     = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+                        .metric        = 0,
+                        .table_coerced = nm_platform_route_table_coerce(local_table),
+                        .rt_pref       = NM_ICMPV6_ROUTER_PREF_MEDIUM,
+                        .gateway       = IN6ADDR_ANY_INIT,
+                    };
+                }
+
+                rt_local6->network = rt->r6.network;
+
+                if (nm_platform_ip6_route_cmp(&rt->r6,
+                                              rt_local6,
+                                              NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
+                    == 0)
+                    return FALSE;
+            }
+        }
+        break;
+
+    case NM_IP_ROUTE_TABLE_SYNC_MODE_ALL_PRUNE:
+        break;
+
+    default:
+        nm_assert_not_reached();
+        break;
+    }
+
+    return TRUE;
+}
+
+static guint32
+_ip_route_prune_list_get_local_table(NMPlatform *self, int ifindex)
+{
+    const NMPlatformLink *  pllink;
+    const NMPlatformLnkVrf *lnk_vrf;
+
+    lnk_vrf = nm_platform_link_get_lnk_vrf(self, ifindex, &pllink);
+    if (!lnk_vrf && pllink && pllink->master > 0)
+        lnk_vrf = nm_platform_link_get_lnk_vrf(self, pllink->master, NULL);
+    return lnk_vrf ? lnk_vrf->table : RT_TABLE_LOCAL;
+}
+
 GPtrArray *
 nm_platform_ip_route_get_prune_list(NMPlatform *           self,
                                     int                    addr_family,
@@ -4314,8 +4673,6 @@ nm_platform_ip_route_get_prune_list(NMPlatform *           self,
     CList *                      iter;
     NMPlatformIP4Route           rt_local4;
     NMPlatformIP6Route           rt_local6;
-    const NMPlatformLink *       pllink;
-    const NMPlatformLnkVrf *     lnk_vrf;
     guint32                      local_table;
 
     nm_assert(NM_IS_PLATFORM(self));
@@ -4331,10 +4688,7 @@ nm_platform_ip_route_get_prune_list(NMPlatform *           self,
     if (!head_entry)
         return NULL;
 
-    lnk_vrf = nm_platform_link_get_lnk_vrf(self, ifindex, &pllink);
-    if (!lnk_vrf && pllink && pllink->master > 0)
-        lnk_vrf = nm_platform_link_get_lnk_vrf(self, pllink->master, NULL);
-    local_table = lnk_vrf ? lnk_vrf->table : RT_TABLE_LOCAL;
+    local_table = _ip_route_prune_list_get_local_table(self, ifindex);
 
     rt_local4.plen = 0;
     rt_local6.plen = 0;
@@ -4342,113 +4696,351 @@ nm_platform_ip_route_get_prune_list(NMPlatform *           self,
     routes_prune = g_ptr_array_new_full(head_entry->len, (GDestroyNotify) nm_dedup_multi_obj_unref);
 
     c_list_for_each (iter, &head_entry->lst_entries_head) {
-        const NMPObject *         obj = c_list_entry(iter, NMDedupMultiEntry, lst_entries)->obj;
-        const NMPlatformIPXRoute *rt  = NMP_OBJECT_CAST_IPX_ROUTE(obj);
+        const NMPObject *obj = c_list_entry(iter, NMDedupMultiEntry, lst_entries)->obj;
 
-        switch (route_table_sync) {
-        case NM_IP_ROUTE_TABLE_SYNC_MODE_MAIN:
-            if (!nm_platform_route_table_is_main(nm_platform_ip_route_get_effective_table(&rt->rx)))
-                continue;
-            break;
-        case NM_IP_ROUTE_TABLE_SYNC_MODE_FULL:
-            if (nm_platform_ip_route_get_effective_table(&rt->rx) == RT_TABLE_LOCAL)
-                continue;
-            break;
-        case NM_IP_ROUTE_TABLE_SYNC_MODE_ALL:
+        if (!_ip_route_prune_list_filter(addr_family,
+                                         route_table_sync,
+                                         local_table,
+                                         NMP_OBJECT_CAST_IPX_ROUTE(obj),
+                                         &rt_local4,
+                                         &rt_local6))
+            continue;
 
-            /* FIXME: we should better handle routes that are automatically added by kernel.
-             *
-             * For now, make a good guess which are those routes and exclude them from
-             * pruning them. */
+        g_ptr_array_add(routes_prune, (gpointer) nmp_object_ref(obj));
+    }
 
-            if (NM_IS_IPv4(addr_family)) {
-                /* for each IPv4 address kernel adds a route like
-                 *
-                 *  local $ADDR dev $IFACE table local proto kernel scope host src $PRIMARY_ADDR
-                 *
-                 * Check whether route could be of that kind. */
-                if (nm_platform_ip_route_get_effective_table(&rt->rx) == local_table
-                    && rt->rx.plen == 32 && rt->rx.rt_source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL
-                    && rt->rx.metric == 0
-                    && rt->r4.scope_inv == nm_platform_route_scope_inv(RT_SCOPE_HOST)
-                    && rt->r4.gateway == INADDR_ANY) {
-                    if (rt_local4.plen == 0) {
-                        rt_local4 = (NMPlatformIP4Route){
-                            .ifindex       = ifindex,
-                            .type_coerced  = nm_platform_route_type_coerce(RTN_LOCAL),
-                            .plen          = 32,
-                            .rt_source     = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
-                            .metric        = 0,
-                            .table_coerced = nm_platform_route_table_coerce(local_table),
-                            .scope_inv     = nm_platform_route_scope_inv(RT_SCOPE_HOST),
-                            .gateway       = INADDR_ANY,
-                        };
-                    }
+    if (routes_prune->len == 0) {
+        g_ptr_array_unref(routes_prune);
+        return NULL;
+    }
+    return routes_prune;
+}
 
-                    /* the possible "network" depends on the addresses we have. We don't check that
-                     * carefully. If the other parameters match, we assume that this route is the one
-                     * generated by kernel. */
-                    rt_local4.network  = rt->r4.network;
-                    rt_local4.pref_src = rt->r4.pref_src;
-
-                    /* to be more confident about comparing the value, use our nm_platform_ip4_route_cmp()
-                     * implementation. That will also consider parameters that we leave unspecified here. */
-                    if (nm_platform_ip4_route_cmp(&rt->r4,
-                                                  &rt_local4,
-                                                  NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
-                        == 0)
-                        continue;
-                }
-            } else {
-                /* for each IPv6 address (that is no longer tentative) kernel adds a route like
-                 *
-                 *  local $ADDR dev $IFACE table local proto kernel metric 0 pref medium
-                 *
-                 * Same as for the IPv4 case. */
-                if (nm_platform_ip_route_get_effective_table(&rt->rx) == local_table
-                    && rt->rx.plen == 128 && rt->rx.rt_source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL
-                    && rt->rx.metric == 0 && rt->r6.rt_pref == NM_ICMPV6_ROUTER_PREF_MEDIUM
-                    && IN6_IS_ADDR_UNSPECIFIED(&rt->r6.gateway)) {
-                    if (rt_local6.plen == 0) {
-                        rt_local6 = (NMPlatformIP6Route){
-                            .ifindex       = ifindex,
-                            .type_coerced  = nm_platform_route_type_coerce(RTN_LOCAL),
-                            .plen          = 128,
-                            .rt_source     = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
-                            .metric        = 0,
-                            .table_coerced = nm_platform_route_table_coerce(local_table),
-                            .rt_pref       = NM_ICMPV6_ROUTER_PREF_MEDIUM,
-                            .gateway       = IN6ADDR_ANY_INIT,
-                        };
-                    }
+typedef struct {
+    int                    ifindex;
+    NMIPRouteTableSyncMode route_table_sync;
+    bool                   is_ipv4;
 
-                    rt_local6.network = rt->r6.network;
+    /* the parameters with which @routes was computed. */
+    guint32 local_table;
+    guint64 generation;
 
-                    if (nm_platform_ip6_route_cmp(&rt->r6,
-                                                  &rt_local6,
-                                                  NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
-                        == 0)
-                        continue;
-                }
-            }
-            break;
+    GPtrArray *routes;
+} IPRoutePruneListData;
 
-        case NM_IP_ROUTE_TABLE_SYNC_MODE_ALL_PRUNE:
-            break;
+static guint
+_ip_route_prune_list_data_hash(gconstpointer ptr)
+{
+    const IPRoutePruneListData *data = ptr;
+    NMHashState                 h;
 
-        default:
-            nm_assert_not_reached();
-            break;
-        }
+    nm_hash_init(&h, 2183462771u);
+    nm_hash_update_vals(&h, data->ifindex, data->route_table_sync, (bool) data->is_ipv4);
+    return nm_hash_complete(&h);
+}
 
-        g_ptr_array_add(routes_prune, (gpointer) nmp_object_ref(obj));
+static gboolean
+_ip_route_prune_list_data_equal(gconstpointer a, gconstpointer b)
+{
+    const IPRoutePruneListData *data_a = a;
+    const IPRoutePruneListData *data_b = b;
+
+    return data_a->ifindex == data_b->ifindex
+           && data_a->route_table_sync == data_b->route_table_sync
+           && data_a->is_ipv4 == data_b->is_ipv4;
+}
+
+static void
+_ip_route_prune_list_data_free(gpointer ptr)
+{
+    IPRoutePruneListData *data = ptr;
+
+    nm_g_ptr_array_unref(data->routes);
+    nm_g_slice_free(data);
+}
+
+static gboolean
+_ip_route_prune_list_data_has_ifindex(gpointer key, gpointer value, gpointer user_data)
+{
+    return ((const IPRoutePruneListData *) key)->ifindex == GPOINTER_TO_INT(user_data);
+}
+
+static void
+_ip_route_prune_lists_forget(NMPlatform *self, int ifindex)
+{
+    NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE(self);
+
+    if (priv->ip_route_prune_lists) {
+        g_hash_table_foreach_remove(priv->ip_route_prune_lists,
+                                    _ip_route_prune_list_data_has_ifindex,
+                                    GINT_TO_POINTER(ifindex));
     }
+}
 
-    if (routes_prune->len == 0) {
-        g_ptr_array_unref(routes_prune);
+/**
+ * nm_platform_ip_route_get_prune_list_cached:
+ * @self: the #NMPlatform instance.
+ * @addr_family: the address family.
+ * @ifindex: the interface.
+ * @route_table_sync: the sync mode.
+ *
+ * Like nm_platform_ip_route_get_prune_list(), but the result is remembered
+ * together with the route generation of the cache (see
+ * nmp_cache_get_route_generation()). When no route was added or changed on
+ * the interface since the last call, the previous list is returned right away.
+ * Otherwise, only the routes that are newer than the previous list are looked
+ * at and merged with it.
+ *
+ * Since removed routes don't bump the generation, the returned list
+ * may still contain routes that are no longer in the platform cache.
+ * That is fine for nm_platform_ip_route_sync(), which skips them.
+ *
+ * Returns: (transfer full): the routes to prune, or %NULL. The list
+ *   is shared and must not be modified.
+ */
+GPtrArray *
+nm_platform_ip_route_get_prune_list_cached(NMPlatform *           self,
+                                           int                    addr_family,
+                                           int                    ifindex,
+                                           NMIPRouteTableSyncMode route_table_sync)
+{
+    NMPlatformPrivate *   priv     = NM_PLATFORM_GET_PRIVATE(self);
+    const NMPObjectType   obj_type = NMP_OBJECT_TYPE_IP_ROUTE(NM_IS_IPv4(addr_family));
+    NMPCache *            cache    = nm_platform_get_cache(self);
+    IPRoutePruneListData *data;
+    GPtrArray *           routes_prune;
+    NMPlatformIP4Route    rt_local4;
+    NMPlatformIP6Route    rt_local6;
+    guint32               local_table;
+    guint64               generation;
+    guint                 i;
+    IPRoutePruneListData  needle = {
+        .ifindex          = ifindex,
+        .route_table_sync = route_table_sync,
+        .is_ipv4          = NM_IS_IPv4(addr_family),
+    };
+
+    nm_assert(NM_IS_PLATFORM(self));
+    nm_assert(NM_IN_SET(addr_family, AF_INET, AF_INET6));
+
+    if (!priv->ip_route_prune_lists) {
+        priv->ip_route_prune_lists = g_hash_table_new_full(_ip_route_prune_list_data_hash,
+                                                           _ip_route_prune_list_data_equal,
+                                                           _ip_route_prune_list_data_free,
+                                                           NULL);
+    }
+
+    generation = nmp_cache_get_route_generation(cache, obj_type, ifindex);
+    if (generation == 0) {
+        /* no routes on the interface. */
+        g_hash_table_remove(priv->ip_route_prune_lists, &needle);
         return NULL;
     }
-    return routes_prune;
+
+    local_table = _ip_route_prune_list_get_local_table(self, ifindex);
+
+    data = g_hash_table_lookup(priv->ip_route_prune_lists, &needle);
+    if (!data || data->local_table != local_table) {
+        routes_prune =
+            nm_platform_ip_route_get_prune_list(self, addr_family, ifindex, route_table_sync);
+        goto out;
+    }
+
+    if (generation <= data->generation) {
+        /* Nothing was added or changed since last time. */
+        return nm_g_ptr_array_ref(data->routes);
+    }
+
+    routes_prune = g_ptr_array_new_with_free_func((GDestroyNotify) nm_dedup_multi_obj_unref);
+
+    /* keep the previous routes, unless they were removed or changed meanwhile.
+     * The changed ones are among the new routes below. */
+    for (i = 0; data->routes && i < data->routes->len; i++) {
+        const NMPObject *obj = data->routes->pdata[i];
+        guint64          g;
+
+        g = nmp_cache_get_route_obj_generation(cache, obj);
+        if (g == 0 || g > data->generation)
+            continue;
+        g_ptr_array_add(routes_prune, (gpointer) nmp_object_ref(obj));
+    }
+
+    i = routes_prune->len;
+    nmp_cache_lookup_routes_since(cache, obj_type, ifindex, data->generation, routes_prune);
+
+    rt_local4.plen = 0;
+    rt_local6.plen = 0;
+    while (i < routes_prune->len) {
+        if (_ip_route_prune_list_filter(addr_family,
+                                        route_table_sync,
+                                        local_table,
+                                        NMP_OBJECT_CAST_IPX_ROUTE(routes_prune->pdata[i]),
+                                        &rt_local4,
+                                        &rt_local6))
+            i++;
+        else
+            g_ptr_array_remove_index_fast(routes_prune, i);
+    }
+
+    if (routes_prune->len == 0)
+        nm_clear_pointer(&routes_prune, g_ptr_array_unref);
+
+out:
+    if (!data) {
+        data  = g_slice_new(IPRoutePruneListData);
+        *data = needle;
+        g_hash_table_add(priv->ip_route_prune_lists, data);
+    } else
+        nm_g_ptr_array_unref(data->routes);
+    data->local_table = local_table;
+    data->generation  = generation;
+    data->routes      = routes_prune;
+    return nm_g_ptr_array_ref(routes_prune);
+}
+
+#define VTABLE_IS_DEVICE_ROUTE(vt, o)                          \
+    (vt->is_ip4 ? (NMP_OBJECT_CAST_IP4_ROUTE(o)->gateway == 0) \
+                : IN6_IS_ADDR_UNSPECIFIED(&NMP_OBJECT_CAST_IP6_ROUTE(o)->gateway))
+
+/* Handles failure @r for adding @conf_o during nm_platform_ip_route_sync().
+ *
+ * Returns %TRUE if the caller should retry adding the route. */
+static gboolean
+_ip_route_sync_add_failed(NMPlatform *                 self,
+                          const NMPlatformVTableRoute *vt,
+                          int                          ifindex,
+                          const NMPObject *            conf_o,
+                          int                          r,
+                          gboolean *                   inout_gateway_route_added,
+                          GPtrArray **                 out_temporary_not_available,
+                          gboolean *                   inout_success)
+{
+    const NMDedupMultiEntry *plat_entry;
+    char                     sbuf1[sizeof(_nm_utils_to_string_buffer)];
+    char                     sbuf2[sizeof(_nm_utils_to_string_buffer)];
+
+    nm_assert(r < 0);
+
+    if (r == -EEXIST) {
+        /* Don't fail for EEXIST. It's not clear that the existing route
+         * is identical to the one that we were about to add. However,
+         * above we should have deleted conflicting (non-identical) routes. */
+        if (_LOGD_ENABLED()) {
+            plat_entry = nm_platform_lookup_entry(self, NMP_CACHE_ID_TYPE_OBJECT_TYPE, conf_o);
+            if (!plat_entry) {
+                _LOG3D("route-sync: adding route %s failed with EEXIST, however we "
+                       "cannot find such a route",
+                       nmp_object_to_string(conf_o,
+                                            NMP_OBJECT_TO_STRING_PUBLIC,
+                                            sbuf1,
+                                            sizeof(sbuf1)));
+            } else if (vt->route_cmp(NMP_OBJECT_CAST_IPX_ROUTE(conf_o),
+                                     NMP_OBJECT_CAST_IPX_ROUTE(plat_entry->obj),
+                                     NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
+                       != 0) {
+                _LOG3D("route-sync: adding route %s failed due to existing "
+                       "(different!) route %s",
+                       nmp_object_to_string(conf_o,
+                                            NMP_OBJECT_TO_STRING_PUBLIC,
+                                            sbuf1,
+                                            sizeof(sbuf1)),
+                       nmp_object_to_string(plat_entry->obj,
+                                            NMP_OBJECT_TO_STRING_PUBLIC,
+                                            sbuf2,
+                                            sizeof(sbuf2)));
+            }
+        }
+        return FALSE;
+    }
+
+    if (NMP_OBJECT_CAST_IP_ROUTE(conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
+        _LOG3D("route-sync: ignore failure to add IPv%c route: %s: %s",
+               vt->is_ip4 ? '4' : '6',
+               nmp_object_to_string(conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof(sbuf1)),
+               nm_strerror(r));
+        return FALSE;
+    }
+
+    if (r == -EINVAL && out_temporary_not_available
+        && _err_inval_due_to_ipv6_tentative_pref_src(self, conf_o)) {
+        _LOG3D("route-sync: ignore failure to add IPv6 route with tentative IPv6 "
+               "pref-src: %s: %s",
+               nmp_object_to_string(conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof(sbuf1)),
+               nm_strerror(r));
+        if (!*out_temporary_not_available)
+            *out_temporary_not_available =
+                g_ptr_array_new_full(0, (GDestroyNotify) nmp_object_unref);
+        g_ptr_array_add(*out_temporary_not_available, (gpointer) nmp_object_ref(conf_o));
+        return FALSE;
+    }
+
+    if (!*inout_gateway_route_added
+        && ((r == -ENETUNREACH && vt->is_ip4 && !!NMP_OBJECT_CAST_IP4_ROUTE(conf_o)->gateway)
+            || (r == -EHOSTUNREACH && !vt->is_ip4
+                && !IN6_IS_ADDR_UNSPECIFIED(&NMP_OBJECT_CAST_IP6_ROUTE(conf_o)->gateway)))) {
+        NMPObject oo;
+        int       r2;
+
+        if (vt->is_ip4) {
+            const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE(conf_o);
+
+            nmp_object_stackinit(
+                &oo,
+                NMP_OBJECT_TYPE_IP4_ROUTE,
+                &((NMPlatformIP4Route){
+                    .ifindex       = rt->ifindex,
+                    .network       = rt->gateway,
+                    .plen          = 32,
+                    .metric        = nm_platform_ip4_route_get_effective_metric(rt),
+                    .rt_source     = rt->rt_source,
+                    .table_coerced = nm_platform_ip_route_get_effective_table(
+                        NM_PLATFORM_IP_ROUTE_CAST(rt)),
+                }));
+        } else {
+            const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE(conf_o);
+
+            nmp_object_stackinit(
+                &oo,
+                NMP_OBJECT_TYPE_IP6_ROUTE,
+                &((NMPlatformIP6Route){
+                    .ifindex       = rt->ifindex,
+                    .network       = rt->gateway,
+                    .plen          = 128,
+                    .metric        = nm_platform_ip6_route_get_effective_metric(rt),
+                    .rt_source     = rt->rt_source,
+                    .table_coerced = nm_platform_ip_route_get_effective_table(
+                        NM_PLATFORM_IP_ROUTE_CAST(rt)),
+                }));
+        }
+
+        _LOG3D("route-sync: failure to add IPv%c route: %s: %s; try adding direct "
+               "route to gateway %s",
+               vt->is_ip4 ? '4' : '6',
+               nmp_object_to_string(conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof(sbuf1)),
+               nm_strerror(r),
+               nmp_object_to_string(&oo, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof(sbuf2)));
+
+        r2 = nm_platform_ip_route_add(self,
+                                      NMP_NLM_FLAG_APPEND | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+                                      &oo);
+
+        if (r2 < 0) {
+            _LOG3D("route-sync: failure to add gateway IPv%c route: %s: %s",
+                   vt->is_ip4 ? '4' : '6',
+                   nmp_object_to_string(conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof(sbuf1)),
+                   nm_strerror(r2));
+        }
+
+        *inout_gateway_route_added = TRUE;
+        return TRUE;
+    }
+
+    _LOG3W("route-sync: failure to add IPv%c route: %s: %s",
+           vt->is_ip4 ? '4' : '6',
+           nmp_object_to_string(conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof(sbuf1)),
+           nm_strerror(r));
+    *inout_success = FALSE;
+    return FALSE;
 }
 
 /**
@@ -4466,6 +5058,9 @@ nm_platform_ip_route_get_prune_list(NMPlatform *           self,
  * @out_temporary_not_available: (allow-none) (out): routes that could
  *   currently not be synced. The caller shall keep them and try later again.
  *
+ * The requests are sent to kernel with nm_platform_object_batch(), so that
+ * we don't wait for the response to one route before sending the next.
+ *
  * Returns: %TRUE on success.
  */
 gboolean
@@ -4479,30 +5074,32 @@ nm_platform_ip_route_sync(NMPlatform *self,
     const int                    IS_IPv4 = NM_IS_IPv4(addr_family);
     const NMPlatformVTableRoute *vt;
     gs_unref_hashtable GHashTable *routes_idx = NULL;
-    const NMPObject *              conf_o;
-    const NMDedupMultiEntry *      plat_entry;
-    guint                          i;
-    int                            i_type;
-    gboolean                       success = TRUE;
-    char                           sbuf1[sizeof(_nm_utils_to_string_buffer)];
-    char                           sbuf2[sizeof(_nm_utils_to_string_buffer)];
+    gs_free NMPlatformObjBatchOp *ops         = NULL;
+    guint                         n_ops;
+    const NMPObject *             conf_o;
+    const NMDedupMultiEntry *     plat_entry;
+    guint                         i;
+    int                           i_type;
+    gboolean                      success = TRUE;
+    char                          sbuf1[sizeof(_nm_utils_to_string_buffer)];
 
     nm_assert(NM_IS_PLATFORM(self));
     nm_assert(ifindex > 0);
 
     vt = &nm_platform_vtable_route.vx[IS_IPv4];
 
+    /* for each route we might need a deletion (of the conflicting route)
+     * and an addition. */
+    n_ops = MAX(routes ? routes->len * 2u : 0u, routes_prune ? routes_prune->len : 0u);
+    if (n_ops > 0)
+        ops = g_new(NMPlatformObjBatchOp, n_ops);
+
     for (i_type = 0; routes && i_type < 2; i_type++) {
-        for (i = 0; i < routes->len; i++) {
-            int      r, r2;
-            gboolean gateway_route_added = FALSE;
+        n_ops = 0;
 
+        for (i = 0; i < routes->len; i++) {
             conf_o = routes->pdata[i];
 
-#define VTABLE_IS_DEVICE_ROUTE(vt, o)                          \
-    (vt->is_ip4 ? (NMP_OBJECT_CAST_IP4_ROUTE(o)->gateway == 0) \
-                : IN6_IS_ADDR_UNSPECIFIED(&NMP_OBJECT_CAST_IP6_ROUTE(o)->gateway))
-
             if ((i_type == 0 && !VTABLE_IS_DEVICE_ROUTE(vt, conf_o))
                 || (i_type == 1 && VTABLE_IS_DEVICE_ROUTE(vt, conf_o))) {
                 /* we add routes in two runs over @i_type.
@@ -4545,155 +5142,57 @@ nm_platform_ip_route_sync(NMPlatform *self,
                     continue;
 
                 /* we need to replace the existing route with a (slightly) different
-                 * one. Delete it first. */
-                if (!nm_platform_object_delete(self, plat_o)) {
-                    /* ignore error. */
-                }
+                 * one. Delete it first. Kernel handles the requests of one batch
+                 * in order, so the deletion happens before the addition. */
+                ops[n_ops++] = (NMPlatformObjBatchOp){
+                    .obj       = plat_o,
+                    .is_delete = TRUE,
+                };
             }
 
-sync_route_add:
-            r = nm_platform_ip_route_add(self,
-                                         NMP_NLM_FLAG_APPEND
-                                             | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-                                         conf_o);
-            if (r < 0) {
-                if (r == -EEXIST) {
-                    /* Don't fail for EEXIST. It's not clear that the existing route
-                     * is identical to the one that we were about to add. However,
-                     * above we should have deleted conflicting (non-identical) routes. */
-                    if (_LOGD_ENABLED()) {
-                        plat_entry =
-                            nm_platform_lookup_entry(self, NMP_CACHE_ID_TYPE_OBJECT_TYPE, conf_o);
-                        if (!plat_entry) {
-                            _LOG3D("route-sync: adding route %s failed with EEXIST, however we "
-                                   "cannot find such a route",
-                                   nmp_object_to_string(conf_o,
-                                                        NMP_OBJECT_TO_STRING_PUBLIC,
-                                                        sbuf1,
-                                                        sizeof(sbuf1)));
-                        } else if (vt->route_cmp(NMP_OBJECT_CAST_IPX_ROUTE(conf_o),
-                                                 NMP_OBJECT_CAST_IPX_ROUTE(plat_entry->obj),
-                                                 NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
-                                   != 0) {
-                            _LOG3D("route-sync: adding route %s failed due to existing "
-                                   "(different!) route %s",
-                                   nmp_object_to_string(conf_o,
-                                                        NMP_OBJECT_TO_STRING_PUBLIC,
-                                                        sbuf1,
-                                                        sizeof(sbuf1)),
-                                   nmp_object_to_string(plat_entry->obj,
-                                                        NMP_OBJECT_TO_STRING_PUBLIC,
-                                                        sbuf2,
-                                                        sizeof(sbuf2)));
-                        }
-                    }
-                } else if (NMP_OBJECT_CAST_IP_ROUTE(conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
-                    _LOG3D("route-sync: ignore failure to add IPv%c route: %s: %s",
-                           vt->is_ip4 ? '4' : '6',
-                           nmp_object_to_string(conf_o,
-                                                NMP_OBJECT_TO_STRING_PUBLIC,
-                                                sbuf1,
-                                                sizeof(sbuf1)),
-                           nm_strerror(r));
-                } else if (r == -EINVAL && out_temporary_not_available
-                           && _err_inval_due_to_ipv6_tentative_pref_src(self, conf_o)) {
-                    _LOG3D("route-sync: ignore failure to add IPv6 route with tentative IPv6 "
-                           "pref-src: %s: %s",
-                           nmp_object_to_string(conf_o,
-                                                NMP_OBJECT_TO_STRING_PUBLIC,
-                                                sbuf1,
-                                                sizeof(sbuf1)),
-                           nm_strerror(r));
-                    if (!*out_temporary_not_available)
-                        *out_temporary_not_available =
-                            g_ptr_array_new_full(0, (GDestroyNotify) nmp_object_unref);
-                    g_ptr_array_add(*out_temporary_not_available,
-                                    (gpointer) nmp_object_ref(conf_o));
-                } else if (!gateway_route_added
-                           && ((r == -ENETUNREACH && vt->is_ip4
-                                && !!NMP_OBJECT_CAST_IP4_ROUTE(conf_o)->gateway)
-                               || (r == -EHOSTUNREACH && !vt->is_ip4
-                                   && !IN6_IS_ADDR_UNSPECIFIED(
-                                       &NMP_OBJECT_CAST_IP6_ROUTE(conf_o)->gateway)))) {
-                    NMPObject oo;
-
-                    if (vt->is_ip4) {
-                        const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE(conf_o);
-
-                        nmp_object_stackinit(
-                            &oo,
-                            NMP_OBJECT_TYPE_IP4_ROUTE,
-                            &((NMPlatformIP4Route){
-                                .ifindex       = rt->ifindex,
-                                .network       = rt->gateway,
-                                .plen          = 32,
-                                .metric        = nm_platform_ip4_route_get_effective_metric(rt),
-                                .rt_source     = rt->rt_source,
-                                .table_coerced = nm_platform_ip_route_get_effective_table(
-                                    NM_PLATFORM_IP_ROUTE_CAST(rt)),
-                            }));
-                    } else {
-                        const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE(conf_o);
-
-                        nmp_object_stackinit(
-                            &oo,
-                            NMP_OBJECT_TYPE_IP6_ROUTE,
-                            &((NMPlatformIP6Route){
-                                .ifindex       = rt->ifindex,
-                                .network       = rt->gateway,
-                                .plen          = 128,
-                                .metric        = nm_platform_ip6_route_get_effective_metric(rt),
-                                .rt_source     = rt->rt_source,
-                                .table_coerced = nm_platform_ip_route_get_effective_table(
-                                    NM_PLATFORM_IP_ROUTE_CAST(rt)),
-                            }));
-                    }
+            ops[n_ops++] = (NMPlatformObjBatchOp){
+                .obj      = conf_o,
+                .nlmflags = NMP_NLM_FLAG_APPEND | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+            };
+        }
 
-                    _LOG3D("route-sync: failure to add IPv%c route: %s: %s; try adding direct "
-                           "route to gateway %s",
-                           vt->is_ip4 ? '4' : '6',
-                           nmp_object_to_string(conf_o,
-                                                NMP_OBJECT_TO_STRING_PUBLIC,
-                                                sbuf1,
-                                                sizeof(sbuf1)),
-                           nm_strerror(r),
-                           nmp_object_to_string(&oo,
-                                                NMP_OBJECT_TO_STRING_PUBLIC,
-                                                sbuf2,
-                                                sizeof(sbuf2)));
-
-                    r2 = nm_platform_ip_route_add(self,
-                                                  NMP_NLM_FLAG_APPEND
-                                                      | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-                                                  &oo);
-
-                    if (r2 < 0) {
-                        _LOG3D("route-sync: failure to add gateway IPv%c route: %s: %s",
-                               vt->is_ip4 ? '4' : '6',
-                               nmp_object_to_string(conf_o,
-                                                    NMP_OBJECT_TO_STRING_PUBLIC,
-                                                    sbuf1,
-                                                    sizeof(sbuf1)),
-                               nm_strerror(r2));
-                    }
+        /* All device routes are configured (and acknowledged) before we send
+         * the first gateway route in the next run. */
+        nm_platform_object_batch(self, ops, n_ops);
 
-                    gateway_route_added = TRUE;
-                    goto sync_route_add;
-                } else {
-                    _LOG3W("route-sync: failure to add IPv%c route: %s: %s",
-                           vt->is_ip4 ? '4' : '6',
-                           nmp_object_to_string(conf_o,
-                                                NMP_OBJECT_TO_STRING_PUBLIC,
-                                                sbuf1,
-                                                sizeof(sbuf1)),
-                           nm_strerror(r));
-                    success = FALSE;
-                }
+        for (i = 0; i < n_ops; i++) {
+            gboolean gateway_route_added = FALSE;
+            int      r;
+
+            if (ops[i].is_delete) {
+                /* ignore error. */
+                continue;
+            }
+
+            conf_o = ops[i].obj;
+            r      = ops[i].result;
+
+            /* retrying is rare (it happens only after adding a direct route to
+             * the gateway). We do that synchronously. */
+            while (r < 0
+                   && _ip_route_sync_add_failed(self,
+                                                vt,
+                                                ifindex,
+                                                conf_o,
+                                                r,
+                                                &gateway_route_added,
+                                                out_temporary_not_available,
+                                                &success)) {
+                r = nm_platform_ip_route_add(self,
+                                             NMP_NLM_FLAG_APPEND
+                                                 | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+                                             conf_o);
             }
         }
     }
 
     if (routes_prune) {
+        n_ops = 0;
         for (i = 0; i < routes_prune->len; i++) {
             const NMPObject *prune_o;
 
@@ -4710,10 +5209,14 @@ sync_route_add:
             if (!nm_platform_lookup_entry(self, NMP_CACHE_ID_TYPE_OBJECT_TYPE, prune_o))
                 continue;
 
-            if (!nm_platform_object_delete(self, prune_o)) {
-                /* ignore error... */
-            }
+            ops[n_ops++] = (NMPlatformObjBatchOp){
+                .obj       = prune_o,
+                .is_delete = TRUE,
+            };
         }
+
+        /* ignore errors... */
+        nm_platform_object_batch(self, ops, n_ops);
     }
 
     return success;
@@ -4910,6 +5413,142 @@ nm_platform_object_delete(NMPlatform *self, const NMPObject *obj)
     return klass->object_delete(self, obj);
 }
 
+/**
+ * nm_platform_object_batch:
+ * @self: the #NMPlatform instance.
+ * @ops: the operations to perform.
+ * @n_ops: the number of operations in @ops.
+ *
+ * Performs the additions and deletions in @ops in the given order. Contrary
+ * to calling nm_platform_ip_route_add(), nm_platform_ip4_address_add() and
+ * the like for each object, the requests get sent to kernel without waiting
+ * for each response in between. The result of each operation is returned in
+ * its "result" field.
+ */
+void
+nm_platform_object_batch(NMPlatform *self, NMPlatformObjBatchOp *ops, guint n_ops)
+{
+    gs_unref_ptrarray GPtrArray *objs_keep_alive = NULL;
+    char                         sbuf[sizeof(_nm_utils_to_string_buffer)];
+    guint                        i;
+
+    _CHECK_SELF_VOID(self, klass);
+
+    nm_assert(ops || n_ops == 0);
+
+    if (n_ops == 0)
+        return;
+
+    /* the objects might be owned by the cache only. Processing netlink events
+     * while waiting for the responses can drop them from the cache. */
+    objs_keep_alive = g_ptr_array_new_full(n_ops, (GDestroyNotify) nmp_object_unref);
+
+    for (i = 0; i < n_ops; i++) {
+        const NMPObject *obj = ops[i].obj;
+        int              ifindex;
+
+        nm_assert(NM_IN_SET(NMP_OBJECT_GET_TYPE(obj),
+                            NMP_OBJECT_TYPE_IP4_ADDRESS,
+                            NMP_OBJECT_TYPE_IP6_ADDRESS,
+                            NMP_OBJECT_TYPE_IP4_ROUTE,
+                            NMP_OBJECT_TYPE_IP6_ROUTE));
+
+        ifindex = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX(obj)->ifindex;
+        if (ops[i].is_delete) {
+            _LOG3D("%s: delete %s",
+                   NMP_OBJECT_GET_CLASS(obj)->obj_type_name,
+                   nmp_object_to_string(obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof(sbuf)));
+        } else if (NM_IN_SET(NMP_OBJECT_GET_TYPE(obj),
+                             NMP_OBJECT_TYPE_IP4_ADDRESS,
+                             NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+            nm_assert(NMP_OBJECT_CAST_IP_ADDRESS(obj)->lifetime > 0);
+            nm_assert(NMP_OBJECT_CAST_IP_ADDRESS(obj)->preferred
+                      <= NMP_OBJECT_CAST_IP_ADDRESS(obj)->lifetime);
+
+            /* "timestamp" is expected to be zero, which to_string() treats as *now*. */
+            _LOG3D("address: adding or updating IPv%c address: %s",
+                   nm_utils_addr_family_to_char(NMP_OBJECT_GET_CLASS(obj)->addr_family),
+                   nmp_object_to_string(obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof(sbuf)));
+        } else {
+            _LOG3D("route: %-10s IPv%c route: %s",
+                   _nmp_nlm_flag_to_string(ops[i].nlmflags & NMP_NLM_FLAG_FMASK),
+                   nm_utils_addr_family_to_char(NMP_OBJECT_GET_CLASS(obj)->addr_family),
+                   nmp_object_to_string(obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof(sbuf)));
+        }
+        ops[i].result = 0;
+
+        if (!NMP_OBJECT_IS_STACKINIT(obj))
+            g_ptr_array_add(objs_keep_alive, (gpointer) nmp_object_ref(obj));
+    }
+
+    if (klass->object_batch) {
+        klass->object_batch(self, ops, n_ops);
+        return;
+    }
+
+    for (i = 0; i < n_ops; i++) {
+        const NMPObject *obj = ops[i].obj;
+        gboolean         success;
+
+        switch (NMP_OBJECT_GET_TYPE(obj)) {
+        case NMP_OBJECT_TYPE_IP4_ADDRESS:
+        {
+            const NMPlatformIP4Address *a = NMP_OBJECT_CAST_IP4_ADDRESS(obj);
+
+            if (ops[i].is_delete) {
+                success = klass->ip4_address_delete(self,
+                                                    a->ifindex,
+                                                    a->address,
+                                                    a->plen,
+                                                    a->peer_address);
+            } else {
+                success = klass->ip4_address_add(self,
+                                                 a->ifindex,
+                                                 a->address,
+                                                 a->plen,
+                                                 a->peer_address,
+                                                 nm_platform_ip4_broadcast_address_from_addr(a),
+                                                 a->lifetime,
+                                                 a->preferred,
+                                                 a->n_ifa_flags,
+                                                 a->label);
+            }
+            ops[i].result = success ? 0 : -NME_UNSPEC;
+            break;
+        }
+        case NMP_OBJECT_TYPE_IP6_ADDRESS:
+        {
+            const NMPlatformIP6Address *a = NMP_OBJECT_CAST_IP6_ADDRESS(obj);
+
+            if (ops[i].is_delete)
+                success = klass->ip6_address_delete(self, a->ifindex, a->address, a->plen);
+            else {
+                success = klass->ip6_address_add(self,
+                                                 a->ifindex,
+                                                 a->address,
+                                                 a->plen,
+                                                 a->peer_address,
+                                                 a->lifetime,
+                                                 a->preferred,
+                                                 a->n_ifa_flags);
+            }
+            ops[i].result = success ? 0 : -NME_UNSPEC;
+            break;
+        }
+        default:
+            if (ops[i].is_delete)
+                ops[i].result = klass->object_delete(self, obj) ? 0 : -NME_UNSPEC;
+            else {
+                ops[i].result = klass->ip_route_add(self,
+                                                    ops[i].nlmflags,
+                                                    NMP_OBJECT_GET_CLASS(obj)->addr_family,
+                                                    NMP_OBJECT_CAST_IP_ROUTE(obj));
+            }
+            break;
+        }
+    }
+}
+
 /*****************************************************************************/
 
 int
@@ -8686,6 +9325,108 @@ log_tfilter(NMPlatform *               self,
 
 /*****************************************************************************/
 
+static void
+_change_batch_entry_clear(gpointer data)
+{
+    NMPlatformSignalChangeBatchEntry *entry = data;
+
+    nmp_object_unref(entry->obj);
+}
+
+static gboolean
+_change_batch_idle_cb(gpointer user_data)
+{
+    gs_unref_object NMPlatform *self    = g_object_ref(NM_PLATFORM(user_data));
+    NMPlatformPrivate *         priv    = NM_PLATFORM_GET_PRIVATE(self);
+    gs_unref_array GArray *     entries = NULL;
+
+    nm_clear_g_source_inst(&priv->change_batch.idle_source);
+
+    /* Changes that happen while the handlers run are collected for
+     * the next batch. */
+    entries = g_steal_pointer(&priv->change_batch.entries);
+    nm_clear_pointer(&priv->change_batch.entries_idx, g_hash_table_unref);
+
+    _LOGt("emit signal %s with %u changes", NM_PLATFORM_SIGNAL_CHANGES_BATCH, entries->len);
+
+    g_signal_emit(self,
+                  signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH],
+                  0,
+                  (gconstpointer) entries->data,
+                  entries->len);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_change_batch_add(NMPlatform *self, const NMPObject *obj, NMPlatformSignalChangeType change_type)
+{
+    NMPlatformPrivate *               priv = NM_PLATFORM_GET_PRIVATE(self);
+    NMPlatformSignalChangeBatchEntry *entry;
+    const NMPObject *                 obj_old;
+    gpointer                          p_idx;
+
+    /* Without subscribers, don't bother keeping the objects alive. */
+    if (!g_signal_has_handler_pending(self,
+                                      signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH],
+                                      0,
+                                      FALSE))
+        return;
+
+    if (!priv->change_batch.entries) {
+        priv->change_batch.entries =
+            g_array_new(FALSE, FALSE, sizeof(NMPlatformSignalChangeBatchEntry));
+        g_array_set_clear_func(priv->change_batch.entries, _change_batch_entry_clear);
+        priv->change_batch.entries_idx =
+            g_hash_table_new((GHashFunc) nmp_object_id_hash, (GEqualFunc) nmp_object_id_equal);
+    }
+
+    if (g_hash_table_lookup_extended(priv->change_batch.entries_idx, obj, NULL, &p_idx)) {
+        /* Coalesce with the pending change of the same object. So a batch
+         * has at most one entry per object, no matter how often it changed. */
+        entry = &g_array_index(priv->change_batch.entries,
+                               NMPlatformSignalChangeBatchEntry,
+                               GPOINTER_TO_UINT(p_idx));
+
+        obj_old    = entry->obj;
+        entry->obj = nmp_object_ref(obj);
+        g_hash_table_replace(priv->change_batch.entries_idx, (gpointer) entry->obj, p_idx);
+        nmp_object_unref(obj_old);
+
+        if (entry->change_type == NM_PLATFORM_SIGNAL_ADDED) {
+            /* still new for the subscribers, unless it's gone again. */
+            if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+                entry->change_type = NM_PLATFORM_SIGNAL_REMOVED;
+        } else if (entry->change_type == NM_PLATFORM_SIGNAL_REMOVED
+                   && change_type == NM_PLATFORM_SIGNAL_ADDED) {
+            /* removed and added again. For the subscribers it changed. */
+            entry->change_type = NM_PLATFORM_SIGNAL_CHANGED;
+        } else
+            entry->change_type = change_type;
+        return;
+    }
+
+    g_hash_table_insert(priv->change_batch.entries_idx,
+                        (gpointer) obj,
+                        GUINT_TO_POINTER(priv->change_batch.entries->len));
+
+    entry  = nm_g_array_append_new(priv->change_batch.entries, NMPlatformSignalChangeBatchEntry);
+    *entry = (NMPlatformSignalChangeBatchEntry){
+        .obj         = nmp_object_ref(obj),
+        .change_type = change_type,
+    };
+
+    if (!priv->change_batch.idle_source) {
+        /* Use idle priority, so that the batch is only emitted once the pending
+         * netlink events are processed. During a route storm, this collects the
+         * changes from many reads of the route socket into one batch. */
+        priv->change_batch.idle_source =
+            nm_g_idle_source_new(G_PRIORITY_DEFAULT_IDLE, _change_batch_idle_cb, self, NULL);
+        g_source_attach(priv->change_batch.idle_source, NULL);
+    }
+}
+
+/*****************************************************************************/
+
 void
 nm_platform_cache_update_emit_signal(NMPlatform *     self,
                                      NMPCacheOpsType  cache_op,
@@ -8746,6 +9487,9 @@ nm_platform_cache_update_emit_signal(NMPlatform *     self,
     else
         ifindex = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX(o)->ifindex;
 
+    if (klass->obj_type == NMP_OBJECT_TYPE_LINK && cache_op == NMP_CACHE_OPS_REMOVED)
+        _ip_route_prune_lists_forget(self, ifindex);
+
     if (klass->obj_type == NMP_OBJECT_TYPE_IP4_ROUTE
         && NM_PLATFORM_GET_PRIVATE(self)->ip4_dev_route_blacklist_gc_timeout_id
         && NM_IN_SET(cache_op, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED))
@@ -8764,6 +9508,9 @@ nm_platform_cache_update_emit_signal(NMPlatform *     self,
                   ifindex,
                   &o->object,
                   (int) cache_op);
+
+    _change_batch_add(self, o, (NMPlatformSignalChangeType) cache_op);
+
     nmp_object_unref(o);
 }
 
@@ -8895,6 +9642,12 @@ finalize(GObject *object)
     nm_clear_g_source(&priv->ip4_dev_route_blacklist_check_id);
     nm_clear_g_source(&priv->ip4_dev_route_blacklist_gc_timeout_id);
     nm_clear_pointer(&priv->ip4_dev_route_blacklist_hash, g_hash_table_unref);
+    nm_clear_g_source_inst(&priv->link_stats_refresh.timeout_source);
+    nm_clear_pointer(&priv->link_stats_refresh.hash, g_hash_table_unref);
+    nm_clear_g_source_inst(&priv->change_batch.idle_source);
+    nm_clear_pointer(&priv->change_batch.entries_idx, g_hash_table_unref);
+    nm_clear_pointer(&priv->change_batch.entries, g_array_unref);
+    nm_clear_pointer(&priv->ip_route_prune_lists, g_hash_table_unref);
     g_clear_object(&self->_netns);
     nm_dedup_multi_index_unref(priv->multi_idx);
     nmp_cache_free(priv->cache);
@@ -8976,4 +9729,17 @@ nm_platform_class_init(NMPlatformClass *platform_class)
            log_routing_rule);
     SIGNAL(NM_PLATFORM_SIGNAL_ID_QDISC, NM_PLATFORM_SIGNAL_QDISC_CHANGED, log_qdisc);
     SIGNAL(NM_PLATFORM_SIGNAL_ID_TFILTER, NM_PLATFORM_SIGNAL_TFILTER_CHANGED, log_tfilter);
+
+    signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH] =
+        g_signal_new(NM_PLATFORM_SIGNAL_CHANGES_BATCH,
+                     G_OBJECT_CLASS_TYPE(object_class),
+                     G_SIGNAL_RUN_FIRST,
+                     0,
+                     NULL,
+                     NULL,
+                     NULL,
+                     G_TYPE_NONE,
+                     2,
+                     G_TYPE_POINTER /* const NMPlatformSignalChangeBatchEntry * */,
+                     G_TYPE_UINT /* n_entries */);
 }
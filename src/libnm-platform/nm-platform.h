@@ -264,6 +264,7 @@ typedef enum { /*< skip >*/
                NM_PLATFORM_SIGNAL_ID_ROUTING_RULE,
                NM_PLATFORM_SIGNAL_ID_QDISC,
                NM_PLATFORM_SIGNAL_ID_TFILTER,
+               NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH,
                _NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -276,6 +277,11 @@ typedef enum {
     NM_PLATFORM_SIGNAL_REMOVED,
 } NMPlatformSignalChangeType;
 
+typedef struct {
+    const NMPObject *          obj;
+    NMPlatformSignalChangeType change_type;
+} NMPlatformSignalChangeBatchEntry;
+
 #define NM_PLATFORM_IP_ADDRESS_CAST(address) \
     NM_CONSTCAST(NMPlatformIPAddress,        \
                  (address),                  \
@@ -767,6 +773,26 @@ typedef struct {
     const char *(*route_to_string)(const NMPlatformIPXRoute *route, char *buf, gsize len);
 } NMPlatformVTableRoute;
 
+typedef struct {
+    /* the object to add or delete. Supported are IPv4 and IPv6 routes and
+     * addresses.
+     *
+     * When adding an address, the object's "lifetime" and "preferred" are
+     * relative to now (the "timestamp" is ignored), and "n_ifa_flags" are the
+     * flags to set, like for nm_platform_ip4_address_add(). */
+    const NMPObject *obj;
+
+    /* for adding routes, the flags like for nm_platform_ip_route_add(). */
+    NMPNlmFlags nlmflags;
+
+    bool is_delete : 1;
+
+    /* (out): the result of the operation. For adding routes, that is the same as
+     * nm_platform_ip_route_add() would return. Otherwise, zero means success
+     * (which for deletions includes that the object was already gone). */
+    int result;
+} NMPlatformObjBatchOp;
+
 typedef union {
     struct {
         NMPlatformVTableRoute v6;
@@ -1200,6 +1226,7 @@ typedef struct {
     gboolean (*wpan_set_channel)(NMPlatform *self, int ifindex, guint8 page, guint8 channel);
 
     gboolean (*object_delete)(NMPlatform *self, const NMPObject *obj);
+    void (*object_batch)(NMPlatform *self, NMPlatformObjBatchOp *ops, guint n_ops);
 
     gboolean (*ip4_address_add)(NMPlatform *self,
                                 int         ifindex,
@@ -1268,6 +1295,27 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_QDISC_CHANGED        "qdisc-changed"
 #define NM_PLATFORM_SIGNAL_TFILTER_CHANGED      "tfilter-changed"
 
+/* "changes-batch" carries all changes that happened since the last time it was
+ * emitted, as an array of #NMPlatformSignalChangeBatchEntry (in the order in
+ * which the objects first changed) and the number of entries.
+ * Objects that are invisible are not included, like with the per-object signals.
+ *
+ * Changes of the same object (by ID) are coalesced into one entry with the
+ * latest object. An object that was added during the batch is reported as
+ * added (or removed, if it is gone again). The number of entries is thus
+ * bounded by the number of objects, even during a storm of changes.
+ *
+ * The objects are kept alive for the duration of the signal, but they may
+ * be outdated already. Use the cache to get the current state.
+ *
+ * The batch is emitted later than the per-object signals. Subscribers that must
+ * see a change before anything else happens (like a commit that relies on the
+ * cache) need the per-object signals. The batch is for work that can be done
+ * once for all changes.
+ *
+ * The signal is emitted from an idle source with G_PRIORITY_DEFAULT_IDLE. */
+#define NM_PLATFORM_SIGNAL_CHANGES_BATCH "changes-batch"
+
 const char *nm_platform_signal_change_type_to_string(NMPlatformSignalChangeType change_type);
 
 /*****************************************************************************/
@@ -1812,6 +1860,11 @@ gboolean    nm_platform_link_supports_slaves(NMPlatform *self, int ifindex);
 const char *nm_platform_link_get_type_name(NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_refresh(NMPlatform *self, int ifindex);
+void     nm_platform_refresh_all(NMPlatform *self, NMPObjectType obj_type);
+void     nm_platform_link_stats_refresh_set(NMPlatform *  self,
+                                            gconstpointer tag,
+                                            int           ifindex,
+                                            guint         refresh_rate_msec);
 void     nm_platform_process_events(NMPlatform *self);
 
 const NMPlatformLink *
@@ -2010,6 +2063,7 @@ const NMPlatformIP6Address *
 nm_platform_ip6_address_get(NMPlatform *self, int ifindex, const struct in6_addr *address);
 
 gboolean nm_platform_object_delete(NMPlatform *self, const NMPObject *route);
+void     nm_platform_object_batch(NMPlatform *self, NMPlatformObjBatchOp *ops, guint n_ops);
 
 gboolean nm_platform_ip4_address_add(NMPlatform *self,
                                      int         ifindex,
@@ -2143,6 +2197,11 @@ GPtrArray *nm_platform_ip_route_get_prune_list(NMPlatform *           self,
                                                int                    ifindex,
                                                NMIPRouteTableSyncMode route_table_sync);
 
+GPtrArray *nm_platform_ip_route_get_prune_list_cached(NMPlatform *           self,
+                                                      int                    addr_family,
+                                                      int                    ifindex,
+                                                      NMIPRouteTableSyncMode route_table_sync);
+
 gboolean nm_platform_ip_route_sync(NMPlatform *self,
                                    int         addr_family,
                                    int         ifindex,
@@ -71,9 +71,34 @@ struct _NMPCache {
      * Don't bother, use _idx_type_get() instead! */
     DedupMultiIdxType idx_types[NMP_CACHE_ID_TYPE_MAX];
 
+    /* Generation counters for routes. Whenever a route gets added or changed,
+     * @route_generation is bumped and the route is stamped with the new value.
+     * That allows users to find out cheaply whether anything was added to an
+     * interface since they last looked, and to only look at the new routes.
+     * Removing a route does not bump the counter.
+     *
+     * The generation of a route is kept in the cached object itself (see
+     * NMPObjectIPRouteGen). @route_gen_heads are RouteGenHead instances
+     * per (obj-type, ifindex) that link the routes of the interface. */
+    guint64     route_generation;
+    GHashTable *route_gen_heads;
+
     gboolean use_udev;
 };
 
+typedef struct {
+    NMPObjectType obj_type;
+    int           ifindex;
+
+    /* the generation of the last route that was added or changed on
+     * this interface. */
+    guint64 generation;
+
+    /* the routes of this interface (via NMPObjectIPRouteGen.lst_gen),
+     * sorted by generation. */
+    CList lst_gen_head;
+} RouteGenHead;
+
 /*****************************************************************************/
 
 int
@@ -259,6 +284,31 @@ nm_sock_addr_union_to_string(const NMSockAddrUnion *sa, char *buf, gsize len)
 
 static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class;
 
+static guint
+_idx_obj_id_hash(const NMPObject *obj)
+{
+    guint hash;
+
+    /* Every object in the cache is part of several indexes and its ID gets
+     * hashed for each of them, on every lookup, add and remove. For large
+     * routing tables that dominates the cost of nmp_cache_update_netlink_route().
+     *
+     * Interned objects are immutable, so remember their ID hash. Other
+     * objects (like stack allocated lookup needles) compute it each time. */
+    if (obj->parent._multi_idx) {
+        hash = obj->parent._obj_hash_cache;
+        if (G_LIKELY(hash != 0)) {
+            nm_assert(hash == (nmp_object_id_hash(obj) ?: 1u));
+            return hash;
+        }
+    }
+
+    hash = nmp_object_id_hash(obj) ?: 1u;
+    if (obj->parent._multi_idx)
+        ((NMPObject *) obj)->parent._obj_hash_cache = hash;
+    return hash;
+}
+
 static void
 _idx_obj_id_hash_update(const NMDedupMultiIdxType *idx_type,
                         const NMDedupMultiObj *    obj,
@@ -269,7 +319,7 @@ _idx_obj_id_hash_update(const NMDedupMultiIdxType *idx_type,
     nm_assert(idx_type && idx_type->klass == &_dedup_multi_idx_type_class);
     nm_assert(NMP_OBJECT_GET_TYPE(o) != NMP_OBJECT_TYPE_UNKNOWN);
 
-    nmp_object_id_hash_update(o, h);
+    nm_hash_update_val(h, _idx_obj_id_hash(o));
 }
 
 static gboolean
@@ -739,6 +789,23 @@ _vt_cmd_obj_dispose_lnk_wireguard(NMPObject *obj)
     _wireguard_clear(&obj->_lnk_wireguard);
 }
 
+/*****************************************************************************/
+
+/* Allocation statistics per object type, for debug logging. Like the
+ * platform cache, this is not thread-safe. */
+static NMPObjectAllocStats _alloc_stats[NMP_OBJECT_TYPE_MAX + 1];
+
+void
+nmp_object_alloc_stats_get(NMPObjectType obj_type, NMPObjectAllocStats *out_stats)
+{
+    g_return_if_fail(obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_MAX);
+    g_return_if_fail(out_stats);
+
+    *out_stats = _alloc_stats[obj_type];
+}
+
+/*****************************************************************************/
+
 static NMPObject *
 _nmp_object_new_from_class(const NMPClass *klass)
 {
@@ -751,6 +818,9 @@ _nmp_object_new_from_class(const NMPClass *klass)
     obj         = g_slice_alloc0(klass->sizeof_data + G_STRUCT_OFFSET(NMPObject, object));
     obj->_class = klass;
     obj->parent._ref_count = 1;
+
+    _alloc_stats[klass->obj_type].n_allocated++;
+    _alloc_stats[klass->obj_type].n_live++;
     return obj;
 }
 
@@ -1322,6 +1392,13 @@ _vt_cmd_obj_copy_link(NMPObject *dst, const NMPObject *src)
     dst->_link = src->_link;
 }
 
+static void
+_vt_cmd_obj_copy_ipx_route(NMPObject *dst, const NMPObject *src)
+{
+    /* the generation belongs to the cached object and is not copied. */
+    memcpy(&dst->object, &src->object, NMP_OBJECT_GET_CLASS(dst)->sizeof_public);
+}
+
 static void
 _vt_cmd_obj_copy_lnk_vlan(NMPObject *dst, const NMPObject *src)
 {
@@ -1800,6 +1877,11 @@ _vt_dedup_obj_destroy(NMDedupMultiObj *obj)
     klass = o->_class;
     if (klass->cmd_obj_dispose)
         klass->cmd_obj_dispose(o);
+
+    nm_assert(_alloc_stats[klass->obj_type].n_live > 0);
+    _alloc_stats[klass->obj_type].n_freed++;
+    _alloc_stats[klass->obj_type].n_live--;
+
     g_slice_free1(klass->sizeof_data + G_STRUCT_OFFSET(NMPObject, object), o);
 }
 
@@ -2439,6 +2521,216 @@ _idxcache_update_other_cache_ids(NMPCache *       cache,
         nm_dedup_multi_index_remove_entry(cache->multi_idx, entry_old);
 }
 
+static guint
+_route_gen_head_hash(gconstpointer ptr)
+{
+    const RouteGenHead *head = ptr;
+    NMHashState         h;
+
+    nm_hash_init(&h, 1790384581u);
+    nm_hash_update_vals(&h, head->obj_type, head->ifindex);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_route_gen_head_equal(gconstpointer a, gconstpointer b)
+{
+    const RouteGenHead *head_a = a;
+    const RouteGenHead *head_b = b;
+
+    return head_a->obj_type == head_b->obj_type && head_a->ifindex == head_b->ifindex;
+}
+
+static void
+_route_gen_head_free(gpointer ptr)
+{
+    RouteGenHead *       head = ptr;
+    NMPObjectIPRouteGen *gen;
+
+    /* the objects may outlive the cache. */
+    while ((gen = c_list_first_entry(&head->lst_gen_head, NMPObjectIPRouteGen, lst_gen))) {
+        c_list_unlink(&gen->lst_gen);
+        gen->generation = 0;
+    }
+    nm_g_slice_free(head);
+}
+
+static NMPObjectIPRouteGen *
+_route_gen_get(const NMPObject *obj)
+{
+    /* the generation is private to the cache. It is not part of the
+     * public data, so it can be updated while the object is in the
+     * (otherwise immutable) cache. */
+    if (NMP_OBJECT_GET_TYPE(obj) == NMP_OBJECT_TYPE_IP4_ROUTE)
+        return &((NMPObject *) obj)->_ip4_route._gen;
+    nm_assert(NMP_OBJECT_GET_TYPE(obj) == NMP_OBJECT_TYPE_IP6_ROUTE);
+    return &((NMPObject *) obj)->_ip6_route._gen;
+}
+
+static RouteGenHead *
+_route_gen_head_lookup(const NMPCache *cache, NMPObjectType obj_type, int ifindex)
+{
+    RouteGenHead needle = {
+        .obj_type = obj_type,
+        .ifindex  = ifindex,
+    };
+
+    return g_hash_table_lookup(cache->route_gen_heads, &needle);
+}
+
+static void
+_route_gen_track(NMPCache *cache, const NMPObject *obj_old, const NMPObject *obj_new)
+{
+    const NMPObject *    obj_id = obj_old ?: obj_new;
+    NMPObjectIPRouteGen *gen;
+    RouteGenHead *       head;
+
+    nm_assert(obj_id);
+    nm_assert(NM_IN_SET(NMP_OBJECT_GET_TYPE(obj_id),
+                        NMP_OBJECT_TYPE_IP4_ROUTE,
+                        NMP_OBJECT_TYPE_IP6_ROUTE));
+
+    /* the ID contains the ifindex, so old and new share the head. */
+    head = _route_gen_head_lookup(cache,
+                                  NMP_OBJECT_GET_TYPE(obj_id),
+                                  NMP_OBJECT_CAST_OBJ_WITH_IFINDEX(obj_id)->ifindex);
+
+    if (obj_old) {
+        /* the old object may live on outside the cache (the multi_idx
+         * shares it with others), so reset its generation. */
+        gen = _route_gen_get(obj_old);
+        if (gen->generation != 0) {
+            nm_assert(head);
+            c_list_unlink(&gen->lst_gen);
+            gen->generation = 0;
+        }
+    }
+
+    if (!obj_new) {
+        if (head && c_list_is_empty(&head->lst_gen_head))
+            g_hash_table_remove(cache->route_gen_heads, head);
+        return;
+    }
+
+    if (!head) {
+        head  = g_slice_new(RouteGenHead);
+        *head = (RouteGenHead){
+            .obj_type = NMP_OBJECT_GET_TYPE(obj_new),
+            .ifindex  = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX(obj_new)->ifindex,
+        };
+        c_list_init(&head->lst_gen_head);
+        g_hash_table_add(cache->route_gen_heads, head);
+    }
+
+    /* an object is in the cache at most once. */
+    gen = _route_gen_get(obj_new);
+    nm_assert(gen->generation == 0);
+
+    gen->generation  = ++cache->route_generation;
+    head->generation = gen->generation;
+    c_list_link_tail(&head->lst_gen_head, &gen->lst_gen);
+}
+
+/**
+ * nmp_cache_get_route_generation:
+ * @cache: the #NMPCache
+ * @obj_type: %NMP_OBJECT_TYPE_IP4_ROUTE or %NMP_OBJECT_TYPE_IP6_ROUTE
+ * @ifindex: the interface
+ *
+ * Returns: the generation of the route that was last added or changed
+ *   on the interface, or zero if there are no routes. The generations
+ *   are increasing and never reused during the lifetime of the cache.
+ *   Removing routes doesn't change the generation.
+ */
+guint64
+nmp_cache_get_route_generation(const NMPCache *cache, NMPObjectType obj_type, int ifindex)
+{
+    const RouteGenHead *head;
+
+    nm_assert(cache);
+    nm_assert(NM_IN_SET(obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
+
+    head = _route_gen_head_lookup(cache, obj_type, ifindex);
+    return head ? head->generation : 0u;
+}
+
+/**
+ * nmp_cache_get_route_obj_generation:
+ * @cache: the #NMPCache
+ * @obj: a route object that was obtained from @cache.
+ *
+ * This doesn't look up the cache, the generation is read from the
+ * object itself.
+ *
+ * Returns: the generation when @obj was added to the cache, or zero
+ *   if @obj is no longer in the cache (because the route was removed
+ *   or replaced by a changed one).
+ */
+guint64
+nmp_cache_get_route_obj_generation(const NMPCache *cache, const NMPObject *obj)
+{
+    nm_assert(cache);
+    nm_assert(NM_IN_SET(NMP_OBJECT_GET_TYPE(obj),
+                        NMP_OBJECT_TYPE_IP4_ROUTE,
+                        NMP_OBJECT_TYPE_IP6_ROUTE));
+    nm_assert(_route_gen_get(obj)->generation == 0 || nmp_cache_lookup_obj(cache, obj) == obj);
+
+    return _route_gen_get(obj)->generation;
+}
+
+/**
+ * nmp_cache_lookup_routes_since:
+ * @cache: the #NMPCache
+ * @obj_type: %NMP_OBJECT_TYPE_IP4_ROUTE or %NMP_OBJECT_TYPE_IP6_ROUTE
+ * @ifindex: the interface
+ * @generation: the generation that the caller already knows about.
+ * @dst: the array to which the routes get appended (with a new reference).
+ *
+ * Appends all routes of the interface that were added or changed after
+ * @generation, in the order in which they were added. This only visits
+ * the newer routes and not all routes of the interface.
+ *
+ * Returns: the number of appended routes.
+ */
+guint
+nmp_cache_lookup_routes_since(const NMPCache *cache,
+                              NMPObjectType   obj_type,
+                              int             ifindex,
+                              guint64         generation,
+                              GPtrArray *     dst)
+{
+    const RouteGenHead *head;
+    const NMPObject *   obj;
+    CList *             iter;
+    guint               n = 0;
+
+    nm_assert(cache);
+    nm_assert(dst);
+    nm_assert(NM_IN_SET(obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
+
+    head = _route_gen_head_lookup(cache, obj_type, ifindex);
+    if (!head || head->generation <= generation)
+        return 0;
+
+    /* walk backwards to the first route that is newer than @generation... */
+    iter = head->lst_gen_head.prev;
+    while (iter->prev != &head->lst_gen_head
+           && c_list_entry(iter->prev, NMPObjectIPRouteGen, lst_gen)->generation > generation)
+        iter = iter->prev;
+
+    /* ... and from there forward to the end. */
+    for (; iter != &head->lst_gen_head; iter = iter->next) {
+        if (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE)
+            obj = c_list_entry(iter, NMPObject, _ip4_route._gen.lst_gen);
+        else
+            obj = c_list_entry(iter, NMPObject, _ip6_route._gen.lst_gen);
+        nm_assert(_route_gen_get(obj)->generation > generation);
+        g_ptr_array_add(dst, (gpointer) nmp_object_ref(obj));
+        n++;
+    }
+    return n;
+}
+
 static void
 _idxcache_update(NMPCache *                cache,
                  const NMDedupMultiEntry * entry_old,
@@ -2521,6 +2813,9 @@ _idxcache_update(NMPCache *                cache,
                                          is_dump);
     }
 
+    if (NM_IN_SET(klass->obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE))
+        _route_gen_track(cache, obj_old, entry_new ? entry_new->obj : NULL);
+
     NM_SET_OUT(out_entry_new, entry_new);
 }
 
@@ -3034,6 +3329,11 @@ nmp_cache_new(NMDedupMultiIndex *multi_idx, gboolean use_udev)
 
     cache->multi_idx = nm_dedup_multi_index_ref(multi_idx);
 
+    cache->route_gen_heads = g_hash_table_new_full(_route_gen_head_hash,
+                                                   _route_gen_head_equal,
+                                                   _route_gen_head_free,
+                                                   NULL);
+
     cache->use_udev = !!use_udev;
     return cache;
 }
@@ -3043,6 +3343,9 @@ nmp_cache_free(NMPCache *cache)
 {
     guint i;
 
+    /* first, while the routes are still alive. */
+    g_hash_table_unref(cache->route_gen_heads);
+
     for (i = NMP_CACHE_ID_TYPE_NONE + 1; i <= NMP_CACHE_ID_TYPE_MAX; i++)
         nm_dedup_multi_index_remove_idx(cache->multi_idx, _idx_type_get(cache, i));
 
@@ -3147,6 +3450,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
             .signal_type_id           = NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,
             .signal_type              = NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,
             .supported_cache_ids      = _supported_cache_ids_ipx_route,
+            .cmd_obj_copy             = _vt_cmd_obj_copy_ipx_route,
             .cmd_obj_is_alive         = _vt_cmd_obj_is_alive_ipx_route,
             .cmd_plobj_id_copy        = _vt_cmd_plobj_id_copy_ip4_route,
             .cmd_plobj_id_cmp         = _vt_cmd_plobj_id_cmp_ip4_route,
@@ -3168,6 +3472,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
             .signal_type_id           = NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,
             .signal_type              = NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,
             .supported_cache_ids      = _supported_cache_ids_ipx_route,
+            .cmd_obj_copy             = _vt_cmd_obj_copy_ipx_route,
             .cmd_obj_is_alive         = _vt_cmd_obj_is_alive_ipx_route,
             .cmd_plobj_id_copy        = _vt_cmd_plobj_id_copy_ip6_route,
             .cmd_plobj_id_cmp         = _vt_cmd_plobj_id_cmp_ip6_route,
@@ -313,7 +313,15 @@ typedef struct {
 } NMPObjectIP4Address;
 
 typedef struct {
-    NMPlatformIP4Route _public;
+    /* private to the NMPCache that tracks the route. @generation is zero
+     * while the object is not in the cache. See nmp_cache_get_route_generation(). */
+    CList   lst_gen;
+    guint64 generation;
+} NMPObjectIPRouteGen;
+
+typedef struct {
+    NMPlatformIP4Route  _public;
+    NMPObjectIPRouteGen _gen;
 } NMPObjectIP4Route;
 
 typedef struct {
@@ -321,7 +329,8 @@ typedef struct {
 } NMPObjectIP6Address;
 
 typedef struct {
-    NMPlatformIP6Route _public;
+    NMPlatformIP6Route  _public;
+    NMPObjectIPRouteGen _gen;
 } NMPObjectIP6Route;
 
 typedef struct {
@@ -646,6 +655,17 @@ nmp_object_ref_set(const NMPObject **pp, const NMPObject *obj)
 NMPObject *nmp_object_new(NMPObjectType obj_type, gconstpointer plobj);
 NMPObject *nmp_object_new_link(int ifindex);
 
+typedef struct {
+    /* the total number of objects that were ever allocated and freed. */
+    guint64 n_allocated;
+    guint64 n_freed;
+
+    /* the number of objects currently alive. */
+    guint n_live;
+} NMPObjectAllocStats;
+
+void nmp_object_alloc_stats_get(NMPObjectType obj_type, NMPObjectAllocStats *out_stats);
+
 const NMPObject *nmp_object_stackinit(NMPObject *obj, NMPObjectType obj_type, gconstpointer plobj);
 
 static inline NMPObject *
@@ -877,6 +897,14 @@ nmp_cache_reresolve_main_entry(NMPCache *               cache,
 
 void nmp_cache_dirty_set_all_main(NMPCache *cache, const NMPLookup *lookup);
 
+guint64 nmp_cache_get_route_generation(const NMPCache *cache, NMPObjectType obj_type, int ifindex);
+guint64 nmp_cache_get_route_obj_generation(const NMPCache *cache, const NMPObject *obj);
+guint   nmp_cache_lookup_routes_since(const NMPCache *cache,
+                                      NMPObjectType   obj_type,
+                                      int             ifindex,
+                                      guint64         generation,
+                                      GPtrArray *     dst);
+
 NMPCache *nmp_cache_new(NMDedupMultiIndex *multi_idx, gboolean use_udev);
 void      nmp_cache_free(NMPCache *cache);
 
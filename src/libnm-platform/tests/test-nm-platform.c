@@ -2,8 +2,11 @@
 
 #include "libnm-glib-aux/nm-default-glib-i18n-prog.h"
 
+#include <linux/rtnetlink.h>
+
 #include "libnm-log-core/nm-logging.h"
 #include "libnm-platform/nm-netlink.h"
+#include "libnm-platform/nm-platform-utils.h"
 #include "libnm-platform/nmp-netns.h"
 
 #include "libnm-glib-aux/nm-test-utils.h"
@@ -103,6 +106,158 @@ test_use_symbols(void)
 
 /*****************************************************************************/
 
+static void
+test_route_filter_parse(void)
+{
+    NMPUtilsRouteFilter f;
+
+    g_assert(nmp_utils_route_filter_parse("table:200", &f));
+    g_assert_cmpint(f.type, ==, NMP_UTILS_ROUTE_FILTER_TYPE_TABLE);
+    g_assert_cmpint(f.table, ==, 200);
+
+    g_assert(nmp_utils_route_filter_parse("table:10000", &f));
+    g_assert_cmpint(f.table, ==, 10000);
+
+    g_assert(nmp_utils_route_filter_parse("table:252", &f));
+    g_assert_cmpint(f.table, ==, 252);
+
+    g_assert(!nmp_utils_route_filter_parse("table:0", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:253", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:254", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:255", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:-1", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:main", &f));
+    g_assert(!nmp_utils_route_filter_parse("table:", &f));
+
+    g_assert(nmp_utils_route_filter_parse("protocol:bgp", &f));
+    g_assert_cmpint(f.type, ==, NMP_UTILS_ROUTE_FILTER_TYPE_PROTOCOL);
+    g_assert_cmpint(f.protocol, ==, 186);
+
+    g_assert(nmp_utils_route_filter_parse("protocol:bird", &f));
+    g_assert_cmpint(f.protocol, ==, 12);
+
+    g_assert(nmp_utils_route_filter_parse("protocol:42", &f));
+    g_assert_cmpint(f.protocol, ==, 42);
+
+    g_assert(nmp_utils_route_filter_parse("protocol:zebra", &f));
+    g_assert_cmpint(f.protocol, ==, 11);
+
+    g_assert(!nmp_utils_route_filter_parse("protocol:0", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:1", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:redirect", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:2", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:kernel", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:3", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:boot", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:4", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:static", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:9", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:ra", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:16", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:dhcp", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:256", &f));
+    g_assert(!nmp_utils_route_filter_parse("protocol:foo", &f));
+
+    g_assert(nmp_utils_route_filter_parse("prefix:10.1.2.3/8", &f));
+    g_assert_cmpint(f.type, ==, NMP_UTILS_ROUTE_FILTER_TYPE_PREFIX);
+    g_assert_cmpint(f.prefix.addr_family, ==, AF_INET);
+    g_assert_cmpint(f.prefix.plen, ==, 8);
+    g_assert_cmpint(f.prefix.addr.addr4, ==, nmtst_inet4_from_string("10.0.0.0"));
+
+    g_assert(nmp_utils_route_filter_parse("prefix:2001:db8::1", &f));
+    g_assert_cmpint(f.prefix.addr_family, ==, AF_INET6);
+    g_assert_cmpint(f.prefix.plen, ==, 128);
+
+    g_assert(!nmp_utils_route_filter_parse("prefix:10.0.0.0/33", &f));
+    g_assert(!nmp_utils_route_filter_parse("prefix:foo", &f));
+
+    g_assert(!nmp_utils_route_filter_parse("", &f));
+    g_assert(!nmp_utils_route_filter_parse(" table:200", &f));
+    g_assert(!nmp_utils_route_filter_parse("foo:200", &f));
+}
+
+static gboolean
+_route_filters_match(const NMPUtilsRouteFilter *filters,
+                     guint                      n_filters,
+                     int                        addr_family,
+                     guint32                    table,
+                     guint8                     protocol,
+                     const char *               dst,
+                     guint8                     dst_len)
+{
+    nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+    const struct rtmsg           rtmsg = {
+        .rtm_family   = addr_family,
+        .rtm_dst_len  = dst_len,
+        .rtm_table    = table < 256 ? table : RT_TABLE_COMPAT,
+        .rtm_protocol = protocol,
+        .rtm_scope    = RT_SCOPE_UNIVERSE,
+        .rtm_type     = RTN_UNICAST,
+    };
+
+    nlmsg = nlmsg_alloc_simple(nmtst_get_rand_bool() ? RTM_NEWROUTE : RTM_DELROUTE, 0);
+    g_assert(nlmsg);
+    g_assert_cmpint(nlmsg_append_struct(nlmsg, &rtmsg), >=, 0);
+    g_assert_cmpint(nla_put(nlmsg, RTA_TABLE, sizeof(table), &table), >=, 0);
+    if (dst) {
+        g_assert_cmpint(nla_put(nlmsg,
+                                RTA_DST,
+                                nm_utils_addr_family_to_size(addr_family),
+                                nmtst_inet_from_string(addr_family, dst)),
+                        >=,
+                        0);
+    }
+
+    return nmp_utils_route_filters_match(filters, n_filters, nlmsg_hdr(nlmsg));
+}
+
+static void
+test_route_filters_match(void)
+{
+    const char *const specs[] = {
+        "table:200",
+        "table:10000",
+        "protocol:bgp",
+        "prefix:10.0.0.0/8",
+        "prefix:2001:db8::/32",
+    };
+    NMPUtilsRouteFilter f[G_N_ELEMENTS(specs)];
+    const guint         n = G_N_ELEMENTS(f);
+    guint               i;
+
+    for (i = 0; i < n; i++)
+        g_assert(nmp_utils_route_filter_parse(specs[i], &f[i]));
+
+    /* by table. Tables above 255 are only in RTA_TABLE. */
+    g_assert(_route_filters_match(f, n, AF_INET, 200, RTPROT_STATIC, "192.168.1.0", 24));
+    g_assert(_route_filters_match(f, n, AF_INET6, 200, RTPROT_STATIC, "fd00::", 64));
+    g_assert(_route_filters_match(f, n, AF_INET, 10000, RTPROT_STATIC, NULL, 0));
+    g_assert(!_route_filters_match(f, n, AF_INET, 201, RTPROT_STATIC, NULL, 0));
+    g_assert(!_route_filters_match(f, n, AF_INET, 10001, RTPROT_STATIC, NULL, 0));
+    g_assert(!_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, "192.168.1.0", 24));
+
+    /* by protocol. */
+    g_assert(_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, 186, "192.168.1.0", 24));
+    g_assert(_route_filters_match(f, n, AF_INET6, RT_TABLE_MAIN, 186, NULL, 0));
+
+    /* by prefix, for routes of the same address family that lie within. */
+    g_assert(_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, "10.0.0.0", 8));
+    g_assert(_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, "10.5.0.0", 16));
+    g_assert(!_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, "10.0.0.0", 7));
+    g_assert(!_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, "11.0.0.0", 8));
+    g_assert(!_route_filters_match(f, n, AF_INET, RT_TABLE_MAIN, RTPROT_STATIC, NULL, 0));
+    g_assert(
+        _route_filters_match(f, n, AF_INET6, RT_TABLE_MAIN, RTPROT_STATIC, "2001:db8:1::", 48));
+    g_assert(!_route_filters_match(f, n, AF_INET6, RT_TABLE_MAIN, RTPROT_STATIC, "2001:db9::", 32));
+    g_assert(!_route_filters_match(f, n, AF_INET6, RT_TABLE_MAIN, RTPROT_STATIC, "::", 0));
+
+    /* only the first @n_filters are used. */
+    g_assert(!_route_filters_match(f, 1, AF_INET, 10000, 186, "10.0.0.0", 8));
+    g_assert(!_route_filters_match(f, 0, AF_INET, 200, 186, "10.0.0.0", 8));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -111,6 +266,8 @@ main(int argc, char **argv)
     nmtst_init(&argc, &argv, TRUE);
 
     g_test_add_func("/nm-platform/test_use_symbols", test_use_symbols);
+    g_test_add_func("/nm-platform/route-filter-parse", test_route_filter_parse);
+    g_test_add_func("/nm-platform/route-filters-match", test_route_filters_match);
 
     return g_test_run();
 }
@@ -487,7 +487,11 @@ struct NDhcp4ServerLease {
         CList server_link;
 
         NDhcp4Incoming *request;
-        NDhcp4Incoming *reply;
+        struct in_addr yiaddr;
+        uint32_t lifetime;
+
+        uint8_t *options;               /* extra reply options, as TLV stream */
+        size_t n_options;
 };
 
 #define N_DHCP4_SERVER_LEASE_NULL(_x) {                                         \
@@ -673,6 +677,19 @@ int n_dhcp4_client_lease_new(NDhcp4ClientLease **leasep, NDhcp4Incoming *message
 void n_dhcp4_client_lease_link(NDhcp4ClientLease *lease, NDhcp4ClientProbe *probe);
 void n_dhcp4_client_lease_unlink(NDhcp4ClientLease *lease);
 
+/* servers */
+
+int n_dhcp4_s_event_node_new(NDhcp4SEventNode **nodep);
+NDhcp4SEventNode *n_dhcp4_s_event_node_free(NDhcp4SEventNode *node);
+
+int n_dhcp4_server_raise(NDhcp4Server *server, NDhcp4SEventNode **nodep, unsigned int event);
+
+/* server leases */
+
+int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep, NDhcp4Incoming *message);
+void n_dhcp4_server_lease_link(NDhcp4ServerLease *lease, NDhcp4Server *server);
+void n_dhcp4_server_lease_unlink(NDhcp4ServerLease *lease);
+
 /* server connections */
 
 int n_dhcp4_s_connection_init(NDhcp4SConnection *connection, int ifindex);
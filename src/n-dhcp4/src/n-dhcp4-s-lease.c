@@ -33,11 +33,10 @@ int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep, NDhcp4Incoming *message
 }
 
 static void n_dhcp4_server_lease_free(NDhcp4ServerLease *lease) {
-        c_assert(!lease->server);
-
-        c_list_unlink(&lease->server_link);
+        n_dhcp4_server_lease_unlink(lease);
 
         n_dhcp4_incoming_free(lease->request);
+        free(lease->options);
         free(lease);
 }
 
@@ -59,6 +58,102 @@ _c_public_ NDhcp4ServerLease *n_dhcp4_server_lease_unref(NDhcp4ServerLease *leas
         return NULL;
 }
 
+/**
+ * n_dhcp4_server_lease_link() - link lease into server
+ * @lease:                      the lease to operate on
+ * @server:                     the server to link the lease into
+ *
+ * Associate a lease with a server. The lease may not already be linked. The
+ * server does not own the lease, it merely tracks it so it can be detached
+ * when the server goes away.
+ */
+void n_dhcp4_server_lease_link(NDhcp4ServerLease *lease, NDhcp4Server *server) {
+        c_assert(!lease->server);
+        c_assert(!c_list_is_linked(&lease->server_link));
+
+        lease->server = server;
+        c_list_link_tail(&server->lease_list, &lease->server_link);
+}
+
+/**
+ * n_dhcp4_server_lease_unlink() - unlink lease from its server
+ * @lease:                      the lease to operate on
+ *
+ * Dissassociate a lease from a server if it is associated with one. Otherwise,
+ * this is a noop. An unlinked lease can no longer be replied to.
+ */
+void n_dhcp4_server_lease_unlink(NDhcp4ServerLease *lease) {
+        lease->server = NULL;
+        c_list_unlink(&lease->server_link);
+}
+
+/**
+ * n_dhcp4_server_lease_get_chaddr() - get the client hardware address
+ * @lease:                      the lease to operate on
+ * @chaddrp:                    return argument for the hardware address
+ * @n_chaddrp:                  return argument for the address length
+ *
+ * Get the hardware address the client sent the request from. The returned
+ * memory is owned by @lease and valid for as long as the lease is.
+ */
+_c_public_ void n_dhcp4_server_lease_get_chaddr(NDhcp4ServerLease *lease, const uint8_t **chaddrp, size_t *n_chaddrp) {
+        NDhcp4Header *header = n_dhcp4_incoming_get_header(lease->request);
+
+        *chaddrp = header->chaddr;
+        *n_chaddrp = c_min((size_t)header->hlen, sizeof(header->chaddr));
+}
+
+/**
+ * n_dhcp4_server_lease_get_requested_ip() - get the address the client asks for
+ * @lease:                      the lease to operate on
+ * @addrp:                      return argument for the address
+ *
+ * Get the address the client refers to in its request. This is taken from the
+ * requested-ip option if present (DISCOVER, SELECTING, INIT-REBOOT, DECLINE),
+ * or from the 'ciaddr' field otherwise (RENEWING, REBINDING, RELEASE).
+ *
+ * Return: 0 on success, N_DHCP4_E_UNSET if the client did not refer to an
+ *         address, or a negative error code on failure.
+ */
+_c_public_ int n_dhcp4_server_lease_get_requested_ip(NDhcp4ServerLease *lease, struct in_addr *addrp) {
+        NDhcp4Header *header;
+        int r;
+
+        r = n_dhcp4_incoming_query_requested_ip(lease->request, addrp);
+        if (r != N_DHCP4_E_UNSET)
+                return r;
+
+        header = n_dhcp4_incoming_get_header(lease->request);
+        if (!header->ciaddr)
+                return N_DHCP4_E_UNSET;
+
+        addrp->s_addr = header->ciaddr;
+        return 0;
+}
+
+/**
+ * n_dhcp4_server_lease_set_yiaddr() - set the address to hand out
+ * @lease:                      the lease to operate on
+ * @yiaddr:                     the client address
+ *
+ * Set the address to offer or acknowledge to the client. This must be set
+ * before calling n_dhcp4_server_lease_offer() or n_dhcp4_server_lease_ack().
+ */
+_c_public_ void n_dhcp4_server_lease_set_yiaddr(NDhcp4ServerLease *lease, struct in_addr yiaddr) {
+        lease->yiaddr = yiaddr;
+}
+
+/**
+ * n_dhcp4_server_lease_set_lifetime() - set the lease lifetime
+ * @lease:                      the lease to operate on
+ * @lifetime:                   the lifetime in seconds
+ *
+ * Set the lifetime to announce to the client. T1 and T2 are derived from it.
+ */
+_c_public_ void n_dhcp4_server_lease_set_lifetime(NDhcp4ServerLease *lease, uint32_t lifetime) {
+        lease->lifetime = lifetime;
+}
+
 /**
  * n_dhcp4_server_lease_query() - XXX
  */
@@ -82,22 +177,203 @@ _c_public_ int n_dhcp4_server_lease_query(NDhcp4ServerLease *lease, uint8_t opti
         return n_dhcp4_incoming_query(lease->request, option, datap, n_datap);
 }
 
+static bool n_dhcp4_server_lease_option_is_internal(uint8_t option) {
+        switch (option) {
+        case N_DHCP4_OPTION_PAD:
+        case N_DHCP4_OPTION_REQUESTED_IP_ADDRESS:
+        case N_DHCP4_OPTION_IP_ADDRESS_LEASE_TIME:
+        case N_DHCP4_OPTION_OVERLOAD:
+        case N_DHCP4_OPTION_MESSAGE_TYPE:
+        case N_DHCP4_OPTION_SERVER_IDENTIFIER:
+        case N_DHCP4_OPTION_PARAMETER_REQUEST_LIST:
+        case N_DHCP4_OPTION_ERROR_MESSAGE:
+        case N_DHCP4_OPTION_MAXIMUM_MESSAGE_SIZE:
+        case N_DHCP4_OPTION_RENEWAL_T1_TIME:
+        case N_DHCP4_OPTION_REBINDING_T2_TIME:
+        case N_DHCP4_OPTION_CLIENT_IDENTIFIER:
+        case N_DHCP4_OPTION_END:
+                return true;
+        }
+
+        return false;
+}
+
+/**
+ * n_dhcp4_server_lease_append() - append option to the reply
+ * @lease:                      the lease to operate on
+ * @option:                     DHCP option number
+ * @data:                       payload
+ * @n_data:                     number of bytes in payload
+ *
+ * Append an option to the reply sent for this lease. The options are
+ * remembered on the lease and only serialized when the reply is built, so
+ * this must be called before n_dhcp4_server_lease_offer() or
+ * n_dhcp4_server_lease_ack().
+ *
+ * Return: 0 on success, N_DHCP4_E_DUPLICATE_OPTION if the option has already
+ *         been appended, N_DHCP4_E_INTERNAL if the option is not configurable,
+ *         or a negative error code on failure.
+ */
 _c_public_ int n_dhcp4_server_lease_append(NDhcp4ServerLease *lease, uint8_t option, uint8_t *data, size_t n_data) {
-        /* XXX */
-        return -ENOTRECOVERABLE;
+        uint8_t *options;
+        size_t i;
+
+        if (n_dhcp4_server_lease_option_is_internal(option))
+                return N_DHCP4_E_INTERNAL;
+        if (n_data > UINT8_MAX)
+                return -EMSGSIZE;
+
+        for (i = 0; i < lease->n_options; i += 2 + lease->options[i + 1]) {
+                if (lease->options[i] == option)
+                        return N_DHCP4_E_DUPLICATE_OPTION;
+        }
+
+        options = realloc(lease->options, lease->n_options + 2 + n_data);
+        if (!options)
+                return -ENOMEM;
+
+        options[lease->n_options] = option;
+        options[lease->n_options + 1] = n_data;
+        if (n_data)
+                memcpy(options + lease->n_options + 2, data, n_data);
+
+        lease->options = options;
+        lease->n_options += 2 + n_data;
+        return 0;
+}
+
+static int n_dhcp4_server_lease_append_options(NDhcp4ServerLease *lease, NDhcp4Outgoing *reply) {
+        size_t i;
+        int r;
+
+        for (i = 0; i < lease->n_options; i += 2 + lease->options[i + 1]) {
+                r = n_dhcp4_outgoing_append(reply,
+                                            lease->options[i],
+                                            lease->options + i + 2,
+                                            lease->options[i + 1]);
+                if (r)
+                        return r;
+        }
+
+        return 0;
 }
 
+static int n_dhcp4_server_lease_get_connection(NDhcp4ServerLease *lease,
+                                               NDhcp4SConnection **connectionp,
+                                               const struct in_addr **server_addressp) {
+        if (!lease->server)
+                return -ENOTCONN;
+        if (!lease->server->connection.ip)
+                return -EADDRNOTAVAIL;
+
+        *connectionp = &lease->server->connection;
+        *server_addressp = &lease->server->connection.ip->ip;
+        return 0;
+}
+
+/**
+ * n_dhcp4_server_lease_offer() - offer the lease to the client
+ * @lease:                      the lease to operate on
+ *
+ * Send a DHCPOFFER for the address set with n_dhcp4_server_lease_set_yiaddr(),
+ * including all options appended to the lease.
+ *
+ * Return: 0 on success, or a negative error code on failure.
+ */
 _c_public_ int n_dhcp4_server_lease_offer(NDhcp4ServerLease *lease) {
-        /* XXX */
-        return -ENOTRECOVERABLE;
+        _c_cleanup_(n_dhcp4_outgoing_freep) NDhcp4Outgoing *reply = NULL;
+        NDhcp4SConnection *connection;
+        const struct in_addr *server_address;
+        int r;
+
+        r = n_dhcp4_server_lease_get_connection(lease, &connection, &server_address);
+        if (r)
+                return r;
+
+        r = n_dhcp4_s_connection_offer_new(connection,
+                                           &reply,
+                                           lease->request,
+                                           server_address,
+                                           &lease->yiaddr,
+                                           lease->lifetime);
+        if (r)
+                return r;
+
+        r = n_dhcp4_server_lease_append_options(lease, reply);
+        if (r)
+                return r;
+
+        return n_dhcp4_s_connection_send_reply(connection, server_address, reply);
 }
 
+/**
+ * n_dhcp4_server_lease_ack() - acknowledge the lease to the client
+ * @lease:                      the lease to operate on
+ *
+ * Send a DHCPACK for the address set with n_dhcp4_server_lease_set_yiaddr(),
+ * including all options appended to the lease. Once this is sent, the lease is
+ * committed and the reply cannot be sent again.
+ *
+ * Return: 0 on success, or a negative error code on failure.
+ */
 _c_public_ int n_dhcp4_server_lease_ack(NDhcp4ServerLease *lease) {
-        /* XXX */
-        return -ENOTRECOVERABLE;
+        _c_cleanup_(n_dhcp4_outgoing_freep) NDhcp4Outgoing *reply = NULL;
+        NDhcp4SConnection *connection;
+        const struct in_addr *server_address;
+        int r;
+
+        r = n_dhcp4_server_lease_get_connection(lease, &connection, &server_address);
+        if (r)
+                return r;
+
+        r = n_dhcp4_s_connection_ack_new(connection,
+                                         &reply,
+                                         lease->request,
+                                         server_address,
+                                         &lease->yiaddr,
+                                         lease->lifetime);
+        if (r)
+                return r;
+
+        r = n_dhcp4_server_lease_append_options(lease, reply);
+        if (r)
+                return r;
+
+        r = n_dhcp4_s_connection_send_reply(connection, server_address, reply);
+        if (r)
+                return r;
+
+        n_dhcp4_server_lease_unlink(lease);
+        return 0;
 }
 
+/**
+ * n_dhcp4_server_lease_nack() - reject the request of the client
+ * @lease:                      the lease to operate on
+ *
+ * Send a DHCPNAK, telling the client that the address it asked for is not
+ * valid on this link. Appended options are not included.
+ *
+ * Return: 0 on success, or a negative error code on failure.
+ */
 _c_public_ int n_dhcp4_server_lease_nack(NDhcp4ServerLease *lease) {
-        /* XXX */
-        return -ENOTRECOVERABLE;
+        _c_cleanup_(n_dhcp4_outgoing_freep) NDhcp4Outgoing *reply = NULL;
+        NDhcp4SConnection *connection;
+        const struct in_addr *server_address;
+        int r;
+
+        r = n_dhcp4_server_lease_get_connection(lease, &connection, &server_address);
+        if (r)
+                return r;
+
+        r = n_dhcp4_s_connection_nak_new(connection, &reply, lease->request, server_address);
+        if (r)
+                return r;
+
+        r = n_dhcp4_s_connection_send_reply(connection, server_address, reply);
+        if (r)
+                return r;
+
+        n_dhcp4_server_lease_unlink(lease);
+        return 0;
 }
@@ -78,6 +78,26 @@ NDhcp4SEventNode *n_dhcp4_s_event_node_free(NDhcp4SEventNode *node) {
         if (!node)
                 return NULL;
 
+        switch (node->event.event) {
+        case N_DHCP4_SERVER_EVENT_DISCOVER:
+                node->event.discover.lease = n_dhcp4_server_lease_unref(node->event.discover.lease);
+                break;
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+                node->event.request.lease = n_dhcp4_server_lease_unref(node->event.request.lease);
+                break;
+        case N_DHCP4_SERVER_EVENT_RENEW:
+                node->event.renew.lease = n_dhcp4_server_lease_unref(node->event.renew.lease);
+                break;
+        case N_DHCP4_SERVER_EVENT_DECLINE:
+                node->event.decline.lease = n_dhcp4_server_lease_unref(node->event.decline.lease);
+                break;
+        case N_DHCP4_SERVER_EVENT_RELEASE:
+                node->event.release.lease = n_dhcp4_server_lease_unref(node->event.release.lease);
+                break;
+        default:
+                break;
+        }
+
         c_list_unlink(&node->server_link);
         free(node);
 
@@ -110,10 +130,16 @@ _c_public_ int n_dhcp4_server_new(NDhcp4Server **serverp, NDhcp4ServerConfig *co
 
 static void n_dhcp4_server_free(NDhcp4Server *server) {
         NDhcp4SEventNode *node, *t_node;
+        NDhcp4ServerLease *lease, *t_lease;
 
         c_list_for_each_entry_safe(node, t_node, &server->event_list, server_link)
                 n_dhcp4_s_event_node_free(node);
 
+        c_list_for_each_entry_safe(lease, t_lease, &server->lease_list, server_link)
+                n_dhcp4_server_lease_unlink(lease);
+
+        n_dhcp4_s_connection_deinit(&server->connection);
+
         free(server);
 }
 
@@ -161,14 +187,92 @@ _c_public_ void n_dhcp4_server_get_fd(NDhcp4Server *server, int *fdp) {
         n_dhcp4_s_connection_get_fd(&server->connection, fdp);
 }
 
+static int n_dhcp4_server_dispatch_message(NDhcp4Server *server, NDhcp4Incoming *message) {
+        _c_cleanup_(n_dhcp4_server_lease_unrefp) NDhcp4ServerLease *lease = NULL;
+        NDhcp4SEventNode *node;
+        unsigned int event;
+        int r;
+
+        switch (message->userdata.type) {
+        case N_DHCP4_C_MESSAGE_DISCOVER:
+                event = N_DHCP4_SERVER_EVENT_DISCOVER;
+                break;
+        case N_DHCP4_C_MESSAGE_SELECT:
+        case N_DHCP4_C_MESSAGE_REBOOT:
+                event = N_DHCP4_SERVER_EVENT_REQUEST;
+                break;
+        case N_DHCP4_C_MESSAGE_RENEW:
+        case N_DHCP4_C_MESSAGE_REBIND:
+                event = N_DHCP4_SERVER_EVENT_RENEW;
+                break;
+        case N_DHCP4_C_MESSAGE_DECLINE:
+                event = N_DHCP4_SERVER_EVENT_DECLINE;
+                break;
+        case N_DHCP4_C_MESSAGE_RELEASE:
+                event = N_DHCP4_SERVER_EVENT_RELEASE;
+                break;
+        default:
+                /* requests directed at other servers */
+                n_dhcp4_incoming_free(message);
+                return 0;
+        }
+
+        r = n_dhcp4_server_lease_new(&lease, message);
+        if (r) {
+                n_dhcp4_incoming_free(message);
+                return r;
+        }
+
+        r = n_dhcp4_server_raise(server, &node, event);
+        if (r)
+                return r;
+
+        /*
+         * The event owns the lease. The server only tracks it, so the lease
+         * can be detached should the server go away before it is answered.
+         */
+        n_dhcp4_server_lease_link(lease, server);
+
+        switch (event) {
+        case N_DHCP4_SERVER_EVENT_DISCOVER:
+                node->event.discover.lease = lease;
+                break;
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+                node->event.request.lease = lease;
+                break;
+        case N_DHCP4_SERVER_EVENT_RENEW:
+                node->event.renew.lease = lease;
+                break;
+        case N_DHCP4_SERVER_EVENT_DECLINE:
+                node->event.decline.lease = lease;
+                break;
+        case N_DHCP4_SERVER_EVENT_RELEASE:
+                node->event.release.lease = lease;
+                break;
+        }
+
+        lease = NULL;
+        return 0;
+}
+
 /**
- * n_dhcp4_server_dispatch() - XXX
+ * n_dhcp4_server_dispatch() - dispatch server context
+ * @server:                     server to operate on
+ *
+ * Read pending requests from the server socket and queue an event for each of
+ * them. Use n_dhcp4_server_pop_event() to retrieve them. At most a bounded
+ * number of messages is handled per call, so a busy link cannot starve the
+ * caller's event loop; N_DHCP4_E_PREEMPTED is returned in that case and the
+ * caller should dispatch again.
+ *
+ * Return: 0 on success, N_DHCP4_E_PREEMPTED if more messages are pending, or
+ *         a negative error code on failure.
  */
 _c_public_ int n_dhcp4_server_dispatch(NDhcp4Server *server) {
         int r;
 
         for (unsigned int i = 0; i < 128; ++i) {
-                _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
+                NDhcp4Incoming *message = NULL;
 
                 r = n_dhcp4_s_connection_dispatch_io(&server->connection, &message);
                 if (r) {
@@ -176,6 +280,13 @@ _c_public_ int n_dhcp4_server_dispatch(NDhcp4Server *server) {
                                 return 0;
                         return r;
                 }
+
+                if (!message)
+                        continue;
+
+                r = n_dhcp4_server_dispatch_message(server, message);
+                if (r)
+                        return r;
         }
 
         return N_DHCP4_E_PREEMPTED;
@@ -0,0 +1,298 @@
+/*
+ * Tests for DHCP4 Server
+ *
+ * This runs a server and a sequence of clients on the two ends of a veth
+ * pair, each in its own network namespace. Every client runs through
+ * DISCOVER/OFFER/REQUEST/ACK with a distinct client identifier, so each
+ * round-trip allocates a new lease. The achieved rate is printed at the
+ * end.
+ */
+
+#undef NDEBUG
+#include <assert.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <poll.h>
+#include <net/if_arp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+#include "test.h"
+#include "util/link.h"
+#include "util/netns.h"
+
+#define TEST_N_LEASES (200U)
+
+static uint64_t test_now_nsec(void) {
+        struct timespec ts;
+        int r;
+
+        r = clock_gettime(CLOCK_MONOTONIC, &ts);
+        c_assert(r >= 0);
+
+        return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+static void test_server_new(int netns, NDhcp4Server **serverp, int ifindex) {
+        _c_cleanup_(n_dhcp4_server_config_freep) NDhcp4ServerConfig *config = NULL;
+        int r, oldns;
+
+        r = n_dhcp4_server_config_new(&config);
+        c_assert(!r);
+
+        n_dhcp4_server_config_set_ifindex(config, ifindex);
+
+        netns_get(&oldns);
+        netns_set(netns);
+
+        r = n_dhcp4_server_new(serverp, config);
+        c_assert(!r);
+
+        netns_set(oldns);
+}
+
+static void test_c_connection_listen(int netns, NDhcp4CConnection *connection) {
+        int r, oldns;
+
+        netns_get(&oldns);
+        netns_set(netns);
+
+        r = n_dhcp4_c_connection_listen(connection);
+        c_assert(!r);
+
+        netns_set(oldns);
+}
+
+static void test_server_handle(NDhcp4Server *server,
+                               unsigned int expected_event,
+                               const struct in_addr *addr_client,
+                               uint64_t *busy_nsecp) {
+        NDhcp4ServerEvent *event;
+        NDhcp4ServerLease *lease;
+        struct in_addr requested;
+        struct pollfd pfd = { .events = POLLIN };
+        uint8_t *client_id;
+        size_t n_client_id;
+        uint64_t start;
+        int r;
+
+        n_dhcp4_server_get_fd(server, &pfd.fd);
+        r = poll(&pfd, 1, -1);
+        c_assert(r == 1);
+
+        start = test_now_nsec();
+
+        r = n_dhcp4_server_dispatch(server);
+        c_assert(!r);
+
+        r = n_dhcp4_server_pop_event(server, &event);
+        c_assert(!r);
+        c_assert(event);
+        c_assert(event->event == expected_event);
+
+        switch (event->event) {
+        case N_DHCP4_SERVER_EVENT_DISCOVER:
+                lease = event->discover.lease;
+                break;
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+                lease = event->request.lease;
+                r = n_dhcp4_server_lease_get_requested_ip(lease, &requested);
+                c_assert(!r);
+                c_assert(requested.s_addr == addr_client->s_addr);
+                break;
+        default:
+                c_assert(0);
+                return;
+        }
+
+        r = n_dhcp4_server_lease_query(lease, N_DHCP4_OPTION_CLIENT_IDENTIFIER, &client_id, &n_client_id);
+        c_assert(!r);
+        c_assert(n_client_id > 0);
+
+        n_dhcp4_server_lease_set_yiaddr(lease, *addr_client);
+        n_dhcp4_server_lease_set_lifetime(lease, 3600);
+
+        r = n_dhcp4_server_lease_append(lease,
+                                        N_DHCP4_OPTION_SUBNET_MASK,
+                                        (uint8_t[]){ 255, 0, 0, 0 },
+                                        4);
+        c_assert(!r);
+        r = n_dhcp4_server_lease_append(lease,
+                                        N_DHCP4_OPTION_SUBNET_MASK,
+                                        (uint8_t[]){ 255, 0, 0, 0 },
+                                        4);
+        c_assert(r == N_DHCP4_E_DUPLICATE_OPTION);
+
+        if (expected_event == N_DHCP4_SERVER_EVENT_DISCOVER)
+                r = n_dhcp4_server_lease_offer(lease);
+        else
+                r = n_dhcp4_server_lease_ack(lease);
+        c_assert(!r);
+
+        r = n_dhcp4_server_pop_event(server, &event);
+        c_assert(!r);
+        c_assert(!event);
+
+        *busy_nsecp += test_now_nsec() - start;
+}
+
+static void test_client_receive(NDhcp4CConnection *connection, uint8_t expected_type, NDhcp4Incoming **messagep) {
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
+        struct epoll_event event = {};
+        uint8_t received_type;
+        int r;
+
+        r = epoll_wait(connection->fd_epoll, &event, 1, -1);
+        c_assert(r == 1);
+        c_assert(event.data.u32 == N_DHCP4_CLIENT_EPOLL_IO);
+
+        r = n_dhcp4_c_connection_dispatch_io(connection, &message);
+        c_assert(!r);
+        c_assert(message);
+
+        r = n_dhcp4_incoming_query_message_type(message, &received_type);
+        c_assert(!r);
+        c_assert(received_type == expected_type);
+
+        if (messagep) {
+                *messagep = message;
+                message = NULL;
+        }
+}
+
+static void test_lease(NDhcp4Server *server,
+                       int ns_client,
+                       Link *link_client,
+                       int efd_client,
+                       unsigned int idx,
+                       uint64_t *busy_nsecp) {
+        _c_cleanup_(n_dhcp4_client_config_freep) NDhcp4ClientConfig *client_config = NULL;
+        _c_cleanup_(n_dhcp4_client_probe_config_freep) NDhcp4ClientProbeConfig *probe_config = NULL;
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *offer = NULL;
+        _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *ack = NULL;
+        NDhcp4CConnection connection = N_DHCP4_C_CONNECTION_NULL(connection);
+        NDhcp4LogQueue log_queue = N_DHCP4_LOG_QUEUE_NULL_DEFUNCT();
+        const struct in_addr addr_client = { htonl(10 << 24 | (idx + 2)) };
+        NDhcp4Outgoing *request;
+        struct in_addr yiaddr;
+        char client_id[32];
+        int r;
+
+        r = n_dhcp4_client_config_new(&client_config);
+        c_assert(!r);
+
+        n_dhcp4_client_config_set_ifindex(client_config, link_client->ifindex);
+        n_dhcp4_client_config_set_transport(client_config, N_DHCP4_TRANSPORT_ETHERNET);
+        n_dhcp4_client_config_set_request_broadcast(client_config, false);
+        n_dhcp4_client_config_set_mac(client_config, link_client->mac.ether_addr_octet, ETH_ALEN);
+        n_dhcp4_client_config_set_broadcast_mac(client_config,
+                                                (const uint8_t[]){
+                                                        0xff, 0xff, 0xff,
+                                                        0xff, 0xff, 0xff,
+                                                },
+                                                ETH_ALEN);
+        snprintf(client_id, sizeof(client_id), "client-%u", idx);
+        r = n_dhcp4_client_config_set_client_id(client_config, (void *)client_id, strlen(client_id));
+        c_assert(!r);
+
+        r = n_dhcp4_client_probe_config_new(&probe_config);
+        c_assert(!r);
+
+        r = n_dhcp4_c_connection_init(&connection, client_config, probe_config, &log_queue, efd_client);
+        c_assert(!r);
+        test_c_connection_listen(ns_client, &connection);
+
+        r = n_dhcp4_c_connection_discover_new(&connection, &request);
+        c_assert(!r);
+        r = n_dhcp4_c_connection_start_request(&connection, request, 0);
+        c_assert(!r);
+
+        test_server_handle(server, N_DHCP4_SERVER_EVENT_DISCOVER, &addr_client, busy_nsecp);
+        test_client_receive(&connection, N_DHCP4_MESSAGE_OFFER, &offer);
+
+        n_dhcp4_incoming_get_yiaddr(offer, &yiaddr);
+        c_assert(yiaddr.s_addr == addr_client.s_addr);
+
+        r = n_dhcp4_c_connection_select_new(&connection, &request, offer);
+        c_assert(!r);
+        r = n_dhcp4_c_connection_start_request(&connection, request, 0);
+        c_assert(!r);
+
+        test_server_handle(server, N_DHCP4_SERVER_EVENT_REQUEST, &addr_client, busy_nsecp);
+        test_client_receive(&connection, N_DHCP4_MESSAGE_ACK, &ack);
+
+        n_dhcp4_incoming_get_yiaddr(ack, &yiaddr);
+        c_assert(yiaddr.s_addr == addr_client.s_addr);
+
+        n_dhcp4_c_connection_deinit(&connection);
+}
+
+static void test_server(void) {
+        const struct in_addr addr_server = (struct in_addr){ htonl(10 << 24 | 1) };
+        _c_cleanup_(netns_closep) int ns_server = -1, ns_client = -1;
+        _c_cleanup_(link_deinit) Link link_server = LINK_NULL(link_server);
+        _c_cleanup_(link_deinit) Link link_client = LINK_NULL(link_client);
+        _c_cleanup_(c_closep) int efd_client = -1;
+        uint64_t start, duration, busy = 0;
+        int r;
+
+        /* setup */
+
+        netns_new(&ns_server);
+        netns_new(&ns_client);
+
+        link_new_veth(&link_server, &link_client, ns_server, ns_client);
+        link_add_ip4(&link_server, &addr_server, 8);
+
+        efd_client = epoll_create1(EPOLL_CLOEXEC);
+        c_assert(efd_client >= 0);
+
+        /* run leases */
+        {
+                _c_cleanup_(n_dhcp4_server_unrefp) NDhcp4Server *server = NULL;
+                NDhcp4ServerIp *ip;
+
+                test_server_new(ns_server, &server, link_server.ifindex);
+
+                r = n_dhcp4_server_add_ip(server, &ip, addr_server);
+                c_assert(!r);
+
+                start = test_now_nsec();
+                for (unsigned int i = 0; i < TEST_N_LEASES; ++i)
+                        test_lease(server, ns_client, &link_client, efd_client, i, &busy);
+                duration = test_now_nsec() - start;
+
+                n_dhcp4_server_ip_free(ip);
+        }
+
+        /*
+         * The wall-clock time is dominated by setting up a fresh client
+         * connection for every lease. The server-side busy time only covers
+         * dispatching the request and sending the reply, which is what a
+         * server on a busy link is limited by.
+         */
+        fprintf(stderr,
+                "%u leases in %llu.%03llu ms, server busy %llu.%03llu ms (%llu leases/s)\n",
+                TEST_N_LEASES,
+                (unsigned long long)(duration / 1000000),
+                (unsigned long long)(duration / 1000 % 1000),
+                (unsigned long long)(busy / 1000000),
+                (unsigned long long)(busy / 1000 % 1000),
+                (unsigned long long)(TEST_N_LEASES * UINT64_C(1000000000) / c_max(busy, (uint64_t)1)));
+
+        /* teardown */
+
+        link_del_ip4(&link_server, &addr_server, 8);
+}
+
+int main(int argc, char **argv) {
+        test_setup();
+
+        test_server();
+
+        return 0;
+}
@@ -23,21 +23,63 @@
 
 /*****************************************************************************/
 
+#define MAX_PARALLEL_DEFAULT 8
+
 typedef struct Request Request;
 
+/* Requests with "wait" scripts are processed strictly in order per
+ * interface. Requests for different interfaces run in parallel, but at most
+ * @max_parallel of them at the same time. */
+typedef struct {
+    char *   key; /* the interface name, or "" for requests without interface */
+    Request *current_request;
+    GQueue   requests_waiting;
+    bool     is_ready : 1; /* enqueued in gl.queues_ready */
+} RequestQueue;
+
+typedef struct {
+    guint  n_runs;
+    gint64 total_usec;
+    gint64 max_usec;
+} ScriptStats;
+
+typedef enum {
+    SCRIPT_DIR_DEFAULT,
+    SCRIPT_DIR_PRE_UP,
+    SCRIPT_DIR_PRE_DOWN,
+    _SCRIPT_DIR_NUM,
+} ScriptDir;
+
+typedef struct {
+    char *path;
+    bool  wait : 1;
+} ScriptIndexEntry;
+
 static struct {
     GDBusConnection *dbus_connection;
     GMainLoop *      loop;
     gboolean         debug;
     gboolean         persist;
+    int              max_parallel;
     guint            quit_id;
     guint            request_id_counter;
     gboolean         ever_acquired_name;
     bool             exit_with_failure;
 
-    Request *current_request;
-    GQueue * requests_waiting;
-    int      num_requests_pending;
+    GHashTable *request_queues; /* interface name -> RequestQueue */
+    GQueue *    queues_ready;   /* RequestQueues waiting for a free slot */
+    int         num_queues_running;
+    int         num_requests_pending;
+
+    GHashTable *script_stats; /* script path -> ScriptStats */
+
+    struct {
+        /* The eligible scripts for each ScriptDir, sorted by basename. %NULL
+         * if not yet scanned, or if the directories changed since. */
+        GPtrArray *scripts[_SCRIPT_DIR_NUM];
+        GPtrArray *monitors;
+        bool       monitors_failed : 1;
+    } script_index;
 } gl;
 
 typedef struct {
@@ -51,6 +93,7 @@ typedef struct {
     gboolean       dispatched;
     guint          watch_id;
     guint          timeout_id;
+    gint64         start_usec;
 } ScriptInfo;
 
 struct Request {
@@ -62,6 +105,9 @@ struct Request {
     char **                envp;
     gboolean               debug;
 
+    RequestQueue *queue;
+    gint64        enqueued_usec;
+
     GPtrArray *scripts; /* list of ScriptInfo */
     guint      idx;
     int        num_scripts_done;
@@ -173,6 +219,12 @@ script_info_free(gpointer ptr)
     g_slice_free(ScriptInfo, info);
 }
 
+static void
+script_stats_free(gpointer ptr)
+{
+    nm_g_slice_free((ScriptStats *) ptr);
+}
+
 static void
 request_free(Request *request)
 {
@@ -204,44 +256,63 @@ quit_timeout_reschedule(void)
     }
 }
 
+/*****************************************************************************/
+
+static RequestQueue *
+request_queue_get(const char *key)
+{
+    RequestQueue *queue;
+
+    queue = g_hash_table_lookup(gl.request_queues, key);
+    if (!queue) {
+        queue  = g_slice_new(RequestQueue);
+        *queue = (RequestQueue){
+            .key              = g_strdup(key),
+            .requests_waiting = G_QUEUE_INIT,
+        };
+        g_hash_table_insert(gl.request_queues, queue->key, queue);
+    }
+    return queue;
+}
+
+static void
+request_queue_mark_ready(RequestQueue *queue)
+{
+    nm_assert(!queue->current_request);
+    nm_assert(!g_queue_is_empty(&queue->requests_waiting));
+
+    if (queue->is_ready)
+        return;
+    queue->is_ready = TRUE;
+    g_queue_push_tail(gl.queues_ready, queue);
+}
+
 /**
- * next_request:
- *
- * @request: (allow-none): the request to set as next. If %NULL, dequeue the next
- * waiting request. Otherwise, try to set the given request.
+ * request_queue_release:
+ * @queue: the queue which no longer has a running request.
  *
- * Sets the currently active request (@current_request). The current request
- * is a request that has at least on "wait" script, because requests that only
- * consist of "no-wait" scripts are handled right away and not enqueued to
- * @requests_waiting nor set as @current_request.
- *
- * Returns: %TRUE, if there was currently not request in process and it set
- * a new request as current.
+ * Gives up the slot that @queue held. If there are more requests waiting
+ * in @queue, it gets in line for a slot again. That way a busy interface
+ * cannot starve the others, when the limit of parallel queues is reached.
+ * Otherwise, @queue is destroyed.
  */
-static gboolean
-next_request(Request *request)
+static void
+request_queue_release(RequestQueue *queue)
 {
-    if (request) {
-        if (gl.current_request) {
-            g_queue_push_tail(gl.requests_waiting, request);
-            return FALSE;
-        }
-    } else {
-        /* when calling next_request() without explicit @request, we always
-         * forcefully clear @current_request. That one is certainly
-         * handled already. */
-        gl.current_request = NULL;
-
-        request = g_queue_pop_head(gl.requests_waiting);
-        if (!request)
-            return FALSE;
-    }
+    nm_assert(!queue->current_request);
+    nm_assert(!queue->is_ready);
+    nm_assert(gl.num_queues_running > 0);
 
-    _LOG_R_D(request, "start running ordered scripts...");
+    gl.num_queues_running--;
 
-    gl.current_request = request;
+    if (!g_queue_is_empty(&queue->requests_waiting)) {
+        request_queue_mark_ready(queue);
+        return;
+    }
 
-    return TRUE;
+    g_hash_table_remove(gl.request_queues, queue->key);
+    g_free(queue->key);
+    nm_g_slice_free(queue);
 }
 
 /**
@@ -261,6 +332,7 @@ complete_request(Request *request)
     guint           i;
 
     nm_assert(request);
+    nm_assert(!request->queue || request->queue->current_request != request);
 
     /* Are there still pending scripts? Then do nothing (for now). */
     if (request->num_scripts_done < request->scripts->len)
@@ -282,87 +354,131 @@ complete_request(Request *request)
 
     _LOG_R_T(request, "completed (%u scripts)", request->scripts->len);
 
-    if (gl.current_request == request)
-        gl.current_request = NULL;
-
     request_free(request);
 
     g_assert_cmpuint(gl.num_requests_pending, >, 0);
     if (--gl.num_requests_pending <= 0) {
-        nm_assert(!gl.current_request && !g_queue_peek_head(gl.requests_waiting));
+        nm_assert(g_queue_is_empty(gl.queues_ready));
         quit_timeout_reschedule();
     }
 }
 
+/**
+ * request_queue_start:
+ * @queue: the queue which was just granted a slot.
+ *
+ * Starts the next waiting request of @queue. Requests that don't need
+ * to wait for any script are completed right away and the next one
+ * is started.
+ */
 static void
-complete_script(ScriptInfo *script)
+request_queue_start(RequestQueue *queue)
 {
     Request *request;
-    gboolean wait = script->wait;
 
-    request = script->request;
+    nm_assert(!queue->current_request);
+
+    while ((request = g_queue_pop_head(&queue->requests_waiting))) {
+        _LOG_R_D(request,
+                 "start running ordered scripts (queued for %" G_GINT64_FORMAT " msec)...",
+                 (g_get_monotonic_time() - request->enqueued_usec) / 1000);
 
-    if (wait) {
-        /* for "wait" scripts, try to schedule the next blocking script.
-         * If that is successful, return (as we must wait for its completion). */
+        queue->current_request = request;
         if (dispatch_one_script(request))
             return;
+        queue->current_request = NULL;
+
+        /* Try to complete the request. It will be either completed
+         * now, or when all pending "no-wait" scripts return. */
+        complete_request(request);
     }
 
-    nm_assert(!wait || gl.current_request == request);
+    request_queue_release(queue);
+}
 
-    /* Try to complete the request. @request will be possibly free'd,
-     * making @script and @request a dangling pointer. */
-    complete_request(request);
+/**
+ * schedule_requests:
+ *
+ * Hands out free slots to the queues that have requests waiting, in the
+ * order in which they became ready.
+ */
+static void
+schedule_requests(void)
+{
+    RequestQueue *queue;
 
-    if (!wait) {
-        /* this was a "no-wait" script. We either completed the request,
-         * or there is nothing to do. Especially, there is no need to
-         * queue the next_request() -- because no-wait scripts don't block
-         * requests. However, if this was the last "no-wait" script and
-         * there are "wait" scripts ready to run, launch them.
-         */
-        if (gl.current_request == request && gl.current_request->num_scripts_nowait == 0) {
-            if (dispatch_one_script(gl.current_request))
-                return;
-
-            complete_request(gl.current_request);
-        } else
-            return;
-    } else {
-        /* if the script is a "wait" script, we already tried above to
-         * dispatch the next script. As we didn't do that, it means we
-         * just completed the last script of @request and we can continue
-         * with the next request...
-         *
-         * Also, it cannot be that there is another request currently being
-         * processed because only requests with "wait" scripts can become
-         * @current_request. As there can only be one "wait" script running
-         * at any time, it means complete_request() above completed @request. */
-        nm_assert(!gl.current_request);
+    while (gl.num_queues_running < gl.max_parallel
+           && (queue = g_queue_pop_head(gl.queues_ready))) {
+        queue->is_ready = FALSE;
+        gl.num_queues_running++;
+        request_queue_start(queue);
     }
+}
 
-    while (next_request(NULL)) {
-        request = gl.current_request;
+static void
+complete_script(ScriptInfo *script)
+{
+    Request *     request = script->request;
+    RequestQueue *queue   = request->queue;
+
+    if (!queue || queue->current_request != request) {
+        /* A "no-wait" script of a request that has no "wait" scripts, or
+         * that is still waiting for its turn. Try to complete the request.
+         * @request will be possibly free'd, making @script and @request
+         * a dangling pointer. */
+        nm_assert(!script->wait);
+        complete_request(request);
+        return;
+    }
 
-        if (dispatch_one_script(request))
-            return;
+    /* @request is the running request of @queue. Try to schedule the next
+     * "wait" script. This also does nothing while "no-wait" scripts are
+     * still pending, because "wait" scripts only start after them. */
+    if (dispatch_one_script(request))
+        return;
 
-        /* Try to complete the request. It will be either completed
-         * now, or when all pending "no-wait" scripts return. */
-        complete_request(request);
+    /* All scripts of @request are done. Let the next request run. */
+    queue->current_request = NULL;
+    complete_request(request);
+    request_queue_release(queue);
+    schedule_requests();
+}
+
+static const ScriptStats *
+script_stats_update(ScriptInfo *script, gint64 *out_duration_usec)
+{
+    ScriptStats *stats;
+    gint64       duration_usec;
+
+    duration_usec = g_get_monotonic_time() - script->start_usec;
 
-        /* We can immediately start next_request(), because our current
-         * @request has obviously no more "wait" scripts either.
-         * Repeat... */
+    stats = g_hash_table_lookup(gl.script_stats, script->script);
+    if (!stats) {
+        stats = g_slice_new0(ScriptStats);
+        g_hash_table_insert(gl.script_stats, g_strdup(script->script), stats);
     }
+    stats->n_runs++;
+    stats->total_usec += duration_usec;
+    stats->max_usec = NM_MAX(stats->max_usec, duration_usec);
+
+    *out_duration_usec = duration_usec;
+    return stats;
 }
 
+#define _SCRIPT_TIMING_FMT                                                          \
+    "took %" G_GINT64_FORMAT " msec; %u runs, avg %" G_GINT64_FORMAT " msec, max %" \
+    G_GINT64_FORMAT " msec"
+#define _SCRIPT_TIMING_ARG(duration_usec, stats)                                    \
+    (duration_usec) / 1000, (stats)->n_runs,                                        \
+        (stats)->total_usec / (stats)->n_runs / 1000, (stats)->max_usec / 1000
+
 static void
 script_watch_cb(GPid pid, int status, gpointer user_data)
 {
-    ScriptInfo *script = user_data;
-    guint       err;
+    ScriptInfo *       script = user_data;
+    const ScriptStats *stats;
+    gint64             duration_usec;
+    guint              err;
 
     g_assert(pid == script->pid);
 
@@ -391,11 +507,18 @@ script_watch_cb(GPid pid, int status, gpointer user_data)
         script->error = g_strdup_printf("Script '%s' died from an unknown cause", script->script);
     }
 
+    stats = script_stats_update(script, &duration_usec);
+
     if (script->result == DISPATCH_RESULT_SUCCESS) {
-        _LOG_S_T(script, "complete");
+        _LOG_S_D(script,
+                 "complete (" _SCRIPT_TIMING_FMT ")",
+                 _SCRIPT_TIMING_ARG(duration_usec, stats));
     } else {
         script->result = DISPATCH_RESULT_FAILED;
-        _LOG_S_W(script, "complete: failed with %s", script->error);
+        _LOG_S_W(script,
+                 "complete: failed with %s (" _SCRIPT_TIMING_FMT ")",
+                 script->error,
+                 _SCRIPT_TIMING_ARG(duration_usec, stats));
     }
 
     g_spawn_close_pid(script->pid);
@@ -406,7 +529,9 @@ script_watch_cb(GPid pid, int status, gpointer user_data)
 static gboolean
 script_timeout_cb(gpointer user_data)
 {
-    ScriptInfo *script = user_data;
+    ScriptInfo *       script = user_data;
+    const ScriptStats *stats;
+    gint64             duration_usec;
 
     script->timeout_id = 0;
     nm_clear_g_source(&script->watch_id);
@@ -414,7 +539,11 @@ script_timeout_cb(gpointer user_data)
     if (!script->wait)
         script->request->num_scripts_nowait--;
 
-    _LOG_S_W(script, "complete: timeout (kill script)");
+    stats = script_stats_update(script, &duration_usec);
+
+    _LOG_S_W(script,
+             "complete: timeout (kill script) (" _SCRIPT_TIMING_FMT ")",
+             _SCRIPT_TIMING_ARG(duration_usec, stats));
 
     kill(script->pid, SIGKILL);
 again:
@@ -527,6 +656,7 @@ script_dispatch(ScriptInfo *script)
         return FALSE;
     }
 
+    script->start_usec = g_get_monotonic_time();
     script->watch_id   = g_child_watch_add(script->pid, (GChildWatchFunc) script_watch_cb, script);
     script->timeout_id = g_timeout_add_seconds(SCRIPT_TIMEOUT, script_timeout_cb, script);
     if (!script->wait)
@@ -568,8 +698,37 @@ _compare_basenames(gconstpointer a, gconstpointer b)
     return 0;
 }
 
+static gboolean
+script_must_wait(const char *path)
+{
+    gs_free char *link = NULL;
+
+    link = g_file_read_link(path, NULL);
+    if (link) {
+        gs_free char *     dir  = NULL;
+        nm_auto_free char *real = NULL;
+
+        if (!g_path_is_absolute(link)) {
+            char *tmp;
+
+            dir = g_path_get_dirname(path);
+            tmp = g_build_path("/", dir, link, NULL);
+            g_free(link);
+            g_free(dir);
+            link = tmp;
+        }
+
+        dir  = g_path_get_dirname(link);
+        real = realpath(dir, NULL);
+        if (NM_STR_HAS_SUFFIX(real, "/no-wait.d"))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
 static void
-_find_scripts(Request *request, GHashTable *scripts, const char *base, const char *subdir)
+_find_scripts(GHashTable *scripts, const char *base, const char *subdir)
 {
     const char *  filename;
     gs_free char *dirname = NULL;
@@ -580,8 +739,7 @@ _find_scripts(Request *request, GHashTable *scripts, const char *base, const cha
 
     if (!(dir = g_dir_open(dirname, 0, &error))) {
         if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-            _LOG_R_W(request,
-                     "find-scripts: Failed to open dispatcher directory '%s': %s",
+            _LOG_X_W("find-scripts: Failed to open dispatcher directory '%s': %s",
                      dirname,
                      error->message);
         }
@@ -599,34 +757,60 @@ _find_scripts(Request *request, GHashTable *scripts, const char *base, const cha
     g_dir_close(dir);
 }
 
-static GSList *
-find_scripts(Request *request)
+static int
+_script_index_entry_cmp(gconstpointer a, gconstpointer b)
 {
-    gs_unref_hashtable GHashTable *scripts     = NULL;
-    GSList *                       script_list = NULL;
+    const ScriptIndexEntry *entry_a = *((const ScriptIndexEntry *const *) a);
+    const ScriptIndexEntry *entry_b = *((const ScriptIndexEntry *const *) b);
+
+    return _compare_basenames(entry_a->path, entry_b->path);
+}
+
+static void
+_script_index_entry_free(gpointer ptr)
+{
+    ScriptIndexEntry *entry = ptr;
+
+    g_free(entry->path);
+    nm_g_slice_free(entry);
+}
+
+static GPtrArray *
+find_scripts(ScriptDir script_dir)
+{
+    gs_unref_hashtable GHashTable *scripts = NULL;
+    GPtrArray *                    result;
     GHashTableIter                 iter;
     const char *                   subdir;
     char *                         path;
     char *                         filename;
 
-    if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_UP, NMD_ACTION_VPN_PRE_UP))
+    switch (script_dir) {
+    case SCRIPT_DIR_PRE_UP:
         subdir = "pre-up.d";
-    else if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_DOWN, NMD_ACTION_VPN_PRE_DOWN))
+        break;
+    case SCRIPT_DIR_PRE_DOWN:
         subdir = "pre-down.d";
-    else
+        break;
+    default:
         subdir = NULL;
+        break;
+    }
 
     scripts = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, g_free);
 
-    _find_scripts(request, scripts, NMLIBDIR, subdir);
-    _find_scripts(request, scripts, NMCONFDIR, subdir);
+    _find_scripts(scripts, NMLIBDIR, subdir);
+    _find_scripts(scripts, NMCONFDIR, subdir);
+
+    result = g_ptr_array_new_with_free_func(_script_index_entry_free);
 
     g_hash_table_iter_init(&iter, scripts);
     while (g_hash_table_iter_next(&iter, (gpointer *) &filename, (gpointer *) &path)) {
-        gs_free char *link_target = NULL;
-        const char *  err_msg     = NULL;
-        struct stat   st;
-        int           err;
+        gs_free char *    link_target = NULL;
+        const char *      err_msg     = NULL;
+        ScriptIndexEntry *entry;
+        struct stat       st;
+        int               err;
 
         link_target = g_file_read_link(path, NULL);
         if (nm_streq0(link_target, "/dev/null"))
@@ -634,50 +818,119 @@ find_scripts(Request *request)
 
         err = stat(path, &st);
         if (err)
-            _LOG_R_W(request, "find-scripts: Failed to stat '%s': %d", path, err);
+            _LOG_X_W("find-scripts: Failed to stat '%s': %d", path, err);
         else if (!S_ISREG(st.st_mode) || st.st_size == 0) {
             /* silently skip. */
         } else if (!check_permissions(&st, &err_msg))
-            _LOG_R_W(request, "find-scripts: Cannot execute '%s': %s", path, err_msg);
+            _LOG_X_W("find-scripts: Cannot execute '%s': %s", path, err_msg);
         else {
             /* success */
-            script_list = g_slist_prepend(script_list, g_strdup(path));
+            entry  = g_slice_new(ScriptIndexEntry);
+            *entry = (ScriptIndexEntry){
+                .path = g_strdup(path),
+                .wait = script_must_wait(path),
+            };
+            g_ptr_array_add(result, entry);
             continue;
         }
     }
 
-    return g_slist_sort(script_list, _compare_basenames);
+    g_ptr_array_sort(result, _script_index_entry_cmp);
+    return result;
 }
 
-static gboolean
-script_must_wait(const char *path)
+static void
+script_index_invalidate(void)
 {
-    gs_free char *link = NULL;
+    guint i;
 
-    link = g_file_read_link(path, NULL);
-    if (link) {
-        gs_free char *     dir  = NULL;
-        nm_auto_free char *real = NULL;
+    for (i = 0; i < _SCRIPT_DIR_NUM; i++)
+        nm_clear_pointer(&gl.script_index.scripts[i], g_ptr_array_unref);
+}
 
-        if (!g_path_is_absolute(link)) {
-            char *tmp;
+static void
+_script_index_monitor_changed_cb(GFileMonitor *    monitor,
+                                 GFile *           file,
+                                 GFile *           other_file,
+                                 GFileMonitorEvent event_type,
+                                 gpointer          user_data)
+{
+    _LOG_X_T("find-scripts: dispatcher directories changed, rescan scripts");
+    script_index_invalidate();
+}
 
-            dir = g_path_get_dirname(path);
-            tmp = g_build_path("/", dir, link, NULL);
-            g_free(link);
-            g_free(dir);
-            link = tmp;
-        }
+static gboolean
+script_index_monitor_setup(void)
+{
+    static const char *const bases[]   = {NMLIBDIR, NMCONFDIR};
+    static const char *const subdirs[] = {"pre-up.d", "pre-down.d", "no-wait.d", NULL};
+    guint                    i, j;
 
-        dir  = g_path_get_dirname(link);
-        real = realpath(dir, NULL);
-        if (NM_STR_HAS_SUFFIX(real, "/no-wait.d"))
-            return FALSE;
+    if (gl.script_index.monitors)
+        return TRUE;
+    if (gl.script_index.monitors_failed)
+        return FALSE;
+
+    gl.script_index.monitors = g_ptr_array_new_with_free_func(g_object_unref);
+
+    /* Watch every directory that can affect the result of find_scripts(). That includes
+     * "no-wait.d", because the scripts there are only linked from the other directories.
+     * Changes to scripts that are linked from elsewhere are not noticed. */
+    for (i = 0; i < G_N_ELEMENTS(bases); i++) {
+        for (j = 0; j < G_N_ELEMENTS(subdirs); j++) {
+            gs_unref_object GFile *file   = NULL;
+            gs_free_error GError *error   = NULL;
+            gs_free char *        dirname = NULL;
+            GFileMonitor *        monitor;
+
+            dirname = g_build_filename(bases[i], "dispatcher.d", subdirs[j], NULL);
+            file    = g_file_new_for_path(dirname);
+            monitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, &error);
+            if (!monitor) {
+                _LOG_X_W("find-scripts: cannot monitor directory '%s' (%s). Scan for scripts "
+                         "on every request",
+                         dirname,
+                         error->message);
+                nm_clear_pointer(&gl.script_index.monitors, g_ptr_array_unref);
+                gl.script_index.monitors_failed = TRUE;
+                return FALSE;
+            }
+            g_signal_connect(monitor,
+                             "changed",
+                             G_CALLBACK(_script_index_monitor_changed_cb),
+                             NULL);
+            g_ptr_array_add(gl.script_index.monitors, monitor);
+        }
     }
 
     return TRUE;
 }
 
+/**
+ * script_index_get:
+ * @script_dir: the directory for which to get the scripts.
+ *
+ * Returns the eligible scripts for @script_dir. The result is cached
+ * and only rescanned after the dispatcher directories change. In the
+ * common case, this requires no file system access at all.
+ *
+ * Returns: (transfer full): a #GPtrArray of #ScriptIndexEntry, sorted by
+ *   basename.
+ */
+static GPtrArray *
+script_index_get(ScriptDir script_dir)
+{
+    nm_assert((guint) script_dir < _SCRIPT_DIR_NUM);
+
+    if (!script_index_monitor_setup())
+        return find_scripts(script_dir);
+
+    if (!gl.script_index.scripts[script_dir])
+        gl.script_index.scripts[script_dir] = find_scripts(script_dir);
+
+    return g_ptr_array_ref(gl.script_index.scripts[script_dir]);
+}
+
 static void
 _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
 {
@@ -696,8 +949,8 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
     gs_unref_variant GVariant *vpn_ip4_config       = NULL;
     gs_unref_variant GVariant *vpn_ip6_config       = NULL;
     gboolean                   debug;
-    GSList *                   sorted_scripts = NULL;
-    GSList *                   iter;
+    gs_unref_ptrarray GPtrArray *scripts = NULL;
+    ScriptDir                  script_dir;
     Request *                  request;
     char **                    p;
     guint                      i, num_nowait = 0;
@@ -762,17 +1015,24 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
 
     request->scripts = g_ptr_array_new_full(5, script_info_free);
 
-    sorted_scripts = find_scripts(request);
-    for (iter = sorted_scripts; iter; iter = g_slist_next(iter)) {
-        ScriptInfo *s;
+    if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_UP, NMD_ACTION_VPN_PRE_UP))
+        script_dir = SCRIPT_DIR_PRE_UP;
+    else if (NM_IN_STRSET(request->action, NMD_ACTION_PRE_DOWN, NMD_ACTION_VPN_PRE_DOWN))
+        script_dir = SCRIPT_DIR_PRE_DOWN;
+    else
+        script_dir = SCRIPT_DIR_DEFAULT;
+
+    scripts = script_index_get(script_dir);
+    for (i = 0; i < scripts->len; i++) {
+        const ScriptIndexEntry *entry = scripts->pdata[i];
+        ScriptInfo *            s;
 
         s          = g_slice_new0(ScriptInfo);
         s->request = request;
-        s->script  = iter->data;
-        s->wait    = script_must_wait(s->script);
+        s->script  = g_strdup(entry->path);
+        s->wait    = entry->wait;
         g_ptr_array_add(request->scripts, s);
     }
-    g_slist_free(sorted_scripts);
 
     _LOG_R_D(request, "new request (%u scripts)", request->scripts->len);
     if (_LOG_R_T_enabled(request) && request->envp) {
@@ -809,35 +1069,24 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
     }
 
     if (num_nowait < request->scripts->len) {
-        /* The request has at least one wait script.
-         * Try next_request() to schedule the request for
-         * execution. This either enqueues the request or
-         * sets it as gl.current_request. */
-        if (next_request(request)) {
-            /* @request is now @current_request. Go ahead and
-             * schedule the first wait script. */
-            if (!dispatch_one_script(request)) {
-                /* If that fails, we might be already finished with the
-                 * request. Try complete_request(). */
-                complete_request(request);
-
-                if (next_request(NULL)) {
-                    /* As @request was successfully scheduled as next_request(), there is no
-                     * other request in queue that can be scheduled afterwards. Assert against
-                     * that, but call next_request() to clear current_request. */
-                    g_assert_not_reached();
-                }
-            }
-        }
+        RequestQueue *queue;
+
+        /* The request has at least one wait script. Enqueue it
+         * behind the other requests for the same interface. */
+        queue                  = request_queue_get(request->iface ?: "");
+        request->queue         = queue;
+        request->enqueued_usec = g_get_monotonic_time();
+        g_queue_push_tail(&queue->requests_waiting, request);
+        if (!queue->current_request)
+            request_queue_mark_ready(queue);
+        schedule_requests();
     } else {
         /* The request contains only no-wait scripts. Try to complete
          * the request right away (we might have failed to schedule any
          * of the scripts). It will be either completed now, or later
          * when the pending scripts return.
-         * We don't enqueue it to gl.requests_waiting.
-         * There is no need to handle next_request(), because @request is
-         * not the current request anyway and does not interfere with requests
-         * that have any "wait" scripts. */
+         * We don't enqueue it to any RequestQueue, because it does not
+         * interfere with requests that have any "wait" scripts. */
         complete_request(request);
     }
 }
@@ -984,6 +1233,13 @@ parse_command_line(int *p_argc, char ***p_argv, GError **error)
     GOptionEntry    entries[] = {
         {"debug", 0, 0, G_OPTION_ARG_NONE, &gl.debug, "Output to console rather than syslog", NULL},
         {"persist", 0, 0, G_OPTION_ARG_NONE, &gl.persist, "Don't quit after a short timeout", NULL},
+        {"max-parallel",
+         0,
+         0,
+         G_OPTION_ARG_INT,
+         &gl.max_parallel,
+         "Maximum number of interfaces whose scripts run in parallel",
+         "N"},
         {NULL}};
     gboolean success;
 
@@ -993,6 +1249,9 @@ parse_command_line(int *p_argc, char ***p_argv, GError **error)
 
     success = g_option_context_parse(opt_ctx, p_argc, p_argv, error);
 
+    if (gl.max_parallel <= 0)
+        gl.max_parallel = MAX_PARALLEL_DEFAULT;
+
     g_option_context_free(opt_ctx);
 
     return success;
@@ -1037,7 +1296,9 @@ main(int argc, char **argv)
         goto done;
     }
 
-    gl.requests_waiting = g_queue_new();
+    gl.request_queues = g_hash_table_new(nm_str_hash, g_str_equal);
+    gl.queues_ready   = g_queue_new();
+    gl.script_stats   = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, script_stats_free);
 
     dbus_regist_id =
         g_dbus_connection_register_object(gl.dbus_connection,
@@ -1088,7 +1349,11 @@ done:
     if (dbus_regist_id != 0)
         g_dbus_connection_unregister_object(gl.dbus_connection, nm_steal_int(&dbus_regist_id));
 
-    nm_clear_pointer(&gl.requests_waiting, g_queue_free);
+    nm_clear_pointer(&gl.queues_ready, g_queue_free);
+    nm_clear_pointer(&gl.request_queues, g_hash_table_unref);
+    nm_clear_pointer(&gl.script_stats, g_hash_table_unref);
+    script_index_invalidate();
+    nm_clear_pointer(&gl.script_index.monitors, g_ptr_array_unref);
 
     nm_clear_g_source(&signal_id_term);
     nm_clear_g_source(&signal_id_int);